@@ -4,6 +4,7 @@
 #include <imgui/IconsMaterialDesignIcons.h>
 #include <imgui/imgui_helper.h>
 #include <core/profiler.h>
+#include <core/async_log.h>
 #include <maths/maths_utils.h>
 
 namespace diverse
@@ -13,6 +14,8 @@ namespace diverse
     uint16_t ConsolePanel::s_MessageBufferSize = 0;
     uint16_t ConsolePanel::s_MessageBufferBegin = 0;
     Vector<SharedPtr<ConsolePanel::Message>> ConsolePanel::s_MessageBuffer = Vector<SharedPtr<ConsolePanel::Message>>(2000);
+    std::mutex ConsolePanel::s_PendingMutex;
+    std::vector<SharedPtr<ConsolePanel::Message>> ConsolePanel::s_PendingMessages;
     bool ConsolePanel::s_AllowScrollingToBottom = true;
     bool ConsolePanel::s_RequestScrollToBottom = false;
 
@@ -69,6 +72,27 @@ namespace diverse
             s_RequestScrollToBottom = true;
     }
 
+    void ConsolePanel::add_messages(std::vector<SharedPtr<Message>>& messages)
+    {
+        std::scoped_lock lock(s_PendingMutex);
+        s_PendingMessages.insert(s_PendingMessages.end(), std::make_move_iterator(messages.begin()), std::make_move_iterator(messages.end()));
+        // the panel may not be drawn for a while, older messages would be pushed out of the ring anyway
+        if (s_PendingMessages.size() > s_MessageBufferCapacity)
+            s_PendingMessages.erase(s_PendingMessages.begin(), s_PendingMessages.end() - s_MessageBufferCapacity);
+    }
+
+    void ConsolePanel::consume_pending_messages()
+    {
+        DS_PROFILE_FUNCTION();
+        std::vector<SharedPtr<Message>> pending;
+        {
+            std::scoped_lock lock(s_PendingMutex);
+            pending.swap(s_PendingMessages);
+        }
+        for (auto& message : pending)
+            add_message(message);
+    }
+
     void ConsolePanel::flush()
     {
         DS_PROFILE_FUNCTION();
@@ -82,6 +106,7 @@ namespace diverse
         DS_PROFILE_FUNCTION();
         auto flags = ImGuiWindowFlags_NoCollapse;
         ImGui::SetNextWindowSize(ImVec2(640, 480), ImGuiCond_FirstUseEver);
+        consume_pending_messages();
         ImGui::Begin(name.c_str(), &is_active, flags);
         {
             imgui_render_header();
@@ -159,6 +184,21 @@ namespace diverse
 
         ImGui::GetStyle().ItemSpacing.x = spacing;
 
+#if DS_ENABLE_LOG
+        if (auto async_sink = debug::Log::get_async_sink())
+        {
+            auto stats = async_sink->get_stats();
+            if (stats.dropped + stats.sampledOut > 0)
+            {
+                ImGui::SameLine();
+                ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%s", U8CStr2CStr(ICON_MDI_ALERT));
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("Log ring overflowed\nDropped : %llu\nSampled out : %llu\nPeak queued : %u / %u",
+                        (unsigned long long)stats.dropped, (unsigned long long)stats.sampledOut, stats.highWater, stats.capacity);
+            }
+        }
+#endif
+
         if (!Filter.IsActive())
         {
             ImGui::SameLine();
@@ -5,6 +5,8 @@
 #include <imgui/imgui.h>
 #include <core/reference.h>
 #include <core/vector.h>
+#include <mutex>
+#include <vector>
 
 namespace diverse
 {
@@ -50,16 +52,21 @@ namespace diverse
         void on_imgui_render() override;
 
         static void add_message(const SharedPtr<Message>& message);
+        // thread safe, queued until the next on_imgui_render
+        static void add_messages(std::vector<SharedPtr<Message>>& messages);
 
     private:
         void imgui_render_header();
         void imgui_render_messages();
+        static void consume_pending_messages();
 
     private:
         static uint16_t s_MessageBufferCapacity;
         static uint16_t s_MessageBufferSize;
         static uint16_t s_MessageBufferBegin;
         static Vector<SharedPtr<Message>> s_MessageBuffer;
+        static std::mutex s_PendingMutex;
+        static std::vector<SharedPtr<Message>> s_PendingMessages;
         static bool s_AllowScrollingToBottom;
         static bool s_RequestScrollToBottom;
         static uint32_t s_MessageBufferRenderFilter;
@@ -7,6 +7,7 @@
 #include "keyframe_panel.h"
 #include "histogram_panel.h"
 #include "post_process_panel.h"
+#include "memory_panel.h"
 #include "imgui_console_sink.h"
 #include "progress_bar.h"
 #include "helper_panel.h"
@@ -93,9 +94,7 @@ namespace diverse
         , ini_file("")
     {
 #if DS_ENABLE_LOG
-        spdlog::sink_ptr sink = std::make_shared<ImGuiConsoleSink_mt>();
-
-        diverse::debug::Log::add_sink(sink);
+        diverse::debug::Log::add_batch_sink(std::make_shared<ImGuiConsoleSink>());
 #endif
 
         // Remove?
@@ -248,6 +247,7 @@ namespace diverse
         panels.emplace_back(histogram_panel);
         image_2d_panel = createSharedPtr<Img2DDataSetPanel>(false);
         panels.emplace_back(image_2d_panel);
+        panels.emplace_back(createSharedPtr<MemoryPanel>(false));
         //texture_paint_Panel = createSharedPtr<TexturePaintPanel>(false);
         //panels.emplace_back(texture_paint_Panel);
 #ifndef DS_PLATFORM_IOS
@@ -2272,7 +2272,7 @@ namespace diverse
                         GaussianComponent copy_gs(gs_com);
                         copy_gs.ModelRef = createSharedPtr<GaussianModel>();
                         copy_gs.ModelRef->merge(gs_com.ModelRef.get(),apply_transform);
-                        copy_gs.apply_color_adjustment();
+                        copy_gs.bake_color_adjustment(false);
                         gs_model.merge(copy_gs.ModelRef.get());
                     }
                 }
@@ -2287,7 +2287,7 @@ namespace diverse
                             GaussianComponent copy_gs(*gs_com);
                             copy_gs.ModelRef = createSharedPtr<GaussianModel>();
                             copy_gs.ModelRef->merge(gs_com->ModelRef.get(), apply_transform);
-                            copy_gs.apply_color_adjustment();
+                            copy_gs.bake_color_adjustment(false);
                             gs_model.merge(copy_gs.ModelRef.get());
                         }
                     }
@@ -3448,7 +3448,7 @@ namespace diverse
             GaussianComponent copy_gs(gs_com);
             copy_gs.ModelRef = createSharedPtr<GaussianModel>();
             copy_gs.ModelRef->merge(gs_com.ModelRef.get());
-            copy_gs.apply_color_adjustment();
+            copy_gs.bake_color_adjustment(false);
             gs_model.merge(copy_gs.ModelRef.get());
         }
         
@@ -16,9 +16,12 @@ namespace diverse
                 auto ext = entry.path().extension().string();
                 std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
                 auto is_spv = ".cached" == ext;
+                // cache/ also holds the driver pipeline cache
+                if (!is_spv)
+                    continue;
                 std::vector<u8> spirv;
                 size_t data_size = 0;
-                auto shader_cache_name = std::filesystem::relative(entry.path(), spv_Path).string();
+                auto shader_cache_name = strip_shader_cache_key(std::filesystem::relative(entry.path(), spv_Path).string());
                 if (readByteData(entry.path().string(), spirv, data_size) && data_size > 0)
                 {
                     dump_shader_with_append(shader_cache_name, "../../diverse/source/assets/embeded/embeded_shaders.hpp", spirv);
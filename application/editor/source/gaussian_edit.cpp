@@ -14,6 +14,7 @@ namespace diverse
     auto process_selection(GaussianModel* splat,const EditSelectOpType& op, std::function<bool(int i)>&& pred)->void
     {
         if(!splat) return;
+        auto lock = splat->lock_data();
         parallel_for<size_t>(0, splat->position().size(), [&](size_t i){
             u32 state = splat->state()[i];
             if (state == DELETE_STATE || state == HIDE_STATE) {
@@ -45,6 +46,7 @@ namespace diverse
                 splat->state()[i] = state;
             }
         });
+        lock.unlock();
         splat->update_state();
     }
 
@@ -141,6 +143,12 @@ namespace diverse
         UndoRedoSystem::get().add(std::make_shared<SetSplatColorAdjustmentOp>(splat, old_state, new_state));
     }
 
+    auto GaussianEdit::add_bake_color_adjustment_op() -> void
+    {
+        if (!(splat && splat->ModelRef) || splat->color_adjustment.is_identity()) return;
+        UndoRedoSystem::get().add(std::make_shared<BakeSplatColorAdjustmentOp>(splat));
+    }
+
     auto GaussianEdit::add_place_pivot_op(const maths::Transform& old_trans,
         const maths::Transform& new_trans,
         class Pivot* pivot_t) -> void
@@ -363,17 +371,15 @@ namespace diverse
                     glm::vec4 tintColor;//w: transparency
                     glm::vec4 color_offset;
                 }gs_constants;
-                auto offset = -splat->black_point + splat->brightness;
-                auto scale = 1.0f / (splat->white_point - splat->black_point);
                 gs_constants.transform = glm::transpose(splat_transform->get_world_matrix());
                 gs_constants.mesh_index = buffer_id;
                 gs_constants.surface_width = color_img.desc.extent[0];
                 gs_constants.surface_height = color_img.desc.extent[1];
-                gs_constants.tintColor = glm::vec4(splat->albedo_color.xyz * scale, splat->transparency);
+                gs_constants.tintColor = splat->color_adjustment.tint_color();
                 gs_constants.locked_color = g_render_settings.locked_color;
                 gs_constants.select_color = g_render_settings.select_color;
                 gs_constants.num_gaussians = num_gaussians;
-                gs_constants.color_offset = glm::vec4(glm::vec3(offset, offset, offset), splat->ModelRef->splat_size);
+                gs_constants.color_offset = glm::vec4(splat->color_adjustment.color_offset(), splat->ModelRef->splat_size);
                 auto point_list_key_buffer = rg.import_res(splat->ModelRef->points_key_buf, rhi::AccessType::Nothing);
                 auto point_list_value_buffer = rg.import_res(splat->ModelRef->points_value_buf, rhi::AccessType::Nothing);
                 rg::RenderPass::new_compute(
@@ -494,6 +500,10 @@ namespace diverse
             edit_constants.gs_splat_size = splat->ModelRef->splat_size;
             edit_constants.buf_id = buffer_id;
             auto bursh_buffer = rg.import_res(brush_tool.brush_buffer(), rhi::AccessType::Nothing);
+            auto state_delta_buffer = rg.import_res(splat_model->state_delta_buffer(), rhi::AccessType::Nothing);
+            // the last readback consumed the list, restart it on the gpu ahead of the dispatch
+            if (splat_model->take_state_delta_reset())
+                rg::clear_buffer(rg, state_delta_buffer, 0);
             std::vector<std::pair<std::string, std::string>> defines;
             if (edit_mode == EditMode::Points) // Centers
                 defines = std::vector<std::pair<std::string, std::string>>{
@@ -511,6 +521,7 @@ namespace diverse
                 .read(bursh_buffer)
                 .read(pick_tex)
                 .constants(edit_constants)
+                .write(state_delta_buffer)
                 .raw_descriptor_set(1, bindless_set)
                 .dispatch({ (u32)num_gaussians,1,1 });
 
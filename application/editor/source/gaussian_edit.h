@@ -99,6 +99,7 @@ namespace diverse
         auto    add_color_adjustment_op(
                 const SplatColorAdjustment& old_state,
                 const SplatColorAdjustment& new_state)->void;
+        auto    add_bake_color_adjustment_op()->void;
         auto    add_duplicate_selection_op()->void;
         auto    add_seperate_selection_op()->void;
         auto    add_duplicate_selection_2_instance_op()->void;
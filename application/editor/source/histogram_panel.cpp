@@ -23,58 +23,6 @@
 
 namespace diverse
 {
-    namespace splatData{
-        typedef float (*Func)(float);
-        const auto SH_C0 = 0.28209479177387814;
-        float identity(float v) {
-            return v;
-        }
-
-        float scaleFunc(float v) {
-            return std::exp(v);
-        }
-
-        float colorFunc(float v) {
-            return 0.5 + v * SH_C0;
-        }
-
-        float sigmoid(float v) 
-        {
-            if (v > 0) {
-                return 1 / (1 + std::exp(-v));
-            }
-
-            float t = std::exp(v);
-            return t / (1 + t);
-        }
-
-        struct DataFuncs 
-        {
-            Func x;
-            Func y;
-            Func z;
-            Func scale_0;
-            Func scale_1;
-            Func scale_2;
-            Func f_dc_0;
-            Func f_dc_1;
-            Func f_dc_2;
-            Func opacity;
-        };
-
-        Func dataFuncs[10] = {
-            identity,
-            identity,
-            identity,
-            scaleFunc,
-            scaleFunc,
-            scaleFunc,
-            colorFunc,
-            colorFunc,
-            colorFunc,
-            sigmoid
-        };
-    }
     extern auto process_selection(GaussianModel* splat,const EditSelectOpType& op, std::function<bool(int i)>&& pred) -> void;
 
     HistogramPanel::HistogramPanel(bool active)
@@ -117,47 +65,9 @@ namespace diverse
         auto select_valid = reg.valid(editor->get_current_splat_entt());
         auto gaussian = reg.try_get<diverse::GaussianComponent>(editor->get_current_splat_entt());
         auto splat = gaussian ? gaussian->ModelRef : nullptr;
-        using namespace splatData;
-        auto valueFunc = [&](int idx)->float {
-            u32 gs_state = splat->state()[idx];
-            auto state = getOpState(gs_state);
-            if (state != NORMAL_STATE && state != SELECT_STATE) return INVALID_VALUE;
-            auto pos = splat->position()[idx];
-            auto scale = splat->scale()[idx];
-            switch (select_type)
-            {
-            case 0:
-            case 1:
-            case 2:
-                return dataFuncs[select_type](pos[select_type]);
-            case 3:
-            case 4:
-            case 5:
-                return dataFuncs[select_type](scale[select_type-3]);
-            case 6:
-            case 7:
-            case 8:
-                return dataFuncs[select_type](splat->sh0()[idx][select_type - 6]);
-            case 9:
-                return dataFuncs[select_type](splat->opacity()[idx]);
-            case 10: //distance
-                return glm::length(pos);
-            case 11: //volume
-                return scaleFunc(scale.x) * scaleFunc(scale.y) * scaleFunc(scale.z);
-            case 12: //surface area
-                return scaleFunc(scale.x) * scaleFunc(scale.x) + scaleFunc(scale.y) * scaleFunc(scale.y) + scaleFunc(scale.z) * scaleFunc(scale.z);
-            default:
-                return INVALID_VALUE;
-            }
-            return dataFuncs[0](pos[0]);
-        };
-        auto selecFunc = [&](int idx)->bool {
-            u32 gs_state = splat->state()[idx];
-            auto state = getOpState(gs_state);
-            return state == SELECT_STATE;
-        };
-        if(splat && splat->is_flag_set(AssetFlag::UploadedGpu))
-            histogram.calc(splat->position().size(), valueFunc, selecFunc);
+        // histograms are computed on the job system, this only picks up the latest finished result
+        statistics.update(splat);
+        histogram = statistics.histogram(select_type);
         update_histogram(sceneViewPosition, sceneViewSize);
         if (Input::get().get_mouse_clicked(InputCode::MouseKey::ButtonLeft))
         {
@@ -189,7 +99,7 @@ namespace diverse
                 u32 gs_state = splat->state()[idx];
                 auto state = getOpState(gs_state);
                 if( state != 0 && state != SELECT_STATE) return false;
-                const auto value = valueFunc(idx);
+                const auto value = splat_attribute_value(splat.get(), select_type, idx);
                 const auto bucket = histogram.valueToBucket(value);
                 return bucket >= offset_2_bucket(drag_start.x) && bucket <= offset_2_bucket(drag_end.x);
             });
@@ -1,13 +1,13 @@
 #pragma once
 
 #include "console_panel.h"
-#include <spdlog/sinks/base_sink.h>
+#include <core/async_log.h>
 #include <spdlog/fmt/chrono.h>
 
 namespace diverse
 {
-    template <typename Mutex>
-    class ImGuiConsoleSink : public spdlog::sinks::base_sink<Mutex>
+    // Turns each batch drained by the async logger into console messages, handed over with a single lock
+    class ImGuiConsoleSink : public debug::LogBatchSink
     {
     public:
         explicit ImGuiConsoleSink() {};
@@ -16,17 +16,20 @@ namespace diverse
         ImGuiConsoleSink& operator=(const ImGuiConsoleSink&) = delete;
         virtual ~ImGuiConsoleSink() = default;
 
-        // SPDLog sink interface
-        void sink_it_(const spdlog::details::log_msg& msg) override
+        void consume(const debug::LogRecord* records, size_t count) override
         {
-            spdlog::memory_buf_t formatted;
-            spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
-            std::string source = fmt::format("File : {0} | Function : {1} | Line : {2}", msg.source.filename, msg.source.funcname, msg.source.line);
-            const auto time = fmt::localtime(std::chrono::system_clock::to_time_t(msg.time));
-            auto processed = fmt::format("{:%H:%M:%S}", time);
+            std::vector<SharedPtr<ConsolePanel::Message>> batch;
+            batch.reserve(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                const auto& record = records[i];
+                std::string source = fmt::format("File : {0} | Function : {1} | Line : {2}", record.source.filename, record.source.funcname, record.source.line);
+                const auto time = fmt::localtime(std::chrono::system_clock::to_time_t(record.time));
+                auto processed = fmt::format("{:%H:%M:%S}", time);
 
-            auto message = createSharedPtr<ConsolePanel::Message>(fmt::to_string(formatted), get_message_level(msg.level), source, static_cast<int>(msg.thread_id), processed);
-            ConsolePanel::add_message(message);
+                batch.push_back(createSharedPtr<ConsolePanel::Message>(std::string(record.text.data(), record.text.size()), get_message_level(record.level), source, static_cast<int>(record.threadId), processed));
+            }
+            ConsolePanel::add_messages(batch);
         }
 
         static ConsolePanel::Message::Level get_message_level(const spdlog::level::level_enum level)
@@ -48,18 +51,5 @@ namespace diverse
             }
             return ConsolePanel::Message::Level::Trace;
         }
-
-        void flush_() override
-        {
-            ConsolePanel::flush();
-        };
     };
 }
-
-#include "spdlog/details/null_mutex.h"
-#include <mutex>
-namespace diverse
-{
-    using ImGuiConsoleSink_mt = ImGuiConsoleSink<std::mutex>;                  // multi-threaded
-    using ImGuiConsoleSink_st = ImGuiConsoleSink<spdlog::details::null_mutex>; // single threaded
-}
@@ -736,8 +736,8 @@ namespace MM
         ImGuiHelper::Tooltip("Whether this gaussian participate in rendering");
         ImGuiHelper::Property("SHBand", gaussian.sh_degree, 0, 3);
 
-        static auto old_color_adjustment = diverse::SplatColorAdjustment{gaussian.albedo_color, gaussian.brightness, gaussian.transparency, gaussian.white_point, gaussian.black_point};
-        auto splat_color_adjustment = diverse::SplatColorAdjustment{gaussian.albedo_color, gaussian.brightness, gaussian.transparency, gaussian.white_point, gaussian.black_point};
+        static auto old_color_adjustment = gaussian.color_adjustment;
+        auto splat_color_adjustment = gaussian.color_adjustment;
         float transparency = std::log(splat_color_adjustment.transparency);
         auto modified_color = ImGuiHelper::Property("Transparency", transparency, -6.0f, 6.0f, 0.2f, ImGuiHelper::PropertyFlag::SliderValue);
         modified_color |= ImGuiHelper::Property("Brightness", splat_color_adjustment.brightness, -1.0f, 1.0f,0.1f,ImGuiHelper::PropertyFlag::SliderValue);
@@ -749,14 +749,21 @@ namespace MM
             if ( gaussian.ModelRef && gs_edit.splat == &gaussian && ImGui::IsMouseReleased(ImGuiMouseButton_Left))
                 gs_edit.add_color_adjustment_op(splat_color_adjustment,old_color_adjustment);
             else
+                gaussian.color_adjustment = splat_color_adjustment;
+            old_color_adjustment = splat_color_adjustment;
+        }
+        auto& gs_edit = diverse::GaussianEdit::get();
+        if (gs_edit.splat == &gaussian && !gaussian.color_adjustment.is_identity())
+        {
+            ImGui::TextUnformatted("ColorAdjustment");
+            ImGui::NextColumn();
+            if (ImGui::Button("Bake"))
             {
-                gaussian.albedo_color = splat_color_adjustment.albedo_color;
-                gaussian.brightness = splat_color_adjustment.brightness;
-                gaussian.transparency = splat_color_adjustment.transparency;
-                gaussian.white_point = splat_color_adjustment.white_point;
-                gaussian.black_point = splat_color_adjustment.black_point;
+                gs_edit.add_bake_color_adjustment_op();
+                old_color_adjustment = gaussian.color_adjustment;
             }
-            old_color_adjustment = splat_color_adjustment;
+            ImGuiHelper::Tooltip("Write the color adjustment into the splat data");
+            ImGui::NextColumn();
         }
         ImGui::Columns(1);
         ImGui::Separator();
@@ -0,0 +1,110 @@
+#include "memory_panel.h"
+#include <core/memory_manager.h>
+#include <core/frame_arena.h>
+#include <core/profiler.h>
+#include <utility/string_utils.h>
+#include <imgui/imgui_helper.h>
+#include <imgui/IconsMaterialDesignIcons.h>
+
+namespace diverse
+{
+    MemoryPanel::MemoryPanel(bool active)
+        : EditorPanel(active)
+    {
+        name = U8CStr2CStr(ICON_MDI_MEMORY " Memory###Memory");
+        simple_name = "Memory";
+    }
+
+    void MemoryPanel::on_imgui_render()
+    {
+        DS_PROFILE_FUNCTION();
+        auto flags = ImGuiWindowFlags_NoCollapse;
+        if (!ImGui::Begin(name.c_str(), &is_active, flags))
+        {
+            ImGui::End();
+            return;
+        }
+
+        auto manager = MemoryManager::get();
+        const char* modes[] = { "Off", "Sampled", "Full" };
+        int mode = (int)MemoryManager::get_tracking_mode();
+        ImGui::SetNextItemWidth(120.0f);
+        bool changed = ImGui::Combo("Tracking", &mode, modes, IM_ARRAYSIZE(modes));
+        if (mode == (int)MemoryTrackingMode::Sampled)
+        {
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(120.0f);
+            changed |= ImGui::InputInt("Interval (KB)", &sample_interval_kb, 64, 1024, ImGuiInputTextFlags_EnterReturnsTrue);
+            sample_interval_kb = std::max(1, sample_interval_kb);
+        }
+        if (changed)
+            MemoryManager::set_tracking_mode((MemoryTrackingMode)mode, (u32)sample_interval_kb * 1024);
+        ImGui::SameLine();
+        if (ImGui::Button(U8CStr2CStr(ICON_MDI_EXPORT " Export JSON")))
+            manager->export_tag_stats(report_path);
+
+        if (mode == (int)MemoryTrackingMode::Off)
+            ImGui::TextDisabled("Tracking is off, allocations are not charged to tags");
+        else if (mode == (int)MemoryTrackingMode::Sampled)
+            ImGui::TextDisabled("Sampled: values are estimates");
+
+        const auto table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp;
+        if (ImGui::BeginTable("##memory_tags", 6, table_flags))
+        {
+            ImGui::TableSetupColumn("Tag");
+            ImGui::TableSetupColumn("Live");
+            ImGui::TableSetupColumn("Peak");
+            ImGui::TableSetupColumn("Allocations");
+            ImGui::TableSetupColumn("Allocated/s");
+            ImGui::TableSetupColumn("Allocs/s");
+            ImGui::TableHeadersRow();
+            for (auto& stats : manager->get_tag_stats())
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(stats.name);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(stringutility::byte_2_string(std::max<i64>(0, stats.liveBytes)).c_str());
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(stringutility::byte_2_string(stats.peakBytes).c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%lld", (long long)std::max<i64>(0, stats.liveAllocations));
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(stringutility::byte_2_string((u64)stats.bytesPerSecond).c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.0f", stats.allocationsPerSecond);
+            }
+            ImGui::EndTable();
+        }
+
+        if (ImGui::CollapsingHeader("Frame arenas"))
+        {
+            if (ImGui::BeginTable("##frame_arenas", 5, table_flags))
+            {
+                ImGui::TableSetupColumn("Thread");
+                ImGui::TableSetupColumn("Used");
+                ImGui::TableSetupColumn("High water");
+                ImGui::TableSetupColumn("Reserved");
+                ImGui::TableSetupColumn("Blocks");
+                ImGui::TableHeadersRow();
+                for (int i = 0; i < FrameArenaThreadCount(); i++)
+                {
+                    auto stats = FrameArenaGetStats(i);
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(stats.ThreadName[0] ? stats.ThreadName : "Main");
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(stringutility::byte_2_string(stats.Used).c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(stringutility::byte_2_string(stats.HighWater).c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(stringutility::byte_2_string(stats.Reserved).c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%u", stats.Blocks);
+                }
+                ImGui::EndTable();
+            }
+        }
+        ImGui::End();
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "editor_panel.h"
+#include <string>
+
+namespace diverse
+{
+    class MemoryPanel : public EditorPanel
+    {
+    public:
+        MemoryPanel(bool active = false);
+        void    on_imgui_render() override;
+
+    protected:
+        int     sample_interval_kb = 256;
+        std::string report_path = "memory_report.json";
+    };
+}
@@ -26,6 +26,7 @@
 #include <imgui/imgui_renderer.h>
 #include <events/application_event.h>
 #include <renderer/debug_renderer.h>
+#include <renderer/defered_renderer.h>
 #include <imgui/imgui_internal.h>
 #include <imgui/Plugins/ImGuizmo.h>
 #ifdef DS_SPLAT_TRAIN
@@ -410,6 +411,21 @@ namespace diverse
             {
                 editor->refresh_shaders();
             }
+            auto& pass_profiler = editor->get_renderer()->get_pass_profiler();
+            ImGui::Checkbox("Profile Passes", &pass_profiler.enabled);
+            ImGui::SameLine();
+            if (ImGui::Button("Export Pass Timings"))
+            {
+                pass_profiler.export_json("pass_timings.json");
+                pass_profiler.export_csv("pass_timings.csv");
+            }
+            if (ImGui::BeginMenu("Frame Stages"))
+            {
+                // the frame before the last one, stages overlapping into the next frame are done by then
+                for (const auto& timing : editor->get_frame_scheduler().last_timings())
+                    ImGui::Text("%-28s %7.2f ms  at %6.2f ms  %s", timing.name, timing.duration_ms, timing.start_ms, timing.main_thread ? "main" : "worker");
+                ImGui::EndMenu();
+            }
             ImGuiStyle& style = ImGui::GetStyle();
             float old_spacing = style.ItemSpacing.y;
             style.ItemSpacing.y += 2;
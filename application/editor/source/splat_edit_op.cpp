@@ -1,11 +1,13 @@
 #include "splat_edit_op.h"
 #include "pivot.h"
 #include <utility/thread_pool.h>
+#include <core/memory_manager.h>
 
 namespace diverse
 {
     auto build_index(GaussianModel* splat, std::function<bool(int)> pred) -> std::vector<u32>
     {
+        DS_MEMORY_TAG(UndoHistory);
         auto numSplats = 0;
         for (auto i = 0; i < splat->position().size(); i++) 
             if (pred(i)) numSplats++;
@@ -28,23 +30,28 @@ namespace diverse
     void SplateStateOp::apply()
     {
         auto model = splat->ModelRef.get();
-        parallel_for<size_t>(0, indices.size(), [&](size_t i){
-            auto idx = indices[i];
-            auto& gs_state = model->state()[idx];
-            model->state()[idx] = doIt(gs_state);
-        });   
-       
+        {
+            auto lock = model->lock_data();
+            parallel_for<size_t>(0, indices.size(), [&](size_t i){
+                auto idx = indices[i];
+                auto& gs_state = model->state()[idx];
+                model->state()[idx] = doIt(gs_state);
+            });
+        }
         model->update_state();
     }
 
     void SplateStateOp::undo()
     {
         auto model = splat->ModelRef.get();
-        parallel_for<size_t>(0, indices.size(), [&](size_t i){
-            auto idx = indices[i];
-            auto& gs_state = model->state()[idx];
-            model->state()[idx] = undoIt(gs_state);
-        });
+        {
+            auto lock = model->lock_data();
+            parallel_for<size_t>(0, indices.size(), [&](size_t i){
+                auto idx = indices[i];
+                auto& gs_state = model->state()[idx];
+                model->state()[idx] = undoIt(gs_state);
+            });
+        }
         model->update_state();
     }
 
@@ -309,18 +316,24 @@ namespace diverse
         auto model = splat->ModelRef.get();
         //unselect the indices splat
         duplicate_indices = model->merge(model, select_indices);
-        parallel_for<size_t>(0, select_indices.size(), [&](size_t i) {
-            model->state()[select_indices[i]] &= ~SELECT_STATE;
-        });
+        {
+            auto lock = model->lock_data();
+            parallel_for<size_t>(0, select_indices.size(), [&](size_t i) {
+                model->state()[select_indices[i]] &= ~SELECT_STATE;
+            });
+        }
         model->update_state();
     }
 
     auto DuplicateSelectionSplatOp::undo()->void
     {
         auto model = splat->ModelRef.get();
-        parallel_for<size_t>(0, select_indices.size(), [&](size_t i) {
-            model->state()[select_indices[i]] |= SELECT_STATE;
-        });
+        {
+            auto lock = model->lock_data();
+            parallel_for<size_t>(0, select_indices.size(), [&](size_t i) {
+                model->state()[select_indices[i]] |= SELECT_STATE;
+            });
+        }
         model->remove(duplicate_indices);
     }
     
@@ -331,21 +344,40 @@ namespace diverse
 
     auto SetSplatColorAdjustmentOp::apply()->void
     {
-        splat->albedo_color = new_state.albedo_color;
-        splat->brightness = new_state.brightness;
-        splat->transparency = new_state.transparency;
-        splat->white_point = new_state.white_point;
-        splat->black_point = new_state.black_point;
+        splat->color_adjustment = new_state;
     }
 
     auto SetSplatColorAdjustmentOp::undo()->void
     {
-        splat->albedo_color = old_state.albedo_color;
-        splat->brightness = old_state.brightness;
-        splat->transparency = old_state.transparency;
-        splat->white_point = old_state.white_point;
-        splat->black_point = old_state.black_point;
+        splat->color_adjustment = old_state;
     }
+    BakeSplatColorAdjustmentOp::BakeSplatColorAdjustmentOp(GaussianComponent* splat)
+        : SplatEditOperation(splat), adjustment(splat->color_adjustment)
+    {
+    }
+
+    auto BakeSplatColorAdjustmentOp::apply()->void
+    {
+        auto model = splat->ModelRef.get();
+        old_sh0 = model->sh0();
+        old_opacity = model->opacity();
+        splat->color_adjustment = adjustment;
+        splat->bake_color_adjustment();
+    }
+
+    auto BakeSplatColorAdjustmentOp::undo()->void
+    {
+        auto model = splat->ModelRef.get();
+        if (old_sh0.size() != model->sh0().size()) return;
+        {
+            auto lock = model->lock_data();
+            model->sh0() = std::move(old_sh0);
+            model->opacity() = std::move(old_opacity);
+        }
+        model->update_color_data();
+        splat->color_adjustment = adjustment;
+    }
+
     FilterFunc build_paint_filter_func(GaussianComponent* splat, EditSelectOpType op, FilterFunc filter)
     {
         switch (op)
@@ -372,6 +404,7 @@ namespace diverse
     auto SplatPaintColorAdjustmentOp::apply()->void
     {
         auto ModelRef = splat->ModelRef.get();
+        auto lock = ModelRef->lock_data();
         parallel_for<size_t>(0, indices.size(), [&](size_t i) {
             auto idx = indices[i];
             auto& gs_state = ModelRef->state()[idx];
@@ -390,6 +423,7 @@ namespace diverse
             f_dc_1 = from(to(f_dc_1) * (1 - new_state.mix_weight) + new_state.color.y * new_state.mix_weight);
             f_dc_2 = from(to(f_dc_2) * (1 - new_state.mix_weight) + new_state.color.z * new_state.mix_weight);
         });
+        lock.unlock();
         ModelRef->update_state();
         ModelRef->update_feature_dc_data(indices);
     }
@@ -397,6 +431,7 @@ namespace diverse
     auto SplatPaintColorAdjustmentOp::undo()->void
     {
         auto ModelRef = splat->ModelRef.get();
+        auto lock = ModelRef->lock_data();
         parallel_for<size_t>(0, indices.size(), [&](size_t i) {
             auto idx = indices[i];
             auto& gs_state = ModelRef->state()[idx];
@@ -415,6 +450,7 @@ namespace diverse
             f_dc_1 = from((to(f_dc_1) - new_state.color.y * new_state.mix_weight) / std::max<f32>(1 - new_state.mix_weight, eps));
             f_dc_2 = from((to(f_dc_2) - new_state.color.z * new_state.mix_weight) / std::max<f32>(1 - new_state.mix_weight, eps));
         });
+        lock.unlock();
         ModelRef->update_state();
         ModelRef->update_feature_dc_data(indices);
     }
@@ -146,15 +146,6 @@ namespace diverse
         std::vector<u32> duplicate_indices;
     };
 
-    struct SplatColorAdjustment
-    {
-        glm::vec3 albedo_color;
-        f32       brightness;
-        f32       transparency;
-        f32       white_point;
-        f32       black_point;
-    };
-
     struct SetSplatColorAdjustmentOp : public SplatEditOperation
     {
         SetSplatColorAdjustmentOp(GaussianComponent* splat,const SplatColorAdjustment& old,const SplatColorAdjustment& new_state);
@@ -164,6 +155,17 @@ namespace diverse
         SplatColorAdjustment old_state;
     };
 
+    //bakes the shader-side color adjustment into sh0/opacity
+    struct BakeSplatColorAdjustmentOp : public SplatEditOperation
+    {
+        BakeSplatColorAdjustmentOp(GaussianComponent* splat);
+        void apply() override;
+        void undo() override;
+        SplatColorAdjustment adjustment;
+        std::vector<std::array<float, 3>> old_sh0;
+        std::vector<float> old_opacity;
+    };
+
     struct SplatPaintColorAdjustment
     {
         glm::vec3 color;
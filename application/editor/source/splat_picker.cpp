@@ -41,29 +41,27 @@ namespace diverse
             //gs_edit.set_edit_type(edit_type);
             //gs_edit.set_edit_mode(edit_mode);
             splat->download_state_buffer();
-            auto& select_flag = splat->flags();
+            // only the splats under the cursor carry the op flag, no need to walk the whole model
+            const auto& flagged = splat->flagged_splats();
             f32 closestD = 0;
             glm::vec3 closestP(0.0f);
             i32 closetSplat = -1;
-            for(size_t i = 0; i < pos.size(); i++)
+            for(auto i : flagged)
             {
-                if( select_flag[i]  == 1)
+                auto splat_pos = pos[i];
+                auto transform_index = splat_transform_index[i];
+                glm::mat4 transform = splat->splat_transforms[transform_index];
+                transform = model_transform * glm::transpose(transform);
+                glm::vec3 world_pos = transform * glm::vec4(splat_pos,1.0f);
+                Plane plane(world_pos, camera_transform.get_forward_direction());
+                if(plane.intersects_ray(ray.Origin, ray.Direction, isect_points))
                 {
-                    auto splat_pos = pos[i];
-                    auto transform_index = splat_transform_index[i];
-                    glm::mat4 transform = splat->splat_transforms[transform_index];
-                    transform = model_transform * glm::transpose(transform);
-                    glm::vec3 world_pos = transform * glm::vec4(splat_pos,1.0f);
-                    Plane plane(world_pos, camera_transform.get_forward_direction());
-                    if(plane.intersects_ray(ray.Origin, ray.Direction, isect_points))
+                    const auto distance = glm::distance(isect_points, ray.Origin);
+                    if(distance < closestD || closetSplat < 0)
                     {
-                        const auto distance = glm::distance(isect_points, ray.Origin);
-                        if(distance < closestD || closetSplat < 0)
-                        {
-                            closestD = distance;
-                            closestP = world_pos;
-                            closetSplat = i;
-                        }
+                        closestD = distance;
+                        closestP = world_pos;
+                        closetSplat = i;
                     }
                 }
             }
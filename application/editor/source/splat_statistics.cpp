@@ -0,0 +1,419 @@
+#include "splat_statistics.h"
+#include <core/profiler.h>
+
+namespace diverse
+{
+    namespace
+    {
+        constexpr float SH_C0 = 0.28209479177387814f;
+        constexpr u32 CHUNK_SIZE = 64 * 1024;
+        constexpr u32 BLOCK_SIZE = 256;
+
+        inline float sigmoid(float v)
+        {
+            if (v > 0) {
+                return 1 / (1 + std::exp(-v));
+            }
+            float t = std::exp(v);
+            return t / (1 + t);
+        }
+
+        inline u8 splat_status(u8 state)
+        {
+            auto op = getOpState(state);
+            if (op == SELECT_STATE) return 2;
+            if (op == NORMAL_STATE) return 1;
+            return 0;
+        }
+
+        // One chunk of the model's columns. It is copied under the data lock and binned without it, so an edit
+        // on the ui thread waits for one chunk copy at most and the whole model is never duplicated.
+        struct ChunkColumns
+        {
+            std::vector<glm::vec3>              pos;
+            std::vector<glm::vec3>              scale;
+            std::vector<std::array<float, 3>>   sh0;
+            std::vector<float>                  opacity;
+            std::vector<u8>                     state;
+        };
+
+        // false when the model's data changed since revision, the chunk range may not exist anymore
+        bool copy_chunk(GaussianModel* splat, u32 revision, u64 begin, u64 end, bool with_data, ChunkColumns& columns)
+        {
+            auto lock = splat->lock_data();
+            if (splat->get_data_revision() != revision || end > splat->position().size() || end > splat->state().size())
+                return false;
+            columns.state.assign(splat->state().begin() + begin, splat->state().begin() + end);
+            if (with_data)
+            {
+                columns.pos.assign(splat->position().begin() + begin, splat->position().begin() + end);
+                columns.scale.assign(splat->scale().begin() + begin, splat->scale().begin() + end);
+                columns.sh0.assign(splat->sh0().begin() + begin, splat->sh0().begin() + end);
+                columns.opacity.assign(splat->opacity().begin() + begin, splat->opacity().begin() + end);
+            }
+            return true;
+        }
+
+        // evaluates all attributes for [begin, end) of a chunk column by column so the inner loops stay branch free,
+        // they are plain scalar loops, std::exp keeps the compiler from vectorizing them
+        struct AttributeBlock
+        {
+            float values[SplatStatistics::NUM_ATTRIBUTES][BLOCK_SIZE];
+            u8    status[BLOCK_SIZE];
+        };
+
+        void eval_block(const ChunkColumns& chunk, u64 begin, u64 end, AttributeBlock& block)
+        {
+            const auto count = end - begin;
+            const auto* pos = chunk.pos.data() + begin;
+            const auto* scale = chunk.scale.data() + begin;
+            const auto* sh0 = chunk.sh0.data() + begin;
+            const auto* opacity = chunk.opacity.data() + begin;
+            const auto* state = chunk.state.data() + begin;
+            for (u64 j = 0; j < count; j++)
+                block.status[j] = splat_status(state[j]);
+            for (u64 j = 0; j < count; j++)
+            {
+                block.values[0][j] = pos[j].x;
+                block.values[1][j] = pos[j].y;
+                block.values[2][j] = pos[j].z;
+                block.values[10][j] = std::sqrt(pos[j].x * pos[j].x + pos[j].y * pos[j].y + pos[j].z * pos[j].z);
+            }
+            for (u64 j = 0; j < count; j++)
+            {
+                const float sx = std::exp(scale[j].x);
+                const float sy = std::exp(scale[j].y);
+                const float sz = std::exp(scale[j].z);
+                block.values[3][j] = sx;
+                block.values[4][j] = sy;
+                block.values[5][j] = sz;
+                block.values[11][j] = sx * sy * sz;
+                block.values[12][j] = sx * sx + sy * sy + sz * sz;
+            }
+            for (u64 j = 0; j < count; j++)
+            {
+                block.values[6][j] = 0.5f + sh0[j][0] * SH_C0;
+                block.values[7][j] = 0.5f + sh0[j][1] * SH_C0;
+                block.values[8][j] = 0.5f + sh0[j][2] * SH_C0;
+                block.values[9][j] = sigmoid(opacity[j]);
+            }
+        }
+
+        inline int value_to_bucket(float value, float min_value, float max_value)
+        {
+            float n = min_value == max_value ? 0 : (value - min_value) / (max_value - min_value);
+            return std::clamp(static_cast<int>(std::floor(n * SplatStatistics::NUM_BINS)), 0, (int)SplatStatistics::NUM_BINS - 1);
+        }
+
+        struct ChunkBins
+        {
+            i32 selected[SplatStatistics::NUM_ATTRIBUTES][SplatStatistics::NUM_BINS];
+            i32 unselected[SplatStatistics::NUM_ATTRIBUTES][SplatStatistics::NUM_BINS];
+        };
+
+        float attribute_value(int attribute, const glm::vec3& pos, const glm::vec3& scale, const std::array<float, 3>& sh0, float opacity)
+        {
+            switch ((SplatAttribute)attribute)
+        {
+            case SplatAttribute::X:
+            case SplatAttribute::Y:
+            case SplatAttribute::Z:
+                return pos[attribute];
+            case SplatAttribute::ScaleX:
+            case SplatAttribute::ScaleY:
+            case SplatAttribute::ScaleZ:
+                return std::exp(scale[attribute - 3]);
+            case SplatAttribute::Red:
+            case SplatAttribute::Green:
+            case SplatAttribute::Blue:
+                return 0.5f + sh0[attribute - 6] * SH_C0;
+            case SplatAttribute::Opacity:
+                return sigmoid(opacity);
+            case SplatAttribute::Distance:
+                return glm::length(pos);
+            case SplatAttribute::Volume:
+                return std::exp(scale.x) * std::exp(scale.y) * std::exp(scale.z);
+            case SplatAttribute::SurfaceArea:
+                return std::exp(scale.x) * std::exp(scale.x) + std::exp(scale.y) * std::exp(scale.y) + std::exp(scale.z) * std::exp(scale.z);
+            default:
+                return INVALID_VALUE;
+            }
+        }
+    }
+
+    auto splat_attribute_value(GaussianModel* splat, int attribute, u32 idx) -> float
+    {
+        if (splat_status(splat->state()[idx]) == 0) return INVALID_VALUE;
+        return attribute_value(attribute, splat->position()[idx], splat->scale()[idx], splat->sh0()[idx], splat->opacity()[idx]);
+    }
+
+    SplatStatistics::SplatStatistics()
+    {
+        for (auto& hist : working)
+            hist.resize(NUM_BINS);
+        for (auto& hist : published)
+            hist.resize(NUM_BINS);
+    }
+
+    SplatStatistics::~SplatStatistics()
+    {
+        wait();
+    }
+
+    auto SplatStatistics::update(const SharedPtr<GaussianModel>& splat) -> void
+    {
+        if (is_computing()) return;
+        if (!splat || !splat->is_flag_set(AssetFlag::UploadedGpu))
+        {
+            std::lock_guard<std::mutex> lock(result_mutex);
+            if (published_model)
+            {
+                for (auto& hist : published)
+                    hist = HistogramData(NUM_BINS);
+                published_model = nullptr;
+            }
+            model = nullptr;
+            return;
+        }
+        const bool model_changed = model.get() != splat.get();
+        const bool data_changed = model_changed || data_revision != splat->get_data_revision();
+        const bool state_changed = state_revision != splat->get_state_revision();
+        if (!data_changed && !state_changed) return;
+
+        model = splat;
+        data_revision = splat->get_data_revision();
+        state_revision = splat->get_state_revision();
+        System::JobSystem::execute(context, [this, data_changed, revision = data_revision](JobDispatchArgs args) {
+            DS_PROFILE_SCOPE("SplatStatistics");
+            // the data changing under the job drops the result, update() sees the new revision and starts over
+            if (data_changed || !update_selection(revision))
+            {
+                if (!rebuild(revision))
+                    return;
+            }
+            publish();
+        });
+    }
+
+    auto SplatStatistics::histogram(int attribute) -> HistogramData
+    {
+        std::lock_guard<std::mutex> lock(result_mutex);
+        return published[attribute];
+    }
+
+    auto SplatStatistics::rebuild(u32 revision) -> bool
+    {
+        auto splat = model.get();
+        u64 num_splats = 0;
+        {
+            auto lock = splat->lock_data();
+            if (splat->get_data_revision() != revision)
+                return false;
+            num_splats = std::min(splat->position().size(), splat->state().size());
+        }
+        const u32 num_chunks = (u32)((num_splats + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        counted_state.resize(num_splats);
+        std::atomic_bool data_changed = false;
+
+        // pass 1: min/max
+        struct ChunkRange
+        {
+            std::array<float, NUM_ATTRIBUTES> min_value;
+            std::array<float, NUM_ATTRIBUTES> max_value;
+        };
+        std::vector<ChunkRange> ranges(num_chunks);
+        System::JobSystem::Context ctx;
+        System::JobSystem::dispatch(ctx, num_chunks, 1, [&](JobDispatchArgs args) {
+            auto& range = ranges[args.jobIndex];
+            range.min_value.fill(FLT_MAX);
+            range.max_value.fill(-FLT_MAX);
+            const u64 chunk_begin = (u64)args.jobIndex * CHUNK_SIZE;
+            const u64 chunk_end = std::min<u64>(chunk_begin + CHUNK_SIZE, num_splats);
+            ChunkColumns chunk;
+            if (!copy_chunk(splat, revision, chunk_begin, chunk_end, true, chunk))
+            {
+                data_changed = true;
+                return;
+            }
+            auto block = std::make_unique<AttributeBlock>();
+            for (u64 begin = 0; begin < chunk_end - chunk_begin; begin += BLOCK_SIZE)
+            {
+                const u64 end = std::min<u64>(begin + BLOCK_SIZE, chunk_end - chunk_begin);
+                eval_block(chunk, begin, end, *block);
+                for (u32 a = 0; a < NUM_ATTRIBUTES; a++)
+                {
+                    float min_value = range.min_value[a];
+                    float max_value = range.max_value[a];
+                    for (u64 j = 0; j < end - begin; j++)
+                    {
+                        const float v = block->values[a][j];
+                        const bool valid = block->status[j] != 0;
+                        min_value = valid && v < min_value ? v : min_value;
+                        max_value = valid && v > max_value ? v : max_value;
+                    }
+                    range.min_value[a] = min_value;
+                    range.max_value[a] = max_value;
+                }
+            }
+        });
+        System::JobSystem::wait(ctx);
+        if (data_changed)
+            return false;
+
+        std::array<float, NUM_ATTRIBUTES> min_value;
+        std::array<float, NUM_ATTRIBUTES> max_value;
+        min_value.fill(FLT_MAX);
+        max_value.fill(-FLT_MAX);
+        for (const auto& range : ranges)
+        {
+            for (u32 a = 0; a < NUM_ATTRIBUTES; a++)
+            {
+                min_value[a] = std::min(min_value[a], range.min_value[a]);
+                max_value[a] = std::max(max_value[a], range.max_value[a]);
+            }
+        }
+
+        // pass 2: bins, each chunk fills private bins which are summed afterwards
+        std::vector<ChunkBins> chunk_bins(num_chunks);
+        System::JobSystem::dispatch(ctx, num_chunks, 1, [&](JobDispatchArgs args) {
+            auto& bins = chunk_bins[args.jobIndex];
+            memset(&bins, 0, sizeof(ChunkBins));
+            const u64 chunk_begin = (u64)args.jobIndex * CHUNK_SIZE;
+            const u64 chunk_end = std::min<u64>(chunk_begin + CHUNK_SIZE, num_splats);
+            ChunkColumns chunk;
+            if (!copy_chunk(splat, revision, chunk_begin, chunk_end, true, chunk))
+            {
+                data_changed = true;
+                return;
+            }
+            auto block = std::make_unique<AttributeBlock>();
+            for (u64 begin = 0; begin < chunk_end - chunk_begin; begin += BLOCK_SIZE)
+            {
+                const u64 end = std::min<u64>(begin + BLOCK_SIZE, chunk_end - chunk_begin);
+                eval_block(chunk, begin, end, *block);
+                memcpy(counted_state.data() + chunk_begin + begin, block->status, end - begin);
+                for (u32 a = 0; a < NUM_ATTRIBUTES; a++)
+                {
+                    for (u64 j = 0; j < end - begin; j++)
+                    {
+                        const auto status = block->status[j];
+                        if (status == 0) continue;
+                        const auto bucket = value_to_bucket(block->values[a][j], min_value[a], max_value[a]);
+                        if (status == 2)
+                            bins.selected[a][bucket]++;
+                        else
+                            bins.unselected[a][bucket]++;
+                    }
+                }
+            }
+        });
+        System::JobSystem::wait(ctx);
+        if (data_changed)
+            return false;
+
+        for (u32 a = 0; a < NUM_ATTRIBUTES; a++)
+        {
+            auto& hist = working[a];
+            hist.bins.assign(NUM_BINS, { 0, 0 });
+            for (const auto& bins : chunk_bins)
+            {
+                for (u32 b = 0; b < NUM_BINS; b++)
+                {
+                    hist.bins[b].selected += bins.selected[a][b];
+                    hist.bins[b].unselected += bins.unselected[a][b];
+                }
+            }
+            hist.numValues = 0;
+            for (const auto& bin : hist.bins)
+                hist.numValues += bin.selected + bin.unselected;
+            // no valid splat leaves the range inverted
+            hist.minValue = hist.numValues > 0 ? min_value[a] : 0.0f;
+            hist.maxValue = hist.numValues > 0 ? max_value[a] : 0.0f;
+        }
+        return true;
+    }
+
+    auto SplatStatistics::update_selection(u32 revision) -> bool
+    {
+        auto splat = model.get();
+        u64 num_splats = 0;
+        {
+            auto lock = splat->lock_data();
+            num_splats = std::min(splat->position().size(), splat->state().size());
+        }
+        if (counted_state.size() != num_splats) return false;
+
+        const u32 num_chunks = (u32)((num_splats + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        std::vector<ChunkBins> chunk_delta(num_chunks);
+        std::atomic_bool needs_rebuild = false;
+        System::JobSystem::Context ctx;
+        System::JobSystem::dispatch(ctx, num_chunks, 1, [&](JobDispatchArgs args) {
+            auto& delta = chunk_delta[args.jobIndex];
+            memset(&delta, 0, sizeof(ChunkBins));
+            const u64 chunk_begin = (u64)args.jobIndex * CHUNK_SIZE;
+            const u64 chunk_end = std::min<u64>(chunk_begin + CHUNK_SIZE, num_splats);
+            // the state column alone tells whether the chunk changed, the data columns are only copied if it did
+            ChunkColumns chunk;
+            if (!copy_chunk(splat, revision, chunk_begin, chunk_end, false, chunk))
+            {
+                needs_rebuild = true;
+                return;
+            }
+            bool changed = false;
+            for (u64 i = 0; i < chunk_end - chunk_begin && !changed; i++)
+                changed = splat_status(chunk.state[i]) != counted_state[chunk_begin + i];
+            if (!changed)
+                return;
+            if (!copy_chunk(splat, revision, chunk_begin, chunk_end, true, chunk))
+            {
+                needs_rebuild = true;
+                return;
+            }
+            for (u64 i = 0; i < chunk_end - chunk_begin; i++)
+            {
+                const auto status = splat_status(chunk.state[i]);
+                const auto counted = counted_state[chunk_begin + i];
+                if (status == counted) continue;
+                // hiding/deleting changes the value range, only a rebuild can handle it
+                if (status == 0 || counted == 0)
+                {
+                    needs_rebuild = true;
+                    return;
+                }
+                for (u32 a = 0; a < NUM_ATTRIBUTES; a++)
+                {
+                    const auto& hist = working[a];
+                    const auto value = attribute_value(a, chunk.pos[i], chunk.scale[i], chunk.sh0[i], chunk.opacity[i]);
+                    const auto bucket = value_to_bucket(value, hist.minValue, hist.maxValue);
+                    const i32 sign = status == 2 ? 1 : -1;
+                    delta.selected[a][bucket] += sign;
+                    delta.unselected[a][bucket] -= sign;
+                }
+                counted_state[chunk_begin + i] = status;
+            }
+        });
+        System::JobSystem::wait(ctx);
+        if (needs_rebuild) return false;
+
+        for (u32 a = 0; a < NUM_ATTRIBUTES; a++)
+        {
+            auto& hist = working[a];
+            for (const auto& delta : chunk_delta)
+            {
+                for (u32 b = 0; b < NUM_BINS; b++)
+                {
+                    hist.bins[b].selected += delta.selected[a][b];
+                    hist.bins[b].unselected += delta.unselected[a][b];
+                }
+            }
+        }
+        return true;
+    }
+
+    auto SplatStatistics::publish() -> void
+    {
+        std::lock_guard<std::mutex> lock(result_mutex);
+        published = working;
+        published_model = model.get();
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <algorithm>
+#include <cmath>
+#include <core/reference.h>
+#include <core/job_system.h>
+#include <assets/gaussian_model.h>
+
+namespace diverse
+{
+    constexpr float INVALID_VALUE = -1e10f;
+
+    class HistogramData
+    {
+    public:
+        struct Bin
+        {
+            int selected;
+            int unselected;
+        };
+        std::vector<Bin> bins;
+        int numValues = 0;
+        float minValue = 0.0f;
+        float maxValue = 0.0f;
+
+        HistogramData() {}
+        HistogramData(int numBins)
+        {
+            for (auto i = 0; i < numBins; ++i)
+            {
+                bins.push_back({ 0, 0 });
+            }
+        }
+
+        void resize(int numBins)
+        {
+            bins.resize(numBins, { 0, 0 });
+        }
+
+        float bucketValue(int bucket)
+        {
+            return minValue + bucket * bucketSize();
+        }
+
+        float bucketSize()
+        {
+            return (maxValue - minValue) / bins.size();
+        }
+
+        int valueToBucket(float value)
+        {
+            float n = minValue == maxValue ? 0 : (value - minValue) / (maxValue - minValue);
+            return std::min(static_cast<int>(bins.size() - 1), static_cast<int>(std::floor(n * bins.size())));
+        }
+
+        std::pair<int,int> binMaxNumValues()
+        {
+            int maxNum = 0;
+            int idx = 0;
+            for (size_t i = 0;i<bins.size();i++)
+            {
+                const auto& bin = bins[i];
+                auto num = (bin.selected + bin.unselected);
+                if (maxNum < num)
+                {
+                    maxNum = num;
+                    idx = static_cast<int>(i);
+                }
+            }
+            return {maxNum,idx};
+        }
+    };
+
+    enum class SplatAttribute : u8
+    {
+        X = 0,
+        Y,
+        Z,
+        ScaleX,
+        ScaleY,
+        ScaleZ,
+        Red,
+        Green,
+        Blue,
+        Opacity,
+        Distance,
+        Volume,
+        SurfaceArea,
+        Count
+    };
+
+    // single splat evaluation, INVALID_VALUE for hidden/deleted splats
+    auto splat_attribute_value(GaussianModel* splat, int attribute, u32 idx) -> float;
+
+    // Computes the histograms of every splat attribute on the JobSystem.
+    // update() is called once per frame from the ui thread and never waits on the workers;
+    // selection-only changes are folded into the cached bins instead of rebuilding them.
+    // The model's data lock is held only while a chunk of the columns is copied, not while binning it.
+    class SplatStatistics
+    {
+    public:
+        static constexpr u32 NUM_ATTRIBUTES = (u32)SplatAttribute::Count;
+        static constexpr u32 NUM_BINS = 256;
+
+        SplatStatistics();
+        ~SplatStatistics();
+
+        auto update(const SharedPtr<GaussianModel>& model) -> void;
+        auto histogram(int attribute) -> HistogramData;
+        auto is_computing() const -> bool { return System::JobSystem::is_busy(context); }
+        auto wait() -> void { System::JobSystem::wait(context); }
+
+    private:
+        // false when the model's data revision moved away from revision, update_selection also when only a rebuild can follow the change
+        auto rebuild(u32 revision) -> bool;
+        auto update_selection(u32 revision) -> bool;
+        auto publish() -> void;
+
+        System::JobSystem::Context              context;
+        SharedPtr<GaussianModel>                model;
+        u32                                     data_revision = ~0u;
+        u32                                     state_revision = ~0u;
+        std::array<HistogramData, NUM_ATTRIBUTES>   working;
+        std::vector<u8>                         counted_state; //0: not counted, 1: unselected, 2: selected
+
+        std::mutex                              result_mutex;
+        std::array<HistogramData, NUM_ATTRIBUTES>   published;
+        GaussianModel*                          published_model = nullptr;
+    };
+}
@@ -50,9 +50,23 @@
     float gs_splat_size;
     uint buf_id;
 };
+// [0]: number of changed splats, (index, new state) pairs from byte 16
+[[vk::binding(3)]] RWByteAddressBuffer state_delta;
 
 static const float minAlpha = 1.0 / 255.0;
 
+void store_state(uint global_id, uint old_state, uint new_state)
+{
+    bindless_splat_state[buf_id].Store<uint>(global_id * sizeof(uint), new_state);
+    if (old_state == new_state) return;
+    uint capacity_bytes;
+    state_delta.GetDimensions(capacity_bytes);
+    uint slot;
+    state_delta.InterlockedAdd(0, 1, slot);
+    if (16 + (slot + 1) * 8 <= capacity_bytes)
+        state_delta.Store2(16 + slot * 8, uint2(global_id, new_state));
+}
+
 float2 clip_to_uv(float2 cs) 
 {
     return cs * float2(0.5, -0.5) + float2(0.5, 0.5);
@@ -181,8 +195,7 @@ void main(uint2 px: SV_DispatchThreadID)
 
         if (op_state & DELETE_STATE || op_state & HIDE_STATE)
         {
-            gs_state = setOpFlag(gs_state, 0);
-            bindless_splat_state[buf_id].Store<uint>(global_id * sizeof(uint), gs_state);
+            store_state(global_id, gs_state, setOpFlag(gs_state, 0));
             return;
         }
 #if SPLAT_EDIT
@@ -301,7 +314,6 @@ void main(uint2 px: SV_DispatchThreadID)
             }
         }
 #endif
-        gs_state = setOpFlag(gs_state, in_crop);
-        bindless_splat_state[buf_id].Store<uint>(global_id * sizeof(uint), gs_state);
+        store_state(global_id, gs_state, setOpFlag(gs_state, in_crop));
     }
 }
\ No newline at end of file
@@ -0,0 +1,312 @@
+#include "async_log.h"
+
+#if DS_ENABLE_LOG
+#include "core/profiler.h"
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/os.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+namespace diverse::debug
+{
+    static uint32_t round_up_pow2(uint32_t v)
+    {
+        uint32_t p = 64;
+        while(p < v)
+            p <<= 1;
+        return p;
+    }
+
+    AsyncLogSink::AsyncLogSink(const AsyncLogDesc& desc)
+        : m_Policy(desc.policy)
+        , m_SampleRate(std::max(1u, desc.sampleRate))
+        , m_FlushIntervalMs(std::max(1u, desc.flushIntervalMs))
+    {
+        static_assert(sizeof(Slot) <= SLOT_SIZE);
+        const uint32_t capacity = round_up_pow2(desc.capacity);
+        m_Mask                  = capacity - 1;
+        m_Slots                 = static_cast<Slot*>(std::calloc(capacity, sizeof(Slot)));
+        for(uint32_t i = 0; i < capacity; i++)
+            new(&m_Slots[i].sequence) std::atomic<uint64_t>(i);
+
+        m_Thread = std::thread([this] { run(); });
+    }
+
+    AsyncLogSink::~AsyncLogSink()
+    {
+        m_Running.store(false, std::memory_order_release);
+        {
+            std::scoped_lock lock(m_WakeMutex);
+            m_WakeCondition.notify_one();
+        }
+        if(m_Thread.joinable())
+            m_Thread.join();
+
+        for(uint64_t i = 0; i <= m_Mask; i++)
+            std::free(m_Slots[i].heapText);
+        std::free(m_Slots);
+    }
+
+    bool AsyncLogSink::try_push(const spdlog::details::log_msg& msg)
+    {
+        uint64_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+        Slot* slot   = nullptr;
+        for(;;)
+        {
+            slot                = &m_Slots[pos & m_Mask];
+            const uint64_t seq  = slot->sequence.load(std::memory_order_acquire);
+            const int64_t diff  = (int64_t)seq - (int64_t)pos;
+            if(diff == 0)
+            {
+                if(m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if(diff < 0)
+                return false;
+            else
+                pos = m_EnqueuePos.load(std::memory_order_relaxed);
+        }
+
+        slot->level      = msg.level;
+        slot->time       = msg.time;
+        slot->threadId   = msg.thread_id;
+        slot->source     = msg.source;
+        slot->loggerName = msg.logger_name;
+        slot->size       = (uint32_t)msg.payload.size();
+        std::free(slot->heapText);
+        slot->heapText = nullptr;
+        char* dst      = slot->text;
+        if(msg.payload.size() > sizeof(slot->text))
+            dst = slot->heapText = static_cast<char*>(std::malloc(msg.payload.size()));
+        memcpy(dst, msg.payload.data(), msg.payload.size());
+        slot->sequence.store(pos + 1, std::memory_order_release);
+
+        // the consumer may have moved past pos already
+        const int64_t backlog = (int64_t)(pos + 1) - (int64_t)m_DequeuePos.load(std::memory_order_relaxed);
+        const uint32_t queued = (uint32_t)std::clamp<int64_t>(backlog, 0, (int64_t)m_Mask + 1);
+        uint32_t high         = m_HighWater.load(std::memory_order_relaxed);
+        while(queued > high && !m_HighWater.compare_exchange_weak(high, queued, std::memory_order_relaxed))
+            ;
+        // the flush thread polls anyway, only hurry it for important messages or a filling ring
+        if(msg.level >= spdlog::level::warn || queued > (m_Mask + 1) / 4)
+            wake();
+        return true;
+    }
+
+    void AsyncLogSink::log(const spdlog::details::log_msg& msg)
+    {
+        const bool important           = msg.level >= spdlog::level::warn;
+        const LogOverflowPolicy policy = important ? LogOverflowPolicy::Block : m_Policy.load(std::memory_order_relaxed);
+
+        if(policy == LogOverflowPolicy::Sample)
+        {
+            const uint64_t queued = m_EnqueuePos.load(std::memory_order_relaxed) - m_DequeuePos.load(std::memory_order_relaxed);
+            if(queued > (m_Mask + 1) / 4 * 3)
+            {
+                static thread_local uint32_t counter = 0;
+                if(counter++ % m_SampleRate.load(std::memory_order_relaxed) != 0)
+                {
+                    m_SampledOut.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+
+        if(try_push(msg))
+        {
+            m_Enqueued.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        if(policy != LogOverflowPolicy::Block || std::this_thread::get_id() == m_Thread.get_id())
+        {
+            m_Dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        m_Blocked.fetch_add(1, std::memory_order_relaxed);
+        do
+        {
+            wake();
+            std::this_thread::yield();
+        } while(!try_push(msg));
+        m_Enqueued.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void AsyncLogSink::wake()
+    {
+        if(m_Sleeping.load(std::memory_order_acquire))
+        {
+            std::scoped_lock lock(m_WakeMutex);
+            m_WakeCondition.notify_one();
+        }
+    }
+
+    // Drains up to BATCH_COUNT published slots, hands them to every sink and then releases them to the producers
+    size_t AsyncLogSink::drain()
+    {
+        DS_PROFILE_FUNCTION_LOW();
+        LogRecord records[BATCH_COUNT];
+        const uint64_t start = m_DequeuePos.load(std::memory_order_relaxed);
+        size_t count         = 0;
+        bool important       = false;
+        while(count < BATCH_COUNT)
+        {
+            Slot& slot = m_Slots[(start + count) & m_Mask];
+            if(slot.sequence.load(std::memory_order_acquire) != start + count + 1)
+                break;
+            records[count] = { slot.level, slot.time, slot.threadId, slot.source, { slot.heapText ? slot.heapText : slot.text, slot.size } };
+            important |= slot.level >= spdlog::level::warn;
+            count++;
+        }
+        if(count == 0)
+            return 0;
+
+        {
+            std::scoped_lock lock(m_SinkMutex);
+            for(size_t i = 0; i < count; i++)
+            {
+                const Slot& slot = m_Slots[(start + i) & m_Mask];
+                spdlog::details::log_msg msg(records[i].time, records[i].source, slot.loggerName, records[i].level, records[i].text);
+                msg.thread_id = records[i].threadId;
+                for(auto& sink : m_Sinks)
+                {
+                    if(sink->should_log(msg.level))
+                        sink->log(msg);
+                }
+            }
+            for(auto& sink : m_BatchSinks)
+                sink->consume(records, count);
+            if(important)
+            {
+                for(auto& sink : m_Sinks)
+                    sink->flush();
+            }
+        }
+
+        for(size_t i = 0; i < count; i++)
+        {
+            Slot& slot = m_Slots[(start + i) & m_Mask];
+            slot.sequence.store(start + i + m_Mask + 1, std::memory_order_release);
+        }
+        m_DequeuePos.store(start + count, std::memory_order_release);
+        m_Written.fetch_add(count, std::memory_order_relaxed);
+        return count;
+    }
+
+    void AsyncLogSink::run()
+    {
+        DS_PROFILE_SETTHREADNAME("LogFlush");
+        auto last_flush = std::chrono::steady_clock::now();
+        for(;;)
+        {
+            size_t drained = 0;
+            while(size_t n = drain())
+                drained += n;
+
+            if(drained)
+            {
+                std::scoped_lock lock(m_WakeMutex);
+                m_DrainedCondition.notify_all();
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if(now - last_flush >= std::chrono::milliseconds(m_FlushIntervalMs))
+            {
+                std::scoped_lock lock(m_SinkMutex);
+                for(auto& sink : m_Sinks)
+                    sink->flush();
+                last_flush = now;
+            }
+
+            if(!m_Running.load(std::memory_order_acquire))
+            {
+                // producers may still have been writing a claimed slot, pick those up before exiting
+                if(m_DequeuePos.load() == m_EnqueuePos.load())
+                    break;
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock lock(m_WakeMutex);
+            m_Sleeping.store(true, std::memory_order_release);
+            const uint64_t tail = m_DequeuePos.load(std::memory_order_relaxed);
+            if(m_Running.load(std::memory_order_acquire) && m_Slots[tail & m_Mask].sequence.load(std::memory_order_acquire) != tail + 1)
+                m_WakeCondition.wait_for(lock, std::chrono::milliseconds(m_FlushIntervalMs));
+            m_Sleeping.store(false, std::memory_order_release);
+        }
+
+        {
+            std::scoped_lock lock(m_SinkMutex);
+            for(auto& sink : m_Sinks)
+                sink->flush();
+        }
+        std::scoped_lock lock(m_WakeMutex);
+        m_DrainedCondition.notify_all();
+    }
+
+    void AsyncLogSink::flush()
+    {
+        if(std::this_thread::get_id() == m_Thread.get_id())
+            return;
+        const uint64_t target = m_EnqueuePos.load(std::memory_order_acquire);
+        {
+            std::unique_lock lock(m_WakeMutex);
+            m_WakeCondition.notify_one();
+            m_DrainedCondition.wait_for(lock, std::chrono::seconds(2), [&] {
+                return m_DequeuePos.load(std::memory_order_acquire) >= target || !m_Running.load();
+            });
+        }
+        std::scoped_lock lock(m_SinkMutex);
+        for(auto& sink : m_Sinks)
+            sink->flush();
+    }
+
+    void AsyncLogSink::set_pattern(const std::string& pattern)
+    {
+        std::scoped_lock lock(m_SinkMutex);
+        for(auto& sink : m_Sinks)
+            sink->set_pattern(pattern);
+    }
+
+    void AsyncLogSink::set_formatter(std::unique_ptr<spdlog::formatter> formatter)
+    {
+        std::scoped_lock lock(m_SinkMutex);
+        for(auto& sink : m_Sinks)
+            sink->set_formatter(formatter->clone());
+    }
+
+    void AsyncLogSink::add_sink(const spdlog::sink_ptr& sink)
+    {
+        std::scoped_lock lock(m_SinkMutex);
+        m_Sinks.push_back(sink);
+    }
+
+    void AsyncLogSink::add_batch_sink(const std::shared_ptr<LogBatchSink>& sink)
+    {
+        std::scoped_lock lock(m_SinkMutex);
+        m_BatchSinks.push_back(sink);
+    }
+
+    void AsyncLogSink::set_overflow_policy(LogOverflowPolicy policy, uint32_t sampleRate)
+    {
+        m_Policy.store(policy, std::memory_order_relaxed);
+        m_SampleRate.store(std::max(1u, sampleRate), std::memory_order_relaxed);
+    }
+
+    AsyncLogStats AsyncLogSink::get_stats() const
+    {
+        AsyncLogStats stats;
+        stats.enqueued   = m_Enqueued.load(std::memory_order_relaxed);
+        stats.written    = m_Written.load(std::memory_order_relaxed);
+        stats.dropped    = m_Dropped.load(std::memory_order_relaxed);
+        stats.sampledOut = m_SampledOut.load(std::memory_order_relaxed);
+        stats.blocked    = m_Blocked.load(std::memory_order_relaxed);
+        stats.highWater  = m_HighWater.load(std::memory_order_relaxed);
+        stats.capacity   = (uint32_t)(m_Mask + 1);
+        return stats;
+    }
+}
+#endif
@@ -0,0 +1,137 @@
+#pragma once
+#include "ds_log.h"
+
+#if DS_ENABLE_LOG
+#include <spdlog/sinks/sink.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace diverse
+{
+    namespace debug
+    {
+        // What a full ring does with trace / debug / info messages.
+        // Warnings and above always wait for space, they are rare and must not be lost.
+        enum class LogOverflowPolicy : uint8_t
+        {
+            Drop,   // discard the message
+            Block,  // wait for the flush thread to make room
+            Sample  // past 3/4 full keep one message in sampleRate, drop when full
+        };
+
+        struct AsyncLogDesc
+        {
+            uint32_t capacity        = 8192; // rounded up to a power of two
+            LogOverflowPolicy policy = LogOverflowPolicy::Sample;
+            uint32_t sampleRate      = 8;
+            uint32_t flushIntervalMs = 50;
+        };
+
+        struct AsyncLogStats
+        {
+            uint64_t enqueued;
+            uint64_t written;
+            uint64_t dropped;    // ring full
+            uint64_t sampledOut; // skipped by LogOverflowPolicy::Sample
+            uint64_t blocked;    // producers that had to wait for space
+            uint32_t highWater;  // most messages queued at once
+            uint32_t capacity;
+        };
+
+        // A message as handed to batch sinks, text and source strings stay valid for the duration of the call only
+        struct LogRecord
+        {
+            spdlog::level::level_enum level;
+            spdlog::log_clock::time_point time;
+            size_t threadId;
+            spdlog::source_loc source;
+            spdlog::string_view_t text;
+        };
+
+        // Receives every drained batch on the flush thread, e.g. the editor console
+        class LogBatchSink
+        {
+        public:
+            virtual ~LogBatchSink() = default;
+            virtual void consume(const LogRecord* records, size_t count) = 0;
+        };
+
+        // Bounded multi producer / single consumer ring in front of the real sinks. The calling thread only
+        // formats the payload and copies it into a slot, the pattern formatting and the console / file writes
+        // run on a background flush thread.
+        class AsyncLogSink final : public spdlog::sinks::sink
+        {
+        public:
+            explicit AsyncLogSink(const AsyncLogDesc& desc = {});
+            ~AsyncLogSink() override;
+
+            void log(const spdlog::details::log_msg& msg) override;
+            // blocks until everything logged before the call is written
+            void flush() override;
+            void set_pattern(const std::string& pattern) override;
+            void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override;
+
+            void add_sink(const spdlog::sink_ptr& sink);
+            void add_batch_sink(const std::shared_ptr<LogBatchSink>& sink);
+
+            void set_overflow_policy(LogOverflowPolicy policy, uint32_t sampleRate = 8);
+            LogOverflowPolicy get_overflow_policy() const { return m_Policy.load(std::memory_order_relaxed); }
+            AsyncLogStats get_stats() const;
+
+        private:
+            static constexpr uint32_t SLOT_SIZE   = 256;
+            static constexpr uint32_t BATCH_COUNT = 256;
+
+            struct Slot
+            {
+                std::atomic<uint64_t> sequence;
+                spdlog::level::level_enum level;
+                spdlog::log_clock::time_point time;
+                size_t threadId;
+                spdlog::source_loc source;
+                spdlog::string_view_t loggerName;
+                char* heapText; // set when the payload does not fit inline
+                uint32_t size;
+                char text[SLOT_SIZE - 88];
+            };
+
+            bool try_push(const spdlog::details::log_msg& msg);
+            void wake();
+            void run();
+            size_t drain();
+
+            Slot* m_Slots;
+            uint64_t m_Mask;
+            alignas(64) std::atomic<uint64_t> m_EnqueuePos { 0 };
+            alignas(64) std::atomic<uint64_t> m_DequeuePos { 0 };
+
+            std::atomic<LogOverflowPolicy> m_Policy;
+            std::atomic<uint32_t> m_SampleRate;
+            uint32_t m_FlushIntervalMs;
+
+            std::atomic<uint64_t> m_Enqueued { 0 };
+            std::atomic<uint64_t> m_Written { 0 };
+            std::atomic<uint64_t> m_Dropped { 0 };
+            std::atomic<uint64_t> m_SampledOut { 0 };
+            std::atomic<uint64_t> m_Blocked { 0 };
+            std::atomic<uint32_t> m_HighWater { 0 };
+
+            // sinks are only added during startup, the mutex keeps that safe against a running drain
+            std::mutex m_SinkMutex;
+            std::vector<spdlog::sink_ptr> m_Sinks;
+            std::vector<std::shared_ptr<LogBatchSink>> m_BatchSinks;
+
+            std::mutex m_WakeMutex;
+            std::condition_variable m_WakeCondition;
+            std::condition_variable m_DrainedCondition;
+            std::atomic<bool> m_Sleeping { false };
+            std::atomic<bool> m_Running { true };
+            std::thread m_Thread;
+        };
+    }
+}
+#endif
@@ -0,0 +1,264 @@
+#include "cpu_topology.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#ifdef DS_PLATFORM_WINDOWS
+#define NOMINMAX
+#include <Windows.h>
+#elif DS_PLATFORM_LINUX
+#include <sched.h>
+#include <filesystem>
+#endif
+
+namespace diverse
+{
+    namespace System
+    {
+        uint32_t CpuTopology::usable_cpus() const
+        {
+            uint32_t count = std::max<uint32_t>(1u, (uint32_t)cpus.size());
+            if(quota_cpus > 0.0f)
+                count = std::min(count, std::max<uint32_t>(1u, (uint32_t)std::ceil(quota_cpus)));
+            return count;
+        }
+
+        std::vector<uint32_t> CpuTopology::nodes() const
+        {
+            std::vector<uint32_t> result;
+            for(auto& cpu : cpus)
+            {
+                if(std::find(result.begin(), result.end(), cpu.node) == result.end())
+                    result.push_back(cpu.node);
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+
+        std::vector<uint32_t> parse_cpu_list(const std::string& list)
+        {
+            std::vector<uint32_t> result;
+            std::stringstream ss(list);
+            std::string range;
+            while(std::getline(ss, range, ','))
+            {
+                if(range.empty() || !isdigit((unsigned char)range[0]))
+                    continue;
+                auto dash = range.find('-');
+                uint32_t first = (uint32_t)std::stoul(range.substr(0, dash));
+                uint32_t last  = dash == std::string::npos ? first : (uint32_t)std::stoul(range.substr(dash + 1));
+                for(uint32_t i = first; i <= last; i++)
+                    result.push_back(i);
+            }
+            return result;
+        }
+
+#ifdef DS_PLATFORM_LINUX
+        static bool read_line(const std::string& path, std::string& line)
+        {
+            std::ifstream file(path);
+            return file && std::getline(file, line) && !line.empty();
+        }
+
+        static uint32_t read_uint(const std::string& path, uint32_t fallback)
+        {
+            std::string line;
+            if(!read_line(path, line) || !isdigit((unsigned char)line[0]))
+                return fallback;
+            return (uint32_t)std::stoul(line);
+        }
+
+        // cgroup v2 "cpu.max" holds "<quota> <period>" or "max <period>"
+        static float read_cgroup2_quota(const std::string& dir)
+        {
+            std::string line;
+            if(!read_line(dir + "/cpu.max", line))
+                return 0.0f;
+            std::stringstream ss(line);
+            std::string quota;
+            double period = 0.0;
+            ss >> quota >> period;
+            if(quota == "max" || period <= 0.0)
+                return 0.0f;
+            return (float)(std::stod(quota) / period);
+        }
+
+        static float read_cgroup1_quota(const std::string& dir)
+        {
+            std::string quota, period;
+            if(!read_line(dir + "/cpu.cfs_quota_us", quota) || !read_line(dir + "/cpu.cfs_period_us", period))
+                return 0.0f;
+            double q = std::stod(quota), p = std::stod(period);
+            if(q <= 0.0 || p <= 0.0) // -1 is unlimited
+                return 0.0f;
+            return (float)(q / p);
+        }
+
+        static float min_quota(float a, float b)
+        {
+            if(a <= 0.0f)
+                return b;
+            if(b <= 0.0f)
+                return a;
+            return std::min(a, b);
+        }
+
+        // Walks the process cgroup up to the root, every level can limit it. Inside a container the cgroup
+        // namespace root is what /sys/fs/cgroup shows, so the path from /proc/self/cgroup may not exist; the
+        // mount root is read as well in that case.
+        static float query_cgroup_quota()
+        {
+            std::ifstream file("/proc/self/cgroup");
+            std::string line;
+            float quota = 0.0f;
+            while(file && std::getline(file, line))
+            {
+                // "<id>:<controllers>:<path>", v2 has id 0 and no controllers
+                auto first  = line.find(':');
+                auto second = line.find(':', first + 1);
+                if(first == std::string::npos || second == std::string::npos)
+                    continue;
+                std::string controllers = line.substr(first + 1, second - first - 1);
+                std::string path        = line.substr(second + 1);
+
+                std::vector<std::string> roots;
+                bool v2 = controllers.empty();
+                if(v2)
+                    roots = { "/sys/fs/cgroup" };
+                else if(controllers.find("cpu") != std::string::npos && controllers.find("cpuset") == std::string::npos)
+                    roots = { "/sys/fs/cgroup/cpu,cpuacct", "/sys/fs/cgroup/cpu" };
+                else
+                    continue;
+
+                for(auto& root : roots)
+                {
+                    std::string dir = path;
+                    while(true)
+                    {
+                        auto full = root + (dir == "/" ? "" : dir);
+                        quota     = min_quota(quota, v2 ? read_cgroup2_quota(full) : read_cgroup1_quota(full));
+                        if(dir.empty() || dir == "/")
+                            break;
+                        dir = dir.substr(0, dir.find_last_of('/'));
+                    }
+                }
+            }
+            return quota;
+        }
+
+        CpuTopology query_cpu_topology()
+        {
+            CpuTopology topo;
+            topo.hardware_threads = std::thread::hardware_concurrency();
+
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if(sched_getaffinity(0, sizeof(set), &set) == 0)
+            {
+                for(uint32_t i = 0; i < CPU_SETSIZE; i++)
+                {
+                    if(CPU_ISSET(i, &set))
+                        topo.cpus.push_back({ i, i, 0, 0 });
+                }
+            }
+            else
+            {
+                for(uint32_t i = 0; i < topo.hardware_threads; i++)
+                    topo.cpus.push_back({ i, i, 0, 0 });
+            }
+
+            for(auto& cpu : topo.cpus)
+            {
+                const std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu.id) + "/topology/";
+                cpu.core              = read_uint(dir + "core_id", cpu.id);
+                cpu.package           = read_uint(dir + "physical_package_id", 0);
+            }
+
+            std::error_code ec;
+            for(auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec))
+            {
+                auto name = entry.path().filename().string();
+                if(name.size() <= 4 || name.compare(0, 4, "node") != 0 || !isdigit((unsigned char)name[4]))
+                    continue;
+                std::string list;
+                if(!read_line(entry.path().string() + "/cpulist", list))
+                    continue;
+                const uint32_t node = (uint32_t)std::stoul(name.substr(4));
+                for(auto id : parse_cpu_list(list))
+                {
+                    for(auto& cpu : topo.cpus)
+                    {
+                        if(cpu.id == id)
+                            cpu.node = node;
+                    }
+                }
+            }
+
+            topo.quota_cpus = query_cgroup_quota();
+            return topo;
+        }
+#elif defined(DS_PLATFORM_WINDOWS)
+        CpuTopology query_cpu_topology()
+        {
+            CpuTopology topo;
+            topo.hardware_threads = std::thread::hardware_concurrency();
+
+            // only the current processor group is visible through the process mask
+            DWORD_PTR process_mask = 0, system_mask = 0;
+            if(!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+                process_mask = topo.hardware_threads >= 64 ? ~DWORD_PTR(0) : ((DWORD_PTR(1) << topo.hardware_threads) - 1);
+            for(uint32_t i = 0; i < sizeof(DWORD_PTR) * 8; i++)
+            {
+                if(process_mask & (DWORD_PTR(1) << i))
+                    topo.cpus.push_back({ i, i, 0, 0 });
+            }
+
+            DWORD length = 0;
+            GetLogicalProcessorInformation(nullptr, &length);
+            std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> infos(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+            if(!infos.empty() && GetLogicalProcessorInformation(infos.data(), &length))
+            {
+                uint32_t core = 0, package = 0;
+                for(auto& info : infos)
+                {
+                    for(auto& cpu : topo.cpus)
+                    {
+                        if(!(info.ProcessorMask & (ULONG_PTR(1) << cpu.id)))
+                            continue;
+                        if(info.Relationship == RelationProcessorCore)
+                            cpu.core = core;
+                        else if(info.Relationship == RelationProcessorPackage)
+                            cpu.package = package;
+                        else if(info.Relationship == RelationNumaNode)
+                            cpu.node = info.NumaNode.NodeNumber;
+                    }
+                    core += info.Relationship == RelationProcessorCore ? 1 : 0;
+                    package += info.Relationship == RelationProcessorPackage ? 1 : 0;
+                }
+            }
+
+            // hard capped job objects are the windows equivalent of a cfs quota, the rate is in 1/100 % of all cpus
+            JOBOBJECT_CPU_RATE_CONTROL_INFORMATION rate = {};
+            if(QueryInformationJobObject(nullptr, JobObjectCpuRateControlInformation, &rate, sizeof(rate), nullptr)
+               && (rate.ControlFlags & JOB_OBJECT_CPU_RATE_CONTROL_ENABLE)
+               && (rate.ControlFlags & JOB_OBJECT_CPU_RATE_CONTROL_HARD_CAP)
+               && rate.CpuRate > 0)
+            {
+                topo.quota_cpus = topo.hardware_threads * (rate.CpuRate / 10000.0f);
+            }
+            return topo;
+        }
+#else
+        CpuTopology query_cpu_topology()
+        {
+            CpuTopology topo;
+            topo.hardware_threads = std::thread::hardware_concurrency();
+            for(uint32_t i = 0; i < topo.hardware_threads; i++)
+                topo.cpus.push_back({ i, i, 0, 0 });
+            return topo;
+        }
+#endif
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace diverse
+{
+    namespace System
+    {
+        struct LogicalCpu
+        {
+            uint32_t id      = 0; // os processor number, what affinity masks use
+            uint32_t core    = 0; // physical core, smt siblings share it
+            uint32_t package = 0;
+            uint32_t node    = 0; // numa node
+        };
+
+        // The processors this process is actually allowed to run on. In a container the affinity mask and the
+        // cgroup cpu quota are usually much smaller than what hardware_concurrency() reports.
+        struct CpuTopology
+        {
+            std::vector<LogicalCpu> cpus;             // from the process affinity mask, sorted by id
+            uint32_t                hardware_threads = 0;
+            float                   quota_cpus       = 0.0f; // cgroup / job object cpu limit in cpus, 0 when unlimited
+
+            // cpus worth of threads the process can keep busy at once
+            uint32_t usable_cpus() const;
+            std::vector<uint32_t> nodes() const;
+        };
+
+        CpuTopology query_cpu_topology();
+
+        // parses the kernel cpu list format, e.g "0-3,8,10-11"
+        std::vector<uint32_t> parse_cpu_list(const std::string& list);
+    }
+}
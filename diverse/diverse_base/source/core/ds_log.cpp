@@ -1,8 +1,12 @@
 #include "ds_log.h"
+#include "async_log.h"
 
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #ifndef DS_PLATFORM_MACOS
 #define LOG_TO_TEXT_FILE 1
 #endif
@@ -10,12 +14,34 @@ namespace diverse::debug
 {
 #if DS_ENABLE_LOG
     std::shared_ptr<spdlog::logger> Log::s_CoreLogger;
+    std::shared_ptr<AsyncLogSink> Log::s_AsyncSink;
     std::vector<spdlog::sink_ptr> sinks;
+
+    // DS_LOG_POLICY=drop|block|sample[:rate], DS_LOG_CAPACITY=messages
+    static AsyncLogDesc async_log_desc()
+    {
+        AsyncLogDesc desc;
+        if(const char* env = getenv("DS_LOG_POLICY"))
+        {
+            if(strncmp(env, "drop", 4) == 0)
+                desc.policy = LogOverflowPolicy::Drop;
+            else if(strncmp(env, "block", 5) == 0)
+                desc.policy = LogOverflowPolicy::Block;
+            else if(strncmp(env, "sample", 6) == 0)
+                desc.policy = LogOverflowPolicy::Sample;
+            if(const char* colon = strchr(env, ':'))
+                desc.sampleRate = (uint32_t)std::max(1, atoi(colon + 1));
+        }
+        if(const char* env = getenv("DS_LOG_CAPACITY"))
+            desc.capacity = (uint32_t)std::max(64, atoi(env));
+        return desc;
+    }
 #endif
 
     void Log::init()
     {
 #if DS_ENABLE_LOG
+        s_AsyncSink = std::make_shared<AsyncLogSink>(async_log_desc());
         sinks.emplace_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>()); // debug
         // sinks.emplace_back(std::make_shared<ImGuiConsoleSink_mt>()); // ImGuiConsole
 
@@ -24,8 +50,12 @@ namespace diverse::debug
         sinks.emplace_back(logFileSink); // Log file
 #endif
 
+        // the real sinks are written from the async sink's flush thread
+        for(auto& sink : sinks)
+            s_AsyncSink->add_sink(sink);
+
         // create the loggers
-        s_CoreLogger = std::make_shared<spdlog::logger>("diverse", begin(sinks), end(sinks));
+        s_CoreLogger = std::make_shared<spdlog::logger>("diverse", s_AsyncSink);
         spdlog::register_logger(s_CoreLogger);
 
         // configure the loggers
@@ -37,9 +67,14 @@ namespace diverse::debug
 #if DS_ENABLE_LOG
     void Log::add_sink(spdlog::sink_ptr& sink)
     {
-        s_CoreLogger->sinks().push_back(sink);
+        s_AsyncSink->add_sink(sink);
         s_CoreLogger->set_pattern("%v%$");
     }
+
+    void Log::add_batch_sink(const std::shared_ptr<LogBatchSink>& sink)
+    {
+        s_AsyncSink->add_batch_sink(sink);
+    }
 #endif
 
     void Log::release()
@@ -47,6 +82,9 @@ namespace diverse::debug
 #if DS_ENABLE_LOG
         s_CoreLogger.reset();
         spdlog::shutdown();
+        // joins the flush thread after it wrote everything still queued
+        s_AsyncSink.reset();
+        sinks.clear();
 #endif
     }
 }
@@ -41,6 +41,9 @@ namespace diverse
 {
     namespace debug
     {
+        class AsyncLogSink;
+        class LogBatchSink;
+
         class DS_EXPORT Log
         {
         public:
@@ -50,11 +53,15 @@ namespace diverse
 #if DS_ENABLE_LOG
             inline static std::shared_ptr<spdlog::logger>& get_core_logger() { return s_CoreLogger; }
             static void add_sink(std::shared_ptr<spdlog::sinks::sink>& sink);
+            // called with every batch the background flush thread drains
+            static void add_batch_sink(const std::shared_ptr<LogBatchSink>& sink);
+            static AsyncLogSink* get_async_sink() { return s_AsyncSink.get(); }
 #endif
 
         private:
 #if DS_ENABLE_LOG
             static std::shared_ptr<spdlog::logger> s_CoreLogger;
+            static std::shared_ptr<AsyncLogSink> s_AsyncSink;
 #endif
         };
     }
@@ -0,0 +1,529 @@
+#pragma once
+#include "core/memory.h"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DS_FLAT_HASH_MAP_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define DS_FLAT_HASH_MAP_NEON 1
+#endif
+
+namespace diverse
+{
+    // Open addressing hash map in the Swiss table layout: one control byte per slot (empty, deleted or the low
+    // 7 bits of the hash) scanned 16 at a time with SIMD, slots stored flat next to the control bytes.
+    // Lookups touch one or two cache lines and never chase node pointers like std::unordered_map.
+    //
+    //   FlatHashMap<GaussianModel*, u32> ids;            // heap storage
+    //   FlatHashMap<u64, Entry> scratch(frame_arena);    // arena storage, old tables are left in the arena on growth
+    //   FlatHashMap<std::string, T, StringHash> names;   // find(std::string_view / const char*) without a temporary
+    //
+    // Unlike std::unordered_map, inserting may move elements: pointers, references and iterators are invalidated
+    // by every insertion that grows the table, and by rehash / reserve.
+    namespace flat_hash_map_detail
+    {
+        static constexpr size_t GROUP_WIDTH = 16;
+        static constexpr uint8_t CTRL_EMPTY   = 0x80;
+        static constexpr uint8_t CTRL_DELETED = 0xFE;
+
+        // Bit set of matching slots in a group, Shift is log2 of the bits per slot in the mask
+        template <int Shift>
+        struct BitMask
+        {
+            uint64_t mask;
+            explicit operator bool() const { return mask != 0; }
+            uint32_t next()
+            {
+                const uint32_t idx = (uint32_t)std::countr_zero(mask) >> Shift;
+                mask &= mask - 1;
+                return idx;
+            }
+        };
+
+#if defined(DS_FLAT_HASH_MAP_SSE2)
+        struct Group
+        {
+            __m128i ctrl;
+            explicit Group(const uint8_t* p) : ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(p))) { }
+            BitMask<0> match(uint8_t h2) const { return { (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)h2))) }; }
+            BitMask<0> match_empty() const { return { (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)CTRL_EMPTY))) }; }
+            // empty and deleted are the only control bytes with the high bit set
+            BitMask<0> match_empty_or_deleted() const { return { (uint64_t)(uint32_t)_mm_movemask_epi8(ctrl) }; }
+        };
+#elif defined(DS_FLAT_HASH_MAP_NEON)
+        struct Group
+        {
+            uint8x16_t ctrl;
+            explicit Group(const uint8_t* p) : ctrl(vld1q_u8(p)) { }
+            // narrows the byte mask to 4 bits per slot, the top bit of each nibble is kept
+            static BitMask<2> to_mask(uint8x16_t cmp)
+            {
+                const uint64_t nibbles = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+                return { nibbles & 0x8888888888888888ull };
+            }
+            BitMask<2> match(uint8_t h2) const { return to_mask(vceqq_u8(ctrl, vdupq_n_u8(h2))); }
+            BitMask<2> match_empty() const { return to_mask(vceqq_u8(ctrl, vdupq_n_u8(CTRL_EMPTY))); }
+            BitMask<2> match_empty_or_deleted() const { return to_mask(vcltq_s8(vreinterpretq_s8_u8(ctrl), vdupq_n_s8(0))); }
+        };
+#else
+        struct Group
+        {
+            const uint8_t* ctrl;
+            explicit Group(const uint8_t* p) : ctrl(p) { }
+            template <typename Pred>
+            BitMask<0> scan(Pred pred) const
+            {
+                uint64_t mask = 0;
+                for(uint32_t i = 0; i < GROUP_WIDTH; i++)
+                    mask |= (uint64_t)pred(ctrl[i]) << i;
+                return { mask };
+            }
+            BitMask<0> match(uint8_t h2) const { return scan([h2](uint8_t c) { return c == h2; }); }
+            BitMask<0> match_empty() const { return scan([](uint8_t c) { return c == CTRL_EMPTY; }); }
+            BitMask<0> match_empty_or_deleted() const { return scan([](uint8_t c) { return (c & 0x80) != 0; }); }
+        };
+#endif
+
+        // std::hash is the identity for integers and pointers on most standard libraries, mix it so both the
+        // probe start (high bits) and the 7 bit tag (low bits) depend on every input bit
+        inline uint64_t mix(uint64_t h)
+        {
+            h *= 0x9E3779B97F4A7C15ull;
+            return h ^ (h >> 29);
+        }
+    }
+
+    // Transparent string hash, lets FlatHashMap<std::string, V, StringHash> look up by string_view / const char*
+    struct StringHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view> {}(s); }
+        size_t operator()(const std::string& s) const { return std::hash<std::string_view> {}(s); }
+        size_t operator()(const char* s) const { return std::hash<std::string_view> {}(s); }
+    };
+
+    template <typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<>>
+    class FlatHashMap
+    {
+        static constexpr size_t GROUP_WIDTH = flat_hash_map_detail::GROUP_WIDTH;
+        static constexpr size_t NPOS        = ~size_t(0);
+        using Group                         = flat_hash_map_detail::Group;
+
+        template <typename Q>
+        static constexpr bool is_heterogeneous = requires { typename Hash::is_transparent; typename Eq::is_transparent; };
+
+    public:
+        using key_type    = K;
+        using mapped_type = V;
+        using value_type  = std::pair<K, V>;
+        using size_type   = size_t;
+        using hasher      = Hash;
+        using key_equal   = Eq;
+
+        template <bool Const>
+        class Iterator
+        {
+            using Map = std::conditional_t<Const, const FlatHashMap, FlatHashMap>;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = FlatHashMap::value_type;
+            using difference_type   = ptrdiff_t;
+            using reference         = std::conditional_t<Const, const value_type&, value_type&>;
+            using pointer           = std::conditional_t<Const, const value_type*, value_type*>;
+
+            Iterator() = default;
+            Iterator(Map* map, size_t index) : map(map), index(index) { skip_empty(); }
+            template <bool C = Const, typename = std::enable_if_t<C>>
+            Iterator(const Iterator<false>& other) : map(other.map), index(other.index) { }
+
+            reference operator*() const { return map->slots[index]; }
+            pointer operator->() const { return &map->slots[index]; }
+            Iterator& operator++()
+            {
+                ++index;
+                skip_empty();
+                return *this;
+            }
+            Iterator operator++(int)
+            {
+                Iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            friend bool operator==(const Iterator& a, const Iterator& b) { return a.index == b.index; }
+            friend bool operator!=(const Iterator& a, const Iterator& b) { return a.index != b.index; }
+
+        private:
+            friend class FlatHashMap;
+            void skip_empty()
+            {
+                while(index < map->capacity_ && (map->ctrl[index] & 0x80))
+                    ++index;
+            }
+            Map* map     = nullptr;
+            size_t index = 0;
+        };
+        using iterator       = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        FlatHashMap() = default;
+        explicit FlatHashMap(Arena* arena) : arena(arena) { }
+        FlatHashMap(std::initializer_list<value_type> init)
+        {
+            reserve(init.size());
+            for(auto& v : init)
+                insert(v);
+        }
+        FlatHashMap(const FlatHashMap& other) : arena(other.arena)
+        {
+            reserve(other.size_);
+            for(auto& v : other)
+                insert(v);
+        }
+        FlatHashMap(FlatHashMap&& other) noexcept { swap(other); }
+        FlatHashMap& operator=(const FlatHashMap& other)
+        {
+            if(this != &other)
+            {
+                FlatHashMap tmp(other);
+                swap(tmp);
+            }
+            return *this;
+        }
+        FlatHashMap& operator=(FlatHashMap&& other) noexcept
+        {
+            if(this != &other)
+            {
+                FlatHashMap tmp(std::move(other));
+                swap(tmp);
+            }
+            return *this;
+        }
+        ~FlatHashMap()
+        {
+            destroy_slots();
+            release_storage(ctrl);
+        }
+
+        void swap(FlatHashMap& other) noexcept
+        {
+            std::swap(arena, other.arena);
+            std::swap(ctrl, other.ctrl);
+            std::swap(slots, other.slots);
+            std::swap(capacity_, other.capacity_);
+            std::swap(size_, other.size_);
+            std::swap(growth_left, other.growth_left);
+            std::swap(owns_storage, other.owns_storage);
+        }
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, capacity_); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, capacity_); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        size_t capacity() const { return capacity_; }
+
+        void clear()
+        {
+            destroy_slots();
+            if(capacity_)
+                memset(ctrl, flat_hash_map_detail::CTRL_EMPTY, capacity_);
+            size_       = 0;
+            growth_left = max_load(capacity_);
+        }
+
+        void reserve(size_t count)
+        {
+            size_t cap = GROUP_WIDTH;
+            while(max_load(cap) < count)
+                cap *= 2;
+            if(cap > capacity_)
+                rehash(cap);
+        }
+
+        template <typename Q = K>
+        iterator find(const Q& key)
+        {
+            return iterator(this, find_index(key));
+        }
+        template <typename Q = K>
+        const_iterator find(const Q& key) const
+        {
+            return const_iterator(this, find_index(key));
+        }
+        template <typename Q = K>
+        bool contains(const Q& key) const { return find_index(key) != capacity_; }
+        template <typename Q = K>
+        size_t count(const Q& key) const { return contains(key) ? 1 : 0; }
+
+        template <typename Q = K>
+        V& at(const Q& key)
+        {
+            size_t idx = find_index(key);
+            if(idx == capacity_)
+                throw std::out_of_range("FlatHashMap::at");
+            return slots[idx].second;
+        }
+        template <typename Q = K>
+        const V& at(const Q& key) const
+        {
+            size_t idx = find_index(key);
+            if(idx == capacity_)
+                throw std::out_of_range("FlatHashMap::at");
+            return slots[idx].second;
+        }
+
+        V& operator[](const K& key) { return try_emplace(key).first->second; }
+        V& operator[](K&& key) { return try_emplace(std::move(key)).first->second; }
+
+        template <typename KK, typename... Args>
+        std::pair<iterator, bool> try_emplace(KK&& key, Args&&... args)
+        {
+            if constexpr(!is_heterogeneous<KK> && !std::is_same_v<std::decay_t<KK>, K>)
+                return try_emplace(K(std::forward<KK>(key)), std::forward<Args>(args)...);
+            else
+                return try_emplace_impl(std::forward<KK>(key), std::forward<Args>(args)...);
+        }
+
+        template <typename KK, typename... Args>
+        std::pair<iterator, bool> emplace(KK&& key, Args&&... args) { return try_emplace(std::forward<KK>(key), std::forward<Args>(args)...); }
+
+        std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+        std::pair<iterator, bool> insert(value_type&& value) { return try_emplace(std::move(value.first), std::move(value.second)); }
+
+        template <typename KK, typename VV>
+        std::pair<iterator, bool> insert_or_assign(KK&& key, VV&& value)
+        {
+            auto result = try_emplace(std::forward<KK>(key), std::forward<VV>(value));
+            if(!result.second)
+                result.first->second = std::forward<VV>(value);
+            return result;
+        }
+
+        template <typename Q = K>
+        size_t erase(const Q& key)
+        {
+            size_t idx = find_index(key);
+            if(idx == capacity_)
+                return 0;
+            erase_index(idx);
+            return 1;
+        }
+        iterator erase(iterator it)
+        {
+            erase_index(it.index);
+            return iterator(this, it.index + 1);
+        }
+
+    private:
+        template <typename KK, typename... Args>
+        std::pair<iterator, bool> try_emplace_impl(KK&& key, Args&&... args)
+        {
+            const uint64_t hash = hash_of(key);
+            size_t idx          = find_index(key, hash);
+            if(idx != capacity_)
+                return { iterator(this, idx), false };
+            idx = prepare_insert(hash);
+            new(&slots[idx]) value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<KK>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+            return { iterator(this, idx), true };
+        }
+
+        static size_t max_load(size_t cap) { return cap - cap / 8; }
+
+        template <typename Q>
+        uint64_t hash_of(const Q& key) const
+        {
+            if constexpr(is_heterogeneous<Q>)
+                return flat_hash_map_detail::mix((uint64_t)Hash {}(key));
+            else
+                return flat_hash_map_detail::mix((uint64_t)Hash {}(key));
+        }
+        static uint8_t h2(uint64_t hash) { return (uint8_t)(hash & 0x7F); }
+        size_t group_mask() const { return capacity_ / GROUP_WIDTH - 1; }
+
+        template <typename Q>
+        size_t find_index(const Q& key) const
+        {
+            if constexpr(is_heterogeneous<Q>)
+                return find_index(key, hash_of(key));
+            else
+            {
+                // convert once, e.g. a SharedPtr<T> looked up in a T* keyed map
+                const K& k = key;
+                return find_index(k, hash_of(k));
+            }
+        }
+
+        // Groups are probed triangularly, which visits every group of a power of two table.
+        // A lookup can stop at the first group that still has an empty slot.
+        template <typename Q>
+        size_t find_index(const Q& key, uint64_t hash) const
+        {
+            if(size_ == 0)
+                return capacity_;
+            const uint8_t tag = h2(hash);
+            const size_t mask = group_mask();
+            size_t group      = (hash >> 7) & mask;
+            for(size_t step = 1; step <= mask + 1; step++)
+            {
+                Group g(ctrl + group * GROUP_WIDTH);
+                for(auto m = g.match(tag); m;)
+                {
+                    const size_t idx = group * GROUP_WIDTH + m.next();
+                    if(Eq {}(slots[idx].first, key))
+                        return idx;
+                }
+                if(g.match_empty())
+                    break;
+                group = (group + step) & mask;
+            }
+            return capacity_;
+        }
+
+        size_t find_free(uint64_t hash) const
+        {
+            const size_t mask = group_mask();
+            size_t group      = (hash >> 7) & mask;
+            for(size_t step = 1;; step++)
+            {
+                Group g(ctrl + group * GROUP_WIDTH);
+                if(auto m = g.match_empty_or_deleted())
+                    return group * GROUP_WIDTH + m.next();
+                group = (group + step) & mask;
+            }
+        }
+
+        size_t prepare_insert(uint64_t hash)
+        {
+            if(capacity_ == 0)
+                rehash(GROUP_WIDTH);
+            size_t idx = find_free(hash);
+            if(growth_left == 0 && ctrl[idx] == flat_hash_map_detail::CTRL_EMPTY)
+            {
+                // out of empty slots: grow, or rehash in place when most of the load is tombstones
+                rehash(size_ + 1 > max_load(capacity_) / 2 ? capacity_ * 2 : capacity_);
+                idx = find_free(hash);
+            }
+            if(ctrl[idx] == flat_hash_map_detail::CTRL_EMPTY)
+                growth_left--;
+            ctrl[idx] = h2(hash);
+            size_++;
+            return idx;
+        }
+
+        void erase_index(size_t idx)
+        {
+            slots[idx].~value_type();
+            // only a group that already has an empty slot can end probe sequences, otherwise leave a tombstone
+            const size_t group_start = idx & ~(GROUP_WIDTH - 1);
+            if(Group(ctrl + group_start).match_empty())
+            {
+                ctrl[idx] = flat_hash_map_detail::CTRL_EMPTY;
+                growth_left++;
+            }
+            else
+            {
+                ctrl[idx] = flat_hash_map_detail::CTRL_DELETED;
+            }
+            size_--;
+        }
+
+        void rehash(size_t new_capacity)
+        {
+            uint8_t* old_ctrl      = ctrl;
+            value_type* old_slots  = slots;
+            const size_t old_cap   = capacity_;
+            const bool old_owns    = owns_storage;
+
+            allocate_storage(new_capacity);
+            for(size_t i = 0; i < old_cap; i++)
+            {
+                if(old_ctrl[i] & 0x80)
+                    continue;
+                const uint64_t hash = hash_of(old_slots[i].first);
+                const size_t idx    = find_free(hash);
+                ctrl[idx]           = h2(hash);
+                new(&slots[idx]) value_type(std::move(old_slots[i]));
+                old_slots[i].~value_type();
+            }
+            growth_left = max_load(capacity_) - size_;
+
+            if(old_owns && old_ctrl)
+                Memory::AlignedFree(old_ctrl);
+        }
+
+        void allocate_storage(size_t cap)
+        {
+            const size_t align      = alignof(value_type) > GROUP_WIDTH ? alignof(value_type) : GROUP_WIDTH;
+            const size_t slots_at   = (cap + align - 1) & ~(align - 1);
+            const size_t bytes      = slots_at + cap * sizeof(value_type);
+            uint8_t* memory         = nullptr;
+            owns_storage            = false;
+            if(arena)
+            {
+                // falls back to the heap instead of overflowing the arena
+                const uintptr_t base    = reinterpret_cast<uintptr_t>(arena->Ptr);
+                const uintptr_t aligned = (base + arena->Position + align - 1) & ~(uintptr_t)(align - 1);
+                if(aligned - base + bytes + arena->Align <= arena->Size)
+                {
+                    ArenaPushAligner(arena, align);
+                    memory = static_cast<uint8_t*>(ArenaPushNoZero(arena, bytes));
+                }
+            }
+            if(!memory)
+            {
+                memory       = static_cast<uint8_t*>(Memory::AlignedAlloc(bytes, align));
+                owns_storage = true;
+                if(!memory)
+                    throw std::bad_alloc();
+            }
+            memset(memory, flat_hash_map_detail::CTRL_EMPTY, cap);
+            ctrl      = memory;
+            slots     = reinterpret_cast<value_type*>(memory + slots_at);
+            capacity_ = cap;
+        }
+
+        void release_storage(uint8_t* memory)
+        {
+            if(owns_storage && memory)
+                Memory::AlignedFree(memory);
+        }
+
+        void destroy_slots()
+        {
+            if constexpr(!std::is_trivially_destructible_v<value_type>)
+            {
+                for(size_t i = 0; i < capacity_; i++)
+                {
+                    if(!(ctrl[i] & 0x80))
+                        slots[i].~value_type();
+                }
+            }
+        }
+
+        Arena* arena       = nullptr;
+        uint8_t* ctrl      = nullptr;
+        value_type* slots  = nullptr;
+        size_t capacity_   = 0;
+        size_t size_       = 0;
+        size_t growth_left = 0;
+        bool owns_storage  = false;
+    };
+}
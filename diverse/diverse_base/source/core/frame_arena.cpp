@@ -0,0 +1,163 @@
+#include "core/core.h"
+#include "core/profiler.h"
+#include "frame_arena.h"
+#include "thread.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace diverse
+{
+    static constexpr uint64_t FRAME_ARENA_BLOCK_SIZE = Megabytes(1ull);
+
+    struct FrameArenaBuffer
+    {
+        std::vector<Arena*> Blocks;
+        uint64_t Frame = ~0ull;
+        uint64_t Used  = 0;
+    };
+
+    struct ThreadFrameArena
+    {
+        FrameArenaBuffer Buffers[2];
+        char ThreadName[32] = {};
+        // written by the owning thread, read by the stats queries
+        std::atomic<uint64_t> Used { 0 };
+        std::atomic<uint64_t> Reserved { 0 };
+        std::atomic<uint64_t> HighWater { 0 };
+        std::atomic<uint32_t> BlockCount { 0 };
+
+        ThreadFrameArena();
+        ~ThreadFrameArena();
+    };
+
+    static std::atomic<uint64_t> s_FrameArenaIndex { 0 };
+    static std::mutex s_FrameArenaMutex;
+    static std::vector<ThreadFrameArena*> s_FrameArenaThreads;
+
+    ThreadFrameArena::ThreadFrameArena()
+    {
+        String8 name = GetThreadName();
+        MemoryCopy(ThreadName, name.str, std::min<uint64_t>(name.size, sizeof(ThreadName) - 1));
+        std::scoped_lock lock(s_FrameArenaMutex);
+        s_FrameArenaThreads.push_back(this);
+    }
+
+    ThreadFrameArena::~ThreadFrameArena()
+    {
+        {
+            std::scoped_lock lock(s_FrameArenaMutex);
+            s_FrameArenaThreads.erase(std::find(s_FrameArenaThreads.begin(), s_FrameArenaThreads.end(), this));
+        }
+        for(auto& buffer : Buffers)
+        {
+            for(auto block : buffer.Blocks)
+                ArenaReleaseUntracked(block);
+        }
+    }
+
+    static ThreadFrameArena& GetThreadFrameArena()
+    {
+        static thread_local ThreadFrameArena arena;
+        return arena;
+    }
+
+    static Arena* FrameArenaNewBlock(ThreadFrameArena& thread, FrameArenaBuffer& buffer, uint64_t size)
+    {
+        Arena* block = ArenaAllocUntracked(size);
+        ArenaSetAutoAlign(block, 1);
+        buffer.Blocks.push_back(block);
+        thread.Reserved.fetch_add(size, std::memory_order_relaxed);
+        thread.BlockCount.fetch_add(1, std::memory_order_relaxed);
+        return block;
+    }
+
+    // The buffer was last used two frames ago, nothing can reference it anymore
+    static void FrameArenaRecycle(ThreadFrameArena& thread, FrameArenaBuffer& buffer, uint64_t frame)
+    {
+        if(buffer.Blocks.size() > 1)
+        {
+            // the frame did not fit, merge the chain so the next frames push into a single block again
+            uint64_t total = 0;
+            for(auto block : buffer.Blocks)
+            {
+                total += block->Size;
+                ArenaReleaseUntracked(block);
+            }
+            thread.Reserved.fetch_sub(total, std::memory_order_relaxed);
+            thread.BlockCount.fetch_sub((uint32_t)buffer.Blocks.size(), std::memory_order_relaxed);
+            buffer.Blocks.clear();
+            FrameArenaNewBlock(thread, buffer, total);
+        }
+        else if(!buffer.Blocks.empty())
+        {
+            ArenaClear(buffer.Blocks[0]);
+        }
+        buffer.Frame = frame;
+        buffer.Used  = 0;
+    }
+
+    void* FrameArenaPush(uint64_t size, uint64_t alignment)
+    {
+        DS_ASSERT((alignment & (alignment - 1)) == 0);
+        ThreadFrameArena& thread = GetThreadFrameArena();
+        const uint64_t frame     = s_FrameArenaIndex.load(std::memory_order_acquire);
+        FrameArenaBuffer& buffer = thread.Buffers[frame & 1];
+        if(buffer.Frame != frame)
+            FrameArenaRecycle(thread, buffer, frame);
+
+        auto fits = [&](Arena* block) {
+            const uintptr_t base    = reinterpret_cast<uintptr_t>(block->Ptr);
+            const uintptr_t aligned = (base + block->Position + alignment - 1) & ~(uintptr_t)(alignment - 1);
+            return aligned - base + size <= block->Size;
+        };
+
+        Arena* block = buffer.Blocks.empty() ? nullptr : buffer.Blocks.back();
+        if(!block || !fits(block))
+            block = FrameArenaNewBlock(thread, buffer, std::max<uint64_t>(FRAME_ARENA_BLOCK_SIZE, size + alignment + sizeof(Arena)));
+
+        const uint64_t before = ArenaPos(block);
+        ArenaPushAligner(block, alignment);
+        void* ptr = ArenaPushNoZero(block, size);
+
+        buffer.Used += ArenaPos(block) - before;
+        thread.Used.store(buffer.Used, std::memory_order_relaxed);
+        if(buffer.Used > thread.HighWater.load(std::memory_order_relaxed))
+            thread.HighWater.store(buffer.Used, std::memory_order_relaxed);
+        return ptr;
+    }
+
+    void FrameArenaAdvance()
+    {
+        DS_PROFILE_FUNCTION_LOW();
+        s_FrameArenaIndex.fetch_add(1, std::memory_order_release);
+    }
+
+    uint64_t FrameArenaFrameIndex()
+    {
+        return s_FrameArenaIndex.load(std::memory_order_acquire);
+    }
+
+    int FrameArenaThreadCount()
+    {
+        std::scoped_lock lock(s_FrameArenaMutex);
+        return (int)s_FrameArenaThreads.size();
+    }
+
+    FrameArenaStats FrameArenaGetStats(int index)
+    {
+        FrameArenaStats stats = {};
+        std::scoped_lock lock(s_FrameArenaMutex);
+        if(index < 0 || index >= (int)s_FrameArenaThreads.size())
+            return stats;
+
+        ThreadFrameArena* thread = s_FrameArenaThreads[index];
+        MemoryCopy(stats.ThreadName, thread->ThreadName, sizeof(stats.ThreadName));
+        stats.Used      = thread->Used.load(std::memory_order_relaxed);
+        stats.Reserved  = thread->Reserved.load(std::memory_order_relaxed);
+        stats.HighWater = thread->HighWater.load(std::memory_order_relaxed);
+        stats.Blocks    = thread->BlockCount.load(std::memory_order_relaxed);
+        return stats;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "core/memory.h"
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace diverse
+{
+    // Per thread, double buffered linear allocator for transient data: an allocation made during frame N stays
+    // valid until the end of frame N + 1. Every thread (JobSystem workers included) pushes into its own arenas,
+    // so no locking is needed. Blocks are only allocated on first use and chained when a frame outgrows them;
+    // after such a frame the chain is merged into one block sized to the high water mark.
+    struct FrameArenaStats
+    {
+        char     ThreadName[32];
+        uint64_t Used;      // bytes pushed this frame
+        uint64_t Reserved;  // bytes held by both buffers
+        uint64_t HighWater; // largest single frame so far
+        uint32_t Blocks;
+    };
+
+    void* FrameArenaPush(uint64_t size, uint64_t alignment = alignof(std::max_align_t));
+    // Starts a new frame for every thread, called once per frame from the main loop.
+    // Buffers of the frame before the previous one are recycled when their thread next pushes.
+    void FrameArenaAdvance();
+    uint64_t FrameArenaFrameIndex();
+
+    int FrameArenaThreadCount();
+    FrameArenaStats FrameArenaGetStats(int index);
+
+    template <typename T, typename... Args>
+    T* FrameArenaNew(Args&&... args)
+    {
+        void* ptr = FrameArenaPush(sizeof(T), alignof(T));
+        return new(ptr) T(std::forward<Args>(args)...);
+    }
+
+#define FrameArenaPushArray(type, count) (type*)FrameArenaPush(sizeof(type) * (count), alignof(type))
+}
@@ -5,11 +5,19 @@
 #include "job_system.h"
 #include "core/vector.h"
 #include "core/thread.h"
+#include "core/cpu_topology.h"
 
 #include <atomic>
 #include <thread>
 #include <condition_variable>
 #include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <tuple>
 
 #ifdef DS_PLATFORM_WINDOWS
 #define NOMINMAX
@@ -69,130 +77,580 @@ namespace diverse
         {
             struct Job
             {
-                Context* ctx;
-                std::function<void(JobDispatchArgs)> task;
+                JobTask task;           // own task for execute(), the shared task when this is a dispatch parent
+                Job* parent = nullptr;  // dispatch groups run the parent's task
+                Job* next_free = nullptr;
+                Context* ctx = nullptr;
+                std::atomic<uint32_t> pending { 0 }; // dispatch parent: groups still referencing the task
                 uint32_t groupID;
                 uint32_t groupJobOffset;
                 uint32_t groupJobEnd;
                 uint32_t sharedmemory_size;
             };
 
-            struct JobQueue
+            // Jobs are recycled through per-thread free lists, batches move through a shared list
+            //    when a thread produces (or consumes) more than it frees, so steady state needs no allocation.
+            struct JobPool
             {
-                std::deque<Job> queue;
-                std::mutex locker;
+                static constexpr uint32_t CHUNK_SIZE = 256;
+                static constexpr uint32_t BATCH_SIZE = 64;
 
-                inline void push_back(const Job& item)
+                SpinLock lock;
+                Job* free_list = nullptr;
+                std::vector<std::unique_ptr<Job[]>> chunks;
+
+                // returns a chain of up to BATCH_SIZE jobs
+                Job* acquire_batch(uint32_t& count)
                 {
-                    std::scoped_lock lock(locker);
-                    queue.push_back(item);
+                    std::scoped_lock guard(lock);
+                    if(!free_list)
+                    {
+                        auto& chunk = chunks.emplace_back(new Job[CHUNK_SIZE]);
+                        for(uint32_t i = 0; i < CHUNK_SIZE; ++i)
+                        {
+                            chunk[i].next_free = free_list;
+                            free_list          = &chunk[i];
+                        }
+                    }
+                    Job* head = free_list;
+                    Job* tail = head;
+                    count     = 1;
+                    while(tail->next_free && count < BATCH_SIZE)
+                    {
+                        tail = tail->next_free;
+                        count++;
+                    }
+                    free_list       = tail->next_free;
+                    tail->next_free = nullptr;
+                    return head;
                 }
 
-                inline bool pop_front(Job& item)
+                void release_batch(Job* head, Job* tail)
+                {
+                    std::scoped_lock guard(lock);
+                    tail->next_free = free_list;
+                    free_list       = head;
+                }
+            };
+
+            struct JobCache
+            {
+                Job* head           = nullptr;
+                uint32_t count      = 0;
+                uint32_t generation = 0; // InternalState the jobs belong to
+            };
+
+            // Chase-Lev work stealing deque: the owning worker pushes and pops at the bottom,
+            //    every other thread steals from the top. The ring grows on overflow, old rings
+            //    are kept alive until release because a thief may still be reading them.
+            class WorkStealingQueue
+            {
+                struct Ring
                 {
-                    std::scoped_lock lock(locker);
-                    if(queue.empty())
+                    int64_t capacity;
+                    std::unique_ptr<std::atomic<Job*>[]> slots;
+
+                    explicit Ring(int64_t capacity)
+                        : capacity(capacity)
+                        , slots(new std::atomic<Job*>[capacity])
                     {
-                        return false;
                     }
-                    item = std::move(queue.front());
-                    queue.pop_front();
-                    return true;
+                    Job* get(int64_t i) const { return slots[i & (capacity - 1)].load(std::memory_order_acquire); }
+                    void put(int64_t i, Job* job) { slots[i & (capacity - 1)].store(job, std::memory_order_release); }
+                };
+
+                std::atomic<int64_t> top { 0 };
+                std::atomic<int64_t> bottom { 0 };
+                std::atomic<Ring*> ring;
+                std::vector<std::unique_ptr<Ring>> rings;
+
+            public:
+                WorkStealingQueue()
+                {
+                    rings.emplace_back(new Ring(1024));
+                    ring.store(rings.back().get(), std::memory_order_relaxed);
+                }
+
+                bool empty() const
+                {
+                    return top.load(std::memory_order_acquire) >= bottom.load(std::memory_order_acquire);
+                }
+
+                void push(Job* job)
+                {
+                    int64_t b = bottom.load(std::memory_order_relaxed);
+                    int64_t t = top.load(std::memory_order_acquire);
+                    Ring* r   = ring.load(std::memory_order_relaxed);
+                    if(b - t > r->capacity - 1)
+                    {
+                        auto grown = std::make_unique<Ring>(r->capacity * 2);
+                        for(int64_t i = t; i < b; ++i)
+                            grown->put(i, r->get(i));
+                        r = grown.get();
+                        rings.push_back(std::move(grown));
+                        ring.store(r, std::memory_order_release);
+                    }
+                    r->put(b, job);
+                    bottom.store(b + 1, std::memory_order_release);
+                }
+
+                Job* pop()
+                {
+                    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+                    Ring* r   = ring.load(std::memory_order_relaxed);
+                    bottom.store(b, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    int64_t t = top.load(std::memory_order_relaxed);
+                    if(t > b)
+                    {
+                        bottom.store(b + 1, std::memory_order_relaxed);
+                        return nullptr;
+                    }
+                    Job* job = r->get(b);
+                    if(t == b)
+                    {
+                        // last element, race against thieves
+                        if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                            job = nullptr;
+                        bottom.store(b + 1, std::memory_order_relaxed);
+                    }
+                    return job;
+                }
+
+                Job* steal()
+                {
+                    int64_t t = top.load(std::memory_order_acquire);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    int64_t b = bottom.load(std::memory_order_acquire);
+                    if(t >= b)
+                        return nullptr;
+                    Ring* r  = ring.load(std::memory_order_acquire);
+                    Job* job = r->get(t);
+                    if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                        return nullptr;
+                    return job;
                 }
             };
 
+            // Bounded multi producer / multi consumer queue (Vyukov) for jobs submitted from threads
+            //    that do not own a work stealing deque (main thread, asset loaders, ...).
+            class InjectionQueue
+            {
+                struct Cell
+                {
+                    std::atomic<size_t> sequence;
+                    Job* job;
+                };
+                static constexpr size_t CAPACITY = 1 << 14;
+
+                std::unique_ptr<Cell[]> cells;
+                alignas(64) std::atomic<size_t> enqueue_pos { 0 };
+                alignas(64) std::atomic<size_t> dequeue_pos { 0 };
+
+            public:
+                InjectionQueue()
+                    : cells(new Cell[CAPACITY])
+                {
+                    for(size_t i = 0; i < CAPACITY; ++i)
+                        cells[i].sequence.store(i, std::memory_order_relaxed);
+                }
+
+                bool empty() const
+                {
+                    return enqueue_pos.load(std::memory_order_acquire) == dequeue_pos.load(std::memory_order_acquire);
+                }
+
+                bool push(Job* job)
+                {
+                    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+                    for(;;)
+                    {
+                        Cell& cell    = cells[pos & (CAPACITY - 1)];
+                        size_t seq    = cell.sequence.load(std::memory_order_acquire);
+                        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+                        if(diff == 0)
+                        {
+                            if(enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            {
+                                cell.job = job;
+                                cell.sequence.store(pos + 1, std::memory_order_release);
+                                return true;
+                            }
+                        }
+                        else if(diff < 0)
+                            return false; // full
+                        else
+                            pos = enqueue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+
+                Job* pop()
+                {
+                    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+                    for(;;)
+                    {
+                        Cell& cell    = cells[pos & (CAPACITY - 1)];
+                        size_t seq    = cell.sequence.load(std::memory_order_acquire);
+                        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+                        if(diff == 0)
+                        {
+                            if(dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            {
+                                Job* job = cell.job;
+                                cell.sequence.store(pos + CAPACITY, std::memory_order_release);
+                                return job;
+                            }
+                        }
+                        else if(diff < 0)
+                            return nullptr; // empty
+                        else
+                            pos = dequeue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+            };
+
+            struct Worker
+            {
+                WorkStealingQueue queue;
+                alignas(64) std::atomic<uint32_t> parked { 0 };
+            };
+
             // This structure is responsible to stop worker thread loops.
-            //    Once this is destroyed, worker threads will be woken up and end their loops.
+            //    Once this is destroyed, worker threads are unparked, end their loops and are joined.
             struct InternalState
             {
                 uint32_t numCores   = 0;
                 uint32_t numThreads = 0;
-                std::unique_ptr<JobQueue[]> jobQueuePerThread;
+                uint32_t generation = 0;
+                AffinityMode affinity = AffinityMode::None;
+                std::unique_ptr<Worker[]> workers;
+                InjectionQueue injection;
+                JobPool pool;
                 std::atomic_bool alive { true };
-                std::condition_variable wakeCondition;
-                std::mutex wakeMutex;
-                std::atomic<uint32_t> nextQueue { 0 };
+                std::atomic<uint32_t> numParked { 0 };
+                std::atomic<uint32_t> nextWake { 0 };
                 Vector<std::thread> threads;
 
                 ~InternalState()
                 {
                     DS_PROFILE_FUNCTION_LOW();
                     alive.store(false); // indicate that new jobs cannot be started from this point
-                    bool wake_loop = true;
-                    std::thread waker([&]
-                                      {
-                        while (wake_loop)
-                        {
-                            wakeCondition.notify_all(); // wakes up sleeping worker threads
-                        } });
+                    for(uint32_t i = 0; i < numThreads; ++i)
+                    {
+                        workers[i].parked.store(0);
+                        workers[i].parked.notify_one();
+                    }
                     for(auto& thread : threads)
                     {
                         if(thread.joinable())
                             thread.join();
                     }
-                    wake_loop = false;
-                    if(waker.joinable())
-                        waker.join();
                 }
             };
             static InternalState* internal_state = nullptr;
+            static uint32_t state_generation     = 0;
 
-            // Start working on a job queue
-            //    After the job queue is finished, it can switch to an other queue and steal jobs from there
-            inline void work(uint32_t startingQueue)
+            static constexpr uint32_t INVALID_WORKER = ~0u;
+            thread_local uint32_t worker_index       = INVALID_WORKER;
+            thread_local uint32_t steal_seed         = 0x9E3779B9u;
+            thread_local JobCache job_cache;
+
+            // Every thread that allocated jobs keeps a cache, not only the workers. A cache filled by an earlier
+            //    init points into that instance's freed pool and is dropped on first use.
+            inline JobCache& local_job_cache()
             {
-                Job job;
-                for(uint32_t i = 0; i < internal_state->numThreads; ++i)
+                if(job_cache.generation != internal_state->generation)
+                    job_cache = { nullptr, 0, internal_state->generation };
+                return job_cache;
+            }
+
+            inline Job* allocate_job()
+            {
+                JobCache& job_cache = local_job_cache();
+                if(!job_cache.head)
+                    job_cache.head = internal_state->pool.acquire_batch(job_cache.count);
+                Job* job       = job_cache.head;
+                job_cache.head = job->next_free;
+                job_cache.count--;
+                job->next_free = nullptr;
+                job->parent    = nullptr;
+                return job;
+            }
+
+            inline void free_job(Job* job)
+            {
+                job->task.reset();
+                JobCache& job_cache = local_job_cache();
+                job->next_free = job_cache.head;
+                job_cache.head = job;
+                if(++job_cache.count >= JobPool::BATCH_SIZE * 2)
                 {
-                    JobQueue& job_queue = internal_state->jobQueuePerThread[startingQueue % internal_state->numThreads];
-                    while(job_queue.pop_front(job))
+                    // hand a batch back so producer threads can reuse it
+                    Job* head = job_cache.head;
+                    Job* tail = head;
+                    for(uint32_t i = 1; i < JobPool::BATCH_SIZE; ++i)
+                        tail = tail->next_free;
+                    job_cache.head = tail->next_free;
+                    job_cache.count -= JobPool::BATCH_SIZE;
+                    internal_state->pool.release_batch(head, tail);
+                }
+            }
+
+            inline uint32_t next_random()
+            {
+                // xorshift32
+                steal_seed ^= steal_seed << 13;
+                steal_seed ^= steal_seed >> 17;
+                steal_seed ^= steal_seed << 5;
+                return steal_seed;
+            }
+
+            // Unpark up to count sleeping workers, starting from a rotating index so wakeups spread out
+            inline void wake_workers(uint32_t count)
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if(internal_state->numParked.load(std::memory_order_relaxed) == 0)
+                    return;
+                const uint32_t numThreads = internal_state->numThreads;
+                const uint32_t start      = internal_state->nextWake.fetch_add(1, std::memory_order_relaxed);
+                for(uint32_t i = 0; i < numThreads && count > 0; ++i)
+                {
+                    Worker& worker    = internal_state->workers[(start + i) % numThreads];
+                    uint32_t expected = 1;
+                    if(worker.parked.load(std::memory_order_relaxed) == 1 && worker.parked.compare_exchange_strong(expected, 0))
                     {
-                        JobDispatchArgs args;
-                        args.groupID = job.groupID;
-                        if(job.sharedmemory_size > 0)
-                        {
-                            thread_local static Vector<uint8_t> shared_allocation_data;
-                            shared_allocation_data.Reserve(job.sharedmemory_size);
-                            args.sharedmemory = shared_allocation_data.Data();
-                        }
-                        else
-                        {
-                            args.sharedmemory = nullptr;
-                        }
+                        internal_state->numParked.fetch_sub(1);
+                        worker.parked.notify_one();
+                        count--;
+                    }
+                }
+            }
 
-                        for(uint32_t j = job.groupJobOffset; j < job.groupJobEnd; ++j)
-                        {
-                            args.jobIndex          = j;
-                            args.groupIndex        = j - job.groupJobOffset;
-                            args.isFirstJobInGroup = (j == job.groupJobOffset);
-                            args.isLastJobInGroup  = (j == job.groupJobEnd - 1);
-                            job.task(args);
-                        }
+            void run_job(Job* job);
+
+            inline void submit(Job* job)
+            {
+                if(worker_index != INVALID_WORKER)
+                {
+                    internal_state->workers[worker_index].queue.push(job);
+                    return;
+                }
+                while(!internal_state->injection.push(job))
+                {
+                    // injection queue is full, help draining it instead of growing without bound
+                    if(Job* other = internal_state->injection.pop())
+                        run_job(other);
+                }
+            }
+
+            inline bool has_work()
+            {
+                if(!internal_state->injection.empty())
+                    return true;
+                for(uint32_t i = 0; i < internal_state->numThreads; ++i)
+                {
+                    if(!internal_state->workers[i].queue.empty())
+                        return true;
+                }
+                return false;
+            }
+
+            // Own deque first, then jobs submitted from outside, then steal from a random victim
+            inline Job* find_job()
+            {
+                const uint32_t numThreads = internal_state->numThreads;
+                if(worker_index != INVALID_WORKER)
+                {
+                    if(Job* job = internal_state->workers[worker_index].queue.pop())
+                        return job;
+                }
+                if(Job* job = internal_state->injection.pop())
+                    return job;
+                const uint32_t start = next_random() % numThreads;
+                for(uint32_t i = 0; i < numThreads; ++i)
+                {
+                    const uint32_t victim = (start + i) % numThreads;
+                    if(victim == worker_index)
+                        continue;
+                    if(Job* job = internal_state->workers[victim].queue.steal())
+                        return job;
+                }
+                return nullptr;
+            }
+
+            void run_job(Job* job)
+            {
+                Job* parent   = job->parent;
+                JobTask& task = parent ? parent->task : job->task;
+
+                JobDispatchArgs args;
+                args.groupID = job->groupID;
+                if(job->sharedmemory_size > 0)
+                {
+                    thread_local static Vector<uint8_t> shared_allocation_data;
+                    shared_allocation_data.Reserve(job->sharedmemory_size);
+                    args.sharedmemory = shared_allocation_data.Data();
+                }
+                else
+                {
+                    args.sharedmemory = nullptr;
+                }
+
+                for(uint32_t j = job->groupJobOffset; j < job->groupJobEnd; ++j)
+                {
+                    args.jobIndex          = j;
+                    args.groupIndex        = j - job->groupJobOffset;
+                    args.isFirstJobInGroup = (j == job->groupJobOffset);
+                    args.isLastJobInGroup  = (j == job->groupJobEnd - 1);
+                    task(args);
+                }
+
+                // captures are destroyed before the context is signalled
+                Context* ctx = job->ctx;
+                free_job(job);
+                if(parent && parent->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    free_job(parent);
+                ctx->counter.fetch_sub(1, std::memory_order_release);
+            }
 
-                        job.ctx->counter.fetch_sub(1);
+            // Park until another thread submits work, re-checking the queues after announcing
+            //    so a submission racing with the announcement is never missed.
+            inline void park()
+            {
+                Worker& worker = internal_state->workers[worker_index];
+                worker.parked.store(1);
+                internal_state->numParked.fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if(has_work() || !internal_state->alive.load())
+                {
+                    uint32_t expected = 1;
+                    if(worker.parked.compare_exchange_strong(expected, 0))
+                        internal_state->numParked.fetch_sub(1);
+                    return;
+                }
+                worker.parked.wait(1);
+            }
+
+            static AffinityMode parse_affinity(const char* text, AffinityMode fallback, int32_t& node)
+            {
+                if(strcmp(text, "none") == 0)
+                    return AffinityMode::None;
+                if(strcmp(text, "compact") == 0)
+                    return AffinityMode::Compact;
+                if(strcmp(text, "scatter") == 0)
+                    return AffinityMode::Scatter;
+                if(strncmp(text, "numa", 4) == 0)
+                {
+                    if(text[4] == ':')
+                        node = atoi(text + 5);
+                    return AffinityMode::NumaNode;
+                }
+                DS_LOG_WARN("JobSystem: unknown DS_JOB_AFFINITY {0}, expected none|compact|scatter|numa[:node]", text);
+                return fallback;
+            }
+
+            // The cpu each worker is pinned to, in assignment order
+            static std::vector<uint32_t> pinning_order(std::vector<LogicalCpu> cpus, AffinityMode mode)
+            {
+                auto key = [](const LogicalCpu& cpu) { return std::make_tuple(cpu.package, cpu.core, cpu.id); };
+                std::sort(cpus.begin(), cpus.end(), [&](auto& a, auto& b) { return key(a) < key(b); });
+                if(mode == AffinityMode::Scatter)
+                {
+                    // rank = smt sibling index within the core, ordinal = core index within the package.
+                    // sorting by (rank, ordinal, package) fills every physical core of every package before any sibling
+                    std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>> order;
+                    uint32_t rank = 0, ordinal = 0;
+                    for(size_t i = 0; i < cpus.size(); i++)
+                    {
+                        const bool same_package = i > 0 && cpus[i].package == cpus[i - 1].package;
+                        const bool same_core    = same_package && cpus[i].core == cpus[i - 1].core;
+                        rank                    = same_core ? rank + 1 : 0;
+                        ordinal                 = !same_package ? 0 : (same_core ? ordinal : ordinal + 1);
+                        order.emplace_back(rank, ordinal, cpus[i].package, cpus[i].id);
                     }
-                    startingQueue++; // go to next queue
+                    std::sort(order.begin(), order.end());
+                    std::vector<uint32_t> ids;
+                    for(auto& o : order)
+                        ids.push_back(std::get<3>(o));
+                    return ids;
                 }
+                std::vector<uint32_t> ids;
+                for(auto& cpu : cpus)
+                    ids.push_back(cpu.id);
+                return ids;
             }
 
             void init(uint32_t reservedThreads)
+            {
+                Desc desc;
+                desc.reservedThreads = reservedThreads;
+                init(desc);
+            }
+
+            void init(const Desc& in_desc)
             {
                 DS_PROFILE_FUNCTION();
 
                 if(!internal_state)
-                    internal_state = new InternalState();
+                {
+                    internal_state             = new InternalState();
+                    internal_state->generation = ++state_generation;
+                }
 
                 if(internal_state->numThreads > 0)
                     return;
 
-                // Retrieve the number of hardware threads in this System:
-                internal_state->numCores = std::thread::hardware_concurrency();
+                Desc desc = in_desc;
+                uint32_t forcedThreads = 0;
+                if(const char* env = getenv("DS_JOB_AFFINITY"))
+                    desc.affinity = parse_affinity(env, desc.affinity, desc.numaNode);
+                if(const char* env = getenv("DS_JOB_THREADS"))
+                    forcedThreads = (uint32_t)std::max(0, atoi(env));
+
+                // Only the cpus in our affinity mask count, and a cgroup quota below that caps the useful pool size
+                CpuTopology topo = query_cpu_topology();
+                std::vector<LogicalCpu> cpus = topo.cpus;
+                if(desc.affinity == AffinityMode::NumaNode)
+                {
+                    auto nodes = topo.nodes();
+                    uint32_t node = desc.numaNode >= 0 ? (uint32_t)desc.numaNode : (cpus.empty() ? 0 : cpus[0].node);
+                    if(std::find(nodes.begin(), nodes.end(), node) == nodes.end())
+                    {
+                        DS_LOG_WARN("JobSystem: numa node {0} has no allowed cpu, falling back to node {1}", node, nodes.empty() ? 0 : nodes[0]);
+                        node = nodes.empty() ? 0 : nodes[0];
+                    }
+                    cpus.erase(std::remove_if(cpus.begin(), cpus.end(), [node](auto& cpu) { return cpu.node != node; }), cpus.end());
+                }
+                topo.cpus = cpus;
+                internal_state->numCores = topo.usable_cpus();
+                internal_state->affinity = desc.affinity;
 
                 // Calculate the actual number of worker threads we want:
-                internal_state->numThreads = std::max<uint32_t>(1u, internal_state->numCores - reservedThreads);
+                internal_state->numThreads = internal_state->numCores > desc.reservedThreads ? internal_state->numCores - desc.reservedThreads : 1u;
+                if(desc.maxThreads > 0)
+                    internal_state->numThreads = std::min(internal_state->numThreads, desc.maxThreads);
+                if(forcedThreads > 0)
+                    internal_state->numThreads = forcedThreads;
+
+                // Per worker cpu set, empty when the os is free to place it
+                std::vector<std::vector<uint32_t>> worker_cpus(internal_state->numThreads);
+                if(!cpus.empty() && (desc.affinity == AffinityMode::Compact || desc.affinity == AffinityMode::Scatter))
+                {
+                    auto order = pinning_order(cpus, desc.affinity);
+                    for(uint32_t i = 0; i < internal_state->numThreads; i++)
+                        worker_cpus[i] = { order[i % order.size()] };
+                }
+                else if(desc.affinity == AffinityMode::NumaNode)
+                {
+                    std::vector<uint32_t> node_cpus;
+                    for(auto& cpu : cpus)
+                        node_cpus.push_back(cpu.id);
+                    for(auto& wc : worker_cpus)
+                        wc = node_cpus;
+                }
 
                 // Keep one for update thread
-                internal_state->jobQueuePerThread.reset(new JobQueue[internal_state->numThreads]);
+                internal_state->workers.reset(new Worker[internal_state->numThreads]);
                 internal_state->threads.Reserve(internal_state->numThreads);
 
                 for(uint32_t threadID = 0; threadID < internal_state->numThreads; ++threadID)
@@ -205,24 +663,32 @@ namespace diverse
                                 DS_PROFILE_SETTHREADNAME((const char*)name.str);
                                 SetThreadName(name);
 
+                                worker_index = threadID;
+                                steal_seed ^= (threadID + 1) * 0x85EBCA6Bu;
                                 while (internal_state->alive.load())
                                 {
-                                    work(threadID);
-                                    
+                                    if (Job* job = find_job())
+                                    {
+                                        run_job(job);
+                                        continue;
+                                    }
+
                                     // finished with jobs, put to sleep
-                                    std::unique_lock<std::mutex> lock(internal_state->wakeMutex);
-                                    internal_state->wakeCondition.wait(lock);
-                                    
+                                    park();
                                 } });
 
 #ifdef DS_PLATFORM_WINDOWS
                     // Do Windows-specific thread setup:
                     HANDLE handle = (HANDLE)worker.native_handle();
 
-                    // Put each thread on to dedicated core
-                    DWORD_PTR affinityMask    = 1ull << threadID;
-                    DWORD_PTR affinity_result = SetThreadAffinityMask(handle, affinityMask);
-                    DS_ASSERT(affinity_result > 0);
+                    if(!worker_cpus[threadID].empty())
+                    {
+                        DWORD_PTR affinityMask = 0;
+                        for(auto cpu : worker_cpus[threadID])
+                            affinityMask |= DWORD_PTR(1) << cpu;
+                        DWORD_PTR affinity_result = SetThreadAffinityMask(handle, affinityMask);
+                        DS_ASSERT(affinity_result > 0);
+                    }
 
                     // Increase thread priority:
                     // BOOL priority_result = SetThreadPriority(handle, THREAD_PRIORITY_HIGHEST);
@@ -243,14 +709,18 @@ namespace diverse
     } while(0)
 
                     int ret;
-                    cpu_set_t cpuset;
-                    CPU_ZERO(&cpuset);
-                    size_t cpusetsize = sizeof(cpuset);
-
-                    CPU_SET(threadID, &cpuset);
-                    ret = pthread_setaffinity_np(worker.native_handle(), cpusetsize, &cpuset);
-                    if(ret != 0)
-                        handle_error_en(ret, std::string(" pthread_setaffinity_np[" + std::to_string(threadID) + ']').c_str());
+                    if(!worker_cpus[threadID].empty())
+                    {
+                        cpu_set_t cpuset;
+                        CPU_ZERO(&cpuset);
+                        size_t cpusetsize = sizeof(cpuset);
+
+                        for(auto cpu : worker_cpus[threadID])
+                            CPU_SET(cpu, &cpuset);
+                        ret = pthread_setaffinity_np(worker.native_handle(), cpusetsize, &cpuset);
+                        if(ret != 0)
+                            handle_error_en(ret, std::string(" pthread_setaffinity_np[" + std::to_string(threadID) + ']').c_str());
+                    }
 
                     // Name the thread
                     std::string thread_name = "Job_" + std::to_string(threadID);
@@ -259,18 +729,22 @@ namespace diverse
                         handle_error_en(ret, std::string(" pthread_setname_np[" + std::to_string(threadID) + ']').c_str());
 
 #elif DS_PLATFORM_MACOS
-                    thread_affinity_policy affinity_tag;
-                    affinity_tag.affinity_tag = threadID + 1;
-                    auto thread               = worker.native_handle();
-                    thread_policy_set(pthread_mach_thread_np(pthread_self()), THREAD_AFFINITY_POLICY, (integer_t*)&affinity_tag, THREAD_AFFINITY_POLICY_COUNT);
+                    // macOS has no hard pinning, an affinity tag per cpu only hints the scheduler
+                    if(worker_cpus[threadID].size() == 1)
+                    {
+                        thread_affinity_policy affinity_tag;
+                        affinity_tag.affinity_tag = worker_cpus[threadID][0] + 1;
+                        auto thread               = worker.native_handle();
+                        thread_policy_set(pthread_mach_thread_np(thread), THREAD_AFFINITY_POLICY, (integer_t*)&affinity_tag, THREAD_AFFINITY_POLICY_COUNT);
+                    }
 
                     // pthread_setname_np((const char*)name.str);
 #endif
-
-                    worker.detach();
                 }
 
-                DS_LOG_INFO("Initialised JobSystem with [{0} cores] [{1} threads]", internal_state->numCores, internal_state->numThreads);
+                static const char* affinity_names[] = { "none", "compact", "scatter", "numa" };
+                DS_LOG_INFO("Initialised JobSystem with [{0} cores] [{1} threads] [{2} allowed cpus of {3}] [quota {4:.2f}] [affinity {5}]",
+                            internal_state->numCores, internal_state->numThreads, topo.cpus.size(), topo.hardware_threads, topo.quota_cpus, affinity_names[(int)desc.affinity]);
             }
 
             void release()
@@ -284,25 +758,30 @@ namespace diverse
                 return internal_state->numThreads;
             }
 
-            void execute(Context& ctx, const std::function<void(JobDispatchArgs)>& task)
+            AffinityMode get_affinity_mode()
+            {
+                return internal_state ? internal_state->affinity : AffinityMode::None;
+            }
+
+            void execute(Context& ctx, JobTask task)
             {
                 DS_PROFILE_FUNCTION_LOW();
                 // Context state is updated:
                 ctx.counter.fetch_add(1);
 
-                Job job;
-                job.ctx               = &ctx;
-                job.task              = task;
-                job.groupID           = 0;
-                job.groupJobOffset    = 0;
-                job.groupJobEnd       = 1;
-                job.sharedmemory_size = 0;
+                Job* job               = allocate_job();
+                job->ctx               = &ctx;
+                job->task              = std::move(task);
+                job->groupID           = 0;
+                job->groupJobOffset    = 0;
+                job->groupJobEnd       = 1;
+                job->sharedmemory_size = 0;
 
-                internal_state->jobQueuePerThread[internal_state->nextQueue.fetch_add(1) % internal_state->numThreads].push_back(job);
-                internal_state->wakeCondition.notify_one();
+                submit(job);
+                wake_workers(1);
             }
 
-            void dispatch(Context& ctx, uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& task, size_t sharedmemory_size)
+            void dispatch(Context& ctx, uint32_t jobCount, uint32_t groupSize, JobTask task, size_t sharedmemory_size)
             {
                 DS_PROFILE_FUNCTION_LOW();
                 if(jobCount == 0 || groupSize == 0)
@@ -315,22 +794,26 @@ namespace diverse
                 // Context state is updated:
                 ctx.counter.fetch_add(groupCount);
 
-                Job job;
-                job.ctx               = &ctx;
-                job.task              = task;
-                job.sharedmemory_size = (uint32_t)sharedmemory_size;
+                // the task is stored once, every group references it
+                Job* parent = allocate_job();
+                parent->task = std::move(task);
+                parent->pending.store(groupCount, std::memory_order_relaxed);
 
                 for(uint32_t groupID = 0; groupID < groupCount; ++groupID)
                 {
                     // For each group, generate one real job:
-                    job.groupID        = groupID;
-                    job.groupJobOffset = groupID * groupSize;
-                    job.groupJobEnd    = std::min(job.groupJobOffset + groupSize, jobCount);
-
-                    internal_state->jobQueuePerThread[internal_state->nextQueue.fetch_add(1) % internal_state->numThreads].push_back(job);
+                    Job* job               = allocate_job();
+                    job->ctx               = &ctx;
+                    job->parent            = parent;
+                    job->sharedmemory_size = (uint32_t)sharedmemory_size;
+                    job->groupID           = groupID;
+                    job->groupJobOffset    = groupID * groupSize;
+                    job->groupJobEnd       = std::min(job->groupJobOffset + groupSize, jobCount);
+
+                    submit(job);
                 }
 
-                internal_state->wakeCondition.notify_one();
+                wake_workers(groupCount);
             }
 
             uint32_t dispatch_group_count(uint32_t jobCount, uint32_t groupSize)
@@ -342,28 +825,23 @@ namespace diverse
             bool is_busy(const Context& ctx)
             {
                 // Whenever the main thread label is not reached by the workers, it indicates that some worker is still alive
-                return ctx.counter.load() > 0;
+                return ctx.counter.load(std::memory_order_acquire) > 0;
             }
 
             void wait(const Context& ctx)
             {
                 DS_PROFILE_FUNCTION_LOW();
-                if(is_busy(ctx))
+                while(is_busy(ctx))
                 {
-                    // Wake any threads that might be sleeping:
-                    internal_state->wakeCondition.notify_all();
-
-                    // work() will pick up any jobs that are on stand by and execute them on this thread:
-                    work(internal_state->nextQueue.fetch_add(1) % internal_state->numThreads);
-
-                    while(is_busy(ctx))
+                    // help with any queued job (not necessarily one of ctx) instead of blocking
+                    if(Job* job = find_job())
                     {
-                        // If we are here, then there are still remaining jobs that work() couldn't pick up.
-                        //    In this case those jobs are not standing by on a queue but currently executing
-                        //    on other threads, so they cannot be picked up by this thread.
-                        //    Allow to swap out this thread by OS to not spin endlessly for nothing
-                        std::this_thread::yield();
+                        run_job(job);
+                        continue;
                     }
+                    // If we are here, the remaining jobs are executing on other threads.
+                    //    Allow to swap out this thread by OS to not spin endlessly for nothing
+                    std::this_thread::yield();
                 }
             }
         }
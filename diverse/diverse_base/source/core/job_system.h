@@ -1,4 +1,10 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 struct JobDispatchArgs
 {
@@ -16,10 +22,109 @@ namespace diverse
     {
         namespace JobSystem
         {
+            // Type erased job callable with inline storage, so queuing a job does not allocate.
+            // Callables bigger than INLINE_SIZE (rare, lambdas normally capture a few pointers) fall back to the heap.
+            class JobTask
+            {
+            public:
+                static constexpr size_t INLINE_SIZE = 48;
+
+                JobTask() = default;
+
+                template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, JobTask>>>
+                JobTask(F&& f)
+                {
+                    using T = std::decay_t<F>;
+                    if constexpr(sizeof(T) <= INLINE_SIZE && alignof(T) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<T>)
+                    {
+                        new(storage) T(std::forward<F>(f));
+                        invoke_fn = [](void* p, JobDispatchArgs args) { (*static_cast<T*>(p))(args); };
+                        manage_fn = [](void* dst, void* src) {
+                            if(dst)
+                                new(dst) T(std::move(*static_cast<T*>(src)));
+                            static_cast<T*>(src)->~T();
+                        };
+                    }
+                    else
+                    {
+                        *reinterpret_cast<T**>(storage) = new T(std::forward<F>(f));
+                        invoke_fn = [](void* p, JobDispatchArgs args) { (**static_cast<T**>(p))(args); };
+                        manage_fn = [](void* dst, void* src) {
+                            if(dst)
+                                *static_cast<T**>(dst) = *static_cast<T**>(src);
+                            else
+                                delete *static_cast<T**>(src);
+                        };
+                    }
+                }
+
+                JobTask(JobTask&& other) noexcept { move_from(other); }
+                JobTask& operator=(JobTask&& other) noexcept
+                {
+                    if(this != &other)
+                    {
+                        reset();
+                        move_from(other);
+                    }
+                    return *this;
+                }
+                JobTask(const JobTask&)            = delete;
+                JobTask& operator=(const JobTask&) = delete;
+                ~JobTask() { reset(); }
+
+                void operator()(JobDispatchArgs args) { invoke_fn(storage, args); }
+                explicit operator bool() const { return invoke_fn != nullptr; }
+
+                void reset()
+                {
+                    if(manage_fn)
+                        manage_fn(nullptr, storage);
+                    invoke_fn = nullptr;
+                    manage_fn = nullptr;
+                }
+
+            private:
+                void move_from(JobTask& other)
+                {
+                    if(other.manage_fn)
+                        other.manage_fn(storage, other.storage);
+                    invoke_fn       = other.invoke_fn;
+                    manage_fn       = other.manage_fn;
+                    other.invoke_fn = nullptr;
+                    other.manage_fn = nullptr;
+                }
+
+                alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+                void (*invoke_fn)(void*, JobDispatchArgs) = nullptr;
+                void (*manage_fn)(void* dst, void* src)   = nullptr; // move into dst (when not null) and destroy src
+            };
+
+            enum class AffinityMode : uint8_t
+            {
+                None,     // let the os schedule the workers, right when several processes share the machine
+                Compact,  // worker N on the N-th allowed cpu, smt siblings next to each other
+                Scatter,  // one worker per physical core first, then the smt siblings
+                NumaNode  // the pool is sized to one numa node and its workers may run on any cpu of that node
+            };
+
+            struct Desc
+            {
+                uint32_t     reservedThreads = 1;
+                uint32_t     maxThreads      = 0;  // 0 for no limit
+                AffinityMode affinity        = AffinityMode::None;
+                int32_t      numaNode        = -1; // -1 picks the node of the first allowed cpu
+            };
+
+            // The pool is sized from the cpus the process may actually use (affinity mask and cgroup quota), not
+            // from hardware_concurrency(). The environment overrides the desc:
+            //	DS_JOB_THREADS=<n>                             worker count
+            //	DS_JOB_AFFINITY=none|compact|scatter|numa[:node] pinning mode
             void init(uint32_t reservedThreads = 1);
+            void init(const Desc& desc);
             void release();
 
             uint32_t get_thread_count();
+            AffinityMode get_affinity_mode();
 
             struct Context
             {
@@ -27,20 +132,20 @@ namespace diverse
             };
 
             // Add a job to execute asynchronously. Any idle thread will execute this job.
-            void execute(Context& ctx, const std::function<void(JobDispatchArgs)>& task);
+            void execute(Context& ctx, JobTask task);
 
             // Divide a job onto multiple jobs and execute in parallel.
             //	jobCount	: how many jobs to generate for this task.
             //	groupSize	: how many jobs to execute per thread. Jobs inside a group execute serially. It might be worth to increase for small jobs
             //	func		: receives a JobDispatchArgs as parameter
-            void dispatch(Context& ctx, uint32_t jobCount, uint32_t groupSize, const std::function<void(JobDispatchArgs)>& task, size_t sharedmemory_size = 0);
+            void dispatch(Context& ctx, uint32_t jobCount, uint32_t groupSize, JobTask task, size_t sharedmemory_size = 0);
 
             uint32_t dispatch_group_count(uint32_t jobCount, uint32_t groupSize);
 
             // Check if any threads are working currently or not
             bool is_busy(const Context& ctx);
 
-            // Wait until all threads become idle
+            // Wait until all threads become idle, the calling thread runs queued jobs meanwhile
             void wait(const Context& ctx);
         }
     }
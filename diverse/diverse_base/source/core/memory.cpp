@@ -2,20 +2,24 @@
 #include "core/profiler.h"
 #include "core/ds_log.h"
 #include "memory.h"
+#include "memory_manager.h"
 #include "core/allocators/bin_allocator.h"
 #include "core/allocators/default_allocator.h"
 #include "core/allocators/stb_allocator.h"
+#include <mutex>
 
 namespace diverse
 {
 #ifndef DS_PRODUCTION
     static Arena* s_Arenas[256]; // For Stats
     static int s_CurrentArenaCount = 0;
+    static std::mutex s_ArenaMutex; // arenas are created and released from worker threads
 #endif
 
     int GetArenaCount()
     {
 #ifndef DS_PRODUCTION
+        std::scoped_lock lock(s_ArenaMutex);
         return s_CurrentArenaCount;
 #else
         return 0;
@@ -25,7 +29,8 @@ namespace diverse
     Arena* GetArena(int index)
     {
 #ifndef DS_PRODUCTION
-        return s_Arenas[index];
+        std::scoped_lock lock(s_ArenaMutex);
+        return index < s_CurrentArenaCount ? s_Arenas[index] : nullptr;
 #else
         return nullptr;
 #endif
@@ -67,6 +72,7 @@ namespace diverse
         {
             throw std::bad_alloc();
         }
+        MemoryManager::track_alloc(memory, size);
 
 //#if defined(DS_PROFILE) && defined(TRACY_ENABLE) && DS_TRACK_MEMORY
 //        TracyAlloc(memory, size);
@@ -77,6 +83,7 @@ namespace diverse
 
     void Memory::DeleteFunc(void* p)
     {
+        MemoryManager::track_free(p);
 //#if defined(DS_PROFILE) && defined(TRACY_ENABLE) && DS_TRACK_MEMORY
 //        TracyFree(p);
 //#endif
@@ -94,7 +101,7 @@ namespace diverse
     }
 
     // Arenas
-    Arena* ArenaAlloc(uint64_t size)
+    Arena* ArenaAllocUntracked(uint64_t size)
     {
         Arena* arena          = (Arena*)malloc(sizeof(Arena) + size);
         arena->Position       = sizeof(Arena);
@@ -102,10 +109,19 @@ namespace diverse
         arena->Align          = alignof(std::max_align_t);
         arena->Size           = size;
         arena->Ptr            = arena;
+        return arena;
+    }
+
+    Arena* ArenaAlloc(uint64_t size)
+    {
+        Arena* arena = ArenaAllocUntracked(size);
 
 #ifndef DS_PRODUCTION
-        if(s_CurrentArenaCount < 256)
-            s_Arenas[s_CurrentArenaCount++] = arena;
+        {
+            std::scoped_lock lock(s_ArenaMutex);
+            if(s_CurrentArenaCount < 256)
+                s_Arenas[s_CurrentArenaCount++] = arena;
+        }
 #endif
 //#if defined(DS_PROFILE) && defined(TRACY_ENABLE) && DS_TRACK_MEMORY
 //        TracyAlloc(arena, size);
@@ -121,17 +137,33 @@ namespace diverse
 
     void ArenaRelease(Arena* arena)
     {
-        if(arena)
-        {
+        if(!arena)
+            return;
+
 #ifndef DS_PRODUCTION
-            s_CurrentArenaCount--;
+        {
+            // arenas are released out of order, keep the stats list free of dangling entries
+            std::scoped_lock lock(s_ArenaMutex);
+            for(int i = 0; i < s_CurrentArenaCount; i++)
+            {
+                if(s_Arenas[i] == arena)
+                {
+                    s_Arenas[i] = s_Arenas[--s_CurrentArenaCount];
+                    break;
+                }
+            }
+        }
 #endif
-            free(arena);
+        ArenaReleaseUntracked(arena);
+    }
+
+    void ArenaReleaseUntracked(Arena* arena)
+    {
+        free(arena);
 
 //#if defined(DS_PROFILE) && defined(TRACY_ENABLE) && DS_TRACK_MEMORY
-//            TracyFree(arena);
+//        TracyFree(arena);
 //#endif
-        }
     }
 
     void* ArenaPushNoZero(Arena* arena, uint64_t size)
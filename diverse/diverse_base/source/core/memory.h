@@ -44,6 +44,9 @@ namespace diverse
     Arena* ArenaAlloc(uint64_t size);
     Arena* ArenaAllocDefault();
     void ArenaRelease(Arena* arena);
+    // not listed in the arena stats, for arenas with their own accounting (frame arena blocks)
+    Arena* ArenaAllocUntracked(uint64_t size);
+    void ArenaReleaseUntracked(Arena* arena);
     void* ArenaPushNoZero(Arena* arena, uint64_t size);
     void* ArenaPushAligner(Arena* arena, uint64_t alignment);
     void* ArenaPush(Arena* arena, uint64_t size);
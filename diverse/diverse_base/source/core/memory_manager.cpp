@@ -2,7 +2,16 @@
 #include "core/core.h"
 #include "core/ds_log.h"
 #include "memory_manager.h"
+#include "memory.h"
 #include "utility/string_utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <unordered_map>
 
 namespace diverse
 {
@@ -14,12 +23,25 @@ namespace diverse
 
     void MemoryManager::on_init()
     {
+        // DS_MEMORY_TRACKING=off|sampled|full[:interval]
+        if(const char* env = getenv("DS_MEMORY_TRACKING"))
+        {
+            uint32_t interval = 256 * 1024;
+            if(const char* colon = strchr(env, ':'))
+                interval = (uint32_t)std::max(1, atoi(colon + 1));
+            if(strncmp(env, "sampled", 7) == 0)
+                set_tracking_mode(MemoryTrackingMode::Sampled, interval);
+            else if(strncmp(env, "full", 4) == 0)
+                set_tracking_mode(MemoryTrackingMode::Full, interval);
+        }
     }
 
     void MemoryManager::on_shutdown()
     {
+        set_tracking_mode(MemoryTrackingMode::Off);
         if(s_Instance)
             delete s_Instance;
+        s_Instance = nullptr;
     }
 
     MemoryManager* MemoryManager::get()
@@ -44,4 +66,317 @@ namespace diverse
         DS_LOG_INFO("\tPhysical Memory : {0} / {1}", apm, tpm);
         DS_LOG_INFO("\tVirtual Memory : {0} / {1}: ", avm, tvm);
     }
+
+    // Allocation tracking
+    // The tracker runs inside operator new / delete, so it must not allocate through them itself: records live in
+    // malloc backed maps and a per thread flag stops recursion. Allocations are not given a header because memory
+    // crosses module boundaries (on windows a dll's new pairs with our delete), instead records are kept in a
+    // sharded pointer map which is only consulted while tracking is on.
+    static const char* s_MemoryTagNames[(int)MemoryTag::Count] = {
+        "Untagged", "SplatData", "UndoHistory", "RenderGraph", "Textures", "Meshes", "Scene", "UI", "Assets"
+    };
+
+    const char* memory_tag_name(MemoryTag tag)
+    {
+        return tag < MemoryTag::Count ? s_MemoryTagNames[(int)tag] : "Invalid";
+    }
+
+    template <typename T>
+    struct MallocAllocator
+    {
+        using value_type = T;
+        MallocAllocator() = default;
+        template <typename U>
+        MallocAllocator(const MallocAllocator<U>&) noexcept { }
+
+        T* allocate(size_t n)
+        {
+            if(void* p = malloc(n * sizeof(T)))
+                return static_cast<T*>(p);
+            throw std::bad_alloc();
+        }
+        void deallocate(T* p, size_t) noexcept { free(p); }
+
+        template <typename U>
+        bool operator==(const MallocAllocator<U>&) const noexcept { return true; }
+        template <typename U>
+        bool operator!=(const MallocAllocator<U>&) const noexcept { return false; }
+    };
+
+    struct AllocationRecord
+    {
+        int64_t bytes;       // weighted in sampled mode
+        int64_t allocations; // allocations this record stands for
+        MemoryTag tag;
+    };
+
+    static constexpr uint32_t TRACKING_SHARD_COUNT = 64;
+
+    struct alignas(64) TrackingShard
+    {
+        std::atomic_flag lock = ATOMIC_FLAG_INIT;
+        std::unordered_map<void*, AllocationRecord, std::hash<void*>, std::equal_to<void*>, MallocAllocator<std::pair<void* const, AllocationRecord>>> records;
+
+        void acquire()
+        {
+            while(lock.test_and_set(std::memory_order_acquire))
+                ;
+        }
+        void release() { lock.clear(std::memory_order_release); }
+    };
+
+    struct TagCounters
+    {
+        std::atomic<int64_t> liveBytes { 0 };
+        std::atomic<int64_t> peakBytes { 0 };
+        std::atomic<int64_t> liveAllocations { 0 };
+        std::atomic<int64_t> totalBytes { 0 };
+        std::atomic<int64_t> totalAllocations { 0 };
+    };
+
+    static std::atomic<MemoryTrackingMode> s_TrackingMode { MemoryTrackingMode::Off };
+    static std::atomic<uint32_t> s_SampleInterval { 256 * 1024 };
+    static std::atomic<int64_t> s_LiveRecords { 0 };
+    static std::mutex s_TrackingMutex;
+    // created on first use and never destroyed, operator delete may still run during static destruction
+    static TrackingShard* s_Shards = nullptr;
+    static TagCounters s_TagCounters[(int)MemoryTag::Count];
+
+    static constexpr uint32_t MEMORY_TAG_STACK_SIZE = 32;
+    PerThread uint8_t t_MemoryTagStack[MEMORY_TAG_STACK_SIZE];
+    PerThread uint32_t t_MemoryTagDepth = 0;
+    PerThread int64_t t_BytesUntilSample = 0;
+    PerThread uint32_t t_SampleSeed = 0;
+    PerThread bool t_InTracker = false;
+
+    void push_memory_tag(MemoryTag tag)
+    {
+        if(t_MemoryTagDepth < MEMORY_TAG_STACK_SIZE)
+            t_MemoryTagStack[t_MemoryTagDepth] = (uint8_t)tag;
+        t_MemoryTagDepth++;
+    }
+
+    void pop_memory_tag()
+    {
+        DS_ASSERT(t_MemoryTagDepth > 0);
+        t_MemoryTagDepth--;
+    }
+
+    MemoryTag current_memory_tag()
+    {
+        if(t_MemoryTagDepth == 0)
+            return MemoryTag::Untagged;
+        return (MemoryTag)t_MemoryTagStack[std::min(t_MemoryTagDepth, MEMORY_TAG_STACK_SIZE) - 1];
+    }
+
+    static TrackingShard& shard_for(void* ptr)
+    {
+        const uint64_t h = (uint64_t)(uintptr_t)ptr * 0x9E3779B97F4A7C15ull;
+        return s_Shards[h >> 58]; // top 6 bits, TRACKING_SHARD_COUNT shards
+    }
+
+    // randomised around the interval so periodic allocation patterns are not always missed or always hit
+    static int64_t next_sample_distance(uint32_t interval)
+    {
+        uint32_t x = t_SampleSeed ? t_SampleSeed : (uint32_t)(uintptr_t)&t_SampleSeed | 1u;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        t_SampleSeed = x;
+        return interval / 2 + (int64_t)(x % (interval + 1));
+    }
+
+    void MemoryManager::set_tracking_mode(MemoryTrackingMode mode, uint32_t sampleInterval)
+    {
+        std::scoped_lock lock(s_TrackingMutex);
+        t_InTracker = true;
+        if(!s_Shards)
+        {
+            s_Shards = static_cast<TrackingShard*>(Memory::AlignedAlloc(sizeof(TrackingShard) * TRACKING_SHARD_COUNT, alignof(TrackingShard)));
+            for(uint32_t i = 0; i < TRACKING_SHARD_COUNT; i++)
+                new(&s_Shards[i]) TrackingShard();
+        }
+
+        s_TrackingMode.store(MemoryTrackingMode::Off);
+        for(uint32_t i = 0; i < TRACKING_SHARD_COUNT; i++)
+        {
+            s_Shards[i].acquire();
+            s_Shards[i].records.clear();
+            s_Shards[i].release();
+        }
+        for(auto& counters : s_TagCounters)
+        {
+            counters.liveBytes        = 0;
+            counters.peakBytes        = 0;
+            counters.liveAllocations  = 0;
+            counters.totalBytes       = 0;
+            counters.totalAllocations = 0;
+        }
+        s_LiveRecords = 0;
+        s_SampleInterval.store(std::max<uint32_t>(1u, sampleInterval));
+        s_TrackingMode.store(mode);
+        t_InTracker = false;
+    }
+
+    MemoryTrackingMode MemoryManager::get_tracking_mode()
+    {
+        return s_TrackingMode.load(std::memory_order_relaxed);
+    }
+
+    void MemoryManager::track_alloc(void* ptr, size_t size)
+    {
+        const MemoryTrackingMode mode = s_TrackingMode.load(std::memory_order_relaxed);
+        if(mode == MemoryTrackingMode::Off || !ptr || t_InTracker)
+            return;
+
+        AllocationRecord record = { (int64_t)size, 1, current_memory_tag() };
+        if(mode == MemoryTrackingMode::Sampled)
+        {
+            // an allocation at least one interval large is always taken with its real size,
+            // smaller ones are taken once per interval bytes and stand for interval bytes
+            const uint32_t interval = s_SampleInterval.load(std::memory_order_relaxed);
+            if(size < interval)
+            {
+                t_BytesUntilSample -= (int64_t)size;
+                if(t_BytesUntilSample > 0)
+                    return;
+                t_BytesUntilSample = next_sample_distance(interval);
+                record.bytes       = interval;
+                record.allocations = std::max<int64_t>(1, interval / std::max<size_t>(size, 1));
+            }
+        }
+
+        t_InTracker         = true;
+        TrackingShard& shard = shard_for(ptr);
+        shard.acquire();
+        auto [it, inserted] = shard.records.emplace(ptr, record);
+        AllocationRecord stale = {};
+        if(!inserted)
+        {
+            // the block was released while this thread was inside the tracker, drop the old record
+            stale      = it->second;
+            it->second = record;
+        }
+        shard.release();
+        t_InTracker = false;
+        if(inserted)
+            s_LiveRecords.fetch_add(1, std::memory_order_relaxed);
+        else
+        {
+            s_TagCounters[(int)stale.tag].liveBytes.fetch_sub(stale.bytes, std::memory_order_relaxed);
+            s_TagCounters[(int)stale.tag].liveAllocations.fetch_sub(stale.allocations, std::memory_order_relaxed);
+        }
+
+        TagCounters& counters = s_TagCounters[(int)record.tag];
+        const int64_t live    = counters.liveBytes.fetch_add(record.bytes, std::memory_order_relaxed) + record.bytes;
+        counters.liveAllocations.fetch_add(record.allocations, std::memory_order_relaxed);
+        counters.totalBytes.fetch_add(record.bytes, std::memory_order_relaxed);
+        counters.totalAllocations.fetch_add(record.allocations, std::memory_order_relaxed);
+        int64_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+        while(live > peak && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            ;
+    }
+
+    void MemoryManager::track_free(void* ptr)
+    {
+        if(s_LiveRecords.load(std::memory_order_relaxed) == 0 || !ptr || t_InTracker)
+            return;
+
+        AllocationRecord record;
+        bool found           = false;
+        t_InTracker          = true;
+        TrackingShard& shard = shard_for(ptr);
+        shard.acquire();
+        auto it = shard.records.find(ptr);
+        if(it != shard.records.end())
+        {
+            record = it->second;
+            shard.records.erase(it);
+            found = true;
+        }
+        shard.release();
+        t_InTracker = false;
+        if(!found)
+            return;
+
+        s_LiveRecords.fetch_sub(1, std::memory_order_relaxed);
+        TagCounters& counters = s_TagCounters[(int)record.tag];
+        counters.liveBytes.fetch_sub(record.bytes, std::memory_order_relaxed);
+        counters.liveAllocations.fetch_sub(record.allocations, std::memory_order_relaxed);
+    }
+
+    void MemoryManager::sample()
+    {
+        const double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        const double dt  = now - m_LastSample.time;
+        if(dt < 0.5)
+            return;
+
+        for(int i = 0; i < (int)MemoryTag::Count; i++)
+        {
+            const int64_t bytes       = s_TagCounters[i].totalBytes.load(std::memory_order_relaxed);
+            const int64_t allocations = s_TagCounters[i].totalAllocations.load(std::memory_order_relaxed);
+            // counters are reset when the mode changes, a negative delta means a fresh start
+            m_BytesPerSecond[i]       = m_LastSample.time > 0.0 && bytes >= m_LastSample.bytes[i] ? (bytes - m_LastSample.bytes[i]) / dt : 0.0;
+            m_AllocationsPerSecond[i] = m_LastSample.time > 0.0 && allocations >= m_LastSample.allocations[i] ? (allocations - m_LastSample.allocations[i]) / dt : 0.0;
+            m_LastSample.bytes[i]       = bytes;
+            m_LastSample.allocations[i] = allocations;
+        }
+        m_LastSample.time = now;
+    }
+
+    std::vector<MemoryTagStats> MemoryManager::get_tag_stats() const
+    {
+        std::vector<MemoryTagStats> stats;
+        stats.reserve((size_t)MemoryTag::Count);
+        for(int i = 0; i < (int)MemoryTag::Count; i++)
+        {
+            MemoryTagStats s;
+            s.tag                  = (MemoryTag)i;
+            s.name                 = s_MemoryTagNames[i];
+            s.liveBytes            = s_TagCounters[i].liveBytes.load(std::memory_order_relaxed);
+            s.peakBytes            = s_TagCounters[i].peakBytes.load(std::memory_order_relaxed);
+            s.liveAllocations      = s_TagCounters[i].liveAllocations.load(std::memory_order_relaxed);
+            s.bytesPerSecond       = m_BytesPerSecond[i];
+            s.allocationsPerSecond = m_AllocationsPerSecond[i];
+            stats.push_back(s);
+        }
+        return stats;
+    }
+
+    std::string MemoryManager::tag_stats_to_json() const
+    {
+        static const char* mode_names[] = { "off", "sampled", "full" };
+        std::string json = "{\n";
+        json += "  \"mode\": \"" + std::string(mode_names[(int)get_tracking_mode()]) + "\",\n";
+        json += "  \"sample_interval\": " + std::to_string(s_SampleInterval.load()) + ",\n";
+        json += "  \"tags\": [\n";
+        auto stats = get_tag_stats();
+        for(size_t i = 0; i < stats.size(); i++)
+        {
+            auto& s = stats[i];
+            json += "    { \"name\": \"" + std::string(s.name) + "\""
+                + ", \"live_bytes\": " + std::to_string(s.liveBytes)
+                + ", \"peak_bytes\": " + std::to_string(s.peakBytes)
+                + ", \"live_allocations\": " + std::to_string(s.liveAllocations)
+                + ", \"bytes_per_second\": " + std::to_string(s.bytesPerSecond)
+                + ", \"allocations_per_second\": " + std::to_string(s.allocationsPerSecond) + " }"
+                + (i + 1 < stats.size() ? ",\n" : "\n");
+        }
+        json += "  ]\n}\n";
+        return json;
+    }
+
+    bool MemoryManager::export_tag_stats(const std::string& path) const
+    {
+        std::ofstream file(path);
+        if(!file)
+        {
+            DS_LOG_ERROR("Failed to write memory report {0}", path);
+            return false;
+        }
+        file << tag_stats_to_json();
+        DS_LOG_INFO("Memory report written to {0}", path);
+        return true;
+    }
 }
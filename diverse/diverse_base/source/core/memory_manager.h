@@ -1,4 +1,9 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 namespace diverse
 {
@@ -29,6 +34,41 @@ namespace diverse
         }
     };
 
+    // Subsystem an allocation is charged to. The innermost MemoryTagScope of the allocating thread wins.
+    enum class MemoryTag : uint8_t
+    {
+        Untagged,
+        SplatData,
+        UndoHistory,
+        RenderGraph,
+        Textures,
+        Meshes,
+        Scene,
+        UI,
+        Assets,
+        Count
+    };
+
+    const char* memory_tag_name(MemoryTag tag);
+
+    enum class MemoryTrackingMode : uint8_t
+    {
+        Off,     // nothing recorded, operator new/delete only check the mode
+        Sampled, // about one allocation per sample interval bytes is recorded and weighted, cheap enough for release
+        Full     // every allocation is recorded, exact but slow
+    };
+
+    struct MemoryTagStats
+    {
+        MemoryTag tag;
+        const char* name;
+        int64_t liveBytes;
+        int64_t peakBytes;
+        int64_t liveAllocations;
+        double bytesPerSecond;       // allocated bytes, not net growth
+        double allocationsPerSecond;
+    };
+
     class MemoryManager
     {
     public:
@@ -54,5 +94,75 @@ namespace diverse
 
     public:
         static std::string bytes_to_string(int64_t bytes);
+
+    public:
+        // Switching modes drops everything recorded so far, allocations made before are never charged
+        static void set_tracking_mode(MemoryTrackingMode mode, uint32_t sampleInterval = 256 * 1024);
+        static MemoryTrackingMode get_tracking_mode();
+
+        // called from operator new / delete
+        static void track_alloc(void* ptr, size_t size);
+        static void track_free(void* ptr);
+
+        // updates the allocation rates, call about once per frame
+        void sample();
+        std::vector<MemoryTagStats> get_tag_stats() const;
+        std::string tag_stats_to_json() const;
+        bool export_tag_stats(const std::string& path) const;
+
+    private:
+        struct RateSample
+        {
+            double time = 0.0;
+            int64_t bytes[(int)MemoryTag::Count] = {};
+            int64_t allocations[(int)MemoryTag::Count] = {};
+        };
+        RateSample m_LastSample;
+        double m_BytesPerSecond[(int)MemoryTag::Count] = {};
+        double m_AllocationsPerSecond[(int)MemoryTag::Count] = {};
+    };
+
+    void push_memory_tag(MemoryTag tag);
+    void pop_memory_tag();
+    MemoryTag current_memory_tag();
+
+    struct MemoryTagScope
+    {
+        MemoryTagScope(MemoryTag tag) { push_memory_tag(tag); }
+        ~MemoryTagScope() { pop_memory_tag(); }
+        MemoryTagScope(const MemoryTagScope&)            = delete;
+        MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+    };
+
+#define DS_MEMORY_TAG_CONCAT_(a, b) a##b
+#define DS_MEMORY_TAG_CONCAT(a, b) DS_MEMORY_TAG_CONCAT_(a, b)
+#define DS_MEMORY_TAG(tag) ::diverse::MemoryTagScope DS_MEMORY_TAG_CONCAT(memory_tag_scope_, __LINE__)(::diverse::MemoryTag::tag)
+
+    // Charges a container's storage to a tag wherever it grows, e.g std::vector<u8, TaggedAllocator<u8, MemoryTag::UndoHistory>>
+    template <typename T, MemoryTag Tag>
+    struct TaggedAllocator
+    {
+        using value_type = T;
+        template <typename U>
+        struct rebind
+        {
+            using other = TaggedAllocator<U, Tag>;
+        };
+
+        TaggedAllocator() = default;
+        template <typename U>
+        TaggedAllocator(const TaggedAllocator<U, Tag>&) noexcept { }
+
+        T* allocate(size_t n)
+        {
+            MemoryTagScope scope(Tag);
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        void deallocate(T* p, size_t) noexcept { ::operator delete(p); }
+
+        template <typename U>
+        bool operator==(const TaggedAllocator<U, Tag>&) const noexcept { return true; }
+        template <typename U>
+        bool operator!=(const TaggedAllocator<U, Tag>&) const noexcept { return false; }
     };
 }
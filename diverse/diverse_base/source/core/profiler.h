@@ -15,6 +15,8 @@
 
 #include <Tracy/public/tracy/Tracy.hpp>
 #define DS_PROFILE_SCOPE(name) ZoneScopedN(name)
+// for names only known at runtime, the string is copied into the zone
+#define DS_PROFILE_SCOPE_DYNAMIC(name, size) ZoneScoped; ZoneName(name, size)
 #define DS_PROFILE_FUNCTION() ZoneScoped
 #define DS_PROFILE_FRAMEMARKER() FrameMark
 #define DS_PROFILE_LOCK(type, var, name) TracyLockableN(type, var, name)
@@ -31,6 +33,7 @@
 
 #else
 #define DS_PROFILE_SCOPE(name)
+#define DS_PROFILE_SCOPE_DYNAMIC(name, size)
 #define DS_PROFILE_FUNCTION()
 #define DS_PROFILE_FRAMEMARKER()
 #define DS_PROFILE_LOCK(type, var, name) type var
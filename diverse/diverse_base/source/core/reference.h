@@ -1,102 +1,172 @@
 #pragma once
 #include "core.h"
-#include "reference_counter.h"
+#include <atomic>
+#include <new>
+#include <utility>
 #include "core/memory.h"
 #include "core/ds_log.h"
 
 namespace diverse
 {
+    // Control block shared by every Reference / WeakReference to one object. Strong references collectively hold
+    // one weak reference, so the block outlives the object until the last WeakReference is gone.
+    // createSharedPtr places the object inside the block (one allocation), adopting a raw pointer allocates
+    // the block separately.
     class DS_EXPORT RefCount
     {
     public:
-        RefCount();
-        ~RefCount();
+        RefCount() = default;
+        virtual ~RefCount();
 
-        inline bool isReferenced() const
+        RefCount(const RefCount&)            = delete;
+        RefCount& operator=(const RefCount&) = delete;
+
+        inline void reference()
+        {
+            m_Refcount.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Fails once the object is destroyed, used to promote weak references and borrows
+        inline bool tryReference()
+        {
+            int count = m_Refcount.load(std::memory_order_relaxed);
+            while(count > 0)
+            {
+                if(m_Refcount.compare_exchange_weak(count, count + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                    return true;
+            }
+            return false;
+        }
+        // Destroys the object with the last strong reference and the block with the last weak one
+        inline void unreference()
         {
-            return m_RefcountInit.get() < 1;
+            if(m_Refcount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                destroyObject();
+                weakUnreference();
+            }
         }
-        bool initRef();
 
-        // Returns false if refcount is at zero and didn't get increased
-        bool reference();
-        bool unreference();
+        inline void weakReference()
+        {
+            m_WeakRefcount.fetch_add(1, std::memory_order_relaxed);
+        }
+        inline void weakUnreference()
+        {
+            if(m_WeakRefcount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete this;
+        }
 
-        bool weakReference();
-        bool weakUnreference();
+        inline int getReferenceCount() const
+        {
+            return m_Refcount.load(std::memory_order_relaxed);
+        }
+        // weak references held by WeakReference objects only
+        inline int getWeakReferenceCount() const
+        {
+            return m_WeakRefcount.load(std::memory_order_relaxed) - (getReferenceCount() > 0 ? 1 : 0);
+        }
 
-        int getReferenceCount() const;
-        int getWeakReferenceCount() const;
+    protected:
+        virtual void destroyObject() = 0;
 
     private:
-        ReferenceCounter m_Refcount;
-        ReferenceCounter m_RefcountInit;
-        ReferenceCounter m_WeakRefcount;
+        std::atomic<int> m_Refcount { 1 };
+        std::atomic<int> m_WeakRefcount { 1 };
     };
 
     template <class T>
-    class Reference
+    class RefCountPointer final : public RefCount
     {
     public:
-        Reference() noexcept
-            : m_Ptr(nullptr)
+        explicit RefCountPointer(T* ptr)
+            : m_Object(ptr)
         {
         }
 
+    protected:
+        void destroyObject() override
+        {
+            delete m_Object;
+        }
+
+    private:
+        T* m_Object;
+    };
+
+    template <class T>
+    class RefCountInline final : public RefCount
+    {
+    public:
+        template <typename... Args>
+        explicit RefCountInline(Args&&... args)
+        {
+            new(m_Storage) T(std::forward<Args>(args)...);
+        }
+        inline T* object()
+        {
+            return std::launder(reinterpret_cast<T*>(m_Storage));
+        }
+
+    protected:
+        void destroyObject() override
+        {
+            object()->~T();
+        }
+
+    private:
+        alignas(T) unsigned char m_Storage[sizeof(T)];
+    };
+
+    template <class T>
+    class WeakReference;
+    template <class T>
+    class Borrowed;
+
+    template <class T>
+    class Reference
+    {
+    public:
+        Reference() noexcept = default;
+
         Reference(std::nullptr_t) noexcept
-            : m_Ptr(nullptr)
-            , m_Counter(nullptr)
         {
         }
 
-        explicit Reference(T* ptr) noexcept
-            : m_Ptr(nullptr)
-            , m_Counter(nullptr)
+        // Takes ownership of a heap object, prefer createSharedPtr which allocates the object and its count together
+        explicit Reference(T* ptr)
         {
             if(ptr)
-                refPointer(ptr);
+            {
+                m_Ptr     = ptr;
+                m_Counter = new RefCountPointer<T>(ptr);
+            }
         }
 
         Reference(const Reference<T>& other) noexcept
+            : m_Counter(other.m_Counter)
+            , m_Ptr(other.m_Ptr)
         {
-            m_Ptr     = nullptr;
-            m_Counter = nullptr;
-
-            ref(other);
+            if(m_Counter)
+                m_Counter->reference();
         }
 
         Reference(Reference<T>&& rhs) noexcept
+            : m_Counter(rhs.m_Counter)
+            , m_Ptr(rhs.m_Ptr)
         {
-            m_Ptr     = nullptr;
-            m_Counter = nullptr;
-
-            ref(rhs);
+            rhs.m_Counter = nullptr;
+            rhs.m_Ptr     = nullptr;
         }
 
         template <typename U>
-        inline Reference(const Reference<U>& moving) noexcept
+        inline Reference(const Reference<U>& other) noexcept
         {
-            U* movingPtr = moving.get();
-
-            T* castPointer = static_cast<T*>(movingPtr);
-
-            unref();
-
-            if(castPointer != nullptr)
-            {
-                if(moving.get() == m_Ptr)
-                    return;
-
-                if(moving.getCounter() && moving.get())
-                {
-                    m_Ptr     = castPointer;
-                    m_Counter = moving.getCounter();
-                    m_Counter->reference();
-                }
-            }
-            else
+            T* castPointer = static_cast<T*>(other.get());
+            if(castPointer && other.getCounter())
             {
-                DS_LOG_ERROR("Failed to cast Reference");
+                m_Ptr     = castPointer;
+                m_Counter = other.getCounter();
+                m_Counter->reference();
             }
         }
 
@@ -116,48 +186,30 @@ namespace diverse
         }
 
         inline int use_count() const
-		{
-			return m_Counter ? m_Counter->getReferenceCount() : 0;
-		}
-
-        inline T* release() noexcept
         {
-            T* tmp = nullptr;
-
-            if(m_Counter->unreference())
-            {
-                delete m_Counter;
-                m_Counter = nullptr;
-            }
-
-            std::swap(tmp, m_Ptr);
-            m_Ptr = nullptr;
+            return m_Counter ? m_Counter->getReferenceCount() : 0;
+        }
 
-            return tmp;
+        // Non atomic view for per frame data, see Borrowed
+        inline Borrowed<T> borrow() const
+        {
+            return Borrowed<T>(m_Ptr, m_Counter);
         }
 
         inline void reset(T* p_ptr = nullptr)
         {
-            unref();
-
-            m_Ptr     = p_ptr;
-            m_Counter = nullptr;
-
-            if(m_Ptr != nullptr)
-            {
-                m_Counter = new RefCount();
-                m_Counter->initRef();
-            }
+            Reference<T>(p_ptr).swap(*this);
         }
 
-        inline void operator=(Reference const& rhs)
+        inline Reference& operator=(Reference const& rhs)
         {
-            ref(rhs);
+            Reference<T>(rhs).swap(*this);
+            return *this;
         }
 
         inline Reference& operator=(Reference&& rhs) noexcept
         {
-            ref(rhs);
+            Reference<T>(std::move(rhs)).swap(*this);
             return *this;
         }
 
@@ -168,28 +220,20 @@ namespace diverse
         }
 
         template <typename U>
-        inline Reference& operator=(const Reference<U>& moving)
+        inline Reference& operator=(const Reference<U>& other)
         {
-            U* movingPtr = moving.get();
-
-            T* castPointer = dynamic_cast<T*>(movingPtr);
-
-            unref();
+            T* castPointer = dynamic_cast<T*>(other.get());
+            if(castPointer == nullptr && other.get() != nullptr)
+                DS_LOG_ERROR("Failed to cast Reference");
 
-            if(castPointer != nullptr)
+            Reference<T> tmp;
+            if(castPointer && other.getCounter())
             {
-                if(moving.getCounter() && moving.get())
-                {
-                    m_Ptr     = moving.get();
-                    m_Counter = moving.getCounter();
-                    m_Counter->reference();
-                }
-            }
-            else
-            {
-                DS_LOG_ERROR("Failed to cast Reference");
+                tmp.m_Ptr     = castPointer;
+                tmp.m_Counter = other.getCounter();
+                tmp.m_Counter->reference();
             }
-
+            tmp.swap(*this);
             return *this;
         }
 
@@ -259,69 +303,40 @@ namespace diverse
         }
 
     private:
-        inline void ref(const Reference& p_from)
-        {
-            if(p_from.m_Ptr == m_Ptr)
-                return;
-
-            unref();
-
-            m_Counter = nullptr;
-            m_Ptr     = nullptr;
-
-            if(p_from.getCounter() && p_from.get())
-            {
-                m_Ptr     = p_from.get();
-                m_Counter = p_from.getCounter();
-                m_Counter->reference();
-            }
-        }
+        template <class U>
+        friend class Reference;
+        friend class WeakReference<T>;
+        friend class Borrowed<T>;
+        template <typename U, typename... Args>
+        friend Reference<U> createSharedPtr(Args&&... args);
 
-        inline void refPointer(T* ptr)
+        // adopts a reference that was already counted
+        Reference(T* ptr, RefCount* counter) noexcept
+            : m_Counter(counter)
+            , m_Ptr(ptr)
         {
-            DS_ASSERT(ptr, "Creating shared ptr with nullptr");
-
-            m_Ptr     = ptr;
-            m_Counter = new RefCount();
-            m_Counter->initRef();
         }
 
         inline void unref()
         {
             if(m_Counter != nullptr)
-            {
-                if(m_Counter->unreference())
-                {
-                    delete m_Ptr;
-
-                    if(m_Counter->getWeakReferenceCount() == 0)
-                    {
-                        delete m_Counter;
-                    }
-
-                    m_Ptr     = nullptr;
-                    m_Counter = nullptr;
-                }
-            }
+                m_Counter->unreference();
+            m_Counter = nullptr;
+            m_Ptr     = nullptr;
         }
 
         RefCount* m_Counter = nullptr;
         T* m_Ptr            = nullptr;
     };
 
+    // Does not keep the object alive, Lock() returns an empty Reference once the last strong reference is gone
     template <class T>
     class DS_EXPORT WeakReference
     {
     public:
-        WeakReference() noexcept
-            : m_Ptr(nullptr)
-            , m_Counter(nullptr)
-        {
-        }
+        WeakReference() noexcept = default;
 
         WeakReference(std::nullptr_t) noexcept
-            : m_Ptr(nullptr)
-            , m_Counter(nullptr)
         {
         }
 
@@ -332,41 +347,38 @@ namespace diverse
             addRef();
         }
 
-        explicit WeakReference(T* ptr) noexcept
-            : m_Ptr(ptr)
-        {
-            DS_ASSERT(ptr, "Creating weak ptr with nullptr");
-
-            m_Counter = new RefCount();
-            m_Counter->weakReference();
-        }
-
-        template <class U>
-        WeakReference(const WeakReference<U>& rhs) noexcept
+        WeakReference(WeakReference<T>&& rhs) noexcept
             : m_Ptr(rhs.m_Ptr)
             , m_Counter(rhs.m_Counter)
         {
-            addRef();
+            rhs.m_Ptr     = nullptr;
+            rhs.m_Counter = nullptr;
         }
 
         WeakReference(const Reference<T>& rhs) noexcept
             : m_Ptr(rhs.get())
-            , m_Counter(rhs.m_Counter)
+            , m_Counter(rhs.getCounter())
         {
             addRef();
         }
 
         ~WeakReference() noexcept
         {
-            if(m_Counter->weakUnreference())
-            {
-                delete m_Ptr;
-            }
+            if(m_Counter)
+                m_Counter->weakUnreference();
+        }
+
+        WeakReference& operator=(WeakReference rhs) noexcept
+        {
+            std::swap(m_Ptr, rhs.m_Ptr);
+            std::swap(m_Counter, rhs.m_Counter);
+            return *this;
         }
 
         void addRef()
         {
-            m_Counter->weakReference();
+            if(m_Counter)
+                m_Counter->weakReference();
         }
 
         bool expired() const
@@ -376,30 +388,14 @@ namespace diverse
 
         Reference<T> Lock() const
         {
-            if(expired())
-                return Reference<T>();
-            else
-                return Reference<T>(m_Ptr);
-        }
-
-        inline T* operator->() const
-        {
-            return &*m_Ptr;
-        }
-        inline T& operator*() const
-        {
-            return *m_Ptr;
-        }
-
-        inline T& operator[](int index)
-        {
-            assert(m_Ptr);
-            return m_Ptr[index];
+            if(m_Counter && m_Counter->tryReference())
+                return Reference<T>(m_Ptr, m_Counter);
+            return Reference<T>();
         }
 
         inline explicit operator bool() const
         {
-            return m_Ptr != nullptr;
+            return !expired();
         }
         inline bool operator==(const T* p_ptr) const
         {
@@ -423,7 +419,72 @@ namespace diverse
         }
 
     private:
-        T* m_Ptr;
+        T* m_Ptr             = nullptr;
+        RefCount* m_Counter = nullptr;
+    };
+
+    // Non owning, non atomic handle for data that lives one frame, e.g. render command queues and job payloads
+    // filled from components that own the SharedPtr. Copying it is a pointer copy; debug builds check the object
+    // is still alive on access. Use lock() to keep the object beyond the frame.
+    template <class T>
+    class Borrowed
+    {
+    public:
+        Borrowed() noexcept = default;
+        Borrowed(std::nullptr_t) noexcept
+        {
+        }
+        Borrowed(const Reference<T>& owner) noexcept
+            : m_Ptr(owner.get())
+            , m_Counter(owner.getCounter())
+        {
+        }
+
+        inline T* get() const
+        {
+            check();
+            return m_Ptr;
+        }
+        inline operator T*() const
+        {
+            return get();
+        }
+        inline T* operator->() const
+        {
+            return get();
+        }
+        inline T& operator*() const
+        {
+            return *get();
+        }
+        inline explicit operator bool() const
+        {
+            return m_Ptr != nullptr;
+        }
+
+        Reference<T> lock() const
+        {
+            if(m_Counter && m_Counter->tryReference())
+                return Reference<T>(m_Ptr, m_Counter);
+            return Reference<T>();
+        }
+
+    private:
+        friend class Reference<T>;
+        Borrowed(T* ptr, RefCount* counter) noexcept
+            : m_Ptr(ptr)
+            , m_Counter(counter)
+        {
+        }
+
+        inline void check() const
+        {
+#ifdef DS_DEBUG
+            DS_ASSERT(!m_Counter || m_Counter->getReferenceCount() > 0, "Borrowed pointer outlived its owner");
+#endif
+        }
+
+        T* m_Ptr             = nullptr;
         RefCount* m_Counter = nullptr;
     };
 
@@ -542,11 +603,10 @@ namespace diverse
     using SharedPtr = Reference<T>;
 
     template <typename T, typename... Args>
-    SharedPtr<T> createSharedPtr(Args&&... args)
+    Reference<T> createSharedPtr(Args&&... args)
     {
-        auto ptr = new T(std::forward<Args>(args)...);
-
-        return Reference<T>(ptr);
+        auto block = new RefCountInline<T>(std::forward<Args>(args)...);
+        return Reference<T>(block->object(), block);
     }
 
     template <class T>
@@ -1,6 +1,7 @@
 #include <memory>
 #include "string.h"
 #include <cstdarg>
+#include <algorithm>
 
 // Based on https://github.com/Dion-Systems/metadesk/blob/master/source/md.h
 
@@ -237,6 +238,194 @@ namespace diverse
         return result;
     }
 
+    static bool Str8BuilderReserve(String8Builder* builder, uint64_t extra)
+    {
+        const uint64_t needed = builder->size + extra + 1; // keep room for the terminator
+        if(needed <= builder->capacity)
+            return true;
+        if(builder->failed)
+            return false;
+
+        Arena* arena          = builder->arena;
+        const uint64_t wanted = std::max(needed, builder->capacity * 2);
+        const uint64_t before = arena->Position;
+        uint8_t* top          = (uint8_t*)arena->Ptr + arena->Position;
+        if(builder->str && builder->str + builder->capacity == top)
+        {
+            if(ArenaPushNoZero(arena, wanted - builder->capacity))
+            {
+                builder->capacity += arena->Position - before;
+                return true;
+            }
+        }
+        else if(uint8_t* str = PushArrayNoZero(arena, uint8_t, wanted))
+        {
+            if(builder->size)
+                MemoryCopy(str, builder->str, builder->size);
+            builder->str      = str;
+            builder->capacity = arena->Position - before;
+            return true;
+        }
+        builder->failed = true;
+        return false;
+    }
+
+    String8Builder Str8BuilderBegin(Arena* arena, uint64_t reserve)
+    {
+        String8Builder builder;
+        builder.arena = arena;
+        if(Str8BuilderReserve(&builder, reserve))
+            builder.str[0] = 0;
+        return builder;
+    }
+
+    void Str8BuilderAppend(String8Builder* builder, String8 str)
+    {
+        if(!Str8BuilderReserve(builder, str.size))
+            str.size = builder->capacity ? builder->capacity - builder->size - 1 : 0;
+        if(str.size)
+            MemoryCopy(builder->str + builder->size, str.str, str.size);
+        builder->size += str.size;
+        if(builder->str)
+            builder->str[builder->size] = 0;
+    }
+
+    void Str8BuilderAppendChar(String8Builder* builder, uint8_t c)
+    {
+        if(!Str8BuilderReserve(builder, 1))
+            return;
+        builder->str[builder->size++] = c;
+        builder->str[builder->size]   = 0;
+    }
+
+    void Str8BuilderAppendFV(String8Builder* builder, const char* fmt, va_list args)
+    {
+        va_list args2;
+        va_copy(args2, args);
+        // format straight into the free space, only measure first when it does not fit
+        const uint64_t space = builder->capacity ? builder->capacity - builder->size : 0;
+        const int needed     = vsnprintf(space ? (char*)builder->str + builder->size : nullptr, space, fmt, args);
+        if(needed > 0 && uint64_t(needed) < space)
+            builder->size += needed;
+        else if(needed > 0 && Str8BuilderReserve(builder, needed))
+        {
+            vsnprintf((char*)builder->str + builder->size, needed + 1, fmt, args2);
+            builder->size += needed;
+        }
+        else if(builder->str)
+            builder->str[builder->size] = 0;
+        va_end(args2);
+    }
+
+    void Str8BuilderAppendF(String8Builder* builder, const char* fmt, ...)
+    {
+        va_list args;
+        va_start(args, fmt);
+        Str8BuilderAppendFV(builder, fmt, args);
+        va_end(args);
+    }
+
+    String8 Str8BuilderEnd(String8Builder* builder)
+    {
+        Arena* arena = builder->arena;
+        if(builder->str && builder->str + builder->capacity == (uint8_t*)arena->Ptr + arena->Position)
+        {
+            const uint64_t used = ((builder->size + 1) + arena->Align - 1) & ~(arena->Align - 1);
+            ArenaPopTo(arena, arena->Position - (builder->capacity - std::min(used, builder->capacity)));
+            builder->capacity = std::min(used, builder->capacity);
+        }
+        return Str8(builder->str, builder->size);
+    }
+
+    String8 Str8PathJoin(Arena* arena, String8 a, String8 b)
+    {
+        String8Builder builder = Str8BuilderBegin(arena, a.size + b.size + 1);
+        Str8BuilderAppend(&builder, a);
+        const bool a_slash = a.size && CharToForwardSlash(a.str[a.size - 1]) == '/';
+        const bool b_slash = b.size && CharToForwardSlash(b.str[0]) == '/';
+        if(a_slash && b_slash)
+            b = Str8Skip(b, 1);
+        else if(a.size && b.size && !a_slash && !b_slash)
+            Str8BuilderAppendChar(&builder, '/');
+        Str8BuilderAppend(&builder, b);
+        String8 result = Str8BuilderEnd(&builder);
+        for(uint64_t i = 0; i < result.size; i++)
+            result.str[i] = CharToForwardSlash(result.str[i]);
+        return result;
+    }
+
+    String8 Str8PathNormalize(Arena* arena, String8 path)
+    {
+        uint8_t* out = PushArrayNoZero(arena, uint8_t, path.size + 1);
+        if(!out)
+            return {};
+
+        uint64_t size = 0;
+        while(size < path.size && size < 2 && CharToForwardSlash(path.str[size]) == '/')
+            out[size++] = '/';
+        const uint64_t root = size;
+
+        uint64_t i = root;
+        while(i < path.size)
+        {
+            const uint64_t start = i;
+            while(i < path.size && CharToForwardSlash(path.str[i]) != '/')
+                i++;
+            String8 segment = Substr8(path, { start, i });
+            while(i < path.size && CharToForwardSlash(path.str[i]) == '/')
+                i++;
+
+            if(segment.size == 0 || Str8Match(segment, Str8Lit(".")))
+                continue;
+            if(Str8Match(segment, Str8Lit("..")))
+            {
+                uint64_t prev = size;
+                while(prev > root && out[prev - 1] != '/')
+                    prev--;
+                if(size > root && !Str8Match(Str8(out + prev, size - prev), Str8Lit("..")))
+                {
+                    size = prev > root ? prev - 1 : root;
+                    continue;
+                }
+            }
+            if(size > root)
+                out[size++] = '/';
+            MemoryCopy(out + size, segment.str, segment.size);
+            size += segment.size;
+        }
+        out[size] = 0;
+        return Str8(out, size);
+    }
+
+    String8 Str8ChopLastDot(String8 str)
+    {
+        for(uint64_t i = str.size; i > 0; i--)
+        {
+            if(str.str[i - 1] == '.')
+                return Prefix8(str, i - 1);
+        }
+        return str;
+    }
+
+    String8 Str8RemoveChars(Arena* arena, String8 str, String8 chars)
+    {
+        bool remove[256] = {};
+        for(uint64_t i = 0; i < chars.size; i++)
+            remove[chars.str[i]] = true;
+
+        uint8_t* out = PushArrayNoZero(arena, uint8_t, str.size + 1);
+        if(!out)
+            return {};
+        uint64_t size = 0;
+        for(uint64_t i = 0; i < str.size; i++)
+        {
+            if(!remove[str.str[i]])
+                out[size++] = str.str[i];
+        }
+        out[size] = 0;
+        return Str8(out, size);
+    }
+
     void Str8ListPushNode(String8List* list, String8Node* n)
     {
         QueuePush(list->first, list->last, n);
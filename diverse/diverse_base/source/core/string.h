@@ -1,6 +1,7 @@
 #pragma once
 #include "core/memory.h"
 #include <string>
+#include <cstdarg>
 namespace diverse
 {
     struct String8
@@ -106,6 +107,32 @@ namespace diverse
     String8List StrSplit8(Arena* arena, String8 string, uint64_t split_count, String8* splits);
     String8 Str8ListJoin(Arena* arena, String8List list, StringJoin* optional_params);
 
+    // Growable string on an arena, for building one string out of many pieces. It grows in place while it is the
+    // last thing pushed on the arena and moves to the top otherwise. The contents stay null terminated.
+    struct String8Builder
+    {
+        Arena* arena      = nullptr;
+        uint8_t* str      = nullptr;
+        uint64_t size     = 0;
+        uint64_t capacity = 0;
+        bool failed       = false; // the arena ran out of space, the string is truncated
+    };
+
+    String8Builder Str8BuilderBegin(Arena* arena, uint64_t reserve = 256);
+    void Str8BuilderAppend(String8Builder* builder, String8 str);
+    void Str8BuilderAppendChar(String8Builder* builder, uint8_t c);
+    void Str8BuilderAppendFV(String8Builder* builder, const char* fmt, va_list args);
+    void Str8BuilderAppendF(String8Builder* builder, const char* fmt, ...);
+    // Returns the string and gives the unused reserve back to the arena
+    String8 Str8BuilderEnd(String8Builder* builder);
+
+    // Paths, results are null terminated and use forward slashes
+    String8 Str8PathJoin(Arena* arena, String8 a, String8 b);
+    // Collapses repeated slashes and resolves "." and ".." segments, a leading "//" is kept
+    String8 Str8PathNormalize(Arena* arena, String8 path);
+    String8 Str8ChopLastDot(String8 str);
+    String8 Str8RemoveChars(Arena* arena, String8 str, String8 chars);
+
     String8 Substr8(String8 str, RangeU64 rng);
     String8 Str8Skip(String8 str, uint64_t min);
     String8 Str8Chop(String8 str, uint64_t nmax);
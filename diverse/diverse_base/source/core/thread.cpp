@@ -32,9 +32,27 @@ namespace diverse
         return &ThreadLocalContext;
     }
 
+    // Threads that never set a context (std::thread, pools outside the job system) get their scratch arenas on
+    // first use, released when the thread exits
+    struct LazyScratchArenas
+    {
+        Arena* arenas[2] = {};
+        ~LazyScratchArenas()
+        {
+            for(int i = 0; i < 2; i++)
+                ArenaRelease(arenas[i]);
+        }
+    };
+    PerThread LazyScratchArenas ThreadLocalLazyScratch;
+
     ArenaTemp ScratchBegin(Arena** conflicts, uint64_t conflict_count)
     {
         ThreadContext* tctx = GetThreadContext();
+        if(tctx->ScratchArenas[0] == nullptr)
+        {
+            for(int i = 0; i < 2; i++)
+                tctx->ScratchArenas[i] = ThreadLocalLazyScratch.arenas[i] = ArenaAlloc(Megabytes(1));
+        }
 
         ArenaTemp scratch = { 0 };
         for(uint32_t tctx_idx = 0; tctx_idx < 2; tctx_idx += 1)
@@ -1,6 +1,7 @@
 #include "sh_utils.h"
 #include <glm/gtx/matrix_decompose.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
 namespace diverse
 {
     const float kSqrt03_02  = std::sqrt(3.0f /  2.0f);
@@ -30,17 +31,6 @@ namespace diverse
     const float kSqrt01_18  = std::sqrt(1.0f / 18.0f);
     const float kSqrt01_60  = std::sqrt(1.0f / 60.0f);
 
-    auto dp(int n, int start,const std::vector<float>& a,const std::vector<float>& b)->float
-    {
-        float sum = 0;
-        for (int i = 0; i < n; i++)
-        {
-            sum += a[start + i] * b[i];
-        }
-        return sum;
-    }
-    static std::vector<float> coeffsIn(15);
-
     SHRotation::SHRotation(const glm::mat3& mat)
     {
         auto rot = glm::value_ptr(mat);
@@ -141,37 +131,59 @@ namespace diverse
                 kSqrt01_04 * ((sh1[2][2] * sh2[4][4] - sh1[2][0] * sh2[4][0]) - (sh1[0][2] * sh2[0][4] - sh1[0][0] * sh2[0][0]))
         }};
 
-        apply = [=](std::vector<float>& result, const std::vector<float>& src_p)->void{
-            auto src = src_p;
-            if (src.empty() || src == result) {
-                coeffsIn = result;
-                src = coeffsIn;
-            }
-            // band 1
-            if(result.size() < 3) return;
-            result[0] = dp(3, 0, src, sh1[0]);
-            result[1] = dp(3, 0, src, sh1[1]);
-            result[2] = dp(3, 0, src, sh1[2]);
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 3; c++)
+                band1[r * 3 + c] = sh1[r][c];
+        for (int r = 0; r < 5; r++)
+            for (int c = 0; c < 5; c++)
+                band2[r * 5 + c] = sh2[r][c];
+        for (int r = 0; r < 7; r++)
+            for (int c = 0; c < 7; c++)
+                band3[r * 7 + c] = sh3[r][c];
+    }
 
-            // band 2
-            if (result.size() < 8) return;
-            result[3] = dp(5, 3, src, sh2[0]);
-            result[4] = dp(5, 3, src, sh2[1]);
-            result[5] = dp(5, 3, src, sh2[2]);
-            result[6] = dp(5, 3, src, sh2[3]);
-            result[7] = dp(5, 3, src, sh2[4]);
+    auto SHRotation::rotate(float* coeffs, int num_coeffs, int stride) const -> void
+    {
+        float src[15];
+        const int n = std::min(num_coeffs, 15);
+        for (int i = 0; i < n; i++)
+            src[i] = coeffs[i * stride];
 
-            // band 3
-            if (result.size() < 15) {
-                return;
-            }
-            result[8] = dp(7, 8, src, sh3[0]);
-            result[9] = dp(7, 8, src, sh3[1]);
-            result[10] = dp(7, 8, src, sh3[2]);
-            result[11] = dp(7, 8, src, sh3[3]);
-            result[12] = dp(7, 8, src, sh3[4]);
-            result[13] = dp(7, 8, src, sh3[5]);
-            result[14] = dp(7, 8, src, sh3[6]);
-        };
+        // band 1
+        if (n < 3) return;
+        for (int r = 0; r < 3; r++)
+            coeffs[r * stride] = band1[r * 3 + 0] * src[0] + band1[r * 3 + 1] * src[1] + band1[r * 3 + 2] * src[2];
+
+        // band 2
+        if (n < 8) return;
+        for (int r = 0; r < 5; r++)
+        {
+            const float* row = &band2[r * 5];
+            float sum = 0;
+            for (int c = 0; c < 5; c++)
+                sum += row[c] * src[3 + c];
+            coeffs[(3 + r) * stride] = sum;
+        }
+
+        // band 3
+        if (n < 15) return;
+        for (int r = 0; r < 7; r++)
+        {
+            const float* row = &band3[r * 7];
+            float sum = 0;
+            for (int c = 0; c < 7; c++)
+                sum += row[c] * src[8 + c];
+            coeffs[(8 + r) * stride] = sum;
+        }
+    }
+
+    auto SHRotation::apply(std::vector<float>& result, const std::vector<float>& src) const -> void
+    {
+        if (!src.empty() && src.data() != result.data())
+        {
+            for (size_t i = 0; i < result.size() && i < src.size(); i++)
+                result[i] = src[i];
+        }
+        rotate(result.data(), (int)result.size(), 1);
     }
-}
\ No newline at end of file
+}
@@ -10,6 +10,14 @@ namespace diverse
     {
         SHRotation(const glm::mat3& mat);
 
-        std::function<void(std::vector<float>& result, const std::vector<float>& src)> apply;
+        // rotates the 15 higher-order coefficients of one color channel in place.
+        // coefficient i lives at coeffs[i * stride]; no allocation, safe to call from worker threads
+        auto rotate(float* coeffs, int num_coeffs = 15, int stride = 1) const -> void;
+
+        auto apply(std::vector<float>& result, const std::vector<float>& src = {}) const -> void;
+
+        std::array<float, 9>  band1;
+        std::array<float, 25> band2;
+        std::array<float, 49> band3;
     };
-}
\ No newline at end of file
+}
@@ -7,6 +7,8 @@
 #include "assets/gaussian_model.h"
 #include "assets/point_cloud.h"
 #include "core/reference.h"
+#include "core/memory_manager.h"
+#include "core/flat_hash_map.h"
 #include <mutex>
 #include <thread>
 #include <future>
@@ -28,7 +30,7 @@ namespace diverse
             bool onDisk = false;
         };
 
-        typedef std::unordered_map<IDType, Resource> MapType;
+        typedef FlatHashMap<IDType, Resource, StringHash> MapType;
 
         typedef std::function<bool(const IDType&, ResourceHandle&)> LoadFunc;
         typedef std::function<void(ResourceHandle&)> ReleaseFunc;
@@ -128,23 +130,12 @@ namespace diverse
         void update(const float elapsedSeconds)
         {
             std::lock_guard lock(lock_mutex);
-            typename MapType::iterator itr = name_resource_map.begin();
-
-            static IDType keysToDelete[256];
-            std::size_t keysToDeleteCount = 0;
-
-            for (auto&& [key, value] : name_resource_map)
+            for (auto itr = name_resource_map.begin(); itr != name_resource_map.end();)
             {
-                if (value.data.use_count() == 1 && expiration_time < (elapsedSeconds - itr->second.last_accessed))
-                {
-                    keysToDelete[keysToDeleteCount] = key;
-                    keysToDeleteCount++;
-                }
-            }
-
-            for (std::size_t i = 0; i < keysToDeleteCount; i++)
-            {
-                name_resource_map.erase(keysToDelete[i]);
+                if (itr->second.data.use_count() == 1 && expiration_time < (elapsedSeconds - itr->second.last_accessed))
+                    itr = name_resource_map.erase(itr);
+                else
+                    ++itr;
             }
         }
 
@@ -213,6 +204,7 @@ namespace diverse
                 auto load_texture = [&](const std::string& filePath, SharedPtr<asset::Texture>& texture) {
                     texture = createSharedPtr<asset::Texture>();
                     futures.emplace_back(std::async(std::launch::async, [filePath, texture]()->void {
+                        DS_MEMORY_TAG(Textures);
                         texture->init_from_path(filePath);
                     }));
                     return true;
@@ -233,6 +225,7 @@ namespace diverse
                 auto load_material = [&](const std::string& filePath, SharedPtr<Material>& material) {
                     material = createSharedPtr<Material>();
                     futures.emplace_back(std::async(std::launch::async, [filePath, material]()->void {
+                        DS_MEMORY_TAG(Assets);
                         material->load_material(filePath, filePath);
                         }));
                     return true;
@@ -249,6 +242,7 @@ namespace diverse
                     meshModel->set_primitive_type(PrimitiveType::File);
 
                     futures.emplace_back(std::async(std::launch::async, [filePath, meshModel]()->void {
+                        DS_MEMORY_TAG(Meshes);
                         meshModel->load_model(filePath);
                         }));
                     return true;
@@ -263,6 +257,7 @@ namespace diverse
                     meshModel = createSharedPtr<PointCloud>();
 
                     futures.emplace_back(std::async(std::launch::async, [filePath, meshModel]()->void {
+                        DS_MEMORY_TAG(Assets);
                         meshModel->load(filePath);
                     }));
                     return true;
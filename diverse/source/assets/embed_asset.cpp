@@ -3,6 +3,7 @@
 #include "utility/string_utils.h"
 #include "assets/texture.h"
 #include "core/ds_log.h"
+#include "core/thread.h"
 #include <iomanip>
 #include <sstream>
 #include <string_view>
@@ -31,6 +32,26 @@ namespace diverse
         DS_LOG_INFO("generate embed texture {} to {}", texFilePath, outPath);
     }
 
+    String8 embed_shader_name(Arena* arena, const std::string& shaderPath)
+    {
+        // same name as stripping the extension and then each of these characters (and whitespace) one by one
+        return Str8RemoveChars(arena, Str8ChopLastDot(Str8StdS(shaderPath)), Str8Lit("\\/._:+- \t\n\v\f\r"));
+    }
+
+    std::string strip_shader_cache_key(const std::string& cachePath)
+    {
+        constexpr size_t key_digits = 16;
+        const std::string_view ext = ".cached";
+        std::string_view path = cachePath;
+        if (!path.ends_with(ext) || path.size() < ext.size() + key_digits + 1)
+            return cachePath;
+        auto key = path.substr(path.size() - ext.size() - key_digits, key_digits);
+        if (path[path.size() - ext.size() - key_digits - 1] != '.' ||
+            key.find_first_not_of("0123456789abcdef") != std::string_view::npos)
+            return cachePath;
+        return std::string(path.substr(0, path.size() - ext.size() - key_digits - 1)) + std::string(ext);
+    }
+
     void embed_shader(const std::string& shaderPath, const std::string& outPath)
     {
         uint8_t* data = reinterpret_cast<uint8_t*>(FileSystem::read_file(shaderPath));
@@ -41,24 +62,18 @@ namespace diverse
             DS_LOG_WARN("Failed to load shader : {0}", shaderPath);
             return;
         }
-        auto shaderPath2 = shaderPath;
-        shaderPath2 = stringutility::back_slashes_2_slashes(shaderPath2);
-        auto shaderName = stringutility::remove_file_extension(shaderPath2);
-        shaderName = stringutility::remove_character(shaderName, '/');
-        shaderName = stringutility::remove_character(shaderName, '.');
-        shaderName = stringutility::remove_character(shaderName, '_');
-        shaderName = stringutility::remove_character(shaderName, ':');
-        shaderName = stringutility::remove_character(shaderName, '+');
-        shaderName = stringutility::remove_character(shaderName, '-');
+        ArenaTemp scratch = ScratchBegin(nullptr, 0);
+        auto shaderName = embed_shader_name(scratch.arena, shaderPath);
         std::ofstream file;
         file.open(outPath);
         file << "//Generated by diverse using " << shaderPath << std::endl;
-        file << "static const std::vector<uint8_t> spirv_" << shaderName << " = {" << (int)data[0];
+        file << "static const std::vector<uint8_t> spirv_" << (const char*)shaderName.str << " = {" << (int)data[0];
         for (size_t i = 1; i < size; ++i)
             file << "," << (int)data[i];
         file << "};\n";
-        file << "REGISTER_SHADER(" << shaderName<< ");";
+        file << "REGISTER_SHADER(" << (const char*)shaderName.str << ");";
         file.close();
+        ScratchEnd(scratch);
 
         DS_LOG_INFO("generate Shader {} to {}", shaderPath, outPath);
     }
@@ -3,10 +3,16 @@
 #include <vector>
 #include <assets/texture.h>
 #include <core/reference.h>
+#include <core/string.h>
 namespace diverse
 {
     void embed_texture(const std::string& texFilePath, const std::string& outPath, const std::string& arrayName);
     void embed_shader(const std::string& shaderPath, const std::string& outPath);
+    // Identifier the embedded spirv of a shader is registered under, the path without extension and separators
+    String8 embed_shader_name(Arena* arena, const std::string& shaderPath);
+    // Drops the content key of a shader cache file, <variant>.<16 hex key>.cached becomes <variant>.cached,
+    // the name DS_PRODUCTION builds look the embedded spirv up by
+    std::string strip_shader_cache_key(const std::string& cachePath);
     void dump_shader_with_append(const std::string& shaderPath, 
                                  const std::string& outPath, 
                                  const std::vector<uint8_t>& data);
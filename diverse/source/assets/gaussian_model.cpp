@@ -6,9 +6,13 @@
 #include "utility/file_utils.h"
 #include "utility/data_view.h"
 #include "utility/sh_utils.h"
+#include "splat_transform_bake.h"
 #include "core/ds_log.h"
 #include <tinygsplat/tiny_gsplat.hpp>
 #include "utility/thread_pool.h"
+#include "core/memory_manager.h"
+#include "core/thread.h"
+#include "core/string.h"
 namespace diverse
 {
 	auto sigmoid = [](const float v) {
@@ -49,7 +53,9 @@ namespace diverse
 						float* rots_d,
 						int num_gaussians)
 	{
+		DS_MEMORY_TAG(SplatData);
 		auto device = g_device;
+		auto lock = lock_data();
 		pos.resize(num_gaussians);
 		rot.resize(num_gaussians);
 		scales.resize(num_gaussians);
@@ -69,7 +75,9 @@ namespace diverse
 
 	void GaussianModel::update_from_pos_color(u8* pos_color_h,int num_gaussians)
 	{
+		DS_MEMORY_TAG(SplatData);
 		if(!pos_color_h) return;
+		auto lock = lock_data();
 		pos.resize(num_gaussians);
 		rot.resize(num_gaussians);
 		scales.resize(num_gaussians);
@@ -112,8 +120,100 @@ namespace diverse
 		return {featureDc, featureRest};
 	}
 
+	// position, rotation, scale, opacity and the base color, everything but the higher sh bands
+	static void pack_gaussian_color(const glm::vec3& pos,
+							const glm::vec4& rot,
+							const glm::vec3& scale,
+							f32 opacity,
+							const std::array<float, 3>& sh0,
+							Gaussian& gaussian,
+							PackedVertexColor& gs_color)
+	{
+		constexpr float SH_C0 = 0.28209479177387814f;
+		// copy position
+		gaussian.position.xyz = pos;
+		//normalize 
+		float length2 = 0;
+		for (int j = 0; j < 4; j++)
+			length2 += rot[j] * rot[j];
+		float length = sqrt(length2);
+		glm::vec4 rot_t;
+		for (int j = 0; j < 4; j++)
+			rot_t[j] = rot[j] / length;
+
+		auto rotation0 = glm::packHalf2x16(glm::vec2(rot_t[0], rot_t[1]));
+		auto rotation1 = glm::packHalf2x16(glm::vec2(rot_t[2], rot_t[3]));
+
+		glm::vec3 scale_t;
+		for (int j = 0; j < 3; j++)
+			scale_t[j] = exp(scale[j]);
+		auto scale0 = glm::packHalf2x16(glm::vec2(scale_t[0], scale_t[1]));
+		auto scale1 = glm::packHalf2x16(glm::vec2(scale_t[2], sigmoid(opacity)));
+
+		gaussian.rotation_scale = glm::uvec4(rotation0, rotation1, scale0, scale1);
+		const float r = (sh0[0] * SH_C0 + 0.5);
+		const float g = (sh0[1] * SH_C0 + 0.5);
+		const float b = (sh0[2] * SH_C0 + 0.5);
+		gs_color.x = glm::packHalf2x16(glm::vec2(r, g));
+		gs_color.y = glm::packHalf2x16(glm::vec2(b, 0));
+	}
+
+	static void pack_gaussian(const glm::vec3& pos,
+							const glm::vec4& rot,
+							const glm::vec3& scale,
+							f32 opacity,
+							const std::array<float, 3>& sh0,
+							const std::array<float, 45>& shn,
+							Gaussian& gaussian,
+							PackedVertexColor& gs_color,
+							PackedVertexSH& gs_sh)
+	{
+		pack_gaussian_color(pos, rot, scale, opacity, sh0, gaussian, gs_color);
+
+		// extract coefficients
+		std::array<float,45> c = shn;
+
+		// calc maximum value
+		auto max = c[0];
+		for (auto j = 1; j < 15 * 3; ++j) {
+			max = std::max(max, std::abs(c[j]));
+		}
+
+		// normalize
+		if( max != 0){
+			for (auto j = 0; j < 15 * 3; ++j)
+				c[j] = c[j] / max;
+		}
+		auto& sh1to3 = gs_sh.sh1to3;
+		sh1to3.x = *(u32*)(&max);
+		sh1to3.y = pack_unit_direction_11_10_11(glm::vec3(c[0],c[1],c[2]));
+		sh1to3.z = pack_unit_direction_11_10_11(glm::vec3(c[3],c[4],c[5]));
+		sh1to3.w = pack_unit_direction_11_10_11(glm::vec3(c[6],c[7],c[8]));
+
+		//sh > 1
+		auto& sh4to7 = gs_sh.sh4to7;
+		sh4to7.x = pack_unit_direction_11_10_11(glm::vec3(c[9],c[10],c[11]));
+		sh4to7.y = pack_unit_direction_11_10_11(glm::vec3(c[12],c[13],c[14]));
+		sh4to7.z = pack_unit_direction_11_10_11(glm::vec3(c[15],c[16],c[17]));
+		sh4to7.w = pack_unit_direction_11_10_11(glm::vec3(c[18],c[19],c[20]));
+
+		//sh > 2
+		auto& sh8to11 = gs_sh.sh8to11;
+		sh8to11.x = pack_unit_direction_11_10_11(glm::vec3(c[21],c[22],c[23]));
+		sh8to11.y = pack_unit_direction_11_10_11(glm::vec3(c[24],c[25],c[26]));
+		sh8to11.z = pack_unit_direction_11_10_11(glm::vec3(c[27],c[28],c[29]));
+		sh8to11.w = pack_unit_direction_11_10_11(glm::vec3(c[30],c[31],c[32]));
+
+		auto& sh12to15 = gs_sh.sh12to15;
+		sh12to15.x = pack_unit_direction_11_10_11(glm::vec3(c[33],c[34],c[35]));
+		sh12to15.y = pack_unit_direction_11_10_11(glm::vec3(c[36],c[37],c[38]));
+		sh12to15.z = pack_unit_direction_11_10_11(glm::vec3(c[39],c[40],c[41]));
+		sh12to15.w = pack_unit_direction_11_10_11(glm::vec3(c[42],c[43],c[44]));
+	}
+
 	void GaussianModel::create_gpu_buffer(bool compact)
 	{
+		state_delta_valid = false;
 		auto device = get_global_device();
 		const auto alignment = std::max<u64>(1, device->gpu_limits.minStorageBufferOffsetAlignment);
 		std::vector<Gaussian> gaussians(pos.size());
@@ -123,92 +223,8 @@ namespace diverse
 		splat_select_flag.resize(pos.size());
 		splat_transform_index.resize(pos.size());
 		
-        const u32 t11 = (1 << 11) - 1;
-        const u32 t10 = (1 << 10) - 1;
-		constexpr float SH_C0 = 0.28209479177387814f;
 		parallel_for<size_t>(0, gaussians.size(), [&](size_t k) {
-			glm::vec4 harmonics[16];
-
-			Gaussian& gaussian = gaussians[k];
-			glm::uvec2& gs_color = gaussians_sh_0[k];
-			// copy position
-			gaussian.position.xyz = pos[k];
-			//normalize 
-			float length2 = 0;
-			for (int j = 0; j < 4; j++)
-				length2 += rot[k][j] * rot[k][j];
-			float length = sqrt(length2);
-			glm::vec4 rot_t;
-			for (int j = 0; j < 4; j++)
-				rot_t[j] = rot[k][j] / length;
-
-			auto rotation0 = glm::packHalf2x16(glm::vec2(rot_t[0], rot_t[1]));
-			auto rotation1 = glm::packHalf2x16(glm::vec2(rot_t[2], rot_t[3]));
-
-			glm::vec3 scale_t;
-			for (int j = 0; j < 3; j++)
-				scale_t[j] = exp(scales[k][j]);
-			auto scale0 = glm::packHalf2x16(glm::vec2(scale_t[0], scale_t[1]));
-			auto scale1 = glm::packHalf2x16(glm::vec2(scale_t[2], sigmoid(opacities[k])));
-
-			gaussian.rotation_scale = glm::uvec4(rotation0, rotation1, scale0, scale1);
-			const float r = (shs_0[k][0] * SH_C0 + 0.5);
-            const float g = (shs_0[k][1] * SH_C0 + 0.5);
-            const float b = (shs_0[k][2] * SH_C0 + 0.5);
-			gs_color.x = glm::packHalf2x16(glm::vec2(r, g));
-			gs_color.y = glm::packHalf2x16(glm::vec2(b, 0));
-
-			// extract coefficients
-			std::array<float,45> c = {0};
-			for (auto j = 0; j < 15; ++j) {
-                c[j * 3] = shs_n[k][j * 3];
-                c[j * 3 + 1] = shs_n[k][j * 3 + 1];
-                c[j * 3 + 2] = shs_n[k][j * 3 + 2];
-            }
-
-            // calc maximum value
-            auto max = c[0];
-            for (auto j = 1; j < 15 * 3; ++j) {
-                max = std::max(max, std::abs(c[j]));
-            }
-
-            // normalize
-			if( max != 0){
-				for (auto j = 0; j < 15; ++j) {
-					c[j * 3 + 0] = (c[j * 3 + 0] / max);
-					c[j * 3 + 1] = (c[j * 3 + 1] / max);
-					c[j * 3 + 2] = (c[j * 3 + 2] / max);
-				}
-			}
-			auto& sh1to3 = gaussians_sh_n[k].sh1to3;
-			sh1to3.x = *(u32*)(&max);
-			sh1to3.y = pack_unit_direction_11_10_11(glm::vec3(c[0],c[1],c[2]));
-			sh1to3.z = pack_unit_direction_11_10_11(glm::vec3(c[3],c[4],c[5]));
-			sh1to3.w = pack_unit_direction_11_10_11(glm::vec3(c[6],c[7],c[8]));
-
-			//sh > 1
-            {
-				auto& sh4to7 = gaussians_sh_n[k].sh4to7;
-				sh4to7.x = pack_unit_direction_11_10_11(glm::vec3(c[9],c[10],c[11]));
-				sh4to7.y = pack_unit_direction_11_10_11(glm::vec3(c[12],c[13],c[14]));
-				sh4to7.z = pack_unit_direction_11_10_11(glm::vec3(c[15],c[16],c[17]));
-				sh4to7.w = pack_unit_direction_11_10_11(glm::vec3(c[18],c[19],c[20]));
-
-				//sh > 2
-                {
-					auto& sh8to11 = gaussians_sh_n[k].sh8to11;
-					sh8to11.x = pack_unit_direction_11_10_11(glm::vec3(c[21],c[22],c[23]));
-					sh8to11.y = pack_unit_direction_11_10_11(glm::vec3(c[24],c[25],c[26]));
-					sh8to11.z = pack_unit_direction_11_10_11(glm::vec3(c[27],c[28],c[29]));
-					sh8to11.w = pack_unit_direction_11_10_11(glm::vec3(c[30],c[31],c[32]));
-
-					auto& sh12to15 = gaussians_sh_n[k].sh12to15;
-					sh12to15.x = pack_unit_direction_11_10_11(glm::vec3(c[33],c[34],c[35]));
-					sh12to15.y = pack_unit_direction_11_10_11(glm::vec3(c[36],c[37],c[38]));
-					sh12to15.z = pack_unit_direction_11_10_11(glm::vec3(c[39],c[40],c[41]));
-					sh12to15.w = pack_unit_direction_11_10_11(glm::vec3(c[42],c[43],c[44]));
-                }
-            }
+			pack_gaussian(pos[k], rot[k], scales[k], opacities[k], shs_0[k], shs_n[k], gaussians[k], gaussians_sh_0[k], gaussians_sh_n[k]);
 		});
 		if (gaussians_buf && gaussians_buf->desc.size >= (gaussians.size() * sizeof(Gaussian)))
 		{
@@ -254,6 +270,7 @@ namespace diverse
 			points_key_buf = device->create_buffer(rhi::GpuBufferDesc::new_gpu_only(num_gaussians * sizeof(u32), rhi::BufferUsageFlags::STORAGE_BUFFER | rhi::BufferUsageFlags::TRANSFER_DST), "points_key_buf", nullptr);
 			points_value_buf = device->create_buffer(rhi::GpuBufferDesc::new_gpu_only(num_gaussians * sizeof(u32), rhi::BufferUsageFlags::STORAGE_BUFFER | rhi::BufferUsageFlags::TRANSFER_DST), "points_value_buf", nullptr);
 			gaussian_state_buf = device->create_buffer(rhi::GpuBufferDesc::new_cpu_to_gpu(num_gaussians * sizeof(u32), rhi::BufferUsageFlags::STORAGE_BUFFER | rhi::BufferUsageFlags::VERTEX_BUFFER | rhi::BufferUsageFlags::TRANSFER_DST), "gaussian_state_buf", nullptr);
+			gpu_buffer_version++;
 
 			{
 				auto data = reinterpret_cast<Gaussian*>(gaussians_buf->map(device));
@@ -299,11 +316,125 @@ namespace diverse
 		local_bounding_box = maths::BoundingBox(minn,maxx);
 		set_flag(AssetFlag::Loaded);
 		create_gpu_buffer();
+		data_revision++;
 		update_state();
 	}
 
+	void GaussianModel::reserve_splats(size_t num_splats)
+	{
+		DS_MEMORY_TAG(SplatData);
+		if (num_splats <= pos.capacity()) return;
+		// grow geometrically so repeated appends stay amortized O(1) per splat
+		const auto capacity = std::max<size_t>(num_splats, pos.capacity() * 2);
+		pos.reserve(capacity);
+		shs_0.reserve(capacity);
+		shs_n.reserve(capacity);
+		opacities.reserve(capacity);
+		scales.reserve(capacity);
+		rot.reserve(capacity);
+		splat_state.reserve(capacity);
+		splat_select_flag.reserve(capacity);
+		splat_transform_index.reserve(capacity);
+	}
+
+	auto GaussianModel::gpu_capacity() const -> u64
+	{
+		if (!gaussians_buf) return 0;
+		return gaussians_buf->desc.size / sizeof(Gaussian);
+	}
+
+	void GaussianModel::grow_gpu_buffer(size_t num_splats, size_t old_size)
+	{
+		auto device = get_global_device();
+		const auto capacity = std::max<u64>(num_splats, gpu_capacity() * 2);
+		auto new_gaussians_buf = device->create_buffer(rhi::GpuBufferDesc::new_cpu_to_gpu(capacity * sizeof(Gaussian), rhi::BufferUsageFlags::STORAGE_BUFFER | rhi::BufferUsageFlags::VERTEX_BUFFER | rhi::BufferUsageFlags::TRANSFER_DST), "gaussian_buf", nullptr);
+		auto new_sh_0_buf = device->create_buffer(rhi::GpuBufferDesc::new_cpu_to_gpu(capacity * sizeof(PackedVertexColor), rhi::BufferUsageFlags::STORAGE_BUFFER | rhi::BufferUsageFlags::VERTEX_BUFFER | rhi::BufferUsageFlags::TRANSFER_DST), "gaussian_sh_0_buf", nullptr);
+		auto new_sh_n_buf = device->create_buffer(rhi::GpuBufferDesc::new_cpu_to_gpu(capacity * sizeof(PackedVertexSH), rhi::BufferUsageFlags::STORAGE_BUFFER | rhi::BufferUsageFlags::VERTEX_BUFFER | rhi::BufferUsageFlags::TRANSFER_DST), "gaussian_sh_n_buf", nullptr);
+		auto new_state_buf = device->create_buffer(rhi::GpuBufferDesc::new_cpu_to_gpu(capacity * sizeof(u32), rhi::BufferUsageFlags::STORAGE_BUFFER | rhi::BufferUsageFlags::VERTEX_BUFFER | rhi::BufferUsageFlags::TRANSFER_DST), "gaussian_state_buf", nullptr);
+
+		// the old buffers are host visible, carry the packed head over instead of repacking it
+		auto carry_over = [&](std::shared_ptr<rhi::GpuBuffer>& old_buf, const std::shared_ptr<rhi::GpuBuffer>& new_buf, size_t stride) {
+			if (old_size > 0)
+			{
+				auto src = old_buf->map(device);
+				new_buf->copy_from(device, src, old_size * stride, 0);
+				old_buf->unmap(device);
+			}
+			old_buf = new_buf;
+		};
+		carry_over(gaussians_buf, new_gaussians_buf, sizeof(Gaussian));
+		carry_over(gaussians_sh_0_buf, new_sh_0_buf, sizeof(PackedVertexColor));
+		carry_over(gaussians_sh_n_buf, new_sh_n_buf, sizeof(PackedVertexSH));
+		carry_over(gaussian_state_buf, new_state_buf, sizeof(u32));
+
+		points_key_buf = device->create_buffer(rhi::GpuBufferDesc::new_gpu_only(capacity * sizeof(u32), rhi::BufferUsageFlags::STORAGE_BUFFER | rhi::BufferUsageFlags::TRANSFER_DST), "points_key_buf", nullptr);
+		points_value_buf = device->create_buffer(rhi::GpuBufferDesc::new_gpu_only(capacity * sizeof(u32), rhi::BufferUsageFlags::STORAGE_BUFFER | rhi::BufferUsageFlags::TRANSFER_DST), "points_value_buf", nullptr);
+		gpu_buffer_version++;
+	}
+
+	void GaussianModel::append_data(size_t old_size)
+	{
+		state_delta_valid = false;
+		const auto num_splats = pos.size();
+		if (!gaussians_buf || old_size == 0)
+		{
+			update_data();
+			return;
+		}
+		if (num_splats <= old_size) return;
+		splat_state.resize(num_splats);
+		splat_select_flag.resize(num_splats);
+		splat_transform_index.resize(num_splats);
+
+		glm::vec3 minn = local_bounding_box.min();
+		glm::vec3 maxx = local_bounding_box.max();
+		for (auto i = old_size; i < num_splats; i++)
+		{
+			maxx = glm::max(maxx, pos[i]);
+			minn = glm::min(minn, pos[i]);
+		}
+		local_bounding_box = maths::BoundingBox(minn, maxx);
+
+		if (gpu_capacity() < num_splats)
+			grow_gpu_buffer(num_splats, old_size);
+
+		// only pack and upload the appended tail
+		const auto num_append = num_splats - old_size;
+		std::vector<Gaussian> gaussians(num_append);
+		std::vector<PackedVertexColor>	gaussians_sh_0(num_append);
+		std::vector<PackedVertexSH>	gaussians_sh_n(num_append);
+		std::vector<u32>	states(num_append);
+		parallel_for<size_t>(0, num_append, [&](size_t i) {
+			auto k = i + old_size;
+			pack_gaussian(pos[k], rot[k], scales[k], opacities[k], shs_0[k], shs_n[k], gaussians[i], gaussians_sh_0[i], gaussians_sh_n[i]);
+			uint state = setOpState(0, splat_state[k]);
+			states[i] = setTransformIndex(state, splat_transform_index[k]);
+		});
+		auto device = get_global_device();
+		gaussians_buf->copy_from(device, (const u8*)gaussians.data(), num_append * sizeof(Gaussian), old_size * sizeof(Gaussian));
+		gaussians_sh_0_buf->copy_from(device, (const u8*)gaussians_sh_0.data(), num_append * sizeof(PackedVertexColor), old_size * sizeof(PackedVertexColor));
+		gaussians_sh_n_buf->copy_from(device, (const u8*)gaussians_sh_n.data(), num_append * sizeof(PackedVertexSH), old_size * sizeof(PackedVertexSH));
+		gaussian_state_buf->copy_from(device, (const u8*)states.data(), num_append * sizeof(u32), old_size * sizeof(u32));
+
+		for (auto i = old_size; i < num_splats; i++)
+		{
+			auto state = splat_state[i];
+			if (state & DELETE_STATE)
+				num_delete++;
+			else if (state & SELECT_STATE)
+				num_select++;
+			else if (state & HIDE_STATE)
+				num_hidden++;
+		}
+		data_revision++;
+		state_revision++;
+		make_selection_bound_dirty();
+	}
+
 	void GaussianModel::update_state()
 	{
+		state_revision++;
+		state_delta_valid = false;
 		num_hidden = 0;
 		num_select = 0;
 		num_delete = 0;
@@ -350,10 +481,28 @@ namespace diverse
 			data[i].xy = glm::vec2(hom0, hom1);
 		});
 		gaussians_sh_0_buf->unmap(device);
+		data_revision++;
+	}
+
+	void GaussianModel::update_color_data()
+	{
+		if (!gaussians_buf) return;
+		auto lock = lock_data();
+		// sh0 and opacity only, the sh_n buffer is left untouched
+		std::vector<Gaussian> gaussians(pos.size());
+		std::vector<PackedVertexColor> gaussians_sh_0(pos.size());
+		parallel_for<size_t>(0, pos.size(), [&](size_t k) {
+			pack_gaussian_color(pos[k], rot[k], scales[k], opacities[k], shs_0[k], gaussians[k], gaussians_sh_0[k]);
+		});
+		auto device = get_global_device();
+		gaussians_buf->copy_from(device, (const u8*)gaussians.data(), gaussians.size() * sizeof(Gaussian), 0);
+		gaussians_sh_0_buf->copy_from(device, (const u8*)gaussians_sh_0.data(), gaussians_sh_0.size() * sizeof(PackedVertexColor), 0);
+		data_revision++;
 	}
 
 	void GaussianModel::update_transform_index()
 	{
+		state_delta_valid = false;
 		if (gaussians_buf)
 		{
 			auto device = get_global_device();
@@ -376,46 +525,7 @@ namespace diverse
 		std::vector<glm::vec3>      new_scales;
 		std::vector<glm::vec4>      new_rot;
 		std::vector<u8> 			new_degrees;
-		for (int k = 0; k < pos.size(); k++)
-		{
-			auto state = splat_state[k];
-			if (state & DELETE_STATE)
-				continue;
-			
-			auto transform_index = splat_transform_index[k];
-			auto transform = splat_transforms.get_transform(transform_index);
-			auto q = glm::toQuat(transform);
-			if(apply_transfom)
-			{ 
-				new_pos.push_back(transform * glm::vec4(pos[k],1.0f));
-				auto r = rot[k];
-				auto new_r = glm::quat(r.x, r.y, r.z, r.w) * q;
-				new_rot.push_back(glm::vec4(new_r.w,new_r.x, new_r.y, new_r.z));
-			}
-			else
-			{
-				new_pos.push_back(pos[k]);
-				new_rot.push_back(rot[k]);
-			}
-			new_scales.push_back(scales[k]);
-			new_opacities.push_back(opacities[k]);
-			new_shs_0.push_back(shs_0[k]);
-			new_shs_n.push_back(shs_n[k]);
-			if (apply_transfom)
-			{ 
-				glm::mat3 tmpMat3 = glm::toMat3(q);
-				SHRotation shRot(tmpMat3);
-				for (auto c = 0; c < 3; c++)
-				{
-					std::vector<f32> tmpSHData(15);
-					for (auto j = 0; j < 15; j++)
-						tmpSHData[j] = shs_n[k][c * 15 + j];
-					shRot.apply(tmpSHData, {});
-					for (auto j = 0; j < 15; j++)
-						new_shs_n.back()[c * 15 + j] = tmpSHData[j];
-				}
-			}
-		}
+		gather_alive_splats(apply_transfom, new_pos, new_shs_0, new_shs_n, new_opacities, new_scales, new_rot);
 		if( new_pos.size() == 0 ) 
 		{
 			DS_LOG_ERROR("this gaussian model is an empty model");
@@ -471,6 +581,7 @@ namespace diverse
 
 	auto GaussianModel::load_model(const std::string& filePath)->void
 	{
+		DS_MEMORY_TAG(SplatData);
 		bool load_ret = false;
 		std::vector<tinygsplat::RichPoint> points;
 		auto ext = std::filesystem::path(filePath).extension().string();
@@ -516,6 +627,7 @@ namespace diverse
 			return;
 		}
 		auto numSplats = points.size();
+		auto lock = lock_data();
 		// Resize our SoA data
 		pos.resize(numSplats);
 		shs_0.resize(numSplats);
@@ -586,11 +698,14 @@ namespace diverse
 		});
 		set_flag(AssetFlag::Loaded);
 		create_gpu_buffer(true);
+		data_revision++;
 	}
 
 	void GaussianModel::export_to_cpu()
 	{
+		DS_MEMORY_TAG(SplatData);
 		auto device = get_global_device();
+		auto lock = lock_data();
 
 		std::vector<glm::vec3>	new_pos;
 		std::vector<std::array<float, 3>>        new_shs_0;
@@ -628,17 +743,77 @@ namespace diverse
 		update_data();
 	}
 
+	auto GaussianModel::state_delta_buffer() -> std::shared_ptr<rhi::GpuBuffer>
+	{
+		if (!state_delta_buf)
+		{
+			auto device = get_global_device();
+			state_delta_buf = device->create_buffer(rhi::GpuBufferDesc::new_gpu_to_cpu(16 + STATE_DELTA_CAPACITY * sizeof(glm::uvec2), rhi::BufferUsageFlags::STORAGE_BUFFER | rhi::BufferUsageFlags::TRANSFER_DST), "gaussian_state_delta_buf", nullptr);
+			const u32 zero = 0;
+			state_delta_buf->copy_from(device, (const u8*)&zero, sizeof(u32), 0);
+			state_delta_valid = false;
+			state_delta_reset_pending = false;
+		}
+		return state_delta_buf;
+	}
+
 	void GaussianModel::download_state_buffer()
 	{
 		auto device = get_global_device();
+		auto lock = lock_data();
+		u32 num_changed = ~0u;
+		if (state_delta_buf)
+		{
+			// consumed by the last readback and no intersect pass ran since, nothing new to apply
+			if (state_delta_valid && state_delta_reset_pending)
+				return;
+			// the intersect graph is executed synchronously, its submission fence signalled before we get here
+			auto delta_data = reinterpret_cast<u32*>(state_delta_buf->map(device));
+			num_changed = delta_data[0];
+			// only the changes since the last readback are applied, unless the cpu copy is stale or the list overflowed
+			if (state_delta_valid && num_changed <= STATE_DELTA_CAPACITY)
+			{
+				auto changes = reinterpret_cast<const glm::uvec2*>(delta_data + 4);
+				for (u32 i = 0; i < num_changed; i++)
+				{
+					const auto idx = changes[i].x;
+					const auto state = changes[i].y;
+					if (idx >= pos.size()) continue;
+					const auto op_flag = getOpFlag(state);
+					if (op_flag && !splat_select_flag[idx])
+						flagged_indices.push_back(idx);
+					splat_state[idx] = getOpState(state);
+					splat_select_flag[idx] = op_flag;
+					splat_transform_index[idx] = getTransformIndex(state);
+				}
+				// a splat flipped on, off and on again within one readback is listed twice
+				std::erase_if(flagged_indices, [&](u32 idx) { return idx >= pos.size() || !splat_select_flag[idx]; });
+				std::sort(flagged_indices.begin(), flagged_indices.end());
+				flagged_indices.erase(std::unique(flagged_indices.begin(), flagged_indices.end()), flagged_indices.end());
+			}
+			// the counter is cleared on the gpu ahead of the next intersect dispatch, a cpu write could race
+			// with appends of a submission still in flight
+			state_delta_reset_pending = true;
+			state_delta_buf->unmap(device);
+			if (state_delta_valid && num_changed <= STATE_DELTA_CAPACITY)
+				return;
+		}
+
 		std::vector<u32> states_data(pos.size());
 		gaussian_state_buf->copy_to(device, (u8*)states_data.data(), states_data.size() * sizeof(u32), 0);
 		parallel_for<size_t>(0, pos.size(), [&](size_t i) {
-            auto state = states_data[i];
+			auto state = states_data[i];
 			splat_state[i] = getOpState(state);
-            splat_select_flag[i] = getOpFlag(state);
+			splat_select_flag[i] = getOpFlag(state);
 			splat_transform_index[i] = getTransformIndex(state);
 		});
+		flagged_indices.clear();
+		for (u32 i = 0; i < splat_select_flag.size(); i++)
+		{
+			if (splat_select_flag[i])
+				flagged_indices.push_back(i);
+		}
+		state_delta_valid = state_delta_buf != nullptr;
 	}
 
 	u64 GaussianModel::get_num_gaussians() const
@@ -650,11 +825,14 @@ namespace diverse
 
 	auto GaussianModel::merge(GaussianModel* model, bool apply_transform)->void
 	{
+		DS_MEMORY_TAG(SplatData);
 		const auto old_size = pos.size();
 		if( model )
 		{
+			auto lock = lock_data();
 			const auto molde_num_splats = model->position().size();
 			const auto num_size = molde_num_splats + old_size;
+			reserve_splats(num_size);
 			pos.resize(num_size);
 			scales.resize(num_size);
 			rot.resize(num_size);
@@ -675,42 +853,31 @@ namespace diverse
 				splat_state[idx] = model->splat_state[i];
 				splat_select_flag[idx] = model->splat_select_flag[i];
 				splat_transform_index[idx] = model->splat_transform_index[i];
-				if(apply_transform)
-				{
-					auto transform_index = splat_transform_index[idx];
-					glm::mat4 transform = glm::transpose(splat_transforms[transform_index]);
-					pos[idx] = transform * glm::vec4(pos[idx],1.0f);
-					auto q = glm::toQuat(transform);
-					auto r = rot[idx];auto new_r = glm::quat(r.x, r.y, r.z, r.w) * q;
-					rot[idx] = glm::vec4(new_r.w, new_r.x, new_r.y, new_r.z);
-
-					glm::mat3 tmpMat3 = glm::toMat3(q);
-					SHRotation shRot(tmpMat3);
-					for(auto c = 0;c<3;c++)
-					{
-						std::vector<f32> tmpSHData(15);
-						for (auto j = 0; j < 15; j++)
-							tmpSHData[j] = shs_n[idx][c * 15 + j];
-						shRot.apply(tmpSHData, {});
-						for (auto j = 0; j < 15; j++)
-							shs_n[idx][c* 15 + j] = tmpSHData[j];
-					}
-				}
 			});
+			if (apply_transform)
+			{
+				std::vector<u32> ids(molde_num_splats);
+				for (size_t i = 0; i < molde_num_splats; i++)
+					ids[i] = u32(i + old_size);
+				bake_transforms(ids, old_size);
+			}
 			mip_antialiased = model->mip_antialiased;
-			update_data();
+			append_data(old_size);
 		}
 	}
 
 	auto GaussianModel::merge(GaussianModel* model,const std::vector<u32>& indices, bool apply_transform)->std::vector<u32>
 	{
+		DS_MEMORY_TAG(SplatData);
 		std::vector<u32> add_indices;
 		if(indices.empty()) return add_indices;
 		const auto old_size = pos.size();
 		if (model)
 		{
+			auto lock = lock_data();
 			const auto num_splats = indices.size();
 			const auto num_size = num_splats + old_size;
+			reserve_splats(num_size);
 			pos.resize(num_size);
 			scales.resize(num_size);
 			rot.resize(num_size);
@@ -733,40 +900,103 @@ namespace diverse
 				splat_state[idx] = model->splat_state[model_splat_id];
 				splat_select_flag[idx] = model->splat_select_flag[model_splat_id];
 				splat_transform_index[idx] = model->splat_transform_index[model_splat_id];
-				if (apply_transform)
-				{
-					auto transform_index = splat_transform_index[idx];
-					glm::mat4 transform = glm::transpose(splat_transforms[transform_index]);
-					pos[idx] = transform * glm::vec4(pos[idx], 1.0f);
-					auto q = glm::toQuat(transform);
-					auto r = rot[idx]; auto new_r = glm::quat(r.x, r.y, r.z, r.w) * q;
-					rot[idx] = glm::vec4(new_r.w, new_r.x, new_r.y, new_r.z);
-					glm::mat3 tmpMat3 = glm::toMat3(q);
-					SHRotation shRot(tmpMat3);
-					for (auto c = 0; c < 3; c++)
-					{
-						std::vector<f32> tmpSHData(15);
-						for (auto j = 0; j < 15; j++)
-							tmpSHData[j] = shs_n[idx][c * 15 + j];
-						shRot.apply(tmpSHData, {});
-						for (auto j = 0; j < 15; j++)
-							shs_n[idx][c * 15 + j] = tmpSHData[j];
-					}
-				}
 				add_indices[i] = idx;
 			});
+			if (apply_transform)
+				bake_transforms(add_indices, old_size);
 			mip_antialiased = model->mip_antialiased;
-			update_data();
+			append_data(old_size);
 		}
 		return add_indices;
 	}
 
+	auto GaussianModel::bake_transforms(const std::vector<u32>& ids, size_t first) -> void
+	{
+		// ids are the contiguous tail [first, first + ids.size()), baked in place
+		SplatTransformBake baker(splat_transforms);
+		baker.bake(splat_transform_index.data(), ids.data(), ids.size(),
+			pos.data(), rot.data(), shs_n.data(),
+			pos.data() + first, rot.data() + first, shs_n.data() + first);
+	}
+
+	auto GaussianModel::gather_alive_splats(bool apply_transform,
+		std::vector<glm::vec3>& out_pos,
+		std::vector<std::array<float, 3>>& out_shs_0,
+		std::vector<std::array<float, 45>>& out_shs_n,
+		std::vector<float>& out_opacities,
+		std::vector<glm::vec3>& out_scales,
+		std::vector<glm::vec4>& out_rot) -> void
+	{
+		std::vector<u32> ids;
+		ids.reserve(pos.size());
+		for (u32 k = 0; k < pos.size(); k++)
+		{
+			if (!(splat_state[k] & DELETE_STATE))
+				ids.push_back(k);
+		}
+		const auto num_splats = ids.size();
+		out_pos.resize(num_splats);
+		out_shs_0.resize(num_splats);
+		out_shs_n.resize(num_splats);
+		out_opacities.resize(num_splats);
+		out_scales.resize(num_splats);
+		out_rot.resize(num_splats);
+		parallel_for<size_t>(0, num_splats, [&](size_t i) {
+			auto k = ids[i];
+			out_shs_0[i] = shs_0[k];
+			out_opacities[i] = opacities[k];
+			out_scales[i] = scales[k];
+			if (!apply_transform)
+			{
+				out_pos[i] = pos[k];
+				out_rot[i] = rot[k];
+				out_shs_n[i] = shs_n[k];
+			}
+		});
+		if (apply_transform)
+		{
+			SplatTransformBake baker(splat_transforms);
+			baker.bake(splat_transform_index.data(), ids.data(), num_splats,
+				pos.data(), rot.data(), shs_n.data(),
+				out_pos.data(), out_rot.data(), out_shs_n.data());
+		}
+	}
+
 	auto GaussianModel::remove(const std::vector<u32>& indices)->void
 	{
+		DS_MEMORY_TAG(SplatData);
 		if(indices.empty()) return;
 
+		auto lock = lock_data();
 		const auto old_size = pos.size();
 		const auto new_size = pos.size()- indices.size();
+		// undoing an append (e.g. duplicate) removes exactly the tail, the gpu buffers keep their capacity
+		bool is_tail = indices.size() <= old_size;
+		for (auto i = 0; is_tail && i < indices.size(); i++)
+			is_tail = indices[i] == new_size + i;
+		if (is_tail)
+		{
+			pos.resize(new_size);
+			scales.resize(new_size);
+			rot.resize(new_size);
+			shs_0.resize(new_size);
+			shs_n.resize(new_size);
+			opacities.resize(new_size);
+			splat_state.resize(new_size);
+			splat_transform_index.resize(new_size);
+			splat_select_flag.resize(new_size);
+			glm::vec3 minn(FLT_MAX, FLT_MAX, FLT_MAX);
+			glm::vec3 maxx = -minn;
+			for (int i = 0; i < pos.size(); i++)
+			{
+				maxx = glm::max(maxx, pos[i]);
+				minn = glm::min(minn, pos[i]);
+			}
+			local_bounding_box = maths::BoundingBox(minn, maxx);
+			data_revision++;
+			update_state();
+			return;
+		}
 		std::vector<glm::vec3>	new_pos;
 		std::vector<std::array<float, 3>>        new_shs_0;
 		std::vector<std::array<float, 45>>        new_shs_n;
@@ -812,39 +1042,7 @@ namespace diverse
 		std::vector<glm::vec3>      new_scales;
 		std::vector<glm::vec4>      new_rot;
 
-		for (int k = 0; k < pos.size(); k++)
-		{
-			auto state = splat_state[k];
-			if (state & DELETE_STATE)
-				continue;
-			new_pos.push_back(pos[k]);
-			new_scales.push_back(scales[k]);
-			new_rot.push_back(rot[k]);
-			new_opacities.push_back(opacities[k]);
-			new_shs_0.push_back(shs_0[k]);	
-			new_shs_n.push_back(shs_n[k]);	
-			if (apply_transform)
-			{
-				auto transform_index = splat_transform_index[k];
-				glm::mat4 transform = glm::transpose(splat_transforms[transform_index]);
-				new_pos.back() = transform * glm::vec4(pos[k], 1.0f);
-				auto q = glm::toQuat(transform);
-				auto r = rot[k]; auto new_r = glm::quat(r.x, r.y, r.z, r.w) * q;
-				new_rot.back() = glm::vec4(new_r.w, new_r.x, new_r.y, new_r.z);
-
-				glm::mat3 tmpMat3 = glm::toMat3(q);
-				SHRotation shRot(tmpMat3);
-				for (auto c = 0; c < 3; c++)
-				{
-					std::vector<f32> tmpSHData(15);
-					for (auto j = 0; j < 15; j++)
-						tmpSHData[j] = shs_n[k][c * 15 + j];
-					shRot.apply(tmpSHData, {});
-					for (auto j = 0; j < 15; j++)
-						new_shs_n.back()[c * 15 + j] = tmpSHData[j];
-				}
-			}
-		}
+		gather_alive_splats(apply_transform, new_pos, new_shs_0, new_shs_n, new_opacities, new_scales, new_rot);
 		if (new_pos.size() == 0)
 		{
 			DS_LOG_ERROR("this gaussian model is an empty model");
@@ -878,24 +1076,28 @@ namespace diverse
 		std::sort(mapp.begin(), mapp.end(), sorter);
 		for (auto i = 0; i < numSplats; i++)
 			indices[i] = mapp[i].second;
-		const std::string chunkProps[12] = { "min_x", "min_y", "min_z", "max_x", "max_y", "max_z", "min_scale_x", "min_scale_y", "min_scale_z", "max_scale_x", "max_scale_y", "max_scale_z" };
-		const std::string vertexProps[4] = { "packed_position", "packed_rotation", "packed_scale", "packed_color" };
+		const char* const chunkProps[12] = { "min_x", "min_y", "min_z", "max_x", "max_y", "max_z", "min_scale_x", "min_scale_y", "min_scale_z", "max_scale_x", "max_scale_y", "max_scale_z" };
+		const char* const vertexProps[4] = { "packed_position", "packed_rotation", "packed_scale", "packed_color" };
 
-		std::string header_text = std::format("ply\nformat binary_little_endian 1.0\ncomment generated by splatx\nelement chunk {}\n",numChunks);
+		ArenaTemp scratch = ScratchBegin(nullptr, 0);
+		String8Builder header = Str8BuilderBegin(scratch.arena, 1024);
+		Str8BuilderAppendF(&header, "ply\nformat binary_little_endian 1.0\ncomment generated by splatx\nelement chunk %llu\n", (unsigned long long)numChunks);
 		if (mip_antialiased) {
-			header_text += "comment splatx.anti_aliasing=1\n";
+			Str8BuilderAppend(&header, Str8Lit("comment splatx.anti_aliasing=1\n"));
 		}
 		for(auto i=0;i<12;i++){
-			header_text += std::format("property float {}\n",chunkProps[i]);
+			Str8BuilderAppendF(&header, "property float %s\n", chunkProps[i]);
 		}
-		header_text += std::format("element vertex {}\n",numSplats);
+		Str8BuilderAppendF(&header, "element vertex %llu\n", (unsigned long long)numSplats);
 		for(auto i=0;i<4;i++){
-			header_text += std::format("property uint {}\n",vertexProps[i]);
+			Str8BuilderAppendF(&header, "property uint %s\n", vertexProps[i]);
 		}
-		header_text += "end_header\n";
-		size_t header_size = header_text.length();
+		Str8BuilderAppend(&header, Str8Lit("end_header\n"));
+		String8 header_text = Str8BuilderEnd(&header);
+		size_t header_size = header_text.size;
 		std::vector<u8> serilizeData(header_size + numChunks * 4 * 12 + numSplats * 4 * 4);
-		memcpy(serilizeData.data(),header_text.c_str(),header_size);
+		memcpy(serilizeData.data(),header_text.str,header_size);
+		ScratchEnd(scratch);
 		tinygsplat::DataView dataView(numChunks * 4 * 12 + numSplats * 4 * 4);
 
 		std::vector<std::array<float, 48>> new_shs(numSplats);
@@ -5,6 +5,8 @@
 #include "splat_transform_palette.h"
 #include <glm/gtx/quaternion.hpp>
 #include <array>
+#include <mutex>
+#include <utility>
 
 #define NORMAL_STATE    0
 #define SELECT_STATE    1
@@ -81,6 +83,7 @@ namespace diverse
                                 int num_gaussians);
         void    update_from_pos_color(u8* pos_color,int num_gaussians);
         void    update_feature_dc_data(const std::vector<u32>& indices);
+        void    update_color_data();
         void    update_state();
         void    update_transform_index();
         void    save_to_file(const std::string& filepath, bool apply_transfom = false);
@@ -113,10 +116,37 @@ namespace diverse
         auto    num_hidden_gaussians() ->u32 {return num_hidden;}
         auto    num_delete_gaussians() -> u32 { return num_delete; }
         auto    antialiased() -> bool& { return mip_antialiased; }
+        auto    gpu_capacity() const -> u64;
+        //held while the SoA vectors or the state column are written, lets background readers (statistics) copy them safely
+        auto    lock_data() -> std::unique_lock<std::mutex> { return std::unique_lock<std::mutex>(data_mutex); }
+        auto    get_data_revision() const -> u32 { return data_revision; }
+        auto    get_state_revision() const -> u32 { return state_revision; }
+        //changed-state list written by the intersect pass: u32 count at offset 0, then (index, state) pairs from offset 16
+        auto    state_delta_buffer() -> std::shared_ptr<rhi::GpuBuffer>;
+        //gpu passes that rewrite the state words outside of the intersect pass must call this, the next readback is a full copy
+        auto    invalidate_state_delta() -> void { state_delta_valid = false; }
+        //true once after a readback consumed the changed-state list, the next intersect pass clears the counter before appending
+        auto    take_state_delta_reset() -> bool { return std::exchange(state_delta_reset_pending, false); }
+        //indices with the op flag set, kept in sync by download_state_buffer
+        auto    flagged_splats() const -> const std::vector<u32>& { return flagged_indices; }
+        static constexpr u32 STATE_DELTA_CAPACITY = 1 << 18;
         SET_ASSET_TYPE(AssetType::Splat);
     protected:
         void    update_data();
+        void    append_data(size_t old_size);
+        void    reserve_splats(size_t num_splats);
+        void    grow_gpu_buffer(size_t num_splats, size_t old_size);
         void    create_gpu_buffer(bool compact = false);
+        //bakes the palette transform into the splats [first, first + ids.size()), ids are those splat ids
+        auto    bake_transforms(const std::vector<u32>& ids, size_t first) -> void;
+        //copies every non deleted splat out for export, optionally with the palette transform baked in
+        auto    gather_alive_splats(bool apply_transform,
+                                    std::vector<glm::vec3>& out_pos,
+                                    std::vector<std::array<float, 3>>& out_shs_0,
+                                    std::vector<std::array<float, 45>>& out_shs_n,
+                                    std::vector<float>& out_opacities,
+                                    std::vector<glm::vec3>& out_scales,
+                                    std::vector<glm::vec4>& out_rot) -> void;
     public:
         std::shared_ptr<rhi::GpuBuffer>	gaussians_buf;
         std::shared_ptr<rhi::GpuBuffer>	gaussians_sh_0_buf; //sh0 data, f16 store float data
@@ -130,6 +160,7 @@ namespace diverse
         maths::BoundingBox	                  world_bounding_box;
         maths::BoundingBox                    selection_bounding_box;
         float				                  splat_size = 1.0;
+        u32                                   gpu_buffer_version = 0; //bumped whenever the gpu buffers are reallocated
 	protected:
 		std::vector<glm::vec3>                pos;
 		std::vector<std::array<float,3>>      shs_0;
@@ -148,5 +179,12 @@ namespace diverse
         bool                                  selection_bound_dirty = true;
         int                                   max_splats = 10000;
         bool                                  mip_antialiased = false;     
+        std::mutex                            data_mutex;
+        std::atomic<u32>                      data_revision = 0;
+        std::atomic<u32>                      state_revision = 0;
+        std::shared_ptr<rhi::GpuBuffer>       state_delta_buf;
+        std::vector<u32>                      flagged_indices;
+        bool                                  state_delta_valid = false;
+        bool                                  state_delta_reset_pending = false;
 	};
 }
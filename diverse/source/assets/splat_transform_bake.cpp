@@ -0,0 +1,78 @@
+#include "splat_transform_bake.h"
+#include "utility/thread_pool.h"
+#include <glm/gtx/quaternion.hpp>
+
+namespace diverse
+{
+	SplatTransformBake::SplatTransformBake(const SplatTransformPalette& palette)
+		: palette(palette)
+	{
+	}
+
+	auto SplatTransformBake::build_groups(const u16* transform_index, const u32* src_ids, u64 count) -> void
+	{
+		constexpr u32 NUM_BUCKETS = 1 << 16;
+		std::vector<u32> offsets(NUM_BUCKETS + 1, 0);
+		for (u64 i = 0; i < count; i++)
+			offsets[transform_index[src_ids[i]] + 1]++;
+		for (u32 b = 0; b < NUM_BUCKETS; b++)
+			offsets[b + 1] += offsets[b];
+
+		group_of_index.assign(NUM_BUCKETS, ~0u);
+		groups.clear();
+		for (u32 b = 0; b < NUM_BUCKETS; b++)
+		{
+			if (offsets[b + 1] == offsets[b] || b >= palette.size()) continue;
+			group_of_index[b] = (u32)groups.size();
+			glm::mat4 transform = glm::transpose(palette[b]);
+			auto q = glm::toQuat(transform);
+			groups.push_back({ transform, q, SHRotation(glm::toMat3(q)), transform == glm::mat4(1.0f) });
+		}
+
+		order.resize(count);
+		for (u64 i = 0; i < count; i++)
+			order[offsets[transform_index[src_ids[i]]]++] = (u32)i;
+	}
+
+	auto SplatTransformBake::bake(const u16* transform_index,
+		const u32* src_ids,
+		u64 count,
+		const glm::vec3* src_pos,
+		const glm::vec4* src_rot,
+		const std::array<float, 45>* src_shn,
+		glm::vec3* dst_pos,
+		glm::vec4* dst_rot,
+		std::array<float, 45>* dst_shn) -> void
+	{
+		if (count == 0) return;
+		build_groups(transform_index, src_ids, count);
+
+		// order is grouped, so each worker's contiguous range touches only a few groups
+		parallel_for<size_t>(0, count, [&](size_t i) {
+			const auto slot = order[i];
+			const auto k = src_ids[slot];
+			const auto group_id = group_of_index[transform_index[k]];
+			if (group_id == ~0u || groups[group_id].identity)
+			{
+				if (dst_pos + slot != src_pos + k)
+				{
+					dst_pos[slot] = src_pos[k];
+					dst_rot[slot] = src_rot[k];
+					dst_shn[slot] = src_shn[k];
+				}
+				return;
+			}
+			const auto& group = groups[group_id];
+			dst_pos[slot] = group.transform * glm::vec4(src_pos[k], 1.0f);
+			auto r = src_rot[k];
+			auto new_r = glm::quat(r.x, r.y, r.z, r.w) * group.rotation;
+			dst_rot[slot] = glm::vec4(new_r.w, new_r.x, new_r.y, new_r.z);
+
+			auto shn = src_shn[k];
+			// sh_n is interleaved, coefficient j of channel c lives at [j * 3 + c]
+			for (auto c = 0; c < 3; c++)
+				group.sh_rotation.rotate(shn.data() + c, 15, 3);
+			dst_shn[slot] = shn;
+		});
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "utility/sh_utils.h"
+#include "splat_transform_palette.h"
+
+namespace diverse
+{
+	// Bakes the per-splat palette transform into position, rotation and sh_n.
+	// Splats are bucketed by palette index with a counting sort, so the matrix, quaternion and
+	// sh rotation of a palette entry are set up once for its whole group instead of once per splat.
+	class SplatTransformBake
+	{
+	public:
+		struct Group
+		{
+			glm::mat4	transform;
+			glm::quat	rotation;
+			SHRotation	sh_rotation;
+			bool		identity;
+		};
+
+		SplatTransformBake(const SplatTransformPalette& palette);
+
+		// src_ids[i] is the splat read for output slot i, transform_index is indexed by splat id.
+		// src and dst may alias as long as dst slot i is src splat src_ids[i] (in place bake).
+		auto bake(const u16* transform_index,
+				const u32* src_ids,
+				u64 count,
+				const glm::vec3* src_pos,
+				const glm::vec4* src_rot,
+				const std::array<float, 45>* src_shn,
+				glm::vec3* dst_pos,
+				glm::vec4* dst_rot,
+				std::array<float, 45>* dst_shn) -> void;
+
+		auto num_groups() const -> u32 { return (u32)groups.size(); }
+
+	private:
+		auto build_groups(const u16* transform_index, const u32* src_ids, u64 count) -> void;
+
+		const SplatTransformPalette& palette;
+		std::vector<Group>	groups;
+		std::vector<u32>	group_of_index;	// palette index -> group, ~0u when unused
+		std::vector<u32>	order;			// output slots sorted by palette index
+	};
+}
@@ -0,0 +1,528 @@
+#include "gpu_device_null.h"
+#include "core/ds_log.h"
+#include "core/profiler.h"
+#include <cstring>
+
+namespace diverse
+{
+    namespace rhi
+    {
+        static auto null_cb(CommandBuffer* cb) -> GpuCommandBufferNull*
+        {
+            return static_cast<GpuCommandBufferNull*>(cb);
+        }
+
+        // The workgroup size is all the renderer asks of a compute pipeline, read it straight from OpExecutionMode LocalSize
+        static auto get_cs_local_size(const CompiledShaderCode& shader_code) -> std::array<u32, 3>
+        {
+            constexpr u32 SPIRV_MAGIC = 0x07230203;
+            constexpr u32 OP_EXECUTION_MODE = 16;
+            constexpr u32 EXECUTION_MODE_LOCAL_SIZE = 17;
+
+            const u32 word_count = u32(shader_code.codes.size() / sizeof(u32));
+            if (word_count < 5)
+                return { 1, 1, 1 };
+            std::vector<u32> words(word_count);
+            std::memcpy(words.data(), shader_code.codes.data(), word_count * sizeof(u32));
+            if (words[0] != SPIRV_MAGIC)
+                return { 1, 1, 1 };
+
+            for (u32 i = 5; i < word_count;)
+            {
+                const u32 op = words[i] & 0xffff;
+                const u32 len = words[i] >> 16;
+                if (len == 0)
+                    break;
+                if (op == OP_EXECUTION_MODE && len >= 6 && i + 5 < word_count && words[i + 2] == EXECUTION_MODE_LOCAL_SIZE)
+                    return { words[i + 3], words[i + 4], words[i + 5] };
+                i += len;
+            }
+            return { 1, 1, 1 };
+        }
+
+        GpuDeviceNull::GpuDeviceNull(u32 device_index)
+        {
+            for (int i = 0; i < 2; i++)
+                frames[i] = DeviceFrame(std::make_shared<GpuCommandBufferNull>(), std::make_shared<GpuCommandBufferNull>());
+            setup_cb = std::make_shared<GpuCommandBufferNull>();
+            graphics_queue_setup_cb = std::make_shared<GpuCommandBufferNull>();
+
+            gpu_limits = {};
+            gpu_limits.max_image_dimension1_d = 16384;
+            gpu_limits.max_image_dimension2_d = 16384;
+            gpu_limits.max_image_dimension3_d = 2048;
+            gpu_limits.max_image_dimension_cube = 16384;
+            gpu_limits.max_per_stage_descriptor_sampled_images = 1024 * 1024;
+            gpu_limits.max_per_stage_descriptor_storage_images = 1024 * 1024;
+            gpu_limits.max_per_stage_descriptor_storage_buffers = 1024 * 1024;
+            gpu_limits.max_per_stage_descriptor_unifrom_texel_buffers = 1024 * 1024;
+            gpu_limits.minUniformBufferOffsetAlignment = 256;
+            gpu_limits.minStorageBufferOffsetAlignment = 16;
+            gpu_limits.minTexelBufferOffsetAlignment = 16;
+            gpu_limits.maxDescriptorSetUpdateAfterBindStorageBuffers = 1024 * 1024;
+            gpu_limits.maxDescriptorSetUpdateAfterBindUniformBuffers = 1024 * 1024;
+            gpu_limits.maxDescriptorSetUpdateAfterBindStorageImages = 1024 * 1024;
+            gpu_limits.maxDescriptorSetUpdateAfterBindSampledImages = 1024 * 1024;
+            gpu_limits.maxPerStageDescriptorUpdateAfterBindSampledImages = 1024 * 1024;
+            gpu_limits.maxPerStageDescriptorUpdateAfterBindStorageImages = 1024 * 1024;
+            gpu_limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers = 1024 * 1024;
+            gpu_limits.maxPerStageDescriptorUpdateAfterBindUniformBuffers = 1024 * 1024;
+            gpu_limits.rayQuery = false;
+            gpu_limits.ray_tracing_enabled = false;
+            gpu_limits.support_bindless = true;
+            gpu_limits.vram_size = 8ull * 1024 * 1024 * 1024;
+
+            DS_LOG_INFO("Null gpu device created, nothing will be rendered");
+        }
+
+        GpuDeviceNull::~GpuDeviceNull()
+        {
+            swapchain.reset();
+            for (auto& res : destroy_queue)
+                res.release();
+            destroy_queue.clear();
+        }
+
+        auto GpuDeviceNull::create_swapchain(SwapchainDesc desc, void* window_handle) -> std::shared_ptr<Swapchain>
+        {
+            swapchain = std::make_shared<SwapchainNull>(this, desc);
+            return swapchain;
+        }
+
+        auto GpuDeviceNull::begin_frame() -> DeviceFrame*
+        {
+            std::lock_guard<std::mutex> lock(frame_mutex);
+            release_resources();
+            for (auto& res : destroy_queue)
+                res.frame_counter++;
+            return &frames[0];
+        }
+
+        auto GpuDeviceNull::end_frame(DeviceFrame* frameRes) -> void
+        {
+            std::lock_guard<std::mutex> lock(frame_mutex);
+            std::swap(frames[0], frames[1]);
+            std::lock_guard<std::mutex> stats_lock(stats_mutex);
+            last_frame = current_frame;
+            current_frame = {};
+        }
+
+        auto GpuDeviceNull::release_resources() -> void
+        {
+            std::lock_guard<std::mutex> lock(cb_mutex);
+            for (auto it = destroy_queue.begin(); it != destroy_queue.end();)
+            {
+                if (it->is_can_release())
+                {
+                    it->release();
+                    it = destroy_queue.erase(it);
+                }
+                else
+                    ++it;
+            }
+        }
+
+        auto GpuDeviceNull::create_render_command_buffer(const char* name) -> std::shared_ptr<CommandBuffer>
+        {
+            return std::make_shared<GpuCommandBufferNull>();
+        }
+
+        auto GpuDeviceNull::create_texture(const GpuTextureDesc& desc, const std::vector<ImageSubData>& initial_data, const char* name) -> std::shared_ptr<GpuTexture>
+        {
+            auto texture = std::make_shared<GpuTextureNull>(desc, &mem_stats);
+            if (!initial_data.empty())
+            {
+                u8* dst = texture->storage();
+                const u64 size = texture->host_data.size();
+                u64 offset = 0;
+                for (const auto& sub : initial_data)
+                {
+                    if (!sub.data || offset >= size)
+                        break;
+                    const u64 bytes = std::min<u64>(sub.size, size - offset);
+                    std::memcpy(dst + offset, sub.data, bytes);
+                    offset += bytes;
+                }
+            }
+            return texture;
+        }
+
+        auto GpuDeviceNull::create_buffer(const GpuBufferDesc& desc, const char* name, uint8* initial_data) -> std::shared_ptr<GpuBuffer>
+        {
+            const u64 align = std::max<u64>(256, desc.align);
+            const u64 address = next_device_address.fetch_add((std::max<u64>(desc.size, 1) + align - 1) & ~(align - 1), std::memory_order_relaxed);
+            auto buffer = std::make_shared<GpuBufferNull>(desc, address, &mem_stats);
+            if (initial_data && desc.size > 0)
+                std::memcpy(buffer->storage(), initial_data, desc.size);
+            return buffer;
+        }
+
+        // Sizes follow what a desktop driver reports closely enough for the render graph's aliasing plan to be
+        // representative: 64k aligned images, 256 byte aligned buffers, one memory type.
+        auto GpuDeviceNull::get_memory_requirements(const GpuTextureDesc& desc) -> std::optional<GpuMemoryRequirements>
+        {
+            const u64 size = GpuTextureNull::size_bytes(desc);
+            return GpuMemoryRequirements{ (size + 0xffff) & ~u64(0xffff), 0x10000, 1 };
+        }
+
+        auto GpuDeviceNull::get_memory_requirements(const GpuBufferDesc& desc) -> std::optional<GpuMemoryRequirements>
+        {
+            if (desc.memory_usage != MemoryUsage::GPU_ONLY)
+                return {};
+            return GpuMemoryRequirements{ (std::max<u64>(desc.size, 1) + 255) & ~u64(255), std::max<u64>(256, desc.align), 1 };
+        }
+
+        auto GpuDeviceNull::create_memory_heap(u64 size, u32 memory_type_bits, const char* name) -> std::shared_ptr<GpuMemoryHeap>
+        {
+            return std::make_shared<GpuMemoryHeapNull>(size, memory_type_bits, &mem_stats);
+        }
+
+        auto GpuDeviceNull::create_placed_texture(const GpuTextureDesc& desc, const std::shared_ptr<GpuMemoryHeap>& heap, u64 offset, const char* name) -> std::shared_ptr<GpuTexture>
+        {
+            auto texture = std::make_shared<GpuTextureNull>(desc, &mem_stats);
+            texture->heap = heap;
+            return texture;
+        }
+
+        auto GpuDeviceNull::create_placed_buffer(const GpuBufferDesc& desc, const std::shared_ptr<GpuMemoryHeap>& heap, u64 offset, const char* name) -> std::shared_ptr<GpuBuffer>
+        {
+            auto buffer = std::static_pointer_cast<GpuBufferNull>(create_buffer(desc, name, nullptr));
+            buffer->heap = heap;
+            return buffer;
+        }
+
+        auto GpuDeviceNull::create_render_pass(const RenderPassDesc& desc, const char* name) -> std::shared_ptr<RenderPass>
+        {
+            auto render_pass = std::make_shared<RenderPassNull>();
+            render_pass->desc = desc;
+            return render_pass;
+        }
+
+        auto GpuDeviceNull::create_descriptor_set(GpuBuffer* dynamic_constants, const std::unordered_map<u32, DescriptorInfo>& descriptors, const char* name) -> std::shared_ptr<DescriptorSet>
+        {
+            return create_descriptor_set(descriptors, name);
+        }
+
+        auto GpuDeviceNull::create_descriptor_set(const std::unordered_map<u32, DescriptorInfo>& descriptors, const char* name) -> std::shared_ptr<DescriptorSet>
+        {
+            auto set = std::make_shared<DescriptorSetNull>();
+            set->descriptors = descriptors;
+            return set;
+        }
+
+        auto GpuDeviceNull::bind_descriptor_set(CommandBuffer* cb, GpuPipeline* pipeline, std::vector<DescriptorSetBinding>& bindings, uint32 set_index) -> void
+        {
+            null_cb(cb)->record(NullCommandType::BindDescriptorSet, pipeline, set_index, bindings.size());
+        }
+
+        auto GpuDeviceNull::bind_descriptor_set(CommandBuffer* cb, GpuPipeline* pipeline, uint32 set_idx, DescriptorSet* set, u32 dynamic_offset_count, u32* dynamic_offset) -> void
+        {
+            null_cb(cb)->record(NullCommandType::BindDescriptorSet, set, set_idx, dynamic_offset_count);
+        }
+
+        auto GpuDeviceNull::bind_pipeline(CommandBuffer* cb, GpuPipeline* pipeline) -> void
+        {
+            null_cb(cb)->record(NullCommandType::BindPipeline, pipeline, u64(pipeline->ty));
+        }
+
+        auto GpuDeviceNull::push_constants(CommandBuffer* cb, GpuPipeline* pipeline, u32 offset, u8* constants, u32 size_) -> void
+        {
+            null_cb(cb)->record(NullCommandType::PushConstants, pipeline, offset, size_);
+        }
+
+        auto GpuDeviceNull::create_compute_pipeline(const CompiledShaderCode& spirv, const ComputePipelineDesc& desc) -> std::shared_ptr<ComputePipeline>
+        {
+            auto pipeline = std::make_shared<GpuPipelineNull>();
+            pipeline->ty = GpuPipeline::PieplineType::Compute;
+            pipeline->group_size = get_cs_local_size(spirv);
+            pipeline->name = desc.name;
+            pipeline->push_constants_bytes = desc.push_constant_bytes;
+            return pipeline;
+        }
+
+        auto GpuDeviceNull::create_raster_pipeline(const std::vector<PipelineShader>& shaders, const RasterPipelineDesc& desc) -> std::shared_ptr<RasterPipeline>
+        {
+            auto pipeline = std::make_shared<GpuPipelineNull>();
+            pipeline->ty = GpuPipeline::PieplineType::Raster;
+            pipeline->group_size = { 0, 0, 0 };
+            pipeline->push_constants_bytes = desc.push_constants_bytes;
+            return pipeline;
+        }
+
+        auto GpuDeviceNull::create_ray_tracing_pipeline(const std::vector<PipelineShader>& shaders, const RayTracingPipelineDesc& desc) -> std::shared_ptr<RayTracingPipeline>
+        {
+            auto pipeline = std::make_shared<GpuPipelineNull>();
+            pipeline->ty = GpuPipeline::PieplineType::RayTracing;
+            pipeline->group_size = { 0, 0, 0 };
+            pipeline->name = desc.name;
+            return pipeline;
+        }
+
+        auto GpuDeviceNull::bind_vertex_buffers(CommandBuffer* cb, const GpuBuffer* const* vertexBuffers, uint32_t slot, uint32_t count, const uint32_t* strides, const uint64_t* offsets) -> void
+        {
+            null_cb(cb)->record(NullCommandType::BindVertexBuffers, count ? vertexBuffers[0] : nullptr, slot, count);
+        }
+
+        auto GpuDeviceNull::bind_index_buffer(CommandBuffer* cb, const GpuBuffer* indexBuffer, const IndexBufferFormat format, uint64_t offset) -> void
+        {
+            null_cb(cb)->record(NullCommandType::BindIndexBuffer, indexBuffer, u64(format), offset);
+        }
+
+        auto GpuDeviceNull::draw(CommandBuffer* cb, uint32_t vertexCount, uint32_t startVertexLocation) -> void
+        {
+            null_cb(cb)->record(NullCommandType::Draw, nullptr, vertexCount, 1, startVertexLocation);
+        }
+
+        auto GpuDeviceNull::draw_indexed(CommandBuffer* cb, uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation) -> void
+        {
+            null_cb(cb)->record(NullCommandType::Draw, nullptr, indexCount, 1, startIndexLocation);
+        }
+
+        auto GpuDeviceNull::draw_instanced(CommandBuffer* cb, uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation) -> void
+        {
+            null_cb(cb)->record(NullCommandType::Draw, nullptr, vertexCount, instanceCount, startVertexLocation);
+        }
+
+        auto GpuDeviceNull::draw_indexed_instanced(CommandBuffer* cb, uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocationd) -> void
+        {
+            null_cb(cb)->record(NullCommandType::Draw, nullptr, indexCount, instanceCount, startIndexLocation);
+        }
+
+        auto GpuDeviceNull::draw_instanced_indirect(CommandBuffer* cb, const GpuBuffer* args, uint64_t args_offset) -> void
+        {
+            null_cb(cb)->record(NullCommandType::DrawIndirect, args, args_offset, 1);
+        }
+
+        auto GpuDeviceNull::draw_indexed_instanced_indirect(CommandBuffer* cb, const GpuBuffer* args, uint64_t args_offset) -> void
+        {
+            null_cb(cb)->record(NullCommandType::DrawIndirect, args, args_offset, 1);
+        }
+
+        auto GpuDeviceNull::draw_instanced_indirect_count(CommandBuffer* cb, const GpuBuffer* args, uint64_t args_offset, const GpuBuffer* count, uint64_t count_offset, uint32_t max_count) -> void
+        {
+            null_cb(cb)->record(NullCommandType::DrawIndirect, args, args_offset, max_count);
+        }
+
+        auto GpuDeviceNull::draw_indexed_instanced_indirect_count(CommandBuffer* cb, const GpuBuffer* args, uint64_t args_offset, const GpuBuffer* count, uint64_t count_offset, uint32_t max_count) -> void
+        {
+            null_cb(cb)->record(NullCommandType::DrawIndirect, args, args_offset, max_count);
+        }
+
+        auto GpuDeviceNull::begin_cmd(CommandBuffer* cb) -> void
+        {
+            cb->begin();
+        }
+
+        auto GpuDeviceNull::end_cmd(CommandBuffer* cb) -> void
+        {
+            cb->end();
+        }
+
+        auto GpuDeviceNull::count_commands(CommandBuffer* cb) -> void
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            current_frame.submits++;
+            for (const auto& cmd : null_cb(cb)->commands)
+                current_frame.per_type[u32(cmd.type)]++;
+            current_frame.commands += null_cb(cb)->commands.size();
+        }
+
+        auto GpuDeviceNull::submit_cmd(CommandBuffer* cb) -> void
+        {
+            count_commands(cb);
+        }
+
+        auto GpuDeviceNull::execute_cmd(CommandBuffer* cb) -> void
+        {
+            count_commands(cb);
+        }
+
+        auto GpuDeviceNull::record_image_barrier(CommandBuffer* cb, const ImageBarrier& barrier) -> void
+        {
+            null_cb(cb)->record(NullCommandType::Barrier, barrier.image, barrier.prev_access, barrier.next_access);
+        }
+
+        auto GpuDeviceNull::record_buffer_barrier(CommandBuffer* cb, const BufferBarrier& barrier) -> void
+        {
+            null_cb(cb)->record(NullCommandType::Barrier, barrier.buffer, barrier.prev_access, barrier.next_access);
+        }
+
+        auto GpuDeviceNull::record_global_barrier(CommandBuffer* cb, const std::vector<rhi::AccessType>& previous_accesses, const std::vector<rhi::AccessType>& next_accesses) -> void
+        {
+            null_cb(cb)->record(NullCommandType::Barrier, nullptr, previous_accesses.size(), next_accesses.size());
+        }
+
+        auto GpuDeviceNull::record_barriers(CommandBuffer* cb, const std::optional<GlobalBarrier>& global, const std::vector<BufferBarrier>& buffers, const std::vector<ImageBarrier>& images) -> void
+        {
+            // one command per batch, the argument slots count its parts
+            null_cb(cb)->record(NullCommandType::Barrier, nullptr, global ? 1 : 0, buffers.size(), images.size());
+        }
+
+        auto GpuDeviceNull::dispatch(CommandBuffer* cb, const std::array<u32, 3>& group_dim, const std::array<u32, 3>& group_size) -> void
+        {
+            auto groups = [&](u32 i) { return u64((group_dim[i] + std::max<u32>(1, group_size[i]) - 1) / std::max<u32>(1, group_size[i])); };
+            null_cb(cb)->record(NullCommandType::Dispatch, nullptr, groups(0), groups(1), groups(2));
+        }
+
+        auto GpuDeviceNull::dispatch_indirect(CommandBuffer* cb, GpuBuffer* args_buffer, u64 args_buffer_offset) -> void
+        {
+            null_cb(cb)->record(NullCommandType::DispatchIndirect, args_buffer, args_buffer_offset);
+        }
+
+        auto GpuDeviceNull::write_descriptor_set(DescriptorSet* descriptor_set, u32 dst_binding, rhi::GpuBuffer* buffer, u32 array_index) -> void
+        {
+            static_cast<DescriptorSetNull*>(descriptor_set)->writes++;
+        }
+
+        auto GpuDeviceNull::write_descriptor_set(DescriptorSet* descriptor_set, u32 dst_binding, u32 rray_index, const rhi::DescriptorImageInfo& img_info) -> void
+        {
+            static_cast<DescriptorSetNull*>(descriptor_set)->writes++;
+        }
+
+        auto GpuDeviceNull::clear_depth_stencil(CommandBuffer* cb, GpuTexture* texture, float depth, u32 stencil) -> void
+        {
+            null_cb(cb)->record(NullCommandType::ClearDepthStencil, texture, stencil);
+        }
+
+        auto GpuDeviceNull::clear_color(CommandBuffer* cb, GpuTexture* texture, const std::array<f32, 4>& color) -> void
+        {
+            null_cb(cb)->record(NullCommandType::ClearColor, texture);
+        }
+
+        auto GpuDeviceNull::copy_image(GpuTexture* src, GpuTexture* dst, CommandBuffer* cmd_buf) -> void
+        {
+            null_cb(cmd_buf)->record(NullCommandType::CopyImage, dst, reinterpret_cast<u64>(src));
+        }
+
+        auto GpuDeviceNull::copy_image(GpuBuffer* src, GpuTexture* dst, CommandBuffer* cmd_buf) -> void
+        {
+            null_cb(cmd_buf)->record(NullCommandType::CopyImage, dst, reinterpret_cast<u64>(src));
+        }
+
+        auto GpuDeviceNull::update_texture(GpuTexture* src, const std::vector<ImageSubData>& update_data, const TextureRegion& tex_region) -> void
+        {
+            with_setup_cb([&](CommandBuffer* cb) {
+                null_cb(cb)->record(NullCommandType::CopyImage, src, update_data.size());
+            });
+        }
+
+        auto GpuDeviceNull::set_point_size(CommandBuffer* cb, float point_size) -> void
+        {
+            null_cb(cb)->record(NullCommandType::SetDynamicState);
+        }
+
+        auto GpuDeviceNull::set_line_width(CommandBuffer* cb, float line_width) -> void
+        {
+            null_cb(cb)->record(NullCommandType::SetDynamicState);
+        }
+
+        auto GpuDeviceNull::set_viewport(CommandBuffer* cb, const ViewPort& view, const Scissor& scissors) -> void
+        {
+            null_cb(cb)->record(NullCommandType::SetViewport, nullptr, scissors.extent[0], scissors.extent[1]);
+        }
+
+        auto GpuDeviceNull::begin_render_pass(CommandBuffer* cb, const std::array<u32, 2>& dims, RenderPass* render_pass, const std::vector<rhi::GpuTexture*>& color_desc, rhi::GpuTexture* depth_desc) -> void
+        {
+            null_cb(cb)->record(NullCommandType::BeginRenderPass, render_pass, dims[0], dims[1], color_desc.size() + (depth_desc ? 1 : 0));
+        }
+
+        auto GpuDeviceNull::end_render_pass(CommandBuffer* cb) -> void
+        {
+            null_cb(cb)->record(NullCommandType::EndRenderPass);
+        }
+
+        auto GpuDeviceNull::create_ray_tracing_bottom_acceleration(const RayTracingBottomAccelerationDesc& desc) -> std::shared_ptr<GpuRayTracingAcceleration>
+        {
+            u64 primitives = 0;
+            for (const auto& geo : desc.geometries)
+            {
+                for (const auto& part : geo.parts)
+                    primitives += part.index_count / 3;
+            }
+            auto buffer_desc = GpuBufferDesc::new_gpu_only(std::max<u64>(256, primitives * 64), BufferUsageFlags::ACCELERATION_STRUCTURE_STORAGE_KHR | BufferUsageFlags::SHADER_DEVICE_ADDRESS);
+            return std::make_shared<GpuRayTracingAccelerationNull>(create_buffer(buffer_desc, "null blas", nullptr));
+        }
+
+        auto GpuDeviceNull::create_ray_tracing_top_acceleration(const RayTracingTopAccelerationDesc& desc, const RayTracingAccelerationScratchBuffer& scratch_buffer) -> std::shared_ptr<GpuRayTracingAcceleration>
+        {
+            const u64 bytes = std::max<u64>(desc.preallocate_bytes, desc.instances.size() * sizeof(GeometryInstance));
+            auto buffer_desc = GpuBufferDesc::new_gpu_only(std::max<u64>(256, bytes), BufferUsageFlags::ACCELERATION_STRUCTURE_STORAGE_KHR | BufferUsageFlags::SHADER_DEVICE_ADDRESS);
+            return std::make_shared<GpuRayTracingAccelerationNull>(create_buffer(buffer_desc, "null tlas", nullptr));
+        }
+
+        auto GpuDeviceNull::rebuild_ray_tracing_top_acceleration(CommandBuffer* cb, u64 instance_buffer_address, u64 instance_count, GpuRayTracingAcceleration* tlas, RayTracingAccelerationScratchBuffer* scratch_buffer) -> void
+        {
+            null_cb(cb)->record(NullCommandType::BuildAcceleration, tlas, instance_buffer_address, instance_count);
+        }
+
+        auto GpuDeviceNull::with_setup_cb(std::function<void(CommandBuffer* cmd)>&& callback) -> void
+        {
+            std::lock_guard<std::mutex> lock(cb_mutex);
+            setup_cb->begin();
+            callback(setup_cb.get());
+            count_commands(setup_cb.get());
+        }
+
+        auto GpuDeviceNull::copy_buffer(CommandBuffer* cmd, GpuBuffer* src, u64 src_offset, GpuBuffer* dst, u64 dst_offset, u64 size_) -> void
+        {
+            null_cb(cmd)->record(NullCommandType::CopyBuffer, dst, reinterpret_cast<u64>(src), src_offset, size_);
+        }
+
+        auto GpuDeviceNull::trace_rays(CommandBuffer* cb, RayTracingPipeline* rtpipeline, const std::array<u32, 3>& threads) -> void
+        {
+            null_cb(cb)->record(NullCommandType::TraceRays, rtpipeline, threads[0], threads[1], threads[2]);
+        }
+
+        auto GpuDeviceNull::trace_rays_indirect(CommandBuffer* cb, RayTracingPipeline* rtpipeline, u64 args_buffer_address) -> void
+        {
+            null_cb(cb)->record(NullCommandType::TraceRays, rtpipeline, args_buffer_address);
+        }
+
+        auto GpuDeviceNull::event_begin(const char* name, CommandBuffer* cb) -> void
+        {
+            null_cb(cb)->record(NullCommandType::EventBegin, name);
+        }
+
+        auto GpuDeviceNull::event_end(CommandBuffer* cb) -> void
+        {
+            null_cb(cb)->record(NullCommandType::EventEnd);
+        }
+
+        auto GpuDeviceNull::set_name(GpuResource* resource, const char* name) const -> void
+        {
+        }
+
+        // host storage goes with the resource object, there is no separate gpu allocation to free
+        auto GpuDeviceNull::destroy_resource(GpuResource* resource) -> void
+        {
+        }
+
+        auto GpuDeviceNull::defer_release(std::function<void()> f) -> void
+        {
+            std::lock_guard<std::mutex> lock(cb_mutex);
+            destroy_queue.push_back(DeferedReleaseResource{ f, 0 });
+        }
+
+        auto GpuDeviceNull::export_image(rhi::GpuTexture* image) -> std::vector<u8>
+        {
+            auto texture = static_cast<GpuTextureNull*>(image);
+            texture->storage();
+            return texture->host_data;
+        }
+
+        auto GpuDeviceNull::blit_image(rhi::GpuTexture* src, rhi::GpuTexture* dst, CommandBuffer* cmd_buf) -> void
+        {
+            if (!cmd_buf)
+            {
+                with_setup_cb([&](CommandBuffer* cb) { blit_image(src, dst, cb); });
+                return;
+            }
+            null_cb(cmd_buf)->record(NullCommandType::BlitImage, dst, reinterpret_cast<u64>(src));
+        }
+
+        auto GpuDeviceNull::fill_buffer(CommandBuffer* cb, GpuBuffer* buffer, uint32_t value) -> void
+        {
+            null_cb(cb)->record(NullCommandType::FillBuffer, buffer, value);
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#include "gpu_resource_null.h"
+
+namespace diverse
+{
+    namespace rhi
+    {
+        GpuBufferNull::GpuBufferNull(const GpuBufferDesc& desc, u64 addr, NullMemoryStats* mem_stats)
+            : GpuBuffer(desc), address(addr), stats(mem_stats)
+        {
+            data_buf = nullptr;
+            stats->live_buffers.fetch_add(1, std::memory_order_relaxed);
+            if (desc.memory_usage != MemoryUsage::GPU_ONLY)
+                storage();
+        }
+
+        GpuBufferNull::~GpuBufferNull()
+        {
+            stats->buffer_bytes.fetch_sub(host_data.size(), std::memory_order_relaxed);
+            stats->live_buffers.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        auto GpuBufferNull::storage() -> u8*
+        {
+            if (host_data.empty() && desc.size > 0)
+            {
+                host_data.resize(desc.size);
+                data_buf = host_data.data();
+                stats->buffer_bytes.fetch_add(desc.size, std::memory_order_relaxed);
+            }
+            return data_buf;
+        }
+
+        auto GpuBufferNull::view(const GpuDevice* device, const GpuBufferViewDesc& view_desc) -> std::shared_ptr<GpuBufferView>
+        {
+            std::lock_guard<std::mutex> lock(view_mutex);
+            auto& view = views[view_desc];
+            if (!view)
+            {
+                auto null_view = std::make_shared<GpuBufferViewNull>();
+                null_view->desc = view_desc;
+                view = null_view;
+            }
+            return view;
+        }
+
+        GpuTextureNull::GpuTextureNull(const GpuTextureDesc& tex_desc, NullMemoryStats* mem_stats)
+            : stats(mem_stats)
+        {
+            desc = tex_desc;
+            stats->live_textures.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        GpuTextureNull::~GpuTextureNull()
+        {
+            stats->texture_bytes.fetch_sub(host_data.size(), std::memory_order_relaxed);
+            stats->live_textures.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        auto GpuTextureNull::size_bytes(const GpuTextureDesc& desc) -> u64
+        {
+            return texture_size_bytes(desc);
+        }
+
+        // textures are only backed once something uploads to or exports them
+        auto GpuTextureNull::storage() -> u8*
+        {
+            if (host_data.empty())
+            {
+                host_data.resize(size_bytes(desc));
+                stats->texture_bytes.fetch_add(host_data.size(), std::memory_order_relaxed);
+            }
+            return host_data.data();
+        }
+
+        auto GpuTextureNull::view(const GpuDevice* device, const GpuTextureViewDesc& view_desc) -> std::shared_ptr<GpuTextureView>
+        {
+            std::lock_guard<std::mutex> lock(view_mutex);
+            auto& view = views[view_desc];
+            if (!view)
+            {
+                auto null_view = std::make_shared<GpuTextureViewNull>();
+                null_view->desc = view_desc;
+                view = null_view;
+            }
+            return view;
+        }
+
+        SwapchainNull::SwapchainNull(GpuDevice* dev, const SwapchainDesc& swapchain_desc)
+            : device(dev)
+        {
+            desc = swapchain_desc;
+            resize(desc.dims[0], desc.dims[1]);
+        }
+
+        auto SwapchainNull::acquire_next_image() -> SwapchainImage
+        {
+            const u32 image_index = u32(frame_index % images.size());
+            return { images[image_index], image_index };
+        }
+
+        auto SwapchainNull::present_image(const SwapchainImage& swap_chain, CommandBuffer* present_cb) -> void
+        {
+            frame_index++;
+        }
+
+        auto SwapchainNull::resize(u32 width, u32 height) -> void
+        {
+            desc.dims = { std::max<u32>(1, width), std::max<u32>(1, height) };
+            auto tex_desc = GpuTextureDesc::new_2d(desc.format, desc.dims)
+                .with_usage(TextureUsageFlags::STORAGE | TextureUsageFlags::COLOR_ATTACHMENT | TextureUsageFlags::TRANSFER_DST);
+            images.clear();
+            for (u32 i = 0; i < 3; i++)
+                images.push_back(device->create_texture(tex_desc, {}, "null swapchain image"));
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include "backend/drs_rhi/gpu_device.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace diverse
+{
+    namespace rhi
+    {
+        // Host memory held by every null resource together, so headless runs can track leaks and transient cache growth
+        struct NullMemoryStats
+        {
+            std::atomic<u64> buffer_bytes { 0 };
+            std::atomic<u64> texture_bytes { 0 };
+            std::atomic<u64> heap_bytes { 0 };
+            std::atomic<u32> live_buffers { 0 };
+            std::atomic<u32> live_textures { 0 };
+        };
+
+        struct GpuBufferViewNull : public GpuBufferView
+        {
+            GpuBufferViewDesc desc;
+        };
+
+        // Cpu visible buffers get their storage up front, gpu only buffers when the host first touches them
+        // (initial data, copy_from / copy_to, export), the renderer never reads most of them back.
+        struct GpuBufferNull : public GpuBuffer
+        {
+            GpuBufferNull(const GpuBufferDesc& desc, u64 address, NullMemoryStats* stats);
+            ~GpuBufferNull();
+
+            uint64 device_address(const struct GpuDevice* device) override { return address; }
+            auto view(const struct GpuDevice* device, const GpuBufferViewDesc& view_desc) -> std::shared_ptr<GpuBufferView> override;
+            auto map(const struct GpuDevice* device) -> u8* override { return storage(); }
+            auto unmap(const struct GpuDevice* device) -> void override {}
+            auto storage() -> u8*;
+
+            u64 address;
+            NullMemoryStats* stats;
+            std::shared_ptr<GpuMemoryHeap> heap; // placed buffers only
+            std::vector<u8> host_data;
+            std::mutex view_mutex;
+            std::unordered_map<GpuBufferViewDesc, std::shared_ptr<GpuBufferView>> views;
+        };
+
+        struct GpuTextureViewNull : public GpuTextureView
+        {
+            GpuTextureViewDesc desc;
+        };
+
+        struct GpuTextureNull : public GpuTexture
+        {
+            GpuTextureNull(const GpuTextureDesc& desc, NullMemoryStats* stats);
+            ~GpuTextureNull();
+
+            auto view(const struct GpuDevice* device, const GpuTextureViewDesc& view_desc) -> std::shared_ptr<GpuTextureView> override;
+            auto storage() -> u8*;
+            static auto size_bytes(const GpuTextureDesc& desc) -> u64;
+
+            NullMemoryStats* stats;
+            std::shared_ptr<GpuMemoryHeap> heap; // placed textures only
+            std::vector<u8> host_data;
+            std::mutex view_mutex;
+            std::unordered_map<GpuTextureViewDesc, std::shared_ptr<GpuTextureView>> views;
+        };
+
+        // Only accounts for its size, resources placed into it still get their own host storage when touched
+        struct GpuMemoryHeapNull : public GpuMemoryHeap
+        {
+            GpuMemoryHeapNull(u64 heap_size, u32 type_bits, NullMemoryStats* mem_stats) : stats(mem_stats)
+            {
+                size = heap_size;
+                memory_type_bits = type_bits;
+                stats->heap_bytes.fetch_add(size, std::memory_order_relaxed);
+            }
+            ~GpuMemoryHeapNull() { stats->heap_bytes.fetch_sub(size, std::memory_order_relaxed); }
+
+            NullMemoryStats* stats;
+        };
+
+        struct GpuPipelineNull : public GpuPipeline
+        {
+            std::string name;
+            u32 push_constants_bytes = 0;
+        };
+
+        struct DescriptorSetNull : public DescriptorSet
+        {
+            std::unordered_map<u32, DescriptorInfo> descriptors;
+            u32 writes = 0;
+        };
+
+        struct RenderPassNull : public RenderPass
+        {
+            RenderPassDesc desc;
+            void begin_render_pass() override {}
+            void end_render_pass() override {}
+        };
+
+        struct GpuRayTracingAccelerationNull : public GpuRayTracingAcceleration
+        {
+            GpuRayTracingAccelerationNull(const std::shared_ptr<GpuBuffer>& buffer) : GpuRayTracingAcceleration(buffer) {}
+            auto as_device_address(const GpuDevice* device) -> u64 override { return backing_buffer->device_address(device); }
+        };
+
+        // Offscreen images standing in for a window, presenting just advances the frame index
+        struct SwapchainNull : public Swapchain
+        {
+            SwapchainNull(struct GpuDevice* device, const SwapchainDesc& desc);
+
+            auto acquire_next_image() -> SwapchainImage override;
+            auto present_image(const SwapchainImage& swap_chain, struct CommandBuffer* present_cb) -> void override;
+            auto resize(u32 width, u32 height) -> void override;
+
+            auto current_buffer_index() -> u64 override { return frame_index % images.size(); }
+            auto current_frame_index() -> u64 override { return frame_index; }
+            auto reset_frame_index() -> void override { frame_index = 0; }
+
+            struct GpuDevice* device;
+            std::vector<std::shared_ptr<GpuTexture>> images;
+            u64 frame_index = 0;
+        };
+    }
+}
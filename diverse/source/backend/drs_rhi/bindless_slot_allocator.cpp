@@ -0,0 +1,75 @@
+#include "bindless_slot_allocator.h"
+#include "core/ds_log.h"
+
+namespace diverse
+{
+    namespace rhi
+    {
+        BindlessSlotAllocator::BindlessSlotAllocator(u32 capacity, u32 retire_frames)
+            : capacity(capacity), retire_frames(retire_frames)
+        {
+        }
+
+        auto BindlessSlotAllocator::allocate() -> BindlessSlot
+        {
+            u32 index;
+            if (!free_indices.empty())
+            {
+                index = free_indices.back();
+                free_indices.pop_back();
+            }
+            else
+            {
+                if (capacity != 0 && generations.size() >= capacity)
+                {
+                    DS_LOG_ERROR("bindless slots exhausted: {} live, {} retiring", live, retired.size());
+                    return {};
+                }
+                index = static_cast<u32>(generations.size());
+                generations.push_back(0);
+                is_allocated.push_back(false);
+            }
+            is_allocated[index] = true;
+            live++;
+            return BindlessSlot{ index, generations[index] };
+        }
+
+        auto BindlessSlotAllocator::release(const BindlessSlot& slot) -> bool
+        {
+            if (!is_live(slot))
+                return false;
+            is_allocated[slot.index] = false;
+            generations[slot.index]++;
+            live--;
+            retired.push_back({ slot.index, frame_index });
+            return true;
+        }
+
+        auto BindlessSlotAllocator::is_live(const BindlessSlot& slot) const -> bool
+        {
+            return slot.index < generations.size() && is_allocated[slot.index] && generations[slot.index] == slot.generation;
+        }
+
+        auto BindlessSlotAllocator::end_frame() -> void
+        {
+            frame_index++;
+            // released in frame F, the frames up to F + retire_frames may have been recorded with the old descriptor
+            while (!retired.empty() && frame_index - retired.front().frame > retire_frames)
+            {
+                free_indices.push_back(retired.front().index);
+                retired.pop_front();
+            }
+        }
+
+        auto BindlessSlotAllocator::stats() const -> BindlessSlotStats
+        {
+            return BindlessSlotStats{
+                live,
+                static_cast<u32>(retired.size()),
+                static_cast<u32>(free_indices.size()),
+                high_water_mark()
+            };
+        }
+    }
+}
+
@@ -0,0 +1,64 @@
+#pragma once
+#include "gpu_resource.h"
+#include "core/base_type.h"
+#include <deque>
+#include <vector>
+
+namespace diverse
+{
+    namespace rhi
+    {
+        // An index into a bindless descriptor array. The generation tells a slot apart from a later reuse of its index.
+        struct BindlessSlot
+        {
+            u32 index = ~0u;
+            u32 generation = 0;
+
+            auto valid() const -> bool { return index != ~0u; }
+        };
+
+        struct BindlessSlotStats
+        {
+            u32 live = 0;
+            u32 retiring = 0;           // released, waiting for the frames that may still read them
+            u32 free = 0;
+            u32 high_water_mark = 0;    // highest index ever handed out + 1, the part of the array in use
+        };
+
+        // Free list allocator for bindless descriptor array slots. A released slot is only handed out again
+        // once retire_frames frames have ended after its release: command buffers in flight may still read the
+        // old descriptor. Free indices are reused before the array grows, so the high water mark follows the peak of
+        // live plus retiring slots.
+        // capacity 0 does not bound the slot count.
+        struct BindlessSlotAllocator
+        {
+            explicit BindlessSlotAllocator(u32 capacity = 0, u32 retire_frames = DYNAMIC_CONSTANTS_BUFFER_COUNT);
+
+            // returns an invalid slot when the array is full
+            auto allocate() -> BindlessSlot;
+            // returns false for a slot that was already released or reused
+            auto release(const BindlessSlot& slot) -> bool;
+            auto is_live(const BindlessSlot& slot) const -> bool;
+            // called once per frame, slots whose retire window passed become free
+            auto end_frame() -> void;
+
+            auto high_water_mark() const -> u32 { return static_cast<u32>(generations.size()); }
+            auto stats() const -> BindlessSlotStats;
+
+        private:
+            struct Retired
+            {
+                u32 index;
+                u64 frame;
+            };
+            u32 capacity;
+            u32 retire_frames;
+            u64 frame_index = 0;
+            u32 live = 0;
+            std::vector<u32> generations;   // per index, bumped on release
+            std::vector<bool> is_allocated;
+            std::vector<u32> free_indices;
+            std::deque<Retired> retired;
+        };
+    }
+}
@@ -1,6 +1,7 @@
 #ifdef DS_RENDER_API_VULKAN
 #include "../drs_vulkan_rhi/gpu_device_vulkan.h"
 #endif
+#include "../drs_null_rhi/gpu_device_null.h"
 
 namespace diverse
 {
@@ -33,8 +34,12 @@ namespace diverse
             case RenderAPI::METAL:
             {
                 g_device = create_metal_device(device_index);
-            }
+            }break;
 #endif
+            case RenderAPI::NONE:
+            {
+                g_device = new GpuDeviceNull(device_index);
+            }break;
             default:
                 break;
             }
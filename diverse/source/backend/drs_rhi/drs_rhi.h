@@ -9,7 +9,7 @@ namespace diverse
         VULKAN,
         DIRECT3D, // Unsupported
         METAL,    // Unsupported
-        NONE,     // Unsupported
+        NONE,     // Headless null device, records commands without executing them
     };
 
     void        set_render_api(RenderAPI    api);
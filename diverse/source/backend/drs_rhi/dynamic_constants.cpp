@@ -0,0 +1,149 @@
+#include "dynamic_constants.h"
+#include "gpu_device.h"
+#include "core/core.h"
+#include "core/ds_log.h"
+#include "core/profiler.h"
+
+namespace diverse
+{
+    namespace rhi
+    {
+        static constexpr uint32 DYNAMIC_CONSTANTS_OFFSET_MASK = (1u << DYNAMIC_CONSTANTS_PAGE_SHIFT) - 1;
+
+        static auto align_dynamic_constants(uint64 size) -> uint64
+        {
+            return (std::max<uint64>(size, 1) + DYNAMIC_CONSTANTS_ALIGNMENT - 1) & ~uint64(DYNAMIC_CONSTANTS_ALIGNMENT - 1);
+        }
+
+        DynamicConstants::~DynamicConstants()
+        {
+            if (!device)
+                return;
+            buffer->unmap(device);
+            for (auto& slot : slots)
+            {
+                for (uint32 i = 1; i < slot.page_count; i++)
+                    slot.pages[i].buffer->unmap(device);
+            }
+        }
+
+        auto DynamicConstants::init(GpuDevice* dev, BufferUsageFlags buffer_usage) -> void
+        {
+            device = dev;
+            usage = buffer_usage;
+            auto desc = GpuBufferDesc::new_cpu_to_gpu(DYNAMIC_CONSTANTS_SIZE_BYTES * DYNAMIC_CONSTANTS_BUFFER_COUNT, usage);
+            buffer = device->create_buffer(desc, "dynamic constants buffer", nullptr);
+            // mapped once for the lifetime of the buffer instead of around every push
+            u8* mapped = buffer->map(device);
+            for (uint32 i = 0; i < DYNAMIC_CONSTANTS_BUFFER_COUNT; i++)
+            {
+                auto& page = slots[i].pages[0];
+                page.buffer = buffer;
+                page.mapped = mapped;
+                page.base = uint64(i) * DYNAMIC_CONSTANTS_SIZE_BYTES;
+                page.size = DYNAMIC_CONSTANTS_SIZE_BYTES;
+                slots[i].page_count = 1;
+            }
+        }
+
+        auto DynamicConstants::advance_frame() -> void
+        {
+            last_frame = current_frame_stats();
+            peak_frame_bytes = std::max(peak_frame_bytes, last_frame.used_bytes);
+
+            frame_parity = (frame_parity + 1) % DYNAMIC_CONSTANTS_BUFFER_COUNT;
+            auto& slot = slots[frame_parity];
+            for (uint32 i = 0; i < slot.page_count; i++)
+                slot.pages[i].used.store(0, std::memory_order_relaxed);
+            slot.pushes.store(0, std::memory_order_relaxed);
+            slot.exhausted.store(false, std::memory_order_relaxed);
+            slot.active_page.store(0, std::memory_order_release);
+        }
+
+        auto DynamicConstants::alloc(uint64 size) -> uint32
+        {
+            auto& slot = slots[frame_parity];
+            const uint64 aligned = align_dynamic_constants(size);
+            slot.pushes.fetch_add(1, std::memory_order_relaxed);
+            for (;;)
+            {
+                const uint32 page_idx = slot.active_page.load(std::memory_order_acquire);
+                auto& page = slot.pages[page_idx];
+                const uint64 offset = page.used.fetch_add(aligned, std::memory_order_relaxed);
+                if (offset + size <= page.size)
+                    return uint32(page_idx << DYNAMIC_CONSTANTS_PAGE_SHIFT) | uint32(page.base + offset);
+
+                if (!chain_page(slot, page_idx, size))
+                {
+                    // out of pages, any offset handed out here would alias live constants of this frame
+                    if (!slot.exhausted.exchange(true, std::memory_order_relaxed))
+                        DS_LOG_ERROR("DynamicConstants: {} pages exhausted, dropping pushes for the rest of the frame", DYNAMIC_CONSTANTS_MAX_PAGES);
+                    DS_ASSERT(false, "DynamicConstants: out of pages, {} bytes push dropped", size);
+                    return DYNAMIC_CONSTANTS_INVALID_HANDLE;
+                }
+            }
+        }
+
+        auto DynamicConstants::chain_page(FrameSlot& slot, uint32 full_page, uint64 min_size) -> bool
+        {
+            DS_PROFILE_FUNCTION();
+            std::scoped_lock lock(page_mutex);
+            if (slot.active_page.load(std::memory_order_acquire) != full_page)
+                return true; // another thread chained it already
+
+            const uint32 next = full_page + 1;
+            if (next >= DYNAMIC_CONSTANTS_MAX_PAGES)
+                return false;
+
+            auto& page = slot.pages[next];
+            if (next >= slot.page_count || page.size < min_size)
+            {
+                if (page.buffer)
+                    page.buffer->unmap(device);
+                const uint64 page_size = std::max<uint64>(DYNAMIC_CONSTANTS_SIZE_BYTES, align_dynamic_constants(min_size));
+                DS_LOG_WARN("DynamicConstants: frame exceeded {} bytes, chaining overflow page {}", DYNAMIC_CONSTANTS_SIZE_BYTES, next);
+                page.buffer = device->create_buffer(GpuBufferDesc::new_cpu_to_gpu(page_size, usage), "dynamic constants overflow page", nullptr);
+                page.mapped = page.buffer->map(device);
+                page.base = 0;
+                page.size = page_size;
+                slot.page_count = std::max(slot.page_count, next + 1);
+            }
+            page.used.store(0, std::memory_order_relaxed);
+            slot.active_page.store(next, std::memory_order_release);
+            return true;
+        }
+
+        auto DynamicConstants::host_ptr(uint32 handle) -> u8*
+        {
+            DS_ASSERT(is_valid(handle), "DynamicConstants: host_ptr of a dropped push");
+            auto& page = slots[frame_parity].pages[handle >> DYNAMIC_CONSTANTS_PAGE_SHIFT];
+            return page.mapped + (handle & DYNAMIC_CONSTANTS_OFFSET_MASK);
+        }
+
+        auto DynamicConstants::resolve(uint32 handle) -> std::pair<GpuBuffer*, u32>
+        {
+            // a dropped push still binds a valid range so the frame can finish, its contents are stale
+            if (!is_valid(handle))
+                return { buffer.get(), uint32(slots[frame_parity].pages[0].base) };
+            auto& page = slots[frame_parity].pages[handle >> DYNAMIC_CONSTANTS_PAGE_SHIFT];
+            return { page.buffer.get(), handle & DYNAMIC_CONSTANTS_OFFSET_MASK };
+        }
+
+        auto DynamicConstants::device_address(const GpuDevice* dev, uint32 handle) -> uint64
+        {
+            auto [page_buffer, offset] = resolve(handle);
+            return page_buffer->device_address(dev) + offset;
+        }
+
+        auto DynamicConstants::current_frame_stats() const -> DynamicConstantsFrameStats
+        {
+            auto& slot = slots[frame_parity];
+            DynamicConstantsFrameStats stats;
+            stats.pages = slot.active_page.load(std::memory_order_acquire) + 1;
+            stats.pushes = slot.pushes.load(std::memory_order_relaxed);
+            for (uint32 i = 0; i < stats.pages; i++)
+                stats.used_bytes += std::min(slot.pages[i].used.load(std::memory_order_relaxed), slot.pages[i].size);
+            return stats;
+        }
+    }
+}
@@ -1,73 +1,121 @@
 #pragma once
 #include "gpu_buffer.h"
 #include "utility/concepts_utils.h"
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <mutex>
 namespace diverse
 {
     namespace rhi
     {
-        struct DynamicConstants 
+        // Bits of a push handle above DYNAMIC_CONSTANTS_PAGE_SHIFT select the page, 0 is the main buffer
+        #define DYNAMIC_CONSTANTS_PAGE_SHIFT 26
+        #define DYNAMIC_CONSTANTS_MAX_PAGES 32
+        // returned by alloc() once every page of the frame is full, nothing is written for it
+        #define DYNAMIC_CONSTANTS_INVALID_HANDLE 0xffffffffu
+        static_assert(uint64(DYNAMIC_CONSTANTS_SIZE_BYTES) * DYNAMIC_CONSTANTS_BUFFER_COUNT <= (1ull << DYNAMIC_CONSTANTS_PAGE_SHIFT));
+
+        struct DynamicConstantsFrameStats
+        {
+            uint64 used_bytes = 0;
+            uint32 pages = 0;
+            uint32 pushes = 0;
+        };
+
+        // Per frame bump allocator over a persistently mapped cpu to gpu buffer. Each frame in flight owns one
+        // DYNAMIC_CONSTANTS_SIZE_BYTES half of the main buffer; when it is full, overflow pages are chained
+        // (and kept for that frame slot), so a heavy frame never writes past its half.
+        // push() is lock free and can be called from several recording threads at once, only chaining a page locks.
+        // The returned value is a handle: offsets into the main buffer are returned unchanged, bind it through
+        // resolve() to get the page buffer and its offset.
+        struct DynamicConstants
         {
             std::shared_ptr<GpuBuffer> buffer;
-            struct GpuDevice* device; 
-            uint64 frame_offset_bytes = 0;
+            struct GpuDevice* device = nullptr;
             uint32 frame_parity = 0;
-            
-            auto advance_frame() -> void
-            {
-                this->frame_parity = (this->frame_parity + 1) % DYNAMIC_CONSTANTS_BUFFER_COUNT;
-                this->frame_offset_bytes = 0;
-            }
-            auto current_offset() -> uint32
-            {
-               return (this->frame_parity * DYNAMIC_CONSTANTS_SIZE_BYTES + this->frame_offset_bytes);
-            }
-            auto current_device_address(const struct GpuDevice* device) -> uint64
-            {
-               return this->buffer->device_address(device) + this->current_offset();
-            }
+
+            DynamicConstants() = default;
+            DynamicConstants(const DynamicConstants&) = delete;
+            DynamicConstants& operator=(const DynamicConstants&) = delete;
+            ~DynamicConstants();
+
+            auto init(struct GpuDevice* device, BufferUsageFlags usage) -> void;
+            // the previous use of this frame slot must have finished on the gpu
+            auto advance_frame() -> void;
+
+            auto alloc(uint64 size) -> uint32;
+            auto host_ptr(uint32 handle) -> u8*;
+            auto resolve(uint32 handle) -> std::pair<GpuBuffer*, u32>;
+            auto device_address(const struct GpuDevice* device, uint32 handle) -> uint64;
+            static auto is_main_page(uint32 handle) -> bool { return (handle >> DYNAMIC_CONSTANTS_PAGE_SHIFT) == 0; }
+            static auto is_valid(uint32 handle) -> bool { return handle != DYNAMIC_CONSTANTS_INVALID_HANDLE; }
+
+            auto current_frame_stats() const -> DynamicConstantsFrameStats;
+            auto last_frame_stats() const -> DynamicConstantsFrameStats { return last_frame; }
+            auto peak_bytes() const -> uint64 { return peak_frame_bytes; }
 
             template<typename T>
             auto push(T const& t) -> uint32
             {
                 auto t_size = sizeof(T);
-                assert( (frame_offset_bytes + t_size) < DYNAMIC_CONSTANTS_SIZE_BYTES);
-                auto buffer_offset = current_offset();
-                if constexpr (is_tuple<T>::value) 
+                auto handle = alloc(t_size);
+                if (!is_valid(handle))
+                    return handle;
+                auto dst = host_ptr(handle);
+                if constexpr (is_tuple<T>::value)
                 {
-                    auto buffer_ptr = buffer->map(device);
                     auto src_offset = 0;
                     loop(std::make_index_sequence<std::tuple_size<T>::value>{},
                         [&]<std::size_t i>() {
                         auto value = std::get<i>(t);
-                        std::memcpy(buffer_ptr + buffer_offset + src_offset, &value, sizeof(value));
+                        std::memcpy(dst + src_offset, &value, sizeof(value));
                         src_offset += sizeof(value);
                     });
-                    buffer->unmap(device);
                 }
                 else
-                    buffer->copy_from(device,reinterpret_cast<const u8*>(&t), t_size, buffer_offset);
-                auto t_size_aligned = (t_size + DYNAMIC_CONSTANTS_ALIGNMENT - 1) & ~(DYNAMIC_CONSTANTS_ALIGNMENT - 1);
-                frame_offset_bytes += t_size_aligned;
-                
-                return buffer_offset;
+                    std::memcpy(dst, &t, t_size);
+                return handle;
             }
 
             template<typename T>
             auto push_from_vec(const std::vector<T>& vec) -> uint32
             {
-                auto t_size = sizeof(T);
                 auto t_align = 4;
-                assert((frame_offset_bytes + t_size) < DYNAMIC_CONSTANTS_SIZE_BYTES);
                 assert(DYNAMIC_CONSTANTS_ALIGNMENT % t_align == 0);
 
-                auto buffer_offset = current_offset();
-                auto dst_offset = buffer_offset;
-                buffer->copy_from(device, reinterpret_cast<const u8*>(vec.data()), t_size * vec.size(), dst_offset);
-                dst_offset += t_size * vec.size();
-                frame_offset_bytes += (dst_offset - buffer_offset + DYNAMIC_CONSTANTS_ALIGNMENT - 1) & ~(DYNAMIC_CONSTANTS_ALIGNMENT - 1);
-                return buffer_offset;
+                auto bytes = sizeof(T) * vec.size();
+                auto handle = alloc(bytes);
+                if (bytes && is_valid(handle))
+                    std::memcpy(host_ptr(handle), vec.data(), bytes);
+                return handle;
             }
 
+        private:
+            struct Page
+            {
+                std::shared_ptr<GpuBuffer> buffer;
+                u8* mapped = nullptr;
+                uint64 base = 0; // offset of the page inside its buffer
+                uint64 size = 0;
+                std::atomic<uint64> used { 0 };
+            };
+            struct FrameSlot
+            {
+                std::array<Page, DYNAMIC_CONSTANTS_MAX_PAGES> pages;
+                std::atomic<uint32> active_page { 0 };
+                uint32 page_count = 0; // pages created for this slot so far, kept across frames
+                std::atomic<uint32> pushes { 0 };
+                std::atomic<bool> exhausted { false };
+            };
+
+            auto chain_page(FrameSlot& slot, uint32 full_page, uint64 min_size) -> bool;
+
+            std::array<FrameSlot, DYNAMIC_CONSTANTS_BUFFER_COUNT> slots;
+            BufferUsageFlags usage = {};
+            std::mutex page_mutex;
+            DynamicConstantsFrameStats last_frame;
+            uint64 peak_frame_bytes = 0;
         };
     }
-}
\ No newline at end of file
+}
@@ -29,5 +29,31 @@ namespace diverse
              }
              return image_aspect_mask_from_format(format);
          }
+
+        auto is_write_access(rhi::AccessType access_type) -> bool
+        {
+            switch (access_type)
+            {
+            case AccessType::CommandBufferWriteNVX:
+            case AccessType::VertexShaderWrite:
+            case AccessType::TessellationControlShaderWrite:
+            case AccessType::TessellationEvaluationShaderWrite:
+            case AccessType::GeometryShaderWrite:
+            case AccessType::FragmentShaderWrite:
+            case AccessType::ColorAttachmentWrite:
+            case AccessType::DepthStencilAttachmentWrite:
+            case AccessType::DepthAttachmentWriteStencilReadOnly:
+            case AccessType::StencilAttachmentWriteDepthReadOnly:
+            case AccessType::ComputeShaderWrite:
+            case AccessType::AnyShaderWrite:
+            case AccessType::TransferWrite:
+            case AccessType::HostWrite:
+            case AccessType::ColorAttachmentReadWrite:
+            case AccessType::General:
+                return true;
+            default:
+                return false;
+            }
+        }
     }
 }
\ No newline at end of file
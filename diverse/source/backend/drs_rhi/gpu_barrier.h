@@ -3,6 +3,7 @@
 #include "gpu_texture.h"
 #include "gpu_buffer.h"
 #include <optional>
+#include <vector>
 namespace diverse
 {
     namespace rhi
@@ -31,6 +32,13 @@ namespace diverse
             u32 offset;
             u32 size;
         };
+
+        // memory dependency between the listed accesses on every resource, no layout transitions
+        struct GlobalBarrier
+        {
+            std::vector<AccessType> previous_accesses;
+            std::vector<AccessType> next_accesses;
+        };
         //struct AcessInfo
         //{
 
@@ -41,6 +49,7 @@ namespace diverse
         //};
         auto image_aspect_mask_from_format(PixelFormat format)-> ImageAspectFlags;
         auto image_aspect_mask_from_access_type_and_format(rhi::AccessType access_type, PixelFormat format)->std::optional<ImageAspectFlags>;
+        auto is_write_access(rhi::AccessType access_type) -> bool;
 
     }
 }
\ No newline at end of file
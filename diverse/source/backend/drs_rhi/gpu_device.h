@@ -49,6 +49,13 @@ namespace diverse
             DeviceFrame() = default;
             std::shared_ptr<CommandBuffer> main_cmd_buf;
             std::shared_ptr<CommandBuffer> presentation_cmd_buf;
+            // render graph passes recorded on worker threads, submitted in order after main_cmd_buf
+            std::vector<std::shared_ptr<CommandBuffer>> worker_cmd_bufs;
+            // Timestamp queries written during the last use of this frame, in ns. begin_frame reads them back once
+            // the frame's fences signalled; timestamps_tag is left to the recorder to match them to its own records.
+            u32 timestamp_queries = 0;
+            std::vector<u64> timestamps;
+            u64 timestamps_tag = 0;
         };
 
         struct ViewPort
@@ -110,6 +117,21 @@ namespace diverse
 			}
 		};
 
+        struct GpuMemoryRequirements
+        {
+            u64 size = 0;
+            u64 alignment = 1;
+            u32 memory_type_bits = ~0u;
+        };
+
+        // A block of device local memory that transient resources are placed into, see create_placed_texture
+        struct GpuMemoryHeap
+        {
+            virtual ~GpuMemoryHeap() {}
+            u64 size = 0;
+            u32 memory_type_bits = 0;
+        };
+
         struct GpuDevice
         {
         public:
@@ -158,6 +180,8 @@ namespace diverse
             virtual auto record_image_barrier(CommandBuffer* cb,const ImageBarrier& barrier)->void = 0;
             virtual auto record_buffer_barrier(CommandBuffer* cb, const BufferBarrier& barrier)->void = 0 ;
             virtual auto record_global_barrier(CommandBuffer* cb, const std::vector<rhi::AccessType>& previous_accesses, const std::vector<rhi::AccessType>& next_accesses)->void = 0;
+            // all barriers of one synchronization point in a single command
+            virtual auto record_barriers(CommandBuffer* cb, const std::optional<GlobalBarrier>& global, const std::vector<BufferBarrier>& buffers, const std::vector<ImageBarrier>& images)->void = 0;
             virtual auto dispatch(CommandBuffer* cb, const std::array<u32, 3>& group_dim, const std::array<u32, 3>& group_size)->void = 0;
             virtual auto dispatch_indirect(CommandBuffer* cb,GpuBuffer* args_buffer, u64 args_buffer_offset)->void = 0;
             virtual auto write_descriptor_set(DescriptorSet* descriptor_set, u32 dst_binding, rhi::GpuBuffer* buffer, u32 array_index = 0)->void = 0;
@@ -202,6 +226,21 @@ namespace diverse
             virtual auto fill_buffer(CommandBuffer* cb, GpuBuffer* buffer, uint32_t value) -> void = 0;
         public:
             virtual auto get_graphics_cmd_buffer()->CommandBuffer* {return nullptr;};
+
+            // Memory aliasing for render graph transients. Placed resources share the heap's memory, so the caller
+            // owns synchronisation between resources whose ranges overlap. A backend that leaves these unimplemented
+            // returns empty and the render graph allocates every transient on its own.
+            virtual auto get_memory_requirements(const GpuTextureDesc& desc)->std::optional<GpuMemoryRequirements> { return {}; }
+            virtual auto get_memory_requirements(const GpuBufferDesc& desc)->std::optional<GpuMemoryRequirements> { return {}; }
+            virtual auto create_memory_heap(u64 size, u32 memory_type_bits, const char* name = nullptr)->std::shared_ptr<GpuMemoryHeap> { return nullptr; }
+            virtual auto create_placed_texture(const GpuTextureDesc& desc, const std::shared_ptr<GpuMemoryHeap>& heap, u64 offset, const char* name = nullptr)->std::shared_ptr<GpuTexture> { return nullptr; }
+            virtual auto create_placed_buffer(const GpuBufferDesc& desc, const std::shared_ptr<GpuMemoryHeap>& heap, u64 offset, const char* name = nullptr)->std::shared_ptr<GpuBuffer> { return nullptr; }
+
+            // GPU timestamps into the current frame's query pool, see DeviceFrame::timestamps. The reset has to be
+            // recorded on a command buffer submitted before every one that writes. Capacity 0 means unsupported.
+            virtual auto timestamp_query_capacity()->u32 { return 0; }
+            virtual auto reset_timestamp_queries(CommandBuffer* cb, u32 count)->void {}
+            virtual auto write_timestamp(CommandBuffer* cb, u32 query)->void {}
         public:
             auto inline create_ray_tracing_acceleration_scratch_buffer() -> RayTracingAccelerationScratchBuffer
             {
@@ -213,8 +252,6 @@ namespace diverse
 
             auto fill_ray_tracing_instance_buffer(DynamicConstants* dynamic_constants, const std::vector<RayTracingInstanceDesc>& instances) -> u64
             {
-                auto instance_buffer_address = dynamic_constants->current_device_address(this);
-
                 std::vector< GeometryInstance>  geo_instances;
                 for (auto& inst_desc : instances)
                 {
@@ -223,9 +260,9 @@ namespace diverse
                     auto transform = inst_desc.transformation;
                     geo_instances.push_back(GeometryInstance(transform, inst_desc.mesh_index, inst_desc.mask, 0, GeometryInstanceFlag::TRIANGLE_FACING_CULL_DISABLE, blas_address));
                 }
-                dynamic_constants->push_from_vec(geo_instances);
+                auto instance_handle = dynamic_constants->push_from_vec(geo_instances);
 
-                return instance_buffer_address;
+                return dynamic_constants->device_address(this, instance_handle);
             }
 
             GpuLimits gpu_limits;
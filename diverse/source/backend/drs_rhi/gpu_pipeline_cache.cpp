@@ -51,102 +51,153 @@ namespace diverse
         PipelineCache::PipelineCache()
         {
             shader_compiler_init();
+            u32 threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+            if (const char* env = getenv("DS_SHADER_COMPILE_THREADS"))
+                threads = std::max(1, atoi(env));
+            set_max_concurrent_compiles(threads);
         }
-        auto PipelineCache::prepare_frame(GpuDevice* device)->bool
+
+        PipelineCache::~PipelineCache()
+        {
+            // the tasks only own copies of their workers, finishing them here just keeps dxc alive long enough
+            compile_pool.reset();
+        }
+
+        auto PipelineCache::set_max_concurrent_compiles(u32 count)->void
+        {
+            max_concurrent_compiles = std::max(1u, count);
+            if (compile_pool)
+                compile_pool->set_n_threads(max_concurrent_compiles);
+            else
+                compile_pool = std::make_unique<ThreadPool>(max_concurrent_compiles);
+        }
+
+        auto PipelineCache::prepare_frame(GpuDevice* device, bool wait)->bool
         {
             invalidate_stale_pipelines();
-            return parallel_compile_shaders(device);
+            queue_compiles();
+            collect_compiled(device, wait);
+            return true;
         }
 
+        // a stale entry keeps its pipeline, the recompile replaces it once it is done. Failed entries are retried
+        // here too once their sources changed.
         auto PipelineCache::invalidate_stale_pipelines()->void
         {
             for (auto& [handle,entry] : compute_entries)
             {
-                if (entry.pipeline && entry.worker.need_compile())
-                    entry.pipeline = {};
+                if (entry.worker.need_compile())
+                    entry.stale = true;
             }
             for (auto& [handle, entry] : raster_entries)
             {
-                if (entry.pipeline && entry.worker.need_compile())
-                    entry.pipeline = {};
+                if (entry.worker.need_compile())
+                    entry.stale = true;
             }
             for (auto& [handle, entry] : rt_entries)
             {
-                if (entry.pipeline && entry.worker.need_compile())
-                    entry.pipeline = {};
+                if (entry.worker.need_compile())
+                    entry.stale = true;
             }
         }
 
-        auto PipelineCache::parallel_compile_shaders(rhi::GpuDevice* device)->bool
+        // Tasks run on copies of the workers: registering pipelines may rehash the entries while they compile.
+        // An entry invalidated again while compiling stays stale and is queued once the running compile is collected.
+        auto PipelineCache::queue_compiles()->void
         {
-            ThreadPool pool;
-            std::vector<std::future<CompileTaskOutput>> futures;
-            for (auto& entry : compute_entries)
-            {
-                if( !entry.second.pipeline )
-                { 
-                    auto f = std::bind(&CompileShaderLazyWorker::run, &entry.second.worker, entry.first);
-                    futures.emplace_back(pool.enqueue_task(std::move(f)));
-                }
-            }
-            for (auto& entry : rt_entries)
-            {
-                if (!entry.second.pipeline)
-                { 
-                    auto f = std::bind(&CompilePipelineShadersLazyWorker::run_rt, &entry.second.worker, entry.first);
-                    futures.emplace_back(pool.enqueue_task(std::move(f)));
-                }
-            }
-            for (auto& entry : raster_entries)
-            {
-                if (!entry.second.pipeline)
+            auto queue = [&](auto& entries, auto run) {
+                for (auto& [handle, entry] : entries)
                 {
-                    auto f = std::bind(&CompilePipelineShadersLazyWorker::run_raster,&entry.second.worker, entry.first);
-                    futures.emplace_back(pool.enqueue_task(std::move(f)));
+                    if (!entry.stale || entry.task.valid())
+                        continue;
+                    entry.stale = false;
+                    entry.state = PipelineCompileState::Pending;
+                    entry.task = compile_pool->enqueue_task([worker = entry.worker, handle = handle, run]() mutable {
+                        auto output = (worker.*run)(handle);
+                        output.last_write_time = worker.last_compiled_time;
+                        return output;
+                    });
                 }
-            }
+            };
+            queue(compute_entries, &CompileShaderLazyWorker::run);
+            queue(rt_entries, &CompilePipelineShadersLazyWorker::run_rt);
+            queue(raster_entries, &CompilePipelineShadersLazyWorker::run_raster);
+        }
 
-            auto shader_tasks = diverse::wait_and_get_all(std::move(futures));
-            for (auto& compiled : shader_tasks)
-            {
-                switch ( compiled.ty )
-                {
-                case CompileTaskOutput::Compute:
+        // Pipelines are created here on the calling thread, the device's pipeline cache keeps that part short.
+        // A compile error leaves the last good pipeline in place and marks the entry failed until its sources change.
+        auto PipelineCache::collect_compiled(rhi::GpuDevice* device, bool wait)->void
+        {
+            auto finished = [&](std::future<CompileTaskOutput>& task) {
+                if (!task.valid())
+                    return false;
+                if (wait)
+                    task.wait();
+                return task.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            };
+            auto compiled_shaders = [](CompiledPipelineShaders& compiled, bool& failed) {
+                std::vector<PipelineShader> shaders;
+                for (auto& shader : compiled.shaders)
                 {
-                    auto& [handle, compile_s] = compiled.compute();
-                    auto& entry = compute_entries[handle];
-                    entry.pipeline = device->create_compute_pipeline(compile_s, entry.desc);
+                    failed |= shader.code.codes.empty();
+                    shaders.push_back(PipelineShader{ std::move(shader.code), shader.desc });
                 }
-                break;
-                case CompileTaskOutput::Raster:
+                return shaders;
+            };
+            auto finish = [](auto& entry, i64 last_write_time, auto&& pipeline) {
+                entry.worker.last_compiled_time = std::max(entry.worker.last_compiled_time, last_write_time);
+                if (pipeline)
                 {
-                    auto& [handle, compile_s] = compiled.raster();
-                    auto& entry = raster_entries[handle];
-                    std::vector<PipelineShader> compiled_shaders;
-                    for (const auto& shader : compile_s.shaders)
-                    {
-                        compiled_shaders.push_back(PipelineShader{shader.code,shader.desc});
-                    }
-                    entry.pipeline = device->create_raster_pipeline(compiled_shaders, entry.desc);
+                    entry.pipeline = std::move(pipeline);
+                    entry.state = PipelineCompileState::Ready;
                 }
-                break;
-                case CompileTaskOutput::Rt:
+                else
                 {
-                    auto& [handle, compile_s] = compiled.rt();
-                    auto& entry = rt_entries[handle];
-                    std::vector<PipelineShader> compiled_shaders;
-                    for (const auto& shader : compile_s.shaders)
-                    {
-                        compiled_shaders.push_back(PipelineShader{ shader.code,shader.desc });
-                    }
-                    entry.pipeline  = device->create_ray_tracing_pipeline(compiled_shaders, entry.desc);
-                }
-                break;
-                default:
-                    break;
+                    entry.state = PipelineCompileState::Failed;
                 }
+            };
+
+            for (auto& [handle, entry] : compute_entries)
+            {
+                if (!finished(entry.task))
+                    continue;
+                auto compiled = entry.task.get();
+                auto& [_, code] = compiled.compute();
+                std::shared_ptr<ComputePipeline> pipeline;
+                if (!code.codes.empty())
+                    pipeline = device->create_compute_pipeline(code, entry.desc);
+                else
+                    DS_LOG_WARN("compute pipeline {} failed to compile{}", entry.worker.path, entry.pipeline ? ", keeping the previous one" : "");
+                finish(entry, compiled.last_write_time, pipeline);
+            }
+            for (auto& [handle, entry] : raster_entries)
+            {
+                if (!finished(entry.task))
+                    continue;
+                auto compiled = entry.task.get();
+                bool failed = false;
+                auto shaders = compiled_shaders(compiled.raster().second, failed);
+                std::shared_ptr<RasterPipeline> pipeline;
+                if (!failed)
+                    pipeline = device->create_raster_pipeline(shaders, entry.desc);
+                else
+                    DS_LOG_WARN("raster pipeline {} failed to compile{}", entry.worker.shader_descs[0].source.path, entry.pipeline ? ", keeping the previous one" : "");
+                finish(entry, compiled.last_write_time, pipeline);
+            }
+            for (auto& [handle, entry] : rt_entries)
+            {
+                if (!finished(entry.task))
+                    continue;
+                auto compiled = entry.task.get();
+                bool failed = false;
+                auto shaders = compiled_shaders(compiled.rt().second, failed);
+                std::shared_ptr<RayTracingPipeline> pipeline;
+                if (!failed)
+                    pipeline = device->create_ray_tracing_pipeline(shaders, entry.desc);
+                else
+                    DS_LOG_WARN("ray tracing pipeline {} failed to compile{}", entry.worker.shader_descs[0].source.path, entry.pipeline ? ", keeping the previous one" : "");
+                finish(entry, compiled.last_write_time, pipeline);
             }
-            return true;
         }
         auto PipelineCache::register_compute(const ComputePipelineDesc& desc) -> ComputePipelineHandle
         {
@@ -165,7 +216,12 @@ namespace diverse
 
         auto PipelineCache::get_compute(ComputePipelineHandle handle) -> std::shared_ptr<ComputePipeline>
         {
-            return compute_entries.at(handle).pipeline.value();
+            return compute_entries.at(handle).pipeline.value_or(nullptr);
+        }
+
+        auto PipelineCache::compute_state(ComputePipelineHandle handle) -> PipelineCompileState
+        {
+            return compute_entries.at(handle).state;
         }
 
         auto PipelineCache::register_raster(const std::vector<PipelineShaderDesc>& shaders, const RasterPipelineDesc& desc) -> RasterPipelineHandle
@@ -185,7 +241,12 @@ namespace diverse
 
         auto PipelineCache::get_raster(RasterPipelineHandle handle) -> std::shared_ptr<RasterPipeline>
         {
-            return raster_entries.at(handle).pipeline.value();
+            return raster_entries.at(handle).pipeline.value_or(nullptr);
+        }
+
+        auto PipelineCache::raster_state(RasterPipelineHandle handle) -> PipelineCompileState
+        {
+            return raster_entries.at(handle).state;
         }
 
         auto PipelineCache::register_ray_tracing(const std::vector<PipelineShaderDesc>& shaders, const RayTracingPipelineDesc& desc) -> RtPipelineHandle
@@ -204,7 +265,12 @@ namespace diverse
         }
         auto PipelineCache::get_ray_tracing(RtPipelineHandle handle) -> std::shared_ptr<RayTracingPipeline>
         {
-            return rt_entries.at(handle).pipeline.value();
+            return rt_entries.at(handle).pipeline.value_or(nullptr);
+        }
+
+        auto PipelineCache::ray_tracing_state(RtPipelineHandle handle) -> PipelineCompileState
+        {
+            return rt_entries.at(handle).state;
         }
 
         auto PipelineCache::refresh_shaders()->void
@@ -225,7 +291,8 @@ namespace diverse
             auto source = diverse::process_file(this->path, &provider, "");
             i64 last_write_time = 0;
             for (const auto& s : source)
-                last_compiled_time = std::max<i64>(last_write_time, s.last_write_time);
+                last_write_time = std::max<i64>(last_write_time, s.last_write_time);
+            this->last_compiled_time = last_write_time;
 
             auto target_profile = fmt::format("{}_6_4", profile);
             auto spirv = diverse::compile_generic_shader_hlsl(name, source, target_profile.c_str(), defines, entry_point);
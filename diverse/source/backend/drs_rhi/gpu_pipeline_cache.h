@@ -2,6 +2,7 @@
 
 #include "gpu_raytracing.h"
 #include "utility/thread_pool.h"
+#include "core/flat_hash_map.h"
 namespace diverse
 {
     namespace rhi
@@ -37,6 +38,7 @@ namespace diverse
             }ty;
 
             std::any value;
+            i64 last_write_time = 0;  // newest source file the shaders were compiled from
 
             auto compute() -> std::pair<ComputePipelineHandle, CompiledShaderCode>&
             {
@@ -94,11 +96,22 @@ namespace diverse
             auto need_compile()->bool;
         };
 
+        enum class PipelineCompileState : u8
+        {
+            Pending,    // queued or compiling, the last good pipeline (if any) is still handed out
+            Ready,
+            Failed,     // the last compile failed, the last good pipeline (if any) is still handed out
+        };
+
+        // pipeline holds the last good pipeline, a recompile only replaces it once it succeeded
         struct ComputePipelineCacheEntry
         {
             CompileShaderLazyWorker worker;
             ComputePipelineDesc desc;
             std::optional<std::shared_ptr<ComputePipeline>> pipeline;
+            PipelineCompileState state = PipelineCompileState::Pending;
+            bool stale = true;  // needs a (re)compile that has not been queued yet
+            std::future<CompileTaskOutput> task;
         };
 
         struct RasterPipelineCacheEntry
@@ -106,6 +119,9 @@ namespace diverse
             CompilePipelineShadersLazyWorker worker;
             RasterPipelineDesc desc;
             std::optional<std::shared_ptr<RasterPipeline>> pipeline;
+            PipelineCompileState state = PipelineCompileState::Pending;
+            bool stale = true;
+            std::future<CompileTaskOutput> task;
         };
 
         struct RtPipelineCacheEntry
@@ -113,34 +129,52 @@ namespace diverse
             CompilePipelineShadersLazyWorker worker;
             RayTracingPipelineDesc desc;
             std::optional<std::shared_ptr<RayTracingPipeline>> pipeline;
+            PipelineCompileState state = PipelineCompileState::Pending;
+            bool stale = true;
+            std::future<CompileTaskOutput> task;
         };
 
+        // Shaders are compiled on a persistent background pool, prepare_frame never waits for them unless asked to.
+        // It queues new and stale entries and turns finished compiles into pipelines; until then get_* hands out
+        // the last good pipeline or nullptr, and the render graph skips passes whose pipelines are missing.
+        // DS_SHADER_COMPILE_THREADS overrides how many shaders compile at once.
         struct PipelineCache
         {
             PipelineCache();
-            std::unordered_map<ComputePipelineHandle, ComputePipelineCacheEntry> compute_entries;
-            std::unordered_map<RasterPipelineHandle, RasterPipelineCacheEntry> raster_entries;
-            std::unordered_map<RtPipelineHandle, RtPipelineCacheEntry> rt_entries;
+            ~PipelineCache();
+            FlatHashMap<ComputePipelineHandle, ComputePipelineCacheEntry> compute_entries;
+            FlatHashMap<RasterPipelineHandle, RasterPipelineCacheEntry> raster_entries;
+            FlatHashMap<RtPipelineHandle, RtPipelineCacheEntry> rt_entries;
 
-            std::unordered_map<u64, ComputePipelineHandle> compute_shader_to_handle;
-            std::unordered_map<u64, RasterPipelineHandle> raster_shaders_to_handle;
-            std::unordered_map<u64, RtPipelineHandle> rt_shaders_to_handle;
+            FlatHashMap<u64, ComputePipelineHandle> compute_shader_to_handle;
+            FlatHashMap<u64, RasterPipelineHandle> raster_shaders_to_handle;
+            FlatHashMap<u64, RtPipelineHandle> rt_shaders_to_handle;
 
-            auto prepare_frame(GpuDevice* device)->bool;
+            // wait blocks until every queued compile finished, for one-shot graphs that have to produce their output
+            auto prepare_frame(GpuDevice* device, bool wait = false)->bool;
 
             auto invalidate_stale_pipelines()->void;
-            auto parallel_compile_shaders(rhi::GpuDevice* device)->bool;
+            auto queue_compiles()->void;
+            auto collect_compiled(rhi::GpuDevice* device, bool wait)->void;
+            auto set_max_concurrent_compiles(u32 count)->void;
 
             auto register_compute(const ComputePipelineDesc& desc)-> ComputePipelineHandle;
             auto get_compute(ComputePipelineHandle handle) -> std::shared_ptr<ComputePipeline>;
+            auto compute_state(ComputePipelineHandle handle) -> PipelineCompileState;
 
             auto register_raster(const std::vector< PipelineShaderDesc>& shaders,const RasterPipelineDesc& desc) -> RasterPipelineHandle;
             auto get_raster(RasterPipelineHandle handle) -> std::shared_ptr<RasterPipeline>;
+            auto raster_state(RasterPipelineHandle handle) -> PipelineCompileState;
 
             auto register_ray_tracing(const std::vector< PipelineShaderDesc>& shaders, const RayTracingPipelineDesc& desc) -> RtPipelineHandle;
             auto get_ray_tracing(RtPipelineHandle handle) -> std::shared_ptr<RayTracingPipeline>;
+            auto ray_tracing_state(RtPipelineHandle handle) -> PipelineCompileState;
 
             auto refresh_shaders()->void;
+
+        private:
+            u32 max_concurrent_compiles = 1;
+            std::unique_ptr<ThreadPool> compile_pool;
         };
 
     }
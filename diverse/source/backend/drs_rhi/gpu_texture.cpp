@@ -1,4 +1,5 @@
 #include "gpu_texture.h"
+#include <algorithm>
 
 auto diverse::rhi::image_access_type_to_usage_flags(AccessType access_type) -> TextureUsageFlags
 {
@@ -153,3 +154,17 @@ diverse::rhi::GpuTextureDesc::GpuTextureDesc(TextureType img_ty, TextureUsageFla
 	: image_type(img_ty), usage(usa), flags(flag), format(fmt), extent(extents), mip_levels(mip), array_elements(array_ele)
 {
 }
+
+auto diverse::rhi::texture_size_bytes(const GpuTextureDesc& desc) -> u64
+{
+	const u64 pixel_bytes = std::max<u32>(1, get_pixel_bytes(desc.format));
+	u64 bytes = 0;
+	for (u32 mip = 0; mip < std::max<u32>(1, desc.mip_levels); mip++)
+	{
+		const u64 w = std::max<u32>(1, desc.extent[0] >> mip);
+		const u64 h = std::max<u32>(1, desc.extent[1] >> mip);
+		const u64 d = std::max<u32>(1, desc.extent[2] >> mip);
+		bytes += w * h * d * pixel_bytes;
+	}
+	return bytes * std::max<u32>(1, desc.array_elements);
+}
@@ -329,6 +329,8 @@ namespace diverse
         };
 
         auto image_access_type_to_usage_flags(AccessType access_type)->TextureUsageFlags;
+        // tightly packed size of every mip and layer, a lower bound of what the device allocates
+        auto texture_size_bytes(const GpuTextureDesc& desc)->u64;
     }
 }
 
@@ -2,6 +2,7 @@
 #include "shader_compiler.h"
 #include "utility/string_utils.h"
 #include "utility/file_utils.h"
+#include "assets/embed_asset.h"
 #include <mutex>
 #include <any>
 #if defined(DS_PLATFORM_WINDOWS)
@@ -19,9 +20,10 @@
 #endif
 #include "utility/timer.h"
 #include "utility/hash_utils.h"
+#include "core/flat_hash_map.h"
 
 #ifdef DS_PRODUCTION
-std::unordered_map<std::string, std::vector<uint8_t>> embeded_shaders;
+diverse::FlatHashMap<std::string, std::vector<uint8_t>, diverse::StringHash> embeded_shaders;
 struct RegisterShader
 {
 	RegisterShader(const std::string& name, const std::vector<uint8_t>& data)
@@ -36,21 +38,16 @@ namespace diverse
 {
 	auto load_embed_shader(const std::string& shaderPath) -> std::vector<uint8_t>
 	{
-		auto shaderPath2 = shaderPath;
-		shaderPath2 = stringutility::back_slashes_2_slashes(shaderPath2);
-		auto shaderName = stringutility::remove_file_extension(shaderPath2);
-		shaderName = stringutility::remove_character(shaderName, '/');
-		shaderName = stringutility::remove_character(shaderName, '.');
-		shaderName = stringutility::remove_character(shaderName, '_');
-		shaderName = stringutility::remove_character(shaderName, ':');
-		shaderName = stringutility::remove_character(shaderName, '+');
-		shaderName = stringutility::remove_character(shaderName, '-');
-		if (embeded_shaders.find(shaderName) != embeded_shaders.end())
-		{
-			return embeded_shaders[shaderName];
-		}
-		DS_LOG_ERROR("not found emebed shader {}", shaderName);
-		return {};
+		ArenaTemp scratch = ScratchBegin(nullptr, 0);
+		String8 shaderName = embed_shader_name(scratch.arena, shaderPath);
+		auto it = embeded_shaders.find(std::string_view((const char*)shaderName.str, shaderName.size));
+		std::vector<uint8_t> spirv;
+		if (it != embeded_shaders.end())
+			spirv = it->second;
+		else
+			DS_LOG_ERROR("not found emebed shader {}", (const char*)shaderName.str);
+		ScratchEnd(scratch);
+		return spirv;
 	}
 
 	void delete_embed_shaders(const std::string& outPath)
@@ -74,17 +71,12 @@ namespace diverse
             DS_LOG_WARN("Failed to load shader : {0}", shaderPath);
             return;
         }
-        auto shaderPath2 = shaderPath;
-        shaderPath2 = stringutility::back_slashes_2_slashes(shaderPath2);
-        auto shaderName = stringutility::remove_file_extension(shaderPath2);
-        shaderName = stringutility::remove_character(shaderName, '/');
-        shaderName = stringutility::remove_character(shaderName, '.');
-        shaderName = stringutility::remove_character(shaderName, '_');
-		shaderName = stringutility::remove_character(shaderName, ':');
-		shaderName = stringutility::remove_character(shaderName, '+');
-		shaderName = stringutility::remove_character(shaderName, '-');
-		if (has_dumped.find(shaderName) != has_dumped.end() && has_dumped[shaderName]) return;
-		has_dumped[shaderName] = true;
+		ArenaTemp scratch = ScratchBegin(nullptr, 0);
+		auto shaderName = ToStdString(embed_shader_name(scratch.arena, shaderPath));
+		ScratchEnd(scratch);
+		auto& dumped = has_dumped[shaderName];
+		if (dumped) return;
+		dumped = true;
 
         std::ofstream file(outPath,std::ios_base::app);
 		if (!file.is_open())
@@ -303,6 +295,7 @@ namespace diverse
 	{
 		DxcCreateInstanceProc DxcCreateInstance = nullptr;
 		CComPtr<IDxcUtils> dxcUtils;
+		std::string version;
 		Dxc()
 		{
 #ifdef DS_PLATFORM_WINDOWS
@@ -330,6 +323,7 @@ namespace diverse
 					uint32_t major = 0;
 					hr = info->GetVersion(&major, &minor);
 					assert(SUCCEEDED(hr));
+					version = std::to_string(major) + "." + std::to_string(minor);
 					DS_LOG_INFO("shadercompiler: loaded " LIBDXCOMPILER " (version: " + std::to_string(major) + "." + std::to_string(minor) + ")");
 				}
 				HRESULT hr = DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&dxcUtils));
@@ -411,10 +405,47 @@ namespace diverse
 		}
 	}
 
+	static const std::vector<const char*> dxc_spirv_args = { "-spirv",
+		//"-enable-16bit-types",
+		"-fspv-target-env=vulkan1.2",
+		"-Wfor-redefinition",
+		"-Ges" }; // strict mode
+
+#ifndef DS_PRODUCTION
+	// queried once, a compiler update has to invalidate every cached shader
+	static auto dxc_version() -> const std::string&
+	{
+		static const std::string version = [] {
+			Dxc dxc;
+			return dxc.version;
+		}();
+		return version;
+	}
+
+	// Everything the spirv depends on: the preprocessed source (includes already expanded into it), the files
+	// it was assembled from, defines, entry point, profile, arguments and the compiler version.
+	static auto shader_cache_key(
+			const std::string& source,
+			u64 include_hash,
+			const char* target_profile,
+			const std::vector<std::pair<std::string, std::string>>& defines,
+			const std::string& entry_point) -> u64
+	{
+		std::string options = dxc_version() + '\n' + entry_point + '\n' + (target_profile ? target_profile : "") + '\n';
+		for (auto arg : dxc_spirv_args)
+			options += std::string(arg) + '\n';
+		for (const auto& [name, value] : defines)
+			options += name + '=' + value + '\n';
+		u64 key = murmur_hash64A(source.data(), static_cast<int>(source.size()), include_hash);
+		hash_combine(key, murmur_hash64A(options.data(), static_cast<int>(options.size()), 0));
+		return key;
+	}
+#endif
+
 	auto compile_generic_shader_hlsl(
 			const std::string& name, 
 			const std::string& source, 
-			i64 last_write_time, 
+			u64 include_hash, 
 			const char* target_profile, 
 			const std::vector<std::pair<std::string, std::string>>& defines,
 			const std::string& entry_point) -> std::vector<uint8>
@@ -422,49 +453,31 @@ namespace diverse
 		Timer timer;
 		auto pname = std::filesystem::path(name).parent_path().filename();
 		auto fname = pname / std::filesystem::path(name).filename();
-		bool need_compile = false;
-#ifdef DS_PRODUCTION
-		need_compile = false;
-#else
-		auto meta_name = std::filesystem::path(name).replace_extension(".meta");
-		if (std::filesystem::exists(meta_name))
-		{
-			std::ifstream   ff(meta_name, std::ios::binary);
-			long long last_compile_time = 0;
-			ff >> last_compile_time;
-			//whether the file is modified
-			need_compile  = last_write_time > last_compile_time;
-			ff.close();
-		}
-		else 
-			need_compile = true;
-		if(need_compile)
-		{
-			//write file modify time to meta file
-			std::ofstream file(meta_name, std::ios::binary);
-			file << last_write_time;
-			file.close();
-		}
-#endif
         auto install_path = getInstallDirectory();
 		for (auto define : defines)
 			fname += define.first + define.second;
-#ifdef DS_PLATFORM_MACOS
-        auto shader_cache_name = getExecutablePath() + "/cache/" + fname.string() + ".cached";
-#else
-		auto shader_cache_name = install_path + "/cache/" + fname.string() + ".cached";
-#endif
 #ifdef DS_PRODUCTION
 		//extern auto load_embed_shader(const std::string & shaderPath) -> std::vector<uint8_t>;
 
-		auto spv = load_embed_shader(fname.string() + ".cached");
+		// the embed step strips the content key off cache/<variant>.<key>.cached
+		auto spv = load_embed_shader(fname.string() + "_" + entry_point + ".cached");
 		if( !spv.empty() ) return spv;
 		else
 		{
-			DS_LOG_ERROR("loading shader {} error", shader_cache_name);
+			DS_LOG_ERROR("loading shader {} error", fname.string());
 		}
 #else
-		if (std::filesystem::exists(shader_cache_name) && !need_compile)
+		// content addressed: copies of the tree hit, any change to what the compiler sees misses
+		const u64 key = shader_cache_key(source, include_hash, target_profile, defines, entry_point);
+		const auto variant_name = fname.string() + "_" + entry_point;
+#ifdef DS_PLATFORM_MACOS
+        auto shader_cache_dir = std::filesystem::path(getExecutablePath() + "/cache/" + variant_name).parent_path();
+#else
+		auto shader_cache_dir = std::filesystem::path(install_path + "/cache/" + variant_name).parent_path();
+#endif
+		const auto variant_prefix = std::filesystem::path(variant_name).filename().string() + ".";
+		auto shader_cache_name = (shader_cache_dir / fmt::format("{}{:016x}.cached", variant_prefix, key)).string();
+		if (std::filesystem::exists(shader_cache_name))
 		{
 			std::vector<u8> spirv;
 			size_t data_size = 0;
@@ -479,23 +492,26 @@ namespace diverse
 			}
 		}
 #endif
-		auto res = compile_hlsl(name, source, entry_point.c_str(), target_profile, { "-spirv",
-			//"-enable-16bit-types",
-			"-fspv-target-env=vulkan1.2",
-			"-Wfor-redefinition",
-			"-Ges"}, // strict mode}, 
-			defines);
+		auto res = compile_hlsl(name, source, entry_point.c_str(), target_profile, dxc_spirv_args, defines);
 
 		DS_LOG_INFO("dxc took {} for {}", timer.GetElapsedS(), name);
 		if (res.second.empty())
 		{
-			if (!std::filesystem::exists(std::filesystem::path(shader_cache_name).parent_path()))
-				std::filesystem::create_directories(std::filesystem::path(shader_cache_name).parent_path());
+#ifndef DS_PRODUCTION
+			std::error_code ec;
+			std::filesystem::create_directories(shader_cache_dir, ec);
 			shader_dump_mutex.lock();
+			// older builds of this variant are stale now
+			for (const auto& entry : std::filesystem::directory_iterator(shader_cache_dir, ec))
+			{
+				auto file_name = entry.path().filename().string();
+				if (file_name.size() == variant_prefix.size() + 16 + 7 && file_name.starts_with(variant_prefix) && file_name.ends_with(".cached"))
+					std::filesystem::remove(entry.path(), ec);
+			}
 			writeData(shader_cache_name, res.first.data(), res.first.size());
 			shader_dump_mutex.unlock();
 			DS_LOG_INFO("write shader {} cache", shader_cache_name);
-
+#endif
 			return res.first;
 		}
 		DS_LOG_ERROR("compile {} error: {}", name,res.second);
@@ -510,13 +526,13 @@ namespace diverse
 			const std::string& entry_point) -> std::vector<uint8>
 	{
 		std::string str_text;
-		i64 last_write_time = 0;
+		u64 include_hash = 0;
 		for(const auto& s : source)
 		{
 			str_text += s.source;
-			last_write_time = std::max<i64>(last_write_time, s.last_write_time);
+			hash_combine(include_hash, murmur_hash64A(s.file.data(), static_cast<int>(s.file.size()), 0));
 		}
-		return compile_generic_shader_hlsl(name, str_text, last_write_time,target_profile,defines,entry_point);
+		return compile_generic_shader_hlsl(name, str_text, include_hash,target_profile,defines,entry_point);
 	}
 
 }
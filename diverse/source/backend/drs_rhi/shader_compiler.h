@@ -39,11 +39,14 @@ namespace diverse
 	//auto compile_generic_shader_hlsl(
 	//	const CompilerInput& input
 	//)->std::vector<uint8>;
+	// source is the include-expanded text, include_hash identifies the files it was assembled from;
+	// the spirv is cached under a hash of both plus defines, entry point, profile and compiler version
 	auto compile_generic_shader_hlsl(
 			const std::string& name, 
 			const std::string& source,
-			i64 last_write_time, 
+			u64 include_hash, 
 			const char* target_profile,
+			const std::vector<std::pair<std::string, std::string>>& defines,
 			const std::string& entry_point) -> std::vector<uint8>;
 
 	auto compile_generic_shader_hlsl(
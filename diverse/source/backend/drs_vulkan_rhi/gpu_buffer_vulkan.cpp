@@ -59,13 +59,11 @@ namespace diverse
             if (desc.usage & (BufferUsageFlags::STORAGE_TEXEL_BUFFER | BufferUsageFlags::UNIFORM_TEXEL_BUFFER) )
             {
                 auto vk_device = dynamic_cast<const GpuDeviceVulkan*>(device);
+                std::lock_guard<std::mutex> lock(view_mutex);
                 auto it = views.find(view_desc);
                 if (it == views.end())
-                {
-                    auto buffer_view = vk_device->create_buffer_view(view_desc, desc, handle);
-                    views[view_desc] = std::move(buffer_view);
-                }
-                return views[view_desc];
+                    it = views.emplace(view_desc, vk_device->create_buffer_view(view_desc, desc, handle)).first;
+                return it->second;
             }
             return nullptr;
         }
@@ -6,6 +6,7 @@ namespace diverse
 	namespace rhi
 	{
 		struct GpuDeviceVulkan;
+		struct GpuMemoryHeap;
 		struct GpuBufferViewVulkan : GpuBufferView
 		{
 			GpuBufferViewVulkan(VkBufferView view) :buf_view(view) {}
@@ -20,7 +21,9 @@ namespace diverse
             VkBuffer	handle = VK_NULL_HANDLE;
 			VmaAllocation allocation{};
 			VmaAllocationInfo allocate_info = {};
+			std::shared_ptr<GpuMemoryHeap> heap; // set for placed buffers, which own no allocation
 			std::unordered_map<GpuBufferViewDesc, std::shared_ptr<GpuBufferView>>	views;
+			std::mutex view_mutex; // views are created lazily, also from render graph worker threads
             uint64 device_address(const struct GpuDevice* device) override;
 			auto view(const struct GpuDevice* device, const GpuBufferViewDesc& view_desc) -> std::shared_ptr<GpuBufferView> override;
 			auto map(const struct GpuDevice* device) -> u8* override;
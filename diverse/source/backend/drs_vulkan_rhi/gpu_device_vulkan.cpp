@@ -13,6 +13,7 @@
 
 #include <ranges>
 #include "core/ds_log.h"
+#include "utility/file_utils.h"
 #define SMALL_ALLOCATION_MAX_SIZE 4096
 
 namespace diverse
@@ -20,6 +21,8 @@ namespace diverse
     namespace rhi
     {
         constexpr u32 MAX_SET_COUNT = 4;
+        // per frame, two per render graph pass
+        constexpr u32 MAX_TIMESTAMP_QUERIES = 1024;
         GpuCommandBufferVulkan::GpuCommandBufferVulkan(VkDevice device, Queue	que)
             : family_index(que.family.index), queue(que.queue)
         {
@@ -500,6 +503,12 @@ namespace diverse
             for(auto& res : destroy_queue)
                 res.frame_counter = 0xffff;
             release_resources();
+            save_pipeline_cache();
+            for (auto& frame : frames)
+            {
+                if (frame.timestamp_pool)
+                    vkDestroyQueryPool(device, frame.timestamp_pool, nullptr);
+            }
             //vkDeviceWaitIdle(device);
    /*         vkDestroyDevice(device, nullptr);
             vkDestroyInstance(instance->instance,nullptr);*/
@@ -515,6 +524,17 @@ namespace diverse
                 set_label((u64)present_cmd->handle,VK_OBJECT_TYPE_COMMAND_BUFFER, std::format("present_cmd_{}",i).c_str());
                 frames[i] = DeviceFrameVulkan(main_cmd, present_cmd, VK_NULL_HANDLE, VK_NULL_HANDLE);
             }
+            if (physcial_device.properties.limits.timestampComputeAndGraphics)
+            {
+                timestamp_capacity = MAX_TIMESTAMP_QUERIES;
+                timestamp_period = physcial_device.properties.limits.timestampPeriod;
+                VkQueryPoolCreateInfo query_pool_info = {};
+                query_pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+                query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+                query_pool_info.queryCount = timestamp_capacity;
+                for (auto& frame : frames)
+                    VK_CHECK_RESULT(vkCreateQueryPool(device, &query_pool_info, nullptr, &frame.timestamp_pool));
+            }
 
             immutable_samplers = create_samplers(device);
             setup_cb.reset(new GpuCommandBufferVulkan(device, transfer_queue));
@@ -523,8 +543,82 @@ namespace diverse
             auto crash_buffer_desc = GpuBufferDesc::new_gpu_to_cpu(4, BufferUsageFlags::TRANSFER_DST);
             crash_tracking_buffer = create_buffer_impl(device, global_allocator, crash_buffer_desc,"crash tracing buffer");
             rt_scatch_buffer = create_ray_tracing_acceleration_scratch_buffer();
+            load_pipeline_cache();
         }  
 
+        auto GpuDeviceVulkan::pipeline_cache_path() const -> std::string
+        {
+#ifdef DS_PLATFORM_MACOS
+            return getExecutablePath() + "/cache/pipeline_cache.bin";
+#else
+            return getInstallDirectory() + "/cache/pipeline_cache.bin";
+#endif
+        }
+
+        auto GpuDeviceVulkan::load_pipeline_cache() -> void
+        {
+            std::vector<u8> data;
+            size_t data_size = 0;
+            auto path = pipeline_cache_path();
+            if (std::filesystem::exists(path) && readByteData(path, data, data_size))
+            {
+                // the driver would reject a foreign blob too, checking the header keeps the reason in the log
+                VkPipelineCacheHeaderVersionOne header = {};
+                const auto& props = physcial_device.properties;
+                if (data.size() >= sizeof(header))
+                    memcpy(&header, data.data(), sizeof(header));
+                if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || header.vendorID != props.vendorID ||
+                    header.deviceID != props.deviceID || memcmp(header.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+                {
+                    DS_LOG_INFO("pipeline cache {} is from another device or driver, starting empty", path);
+                    data.clear();
+                }
+            }
+
+            VkPipelineCacheCreateInfo create_info = {};
+            create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            create_info.initialDataSize = data.size();
+            create_info.pInitialData = data.empty() ? nullptr : data.data();
+            if (vkCreatePipelineCache(device, &create_info, nullptr, &pipeline_cache) != VK_SUCCESS && !data.empty())
+            {
+                create_info.initialDataSize = 0;
+                create_info.pInitialData = nullptr;
+                VK_CHECK_RESULT(vkCreatePipelineCache(device, &create_info, nullptr, &pipeline_cache));
+            }
+            if (!data.empty())
+                DS_LOG_INFO("loaded pipeline cache {} ({} bytes)", path, data.size());
+        }
+
+        auto GpuDeviceVulkan::save_pipeline_cache() -> void
+        {
+            if (pipeline_cache == VK_NULL_HANDLE)
+                return;
+            size_t size = 0;
+            std::vector<u8> data;
+            if (vkGetPipelineCacheData(device, pipeline_cache, &size, nullptr) == VK_SUCCESS && size > 0)
+            {
+                data.resize(size);
+                if (vkGetPipelineCacheData(device, pipeline_cache, &size, data.data()) != VK_SUCCESS)
+                    data.clear();
+                data.resize(size);
+            }
+            if (!data.empty())
+            {
+                // written aside and renamed, a crash mid-write must not leave a truncated cache behind
+                auto path = std::filesystem::path(pipeline_cache_path());
+                auto tmp_path = path;
+                tmp_path += ".tmp";
+                std::error_code ec;
+                std::filesystem::create_directories(path.parent_path(), ec);
+                if (writeData(tmp_path.string(), data.data(), data.size()))
+                    std::filesystem::rename(tmp_path, path, ec);
+                if (ec)
+                    DS_LOG_WARN("failed to write pipeline cache {}: {}", path.string(), ec.message());
+            }
+            vkDestroyPipelineCache(device, pipeline_cache, nullptr);
+            pipeline_cache = VK_NULL_HANDLE;
+        }
+
         std::shared_ptr<GpuTexture>  GpuDeviceVulkan::create_texture(const GpuTextureDesc& desc,const std::vector<ImageSubData>&  initial_data, const char* name)
         {
         #ifndef DS_PRODUCTION
@@ -671,6 +765,105 @@ namespace diverse
             return buffer;
         }
 
+        GpuMemoryHeapVulkan::~GpuMemoryHeapVulkan()
+        {
+            auto device = dynamic_cast<GpuDeviceVulkan*>(get_global_device());
+            if (device && allocation)
+            {
+                device->defer_release([allocation = this->allocation, device]() {
+                    vmaFreeMemory(device->global_allocator, allocation);
+                });
+            }
+        }
+
+        // No resource exists yet, so query through a throwaway one. The render graph caches the result per desc.
+        auto GpuDeviceVulkan::get_memory_requirements(const GpuTextureDesc& desc) -> std::optional<GpuMemoryRequirements>
+        {
+            auto create_info = get_image_create_info(desc, false);
+            VkImage image;
+            if (vkCreateImage(device, &create_info, nullptr, &image) != VK_SUCCESS)
+                return {};
+            VkMemoryRequirements requirements;
+            vkGetImageMemoryRequirements(device, image, &requirements);
+            vkDestroyImage(device, image, nullptr);
+            return GpuMemoryRequirements{ requirements.size, requirements.alignment, requirements.memoryTypeBits };
+        }
+
+        auto GpuDeviceVulkan::get_memory_requirements(const GpuBufferDesc& desc) -> std::optional<GpuMemoryRequirements>
+        {
+            if (desc.memory_usage != MemoryUsage::GPU_ONLY)
+                return {};
+            VkBufferCreateInfo buffer_create_info = {};
+            buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            buffer_create_info.size = desc.size;
+            buffer_create_info.usage = (VkBufferUsageFlagBits)(desc.usage);
+            buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            VkBuffer buffer;
+            if (vkCreateBuffer(device, &buffer_create_info, nullptr, &buffer) != VK_SUCCESS)
+                return {};
+            VkMemoryRequirements requirements;
+            vkGetBufferMemoryRequirements(device, buffer, &requirements);
+            vkDestroyBuffer(device, buffer, nullptr);
+            return GpuMemoryRequirements{ requirements.size, requirements.alignment, requirements.memoryTypeBits };
+        }
+
+        auto GpuDeviceVulkan::create_memory_heap(u64 size, u32 memory_type_bits, const char* name) -> std::shared_ptr<GpuMemoryHeap>
+        {
+            VkMemoryRequirements requirements = {};
+            requirements.size = size;
+            requirements.alignment = 64 * 1024;
+            requirements.memoryTypeBits = memory_type_bits;
+            VmaAllocationCreateInfo alloc_create_info = {};
+            alloc_create_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+            alloc_create_info.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
+            auto heap = std::make_shared<GpuMemoryHeapVulkan>();
+            heap->size = size;
+            heap->memory_type_bits = memory_type_bits;
+            std::lock_guard<std::mutex> lock(cb_mutex);
+            if (vmaAllocateMemory(global_allocator, &requirements, &alloc_create_info, &heap->allocation, nullptr) != VK_SUCCESS)
+            {
+                DS_LOG_WARN("Failed to allocate a {} bytes transient heap", size);
+                heap->allocation = nullptr;
+                return nullptr;
+            }
+            if (name)
+                vmaSetAllocationName(global_allocator, heap->allocation, name);
+            return heap;
+        }
+
+        auto GpuDeviceVulkan::create_placed_texture(const GpuTextureDesc& desc, const std::shared_ptr<GpuMemoryHeap>& heap, u64 offset, const char* name) -> std::shared_ptr<GpuTexture>
+        {
+            auto vk_heap = static_cast<GpuMemoryHeapVulkan*>(heap.get());
+            auto vk_image = std::make_shared<GpuTextureVulkan>();
+            vk_image->desc = desc;
+            vk_image->heap = heap;
+            auto create_info = get_image_create_info(desc, false);
+            std::lock_guard<std::mutex> lock(cb_mutex);
+            if (vmaCreateAliasingImage2(global_allocator, vk_heap->allocation, offset, &create_info, &vk_image->image) != VK_SUCCESS)
+                return nullptr;
+            set_name(vk_image.get(), name);
+            return vk_image;
+        }
+
+        auto GpuDeviceVulkan::create_placed_buffer(const GpuBufferDesc& desc, const std::shared_ptr<GpuMemoryHeap>& heap, u64 offset, const char* name) -> std::shared_ptr<GpuBuffer>
+        {
+            auto vk_heap = static_cast<GpuMemoryHeapVulkan*>(heap.get());
+            VkBufferCreateInfo buffer_create_info = {};
+            buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            buffer_create_info.size = desc.size;
+            buffer_create_info.usage = (VkBufferUsageFlagBits)(desc.usage);
+            buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            VkBuffer buffer;
+            std::lock_guard<std::mutex> lock(cb_mutex);
+            if (vmaCreateAliasingBuffer2(global_allocator, vk_heap->allocation, offset, &buffer_create_info, &buffer) != VK_SUCCESS)
+                return nullptr;
+            auto vk_buffer = std::make_shared<GpuBufferVulkan>(buffer, desc, nullptr, VmaAllocationInfo{});
+            vk_buffer->heap = heap;
+            set_name(vk_buffer.get(), name);
+            return vk_buffer;
+        }
+
         auto GpuDeviceVulkan::create_image_view(const GpuTextureViewDesc& view_desc, const GpuTextureDesc& image_desc, VkImage image) const -> std::shared_ptr<GpuTextureViewVulkan>
         {
             if( image_desc.format == PixelFormat::D32_Float && ! (view_desc.aspect_mask & ImageAspectFlags::DEPTH))
@@ -1306,7 +1499,7 @@ namespace diverse
             pipeline_info.layout = pipeline_layout;
 
             VkPipeline pipeline;
-            VK_CHECK_RESULT(vkCreateComputePipelines(device, 0, 1, &pipeline_info, nullptr, &pipeline));
+            VK_CHECK_RESULT(vkCreateComputePipelines(device, pipeline_cache, 1, &pipeline_info, nullptr, &pipeline));
             if(desc.name.data() != nullptr)
             {
                 const auto name = desc.name.data();
@@ -1589,7 +1782,7 @@ namespace diverse
             graphic_pipeline_info.renderPass = static_cast<RenderPassVulkan*>(render_pass)->render_pass;
 
             VkPipeline pipeline;
-            VK_CHECK_RESULT(vkCreateGraphicsPipelines(device, nullptr, 1, &graphic_pipeline_info, nullptr, &pipeline));
+            VK_CHECK_RESULT(vkCreateGraphicsPipelines(device, pipeline_cache, 1, &graphic_pipeline_info, nullptr, &pipeline));
             if(desc.name.data() != nullptr)
             {
                 const auto name = desc.name.data();
@@ -1795,7 +1988,7 @@ namespace diverse
             VkPipeline pipeline;
             vkCreateRayTracingPipelinesKHR(device,
                 VK_NULL_HANDLE,
-                nullptr,
+                pipeline_cache,
                 1,
                 &info,
                 nullptr,
@@ -2448,9 +2641,12 @@ namespace diverse
         {
             std::lock_guard<std::mutex>	lock(frame_mutex[0]);
             auto& frame0 = frames[0];
-            VkFence	fences[2] = { dynamic_pointer_cast<GpuCommandBufferVulkan>(frame0.main_cmd_buf)->submit_done_fence , 
+            std::vector<VkFence> fences = { dynamic_pointer_cast<GpuCommandBufferVulkan>(frame0.main_cmd_buf)->submit_done_fence , 
                                 dynamic_pointer_cast<GpuCommandBufferVulkan>(frame0.presentation_cmd_buf)->submit_done_fence};
-            vkWaitForFences(device, 2, fences, true, UINT64_MAX);
+            for (auto& worker_cb : frame0.worker_cmd_bufs)
+                fences.push_back(dynamic_pointer_cast<GpuCommandBufferVulkan>(worker_cb)->submit_done_fence);
+            vkWaitForFences(device, (u32)fences.size(), fences.data(), true, UINT64_MAX);
+            read_timestamps(frame0);
     
             frame0.pending_resource_releases.release_all(device);
            // if( swapchain->current_frame_index() % 12 == 0)
@@ -2460,6 +2656,37 @@ namespace diverse
             return &frame0;
         }
 
+        auto GpuDeviceVulkan::read_timestamps(DeviceFrameVulkan& frame) -> void
+        {
+            frame.timestamps.clear();
+            if (!frame.timestamp_pool || frame.timestamp_queries == 0)
+                return;
+            // the fences signalled, queries the frame never wrote are the only ones left unavailable
+            std::vector<u64> results(frame.timestamp_queries * 2);
+            vkGetQueryPoolResults(device, frame.timestamp_pool, 0, frame.timestamp_queries, results.size() * sizeof(u64), results.data(), 2 * sizeof(u64), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+            frame.timestamps.resize(frame.timestamp_queries);
+            for (u32 i = 0; i < frame.timestamp_queries; i++)
+                frame.timestamps[i] = results[i * 2 + 1] ? static_cast<u64>(results[i * 2] * static_cast<f64>(timestamp_period)) : 0;
+            frame.timestamp_queries = 0;
+        }
+
+        auto GpuDeviceVulkan::reset_timestamp_queries(CommandBuffer* cb, u32 count) -> void
+        {
+            auto& frame = frames[0];
+            if (!frame.timestamp_pool)
+                return;
+            frame.timestamp_queries = std::min(count, timestamp_capacity);
+            vkCmdResetQueryPool(static_cast<GpuCommandBufferVulkan*>(cb)->handle, frame.timestamp_pool, 0, frame.timestamp_queries);
+        }
+
+        auto GpuDeviceVulkan::write_timestamp(CommandBuffer* cb, u32 query) -> void
+        {
+            auto& frame = frames[0];
+            if (!frame.timestamp_pool || query >= frame.timestamp_queries)
+                return;
+            vkCmdWriteTimestamp(static_cast<GpuCommandBufferVulkan*>(cb)->handle, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.timestamp_pool, query);
+        }
+
         void GpuDeviceVulkan::end_frame(DeviceFrame* frameRes)
         {
             std::lock_guard<std::mutex>	lock0(frame_mutex[0]);
@@ -2548,6 +2775,73 @@ namespace diverse
             vk::pipeline_barrier(device, vk_cb->handle, gb_barrier, {}, {});
         }
 
+        auto GpuDeviceVulkan::record_barriers(CommandBuffer* cb, const std::optional<GlobalBarrier>& global, const std::vector<BufferBarrier>& buffers, const std::vector<ImageBarrier>& images) -> void
+        {
+            auto vk_cb = dynamic_cast<GpuCommandBufferVulkan*>(cb);
+            u32 queue_family_index = universe_queue.family.index;
+            if (vk_cb->family_index == compute_queue.family.index) {
+                queue_family_index = compute_queue.family.index;
+            }
+            else if (vk_cb->family_index == transfer_queue.family.index) {
+                queue_family_index = transfer_queue.family.index;
+            }
+
+            vk::GlobalBarrier gb_barrier;
+            if (global)
+                gb_barrier = { global->previous_accesses, global->next_accesses };
+
+            std::vector<vk::BufferBarrier> vk_buffers;
+            vk_buffers.reserve(buffers.size());
+            for (const auto& barrier : buffers)
+            {
+                vk_buffers.push_back(vk::BufferBarrier{
+                    {barrier.prev_access},
+                    {barrier.next_access},
+                    queue_family_index,
+                    queue_family_index,
+                    static_cast<rhi::GpuBufferVulkan*>(barrier.buffer)->handle,
+                    barrier.offset,
+                    barrier.size
+                });
+            }
+
+            std::vector<vk::ImageBarrier> vk_images;
+            vk_images.reserve(images.size());
+            for (const auto& barrier : images)
+            {
+                // read->read without a layout change only orders execution, the global barrier covers that
+                if (!barrier.discard && !is_write_access(barrier.prev_access) && !is_write_access(barrier.next_access) &&
+                    vk::get_access_info(barrier.prev_access).image_layout == vk::get_access_info(barrier.next_access).image_layout)
+                {
+                    gb_barrier.previous_accesses.push_back(barrier.prev_access);
+                    gb_barrier.next_accesses.push_back(barrier.next_access);
+                    continue;
+                }
+                VkImageSubresourceRange	range = {};
+                range.aspectMask = image_aspect_flag_2_vk(barrier.aspect_mask);
+                range.levelCount = VK_REMAINING_MIP_LEVELS;
+                range.layerCount = VK_REMAINING_ARRAY_LAYERS;
+                vk_images.push_back(vk::ImageBarrier{
+                    {barrier.prev_access},
+                    {barrier.next_access},
+                    vk::ImageLayout::Optimal,
+                    vk::ImageLayout::Optimal,
+                    barrier.discard,
+                    queue_family_index,
+                    queue_family_index,
+                    static_cast<rhi::GpuTextureVulkan*>(barrier.image)->image,
+                    range
+                });
+            }
+
+            std::optional<vk::GlobalBarrier> vk_global;
+            if (!gb_barrier.previous_accesses.empty() || !gb_barrier.next_accesses.empty())
+                vk_global = std::move(gb_barrier);
+            if (!vk_global && vk_buffers.empty() && vk_images.empty())
+                return;
+            vk::pipeline_barrier(device, vk_cb->handle, vk_global, vk_buffers, vk_images);
+        }
+
         auto GpuCommandBufferVulkan::begin() -> void
         {
             vkResetCommandBuffer(handle, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
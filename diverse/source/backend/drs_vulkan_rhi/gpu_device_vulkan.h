@@ -72,6 +72,13 @@ namespace diverse
             VkSemaphore swapchain_acquired_semaphore;
             VkSemaphore rendering_complete_semaphore;
             PendingResourceReleases   pending_resource_releases;
+            VkQueryPool             timestamp_pool = VK_NULL_HANDLE;
+        };
+
+        struct GpuMemoryHeapVulkan : public GpuMemoryHeap
+        {
+            ~GpuMemoryHeapVulkan();
+            VmaAllocation allocation{};
         };
 
         struct GpuDeviceVulkan : public GpuDevice
@@ -114,8 +121,24 @@ namespace diverse
             std::mutex			cb_mutex;
             std::mutex			frame_mutex[2];
             std::vector<DeferedReleaseResource>  destroy_queue;
+            // driver pipeline cache, loaded from cache/pipeline_cache.bin at startup and written back on shutdown
+            VkPipelineCache     pipeline_cache = VK_NULL_HANDLE;
+            auto    pipeline_cache_path() const -> std::string;
+            auto    load_pipeline_cache() -> void;
+            auto    save_pipeline_cache() -> void;
+            u32                 timestamp_capacity = 0;
+            f32                 timestamp_period = 0.0f;   // ns per tick
+            auto    read_timestamps(DeviceFrameVulkan& frame) -> void;
         public:
             auto get_graphics_cmd_buffer()->CommandBuffer* override {return graphics_queue_setup_cb.get();}
+            auto get_memory_requirements(const GpuTextureDesc& desc) -> std::optional<GpuMemoryRequirements> override;
+            auto get_memory_requirements(const GpuBufferDesc& desc) -> std::optional<GpuMemoryRequirements> override;
+            auto create_memory_heap(u64 size, u32 memory_type_bits, const char* name = nullptr) -> std::shared_ptr<GpuMemoryHeap> override;
+            auto create_placed_texture(const GpuTextureDesc& desc, const std::shared_ptr<GpuMemoryHeap>& heap, u64 offset, const char* name = nullptr) -> std::shared_ptr<GpuTexture> override;
+            auto create_placed_buffer(const GpuBufferDesc& desc, const std::shared_ptr<GpuMemoryHeap>& heap, u64 offset, const char* name = nullptr) -> std::shared_ptr<GpuBuffer> override;
+            auto timestamp_query_capacity() -> u32 override { return timestamp_capacity; }
+            auto reset_timestamp_queries(CommandBuffer* cb, u32 count) -> void override;
+            auto write_timestamp(CommandBuffer* cb, u32 query) -> void override;
         public:
             //auto get_min_offset_alignment(const GpuBufferDesc& desc) -> u64 override;
             auto create_render_command_buffer(const char* name = nullptr) -> std::shared_ptr<CommandBuffer> override;
@@ -154,6 +177,7 @@ namespace diverse
             auto record_image_barrier(CommandBuffer* cb, const ImageBarrier& barrier) -> void override;
             auto record_buffer_barrier(CommandBuffer* cb, const BufferBarrier& barrier)->void override;
             auto record_global_barrier(CommandBuffer* cb,const std::vector<rhi::AccessType>& previous_accesses, const std::vector<rhi::AccessType>& next_accesses) -> void override;
+            auto record_barriers(CommandBuffer* cb, const std::optional<GlobalBarrier>& global, const std::vector<BufferBarrier>& buffers, const std::vector<ImageBarrier>& images) -> void override;
 
             auto dispatch(CommandBuffer* cb,const std::array<u32, 3>& group_dim,const std::array<u32,3>& group_size) -> void;
             auto dispatch_indirect(CommandBuffer* cb,GpuBuffer* args_buffer, u64 args_buffer_offset) -> void;
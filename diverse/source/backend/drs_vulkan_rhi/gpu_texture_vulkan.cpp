@@ -276,13 +276,11 @@ namespace diverse
         auto GpuTextureVulkan::view(const GpuDevice* device, const GpuTextureViewDesc& view_desc) -> std::shared_ptr<GpuTextureView>
         {
             auto vk_device = dynamic_cast<const GpuDeviceVulkan*>(device);
+            std::lock_guard<std::mutex> lock(view_mutex);
             auto it = views.find(view_desc);
             if (it == views.end())
-            {
-                auto img_view = vk_device->create_image_view(view_desc, desc, image);
-                views[view_desc] = std::move(img_view);
-            }
-            return views[view_desc];
+                it = views.emplace(view_desc, vk_device->create_image_view(view_desc, desc, image)).first;
+            return it->second;
         }
         auto GpuTextureVulkan::view_desc(const GpuTextureViewDesc& view_desc) -> VkImageViewCreateInfo
         {
@@ -8,6 +8,8 @@ namespace diverse
 	namespace rhi
 	{
 
+		struct GpuMemoryHeap;
+
 		struct GpuTextureViewVulkan : public GpuTextureView
 		{
 			GpuTextureViewVulkan(VkImageView view):img_view(view){}
@@ -20,7 +22,9 @@ namespace diverse
 			~GpuTextureVulkan();
 			VkImage	image = VK_NULL_HANDLE;
 			VmaAllocation allocation{};
+			std::shared_ptr<GpuMemoryHeap> heap; // set for placed textures, which own no allocation
 			std::unordered_map<GpuTextureViewDesc, std::shared_ptr<GpuTextureView>>	views;
+			std::mutex view_mutex; // views are created lazily, also from render graph worker threads
 			bool b_swapchin = false;
 			auto view(const struct GpuDevice* device, const GpuTextureViewDesc& desc) -> std::shared_ptr<GpuTextureView>;
 			auto view_desc( const GpuTextureViewDesc& view_desc)->VkImageViewCreateInfo;
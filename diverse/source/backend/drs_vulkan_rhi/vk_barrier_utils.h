@@ -365,31 +365,6 @@ namespace vk
 		};
 	}
 
-	inline auto is_write_access(diverse::rhi::AccessType access_type) -> bool
-	{
-		switch (access_type)
-		{
-		case	diverse::rhi::AccessType::CommandBufferWriteNVX: return true;
-		case	diverse::rhi::AccessType::VertexShaderWrite: return true;
-		case	diverse::rhi::AccessType::TessellationControlShaderWrite: return true;
-		case	diverse::rhi::AccessType::TessellationEvaluationShaderWrite: return true;
-		case	diverse::rhi::AccessType::GeometryShaderWrite: return true;
-		case	diverse::rhi::AccessType::FragmentShaderWrite: return true;
-		case	diverse::rhi::AccessType::ColorAttachmentWrite: return true;
-		case	diverse::rhi::AccessType::DepthStencilAttachmentWrite: return true;
-		case	diverse::rhi::AccessType::DepthAttachmentWriteStencilReadOnly: return true;
-		case	diverse::rhi::AccessType::StencilAttachmentWriteDepthReadOnly: return true;
-		case	diverse::rhi::AccessType::ComputeShaderWrite:  return true;
-		case	diverse::rhi::AccessType::AnyShaderWrite:  return true;
-		case	diverse::rhi::AccessType::TransferWrite:  return true;
-		case	diverse::rhi::AccessType::HostWrite:  return true;
-		case	diverse::rhi::AccessType::ColorAttachmentReadWrite: return true;
-		case	diverse::rhi::AccessType::General:  return true;
-		default:  return false;
-		}
-
-		return false;
-	}
 	/// Image barriers should only be used when a queue family ownership transfer
 	/// or an image layout transition is required - prefer global barriers at all
 	/// other times.
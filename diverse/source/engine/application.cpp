@@ -9,6 +9,8 @@
 #include "engine/os.h"
 #include "engine/file_system.h"
 #include "engine/core_system.h"
+#include "core/frame_arena.h"
+#include "core/memory_manager.h"
 #include "core/profiler.h"
 #include "core/job_system.h"
 #include "events/application_event.h"
@@ -110,7 +112,11 @@ namespace diverse
         //#ifdef DS_PLATFORM_MACOS
         //       auto device = rhi::create_device(-1, RenderAPI::METAL);
         //#else
-        auto device = rhi::create_device(-1, RenderAPI::VULKAN);
+        // DS_RENDER_API=null runs the whole frame on the headless device, for cpu profiling without a gpu
+        auto render_api = RenderAPI::VULKAN;
+        if (const char* env = getenv("DS_RENDER_API"); env && strcmp(env, "null") == 0)
+            render_api = RenderAPI::NONE;
+        auto device = rhi::create_device(-1, render_api);
         //#endif
         auto swap_chain = device->create_swapchain(rhi::SwapchainDesc{ swapchain_extent, false }, Application::get().get_window());
 
@@ -131,12 +137,14 @@ namespace diverse
         imgui_manager->init();
         DS_LOG_INFO("Initialised ImGui Manager");
 
+        build_frame_stages();
         current_state = AppState::Running;
     }
 
     void Application::quit()
     {
         DS_PROFILE_FUNCTION();
+        frame_scheduler.clear();
         serialise();
 
         ArenaRelease(frame_arena);
@@ -183,11 +191,14 @@ namespace diverse
         DS_PROFILE_FUNCTION();
         DS_PROFILE_FRAMEMARKER();
         ArenaClear(frame_arena);
+        FrameArenaAdvance();
 
         if (scene_manager->get_switching_scene())
         {
             DS_PROFILE_SCOPE("Application::SceneSwitch");
             //wait idle
+            frame_scheduler.wait_carry_over();
+            DS_MEMORY_TAG(Scene);
             scene_manager->apply_scene_switch();
             return current_state != AppState::Closing;
         }
@@ -223,54 +234,17 @@ namespace diverse
             ImGui::NewFrame();
         }
 
-        System::JobSystem::Context context;
-        {
-            DS_PROFILE_SCOPE("Application::Update");
-            update(ts);
-
-            System::JobSystem::execute(context, [](JobDispatchArgs args)
-                { Application::update_systems(); });
-
-            update_cnts++;
-        }
+        frame_scheduler.run();
+        update_cnts++;
 
         // Exit frame early if escape or close button clicked
         // Prevents a crash with vulkan/moltenvk
-        if (current_state == AppState::Closing && !scene_save_on_close)
+        if (closing_without_save())
         {
-            System::JobSystem::wait(context);
+            frame_scheduler.wait_carry_over();
             return false;
         }
 
-        if (!is_minimized)
-        {
-            DS_PROFILE_SCOPE("Application::Render");
-            
-            imgui_manager->render([&](){imgui_render();});
-            DebugRenderer::Reset();
-            debug_draw();
-            render();
-            frame_cnts++;
-        }
-        else
-        {
-            ImGui::Render();
-        }
-
-        {
-            DS_PROFILE_SCOPE("Application::UpdateGraphicsStats");
-        }
-
-        {
-            DS_PROFILE_SCOPE("Application::WindowUpdate");
-            window->update_cursor_imgui();
-            window->on_update();
-        }
-
-        {
-            System::JobSystem::wait(context);
-        }
-
         if (now - second_timer > 1.0f)
         {
             DS_PROFILE_SCOPE("Application::FrameRateCalc");
@@ -290,6 +264,57 @@ namespace diverse
     }
 
 
+    void Application::build_frame_stages()
+    {
+        frame_scheduler.clear();
+
+        frame_scheduler.add_stage(FrameStageDesc("Application::Update", [this]() {
+            update(Engine::get_time_step());
+        }).write("Scene"));
+
+        frame_scheduler.add_stage(FrameStageDesc("Application::UpdateSystems", []() {
+            Application::update_systems();
+        }).write("Systems").on_any_thread());
+
+        // the stages below are skipped when closing, vulkan/moltenvk crashes when rendering into a closing window
+        frame_scheduler.add_stage(FrameStageDesc("Application::ImGui", [this]() {
+            if (closing_without_save())
+                return;
+            DS_MEMORY_TAG(UI);
+            if (!is_minimized)
+                imgui_manager->render([&]() { imgui_render(); });
+            else
+                ImGui::Render();
+        }).read("MemoryStats").write("Scene").write("UI"));
+
+        frame_scheduler.add_stage(FrameStageDesc("Application::DebugDraw", [this]() {
+            if (closing_without_save() || is_minimized)
+                return;
+            DebugRenderer::Reset();
+            debug_draw();
+        }).read("Scene").write("DebugDraw"));
+
+        frame_scheduler.add_stage(FrameStageDesc("Application::Render", [this]() {
+            if (closing_without_save() || is_minimized)
+                return;
+            render();
+            frame_cnts++;
+        }).read("Scene").read("UI").read("DebugDraw").write("GPU"));
+
+        frame_scheduler.add_stage(FrameStageDesc("Application::WindowUpdate", [this]() {
+            if (closing_without_save())
+                return;
+            window->update_cursor_imgui();
+            window->on_update();
+        }).read("UI").write("Window"));
+
+        // the memory panel reads the rates during the next frame's ImGui stage, which joins this first; until then
+        // the sample overlaps the next frame's time step, input and update
+        frame_scheduler.add_stage(FrameStageDesc("Application::MemorySample", []() {
+            MemoryManager::get()->sample();
+        }).write("MemoryStats").on_any_thread().overlap_next_frame());
+    }
+
     void Application::update_systems()
     {
         DS_PROFILE_FUNCTION();
@@ -11,6 +11,7 @@
 #include "maths/transform.h"
 #include "scene/scene_manager.h"
 #include "engine/file_system.h"
+#include "engine/frame_scheduler.h"
 #include <entt/entity/registry.hpp>
 namespace diverse
 {
@@ -237,8 +238,12 @@ namespace diverse
         void open_project(const std::string& filePath);
 
         Arena* get_frame_arena() const { return frame_arena; }
+        //stages added here run every frame after the built-in ones, ordered by the resources they declare
+        FrameScheduler& get_frame_scheduler() { return frame_scheduler; }
     protected:
         bool handle_window_close(WindowCloseEvent& e);
+        void build_frame_stages();
+        bool closing_without_save() const { return current_state == AppState::Closing && !scene_save_on_close; }
         ProjectSettings project_settings;
         bool project_loaded = false;
         bool scene_save_on_close = false;
@@ -262,6 +267,7 @@ namespace diverse
         UniquePtr<ImGuiManager> imgui_manager;
         UniquePtr<DeferedRenderer> main_renderer;
         UniquePtr<SceneManager> scene_manager;
+        FrameScheduler      frame_scheduler;
         //UniquePtr<SystemManager> m_SystemManager;
 
         static Application* s_Instance;
@@ -37,6 +37,8 @@ namespace diverse
                 "that it requires a line break!");
         }
 
+        MemoryManager::on_init();
+
         // Init Jobsystem. Reserve 2 threads for main and render threads
         System::JobSystem::init(2);
         DS_LOG_INFO("Initialising System");
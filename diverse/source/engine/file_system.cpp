@@ -65,21 +65,20 @@ namespace diverse
         }
 
         // Assume path starts with //Assets
+        String8 vfsPath  = Str8StdS(path);
+        String8 relative = Str8Skip(vfsPath, 8);
 #ifndef DS_PRODUCTION
-        if(path.substr(2, 6) != "assets")
+        if(!Str8Match(Substr8(vfsPath, { 2, 8 }), Str8Lit("assets")))
         {
             // Previously paths saved in scenes could be like //Textures and then converted to .../assets/textures/...
-            outPhysicalPath = ToStdString(m_AssetRootPath) + path.substr(1, path.size());
-            return folder ? FileSystem::folder_exists(outPhysicalPath) : FileSystem::file_exists(outPhysicalPath);
+            relative = Str8Skip(vfsPath, 1);
         }
-        else
 #endif
-        {
-            outPhysicalPath = ToStdString(m_AssetRootPath) + path.substr(8, path.size());
-            return folder ? FileSystem::folder_exists(outPhysicalPath) : FileSystem::file_exists(outPhysicalPath);
-        }
-
-        return false;
+        ArenaTemp scratch = ScratchBegin(nullptr, 0);
+        String8 physical  = Str8PathNormalize(scratch.arena, Str8PathJoin(scratch.arena, m_AssetRootPath, relative));
+        outPhysicalPath.assign((const char*)physical.str, physical.size);
+        ScratchEnd(scratch);
+        return folder ? FileSystem::folder_exists(outPhysicalPath) : FileSystem::file_exists(outPhysicalPath);
     }
 
     uint8_t* FileSystem::read_file_vfs(const std::string& path)
@@ -113,8 +112,9 @@ namespace diverse
     bool FileSystem::absolute_path_2_fileSystem(const std::string& path, std::string& outFileSystemPath, bool folder)
     {
         DS_PROFILE_FUNCTION();
-        std::string updatedPath = path;
-        std::replace(updatedPath.begin(), updatedPath.end(), '\\', '/');
+        ArenaTemp scratch       = ScratchBegin(nullptr, 0);
+        std::string updatedPath = ToStdString(Str8PathNormalize(scratch.arena, Str8StdS(path)));
+        ScratchEnd(scratch);
 
         if(updatedPath.find(ToStdString(m_AssetRootPath)) != std::string::npos)
         {
@@ -0,0 +1,182 @@
+#include "frame_scheduler.h"
+#include "core/profiler.h"
+#include "core/ds_log.h"
+#include <thread>
+#include <algorithm>
+
+namespace diverse
+{
+    FrameScheduler::~FrameScheduler()
+    {
+        wait_carry_over();
+    }
+
+    auto FrameScheduler::add_stage(FrameStageDesc desc) -> u32
+    {
+        wait_carry_over();
+        stages.push_back(std::make_unique<Stage>(std::move(desc)));
+        compiled = false;
+        return (u32)stages.size() - 1;
+    }
+
+    auto FrameScheduler::clear() -> void
+    {
+        wait_carry_over();
+        stages.clear();
+        timings[0].clear();
+        timings[1].clear();
+        published_timings.clear();
+        compiled = false;
+    }
+
+    auto FrameScheduler::conflicts(const FrameStageDesc& a, const FrameStageDesc& b) const -> bool
+    {
+        auto intersects = [](const std::vector<FrameResource>& x, const std::vector<FrameResource>& y) {
+            for (auto r : x)
+            {
+                if (std::find(y.begin(), y.end(), r) != y.end())
+                    return true;
+            }
+            return false;
+        };
+        return intersects(a.writes, b.writes) || intersects(a.writes, b.reads) || intersects(a.reads, b.writes);
+    }
+
+    auto FrameScheduler::compile() -> void
+    {
+        num_blocking = 0;
+        for (auto& stage : stages)
+        {
+            stage->successors.clear();
+            stage->num_dependencies = 0;
+            stage->waits_carry_over = false;
+        }
+        for (auto& stage : stages)
+        {
+            // run() returns once the blocking stages are done, nobody would be left to run it on the main thread
+            if (stage->desc.carry_over && stage->desc.thread == StageThread::Main)
+            {
+                DS_LOG_WARN("FrameScheduler: carry over stage {} must run on any thread, it is no longer overlapped", stage->desc.name);
+                stage->desc.carry_over = false;
+            }
+        }
+        for (u32 j = 0; j < stages.size(); j++)
+        {
+            for (u32 i = 0; i < j; i++)
+            {
+                if (!conflicts(stages[i]->desc, stages[j]->desc))
+                    continue;
+                if (stages[i]->desc.carry_over)
+                {
+                    DS_LOG_WARN("FrameScheduler: stage {} depends on carry over stage {}, it is no longer overlapped", stages[j]->desc.name, stages[i]->desc.name);
+                    stages[i]->desc.carry_over = false;
+                }
+                stages[i]->successors.push_back(j);
+                stages[j]->num_dependencies++;
+            }
+            // a carry over stage from the previous frame may still run, wait for it before touching its resources
+            for (u32 i = 0; i < stages.size(); i++)
+            {
+                if (stages[i]->desc.carry_over && (i == j || conflicts(stages[i]->desc, stages[j]->desc)))
+                    stages[j]->waits_carry_over = true;
+            }
+        }
+        for (auto& stage : stages)
+            num_blocking += stage->desc.carry_over ? 0 : 1;
+        compiled = true;
+    }
+
+    auto FrameScheduler::launch(u32 idx, u32 slot) -> void
+    {
+        auto& stage = *stages[idx];
+        if (stage.desc.thread == StageThread::Main)
+        {
+            std::scoped_lock lock(main_mutex);
+            main_ready.push_back(idx);
+            return;
+        }
+        if (stage.waits_carry_over)
+            System::JobSystem::wait(carry_ctx);
+        System::JobSystem::execute(stage.desc.carry_over ? carry_ctx : frame_ctx, [this, idx, slot](JobDispatchArgs) { execute(idx, slot); });
+    }
+
+    auto FrameScheduler::execute(u32 idx, u32 slot) -> void
+    {
+        auto& stage = *stages[idx];
+        const auto start = std::chrono::steady_clock::now();
+        {
+            DS_PROFILE_SCOPE_DYNAMIC(stage.desc.name.c_str(), stage.desc.name.size());
+            stage.desc.run();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        auto& timing = timings[slot][idx];
+        timing.start_ms = std::chrono::duration<f64, std::milli>(start - frame_start[slot]).count();
+        timing.duration_ms = std::chrono::duration<f64, std::milli>(end - start).count();
+        timing.main_thread = stage.desc.thread == StageThread::Main;
+
+        for (auto succ : stage.successors)
+        {
+            if (stages[succ]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                launch(succ, slot);
+        }
+        if (!stage.desc.carry_over)
+            num_finished.fetch_add(1, std::memory_order_release);
+    }
+
+    auto FrameScheduler::run() -> void
+    {
+        DS_PROFILE_FUNCTION();
+        if (!compiled)
+            compile();
+
+        // the slot was last written two frames ago, the carry over stages of that frame were joined during the previous run()
+        frame_slot ^= 1;
+        const u32 slot = frame_slot;
+        frame_start[slot] = std::chrono::steady_clock::now();
+        timings[slot].resize(stages.size());
+        for (u32 i = 0; i < stages.size(); i++)
+        {
+            timings[slot][i].name = stages[i]->desc.name.c_str();
+            stages[i]->remaining.store(stages[i]->num_dependencies, std::memory_order_relaxed);
+        }
+        num_finished.store(0, std::memory_order_relaxed);
+
+        for (u32 i = 0; i < stages.size(); i++)
+        {
+            if (stages[i]->num_dependencies == 0)
+                launch(i, slot);
+        }
+
+        while (num_finished.load(std::memory_order_acquire) < num_blocking)
+        {
+            u32 next = ~0u;
+            {
+                std::scoped_lock lock(main_mutex);
+                if (!main_ready.empty())
+                {
+                    // keep declaration order among the ready main thread stages
+                    auto it = std::min_element(main_ready.begin(), main_ready.end());
+                    next = *it;
+                    main_ready.erase(it);
+                }
+            }
+            if (next != ~0u)
+            {
+                if (stages[next]->waits_carry_over)
+                    System::JobSystem::wait(carry_ctx);
+                execute(next, slot);
+            }
+            else
+                std::this_thread::yield();
+        }
+        System::JobSystem::wait(frame_ctx);
+        // every carry over stage waits for its previous frame's instance before it is launched, and all of them
+        // were launched before the blocking stages above finished: the previous frame's slot is complete
+        published_timings = timings[slot ^ 1];
+    }
+
+    auto FrameScheduler::wait_carry_over() -> void
+    {
+        System::JobSystem::wait(carry_ctx);
+    }
+}
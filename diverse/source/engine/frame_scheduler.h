@@ -0,0 +1,112 @@
+#pragma once
+#include "core/core.h"
+#include "core/job_system.h"
+#include <entt/core/hashed_string.hpp>
+#include <entt/core/type_info.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <chrono>
+
+namespace diverse
+{
+    // Something a frame stage touches: a component type or a named engine subsystem.
+    using FrameResource = u32;
+
+    template <typename T>
+    inline auto frame_resource() -> FrameResource { return entt::type_hash<T>::value(); }
+    inline auto frame_resource(const char* name) -> FrameResource { return entt::hashed_string::value(name); }
+
+    enum class StageThread : u8
+    {
+        Main,   // imgui, window and gpu submission stay on the thread that called run()
+        Any     // runs on the JobSystem
+    };
+
+    struct FrameStageDesc
+    {
+        std::string                 name;
+        std::function<void()>       run;
+        std::vector<FrameResource>  reads;
+        std::vector<FrameResource>  writes;
+        StageThread                 thread = StageThread::Main;
+        // the stage may keep running after run() returns, it is joined before the next frame's conflicting stage.
+        // such a stage cannot have successors in the same frame
+        bool                        carry_over = false;
+
+        FrameStageDesc(const std::string& name, std::function<void()> run)
+            : name(name), run(std::move(run)) {}
+
+        template <typename... T>
+        auto read() -> FrameStageDesc& { (reads.push_back(frame_resource<T>()), ...); return *this; }
+        template <typename... T>
+        auto write() -> FrameStageDesc& { (writes.push_back(frame_resource<T>()), ...); return *this; }
+        auto read(const char* name) -> FrameStageDesc& { reads.push_back(frame_resource(name)); return *this; }
+        auto write(const char* name) -> FrameStageDesc& { writes.push_back(frame_resource(name)); return *this; }
+        auto on_any_thread() -> FrameStageDesc& { thread = StageThread::Any; return *this; }
+        auto overlap_next_frame() -> FrameStageDesc& { carry_over = true; return *this; }
+    };
+
+    struct FrameStageTiming
+    {
+        const char* name;
+        f64         start_ms;       // relative to the start of run()
+        f64         duration_ms;
+        bool        main_thread;
+    };
+
+    // Runs the stages of a frame as a task graph. Stages are declared in program order; a stage depends on
+    // every earlier stage it conflicts with (write/write or read/write on a shared resource), independent
+    // stages run concurrently on the JobSystem.
+    class FrameScheduler
+    {
+    public:
+        FrameScheduler() = default;
+        ~FrameScheduler();
+
+        auto add_stage(FrameStageDesc desc) -> u32;
+        auto clear() -> void;
+
+        auto run() -> void;
+        // joins the stages still running from the previous frame
+        auto wait_carry_over() -> void;
+
+        // timings of the frame before the last run(), the newest frame whose carry over stages are known to be done
+        auto last_timings() const -> const std::vector<FrameStageTiming>& { return published_timings; }
+        auto num_stages() const -> u32 { return (u32)stages.size(); }
+
+    private:
+        struct Stage
+        {
+            FrameStageDesc      desc;
+            std::vector<u32>    successors;
+            u32                 num_dependencies = 0;
+            bool                waits_carry_over = false;
+            std::atomic<u32>    remaining { 0 };
+
+            Stage(FrameStageDesc desc) : desc(std::move(desc)) {}
+        };
+
+        auto compile() -> void;
+        auto launch(u32 stage, u32 slot) -> void;
+        auto execute(u32 stage, u32 slot) -> void;
+        auto conflicts(const FrameStageDesc& a, const FrameStageDesc& b) const -> bool;
+
+        std::vector<std::unique_ptr<Stage>> stages;
+        bool                                compiled = false;
+
+        System::JobSystem::Context          frame_ctx;
+        System::JobSystem::Context          carry_ctx;
+        std::mutex                          main_mutex;
+        std::vector<u32>                    main_ready;
+        std::atomic<u32>                    num_finished { 0 };
+        u32                                 num_blocking = 0; // stages run() waits for
+        // double buffered per frame, a carry over stage still writes its frame's slot while the next run() fills the other
+        u32                                 frame_slot = 0;
+        std::chrono::steady_clock::time_point frame_start[2];
+        std::vector<FrameStageTiming>       timings[2];
+        std::vector<FrameStageTiming>       published_timings;
+    };
+}
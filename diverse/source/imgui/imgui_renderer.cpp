@@ -13,6 +13,33 @@ namespace diverse
     auto extern create_vk_imgui_renderer(rhi::GpuDevice* dev, rhi::Swapchain* swapchain)->IMGUIRenderer*;
     auto extern create_metal_imgui_renderer(rhi::GpuDevice* dev, rhi::Swapchain* swapchain)->IMGUIRenderer*;
 
+    // Used with the null device: builds the ui every frame so its cpu cost is still measured, but draws nothing
+    class NullIMGUIRenderer : public IMGUIRenderer
+    {
+    public:
+        NullIMGUIRenderer(rhi::GpuDevice* dev, rhi::Swapchain* swapchain) : IMGUIRenderer(dev, swapchain) {}
+
+        void init() override
+        {
+            handle_resize(m_Width, m_Height);
+            rebuild_font_texture();
+        }
+        void new_frame() override {}
+        void render(rhi::CommandBuffer* cmd_buf) override { ImGui::Render(); }
+        void handle_resize(uint32_t width, uint32_t height) override
+        {
+            m_Width = width;
+            m_Height = height;
+            for (auto& tex : target_tex)
+                tex = create_texture(width, height);
+        }
+        void rebuild_font_texture() override
+        {
+            IMGUIRenderer::rebuild_font_texture();
+            ImGui::GetIO().Fonts->TexID = (ImTextureID)&m_FontTextureID;
+        }
+    };
+
     IMGUIRenderer* IMGUIRenderer::create(rhi::GpuDevice* dev, rhi::Swapchain* swapchain)
     {
         switch (get_render_api())
@@ -21,6 +48,8 @@ namespace diverse
         {
            return create_vk_imgui_renderer(dev, swapchain);
         };
+        case RenderAPI::NONE:
+            return new NullIMGUIRenderer(dev, swapchain);
 #ifdef DS_RENDER_API_METAL
         case RenderAPI::METAL:
                 return create_metal_imgui_renderer(dev, swapchain);
@@ -35,6 +35,7 @@
 #include "utility/cmd_variable.h"
 
 #include <execution>
+#include <unordered_set>
 #define MATERIAL_BUFFER_CAPACITY 1024 * 512
 #define MAX_GPU_MESHES (1024 * 256)
 #define VERTEX_BUFFER_CAPACITY (1024 * 1024 * 1024 * 1)
@@ -278,17 +279,15 @@ namespace diverse
 			const auto& [gs_com, trans] = group.get<GaussianComponent, maths::Transform>(gs_ent);
 			if(!gs_com.ModelRef->is_flag_set(AssetFlag::UploadedGpu) || !gs_com.participate_render) continue;
 			skip_render |= gs_com.skip_render;
-			if (gs_com.ModelRef->gaussians_buf && model_2_gs_buf_id.find(gs_com.ModelRef.get()) != model_2_gs_buf_id.end())
+			if (gs_com.ModelRef->gaussians_buf && model_2_gs_buf_id.find(gs_com.ModelRef->handle) != model_2_gs_buf_id.end())
 			{ 
-				auto offset = -gs_com.black_point + gs_com.brightness;
-				auto scale = 1.0f / (gs_com.white_point - gs_com.black_point);
 				gs_command_queue.push_back(RenderGSCommand{ trans, 
 											gs_com.ModelRef, 
 											(u32)gs_com.sh_degree,
 											g_render_settings.select_color,
 											g_render_settings.locked_color,
-											glm::vec4(gs_com.albedo_color.xyz * scale, gs_com.transparency),
-											glm::vec3(offset,offset,offset)});
+											gs_com.color_adjustment.tint_color(),
+											gs_com.color_adjustment.color_offset()});
 				
 				const auto crop = Entity(gs_ent, current_scene).try_get_component<GaussianCrop>();
 				if (crop)
@@ -310,7 +309,7 @@ namespace diverse
 
 			const auto& [pcd_com, trans] = pointcloud_group.get<PointCloudComponent, maths::Transform>(pcd);
 			if(!pcd_com.ModelRef->is_flag_set(AssetFlag::UploadedGpu) ) continue;
-			if (pcd_com.ModelRef->vertex_buffer && model_2_point_buf_id.find(pcd_com.ModelRef.get()) != model_2_point_buf_id.end())
+			if (pcd_com.ModelRef->vertex_buffer && model_2_point_buf_id.find(pcd_com.ModelRef->handle) != model_2_point_buf_id.end())
 			{ 
 				point_command_queue.push_back(RenderPointCommand{ trans, 
 											pcd_com.ModelRef});
@@ -388,21 +387,28 @@ namespace diverse
 	auto DeferedRenderer::upload_gpu_buffers()->void
 	{
 		auto& registry = current_scene->get_registry();
+		release_unreferenced_buf_slots();
 		auto group = registry.group<GaussianComponent>(entt::get<maths::Transform>);
 		for (auto gs_ent : group)
 		{
 			const auto& [model, trans] = group.get<GaussianComponent, maths::Transform>(gs_ent);
 			if (!model.ModelRef->is_flag_set(AssetFlag::UploadedGpu)) continue;
-			u32 v_buf_id = model_2_gs_buf_id.size();
-			if (model.ModelRef->gaussians_buf && model_2_gs_buf_id.find(model.ModelRef.get()) == model_2_gs_buf_id.end())
+			auto it = model_2_gs_buf_id.find(model.ModelRef->handle);
+			// buffers grown by an append keep their slot, only the descriptors are rewritten
+			const bool buffers_changed = it != model_2_gs_buf_id.end() && model_2_gs_buf_version[model.ModelRef->handle] != model.ModelRef->gpu_buffer_version;
+			if (model.ModelRef->gaussians_buf && (it == model_2_gs_buf_id.end() || buffers_changed))
 			{
+				auto slot = buffers_changed ? it->second : gs_buf_slots.allocate();
+				if (!slot.valid()) continue;
+				const u32 v_buf_id = slot.index;
 				g_device->write_descriptor_set(bindless_descriptor_set.get(), GS_BINDING_ID, model.ModelRef->gaussians_buf.get(), v_buf_id * 4 + 0);
 				g_device->write_descriptor_set(bindless_descriptor_set.get(), GS_BINDING_ID, model.ModelRef->gaussians_sh_0_buf.get(), v_buf_id * 4 + 1);
 				g_device->write_descriptor_set(bindless_descriptor_set.get(), GS_BINDING_ID, model.ModelRef->gaussians_sh_n_buf.get(), v_buf_id * 4 + 2);
 				g_device->write_descriptor_set(bindless_descriptor_set.get(), GS_BINDING_ID, model.ModelRef->splat_transforms.splat_transform_buffer.get(), v_buf_id * 4 + 3);
 
 				g_device->write_descriptor_set(bindless_descriptor_set.get(), SPLAT_STATE_BINDING_ID, model.ModelRef->gaussian_state_buf.get(), v_buf_id);
-				model_2_gs_buf_id[model.ModelRef] = v_buf_id;
+				model_2_gs_buf_id[model.ModelRef->handle] = slot;
+				model_2_gs_buf_version[model.ModelRef->handle] = model.ModelRef->gpu_buffer_version;
 				skip_gs_render = false;
 			}
 		}
@@ -412,11 +418,12 @@ namespace diverse
 		{
 			const auto& [model, trans] = pointcloud_group.get<PointCloudComponent, maths::Transform>(pcd_ent);
 			if (!model.ModelRef->is_flag_set(AssetFlag::UploadedGpu)) continue;
-			u32 v_buf_id = model_2_point_buf_id.size();
-			if (model.ModelRef->vertex_buffer && model_2_point_buf_id.find(model.ModelRef.get()) == model_2_point_buf_id.end())
+			if (model.ModelRef->vertex_buffer && model_2_point_buf_id.find(model.ModelRef->handle) == model_2_point_buf_id.end())
 			{
-				g_device->write_descriptor_set(bindless_descriptor_set.get(), POINT_BUF_BINDING_ID, model.ModelRef->vertex_buffer.get(), v_buf_id);
-				model_2_point_buf_id[model.ModelRef] = v_buf_id;
+				auto slot = point_buf_slots.allocate();
+				if (!slot.valid()) continue;
+				g_device->write_descriptor_set(bindless_descriptor_set.get(), POINT_BUF_BINDING_ID, model.ModelRef->vertex_buffer.get(), slot.index);
+				model_2_point_buf_id[model.ModelRef->handle] = slot;
 			}
 		}
 		auto mmesh_group = registry.group<MeshModelComponent>(entt::get<maths::Transform>);
@@ -813,6 +820,8 @@ namespace diverse
 	auto DeferedRenderer::retire_frame() -> void
 	{
 		frame_idx += 1;
+		gs_buf_slots.end_frame();
+		point_buf_slots.end_frame();
 		auto& registry = current_scene->get_registry();
 		auto mmesh_group = registry.group<MeshModelComponent>(entt::get<maths::Transform>);
 		if(previous_transforms.size() != mmesh_group.size())
@@ -1114,15 +1123,53 @@ namespace diverse
 
 	u32 DeferedRenderer::get_buf_id(GaussianModel* model)
 	{
-		if(model_2_gs_buf_id.find(model) != model_2_gs_buf_id.end())
-			return model_2_gs_buf_id[model];
-		return 0xffffffff;
+		auto it = model_2_gs_buf_id.find(model->handle);
+		return it != model_2_gs_buf_id.end() ? it->second.index : 0xffffffff;
 	}
 
 	u32 DeferedRenderer::get_buf_id(PointCloud* model)
 	{
-		if(model_2_point_buf_id.find(model) != model_2_point_buf_id.end())
-			return model_2_point_buf_id[model];
-		return 0xffffffff;
+		auto it = model_2_point_buf_id.find(model->handle);
+		return it != model_2_point_buf_id.end() ? it->second.index : 0xffffffff;
+	}
+
+	// A model that lost its last component (deleted entity, swapped ModelRef, scene switch) gives its slots back.
+	// The slot allocators hold them until the frames in flight that may still read the descriptors have retired.
+	auto DeferedRenderer::release_unreferenced_buf_slots()->void
+	{
+		auto& registry = current_scene->get_registry();
+		std::unordered_set<u64> referenced;
+		for (auto [ent, gs_com] : registry.view<GaussianComponent>().each())
+		{
+			if (gs_com.ModelRef)
+				referenced.insert(gs_com.ModelRef->handle);
+		}
+		for (auto [ent, pcd_com] : registry.view<PointCloudComponent>().each())
+		{
+			if (pcd_com.ModelRef)
+				referenced.insert(pcd_com.ModelRef->handle);
+		}
+
+		for (auto it = model_2_gs_buf_id.begin(); it != model_2_gs_buf_id.end();)
+		{
+			if (referenced.count(it->first))
+			{
+				++it;
+				continue;
+			}
+			gs_buf_slots.release(it->second);
+			model_2_gs_buf_version.erase(it->first);
+			it = model_2_gs_buf_id.erase(it);
+		}
+		for (auto it = model_2_point_buf_id.begin(); it != model_2_point_buf_id.end();)
+		{
+			if (referenced.count(it->first))
+			{
+				++it;
+				continue;
+			}
+			point_buf_slots.release(it->second);
+			it = model_2_point_buf_id.erase(it);
+		}
 	}
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include "backend/drs_rhi/drs_rhi.h"
 #include "backend/drs_rhi/gpu_device.h"
+#include "backend/drs_rhi/bindless_slot_allocator.h"
+#include "core/flat_hash_map.h"
 #include "render_settings.h"
 #include "drs_rg/renderer.h"
 #include "scene/mesh_light.h"
@@ -35,7 +37,7 @@ namespace diverse
 	struct RenderGSCommand
 	{
 		maths::Transform transform;
-		GaussianModel* model;
+		Borrowed<GaussianModel> model; // the queue only lives for the frame
 		u32 		   sh_degree;
 		glm::vec4 	   select_color;
 		glm::vec4 	   locked_color;
@@ -53,7 +55,7 @@ namespace diverse
 	struct RenderPointCommand
 	{
 		maths::Transform transform;
-		PointCloud* model;
+		Borrowed<PointCloud> model;
 	};
 	struct InstanceTransform
 	{
@@ -123,6 +125,7 @@ namespace diverse
 		auto 	invalidate_pt_state()->void { reset_pt = true;}	
 		auto    has_reset_pt_state()->bool {return reset_pt;}
 		auto 	refresh_shaders()->void {return rg_renderer->refresh_shaders();}
+		auto	get_pass_profiler()->rg::RenderGraphProfiler& {return rg_renderer->pass_profiler;}
 		auto	register_event_render_graph(rg::RenderGraph& rg) -> void;
 		u32 	get_buf_id(GaussianModel* model);
 		u32 	get_buf_id(PointCloud* model);
@@ -177,9 +180,16 @@ namespace diverse
 		std::vector<u32>							ent_2_model_id;
 		std::unordered_map<MeshModel*,u32>			model_2_blas_id;
 		std::unordered_map<MeshModel*,u32>			model_2_mesh_buf_id;
-		std::unordered_map<GaussianModel*,u32>		model_2_gs_buf_id;
-		std::unordered_map<PointCloud*,u32>			model_2_point_buf_id;
-		std::unordered_map<struct Material*, u32>	mat_2_mat_buf_id;
+		// keyed by the asset handle, not the address: a model allocated where a released one lived must not
+		// inherit its slot and the stale descriptors behind it
+		FlatHashMap<u64,rhi::BindlessSlot>			model_2_gs_buf_id;
+		FlatHashMap<u64,u32>						model_2_gs_buf_version;
+		FlatHashMap<u64,rhi::BindlessSlot>			model_2_point_buf_id;
+		// slots of models no component references any more are released in upload_gpu_buffers
+		rhi::BindlessSlotAllocator					gs_buf_slots;
+		rhi::BindlessSlotAllocator					point_buf_slots;
+		auto release_unreferenced_buf_slots()->void;
+		FlatHashMap<struct Material*, u32>			mat_2_mat_buf_id;
 		std::unordered_map<Mesh*, u32>				mesh_2_mesh_buf_id;
 		std::unordered_map<rhi::GpuTexture*,u32> 	bindless_image_ids;
 		std::vector<struct MaterialProperties*>		material_datas;
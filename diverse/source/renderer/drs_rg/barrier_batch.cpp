@@ -0,0 +1,98 @@
+#include "barrier_batch.h"
+#include <algorithm>
+
+namespace diverse
+{
+    namespace rg
+    {
+        static auto push_unique(std::vector<rhi::AccessType>& accesses, rhi::AccessType access) -> void
+        {
+            if (access != rhi::AccessType::Nothing && std::find(accesses.begin(), accesses.end(), access) == accesses.end())
+                accesses.push_back(access);
+        }
+
+        auto BarrierAccumulator::add(const rhi::ImageBarrier& barrier) -> void
+        {
+            stats.transitions++;
+            auto it = std::find_if(images.begin(), images.end(), [&](const rhi::ImageBarrier& pending) { return pending.image == barrier.image; });
+            if (it == images.end())
+            {
+                images.push_back(barrier);
+                return;
+            }
+            it->next_access = barrier.next_access;
+            it->aspect_mask = it->aspect_mask | barrier.aspect_mask;
+            stats.coalesced++;
+        }
+
+        auto BarrierAccumulator::add(const rhi::BufferBarrier& barrier) -> void
+        {
+            stats.transitions++;
+            auto it = std::find_if(buffers.begin(), buffers.end(), [&](const rhi::BufferBarrier& pending) { return pending.buffer == barrier.buffer; });
+            if (it == buffers.end())
+            {
+                buffers.push_back(barrier);
+                return;
+            }
+            it->next_access = barrier.next_access;
+            stats.coalesced++;
+        }
+
+        auto BarrierAccumulator::add_global(const std::vector<rhi::AccessType>& previous_accesses, const std::vector<rhi::AccessType>& next_accesses) -> void
+        {
+            stats.transitions++;
+            if (!global_previous.empty() || !global_next.empty())
+                stats.coalesced++;
+            for (auto access : previous_accesses)
+                push_unique(global_previous, access);
+            for (auto access : next_accesses)
+                push_unique(global_next, access);
+        }
+
+        auto BarrierAccumulator::flush(rhi::GpuDevice* device, rhi::CommandBuffer* cb) -> void
+        {
+            if (empty())
+                return;
+
+            auto redundant = [](rhi::AccessType prev, rhi::AccessType next) {
+                return prev == next && !rhi::is_write_access(prev);
+            };
+            auto image_end = std::remove_if(images.begin(), images.end(), [&](const rhi::ImageBarrier& barrier) {
+                return !barrier.discard && redundant(barrier.prev_access, barrier.next_access);
+            });
+            stats.coalesced += static_cast<u32>(images.end() - image_end);
+            images.erase(image_end, images.end());
+
+            bool had_global = !global_previous.empty() || !global_next.empty();
+            for (const auto& barrier : buffers)
+            {
+                if (redundant(barrier.prev_access, barrier.next_access))
+                {
+                    stats.coalesced++;
+                    continue;
+                }
+                push_unique(global_previous, barrier.prev_access);
+                push_unique(global_next, barrier.next_access);
+                // the first folded buffer stands for the global barrier unless one was already pending
+                if (had_global)
+                    stats.coalesced++;
+                had_global = true;
+            }
+            buffers.clear();
+
+            const bool has_global = !global_previous.empty() || !global_next.empty();
+            if (has_global || !images.empty())
+            {
+                std::optional<rhi::GlobalBarrier> global;
+                if (has_global)
+                    global = rhi::GlobalBarrier{ global_previous, global_next };
+                device->record_barriers(cb, global, {}, images);
+                stats.issued += static_cast<u32>(images.size()) + (has_global ? 1 : 0);
+                stats.batches++;
+            }
+            images.clear();
+            global_previous.clear();
+            global_next.clear();
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "backend/drs_rhi/gpu_device.h"
+#include <vector>
+
+namespace diverse
+{
+    namespace rg
+    {
+        struct RenderGraphBarrierStats
+        {
+            u32 transitions = 0;    // transitions handed to accumulators
+            u32 issued = 0;         // barrier entries that reached the device, a global barrier counts once
+            u32 coalesced = 0;      // transitions merged into another entry or dropped as redundant
+            u32 batches = 0;        // record_barriers calls
+
+            auto operator+=(const RenderGraphBarrierStats& other) -> RenderGraphBarrierStats&
+            {
+                transitions += other.transitions;
+                issued += other.issued;
+                coalesced += other.coalesced;
+                batches += other.batches;
+                return *this;
+            }
+        };
+
+        // Gathers the transitions of one pass boundary and flushes them as a single batched barrier.
+        // Several transitions of the same resource collapse into one from the first previous to the last next
+        // access, nothing executes between them. A read->read transition that ends up with the same access on
+        // both sides is dropped. Buffer barriers are folded into the global barrier: the graph never transfers
+        // queue ownership, and a global barrier is what the access types map to anyway.
+        struct BarrierAccumulator
+        {
+            auto add(const rhi::ImageBarrier& barrier) -> void;
+            auto add(const rhi::BufferBarrier& barrier) -> void;
+            auto add_global(const std::vector<rhi::AccessType>& previous_accesses, const std::vector<rhi::AccessType>& next_accesses) -> void;
+            auto empty() const -> bool { return images.empty() && buffers.empty() && global_previous.empty() && global_next.empty(); }
+            auto flush(rhi::GpuDevice* device, rhi::CommandBuffer* cb) -> void;
+
+            RenderGraphBarrierStats stats;
+
+        private:
+            std::vector<rhi::ImageBarrier> images;
+            std::vector<rhi::BufferBarrier> buffers;
+            std::vector<rhi::AccessType> global_previous;
+            std::vector<rhi::AccessType> global_next;
+        };
+    }
+}
@@ -2,17 +2,16 @@
 #include "graph.h"
 #include "pass_builder.h"
 #include "core/ds_log.h"
+#include "core/job_system.h"
+#include "core/profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 namespace diverse
 {
     namespace rg
     {
         
-        auto frame_alloctor() -> FrameAllocator&
-        {
-            static FrameAllocator allocator;
-            return allocator;
-        }
-
         template<typename Res>
         requires std::derived_from<Res, rhi::GpuResource>
         auto ImportExportToRenderGraph<Res>::import_res(const std::shared_ptr<Res>& resource, RenderGraph& rg, rhi::AccessType access_type) -> Handle<Res>
@@ -164,7 +163,7 @@ namespace diverse
                 case GraphResourceInfo::Type::Created:
                     return ResourceLifeTime{};
                 case GraphResourceInfo::Type::Imported:
-                    return ResourceLifeTime{0};
+                    return ResourceLifeTime{0, 0};
                 default:
                     return ResourceLifeTime{};
                 }
@@ -192,7 +191,9 @@ namespace diverse
 
                 auto traverse_pass = [&](const PassResourceRef& res_access) {
                     auto resource_index = res_access.handle.id;
-                    auto res = lifetimes[resource_index];
+                    auto& res = lifetimes[resource_index];
+                    if (!res.first_access)
+                        res.first_access = pass_idx;
                     res.last_access = res.last_access ? std::max<uint32>(res.last_access.value(), pass_idx) : pass_idx;
                     switch (resources[resource_index].ty)
                     {
@@ -256,26 +257,90 @@ namespace diverse
             };
         }
 
+        auto RenderGraph::cull_passes() -> RenderGraphCullStats
+        {
+            static const bool cull_enabled = [] {
+                const char* env = getenv("DS_RG_CULL");
+                return !(env && strcmp(env, "0") == 0);
+            }();
+
+            RenderGraphCullStats stats;
+            stats.total_passes = static_cast<u32>(passes.size());
+            if (!cull_enabled)
+                return stats;
+
+            // imported resources outlive the graph, so writing one is always observable
+            std::vector<bool> live(resources.size(), false);
+            for (u32 res_id = 0; res_id < resources.size(); res_id++)
+                live[res_id] = resources[res_id].ty == GraphResourceInfo::Type::Imported;
+            for (auto& [res, access_type] : exported_resources)
+                live[res.raw().id] = true;
+
+            // A pass another pass overwrites is still kept, writes may be partial or read-modify-write
+            std::vector<bool> keep(passes.size(), false);
+            for (auto pass_idx = passes.size(); pass_idx-- > 0;)
+            {
+                const auto& pass = passes[pass_idx];
+                bool needed = pass.write.empty();
+                for (const auto& res_ref : pass.write)
+                    needed = needed || live[res_ref.handle.id];
+                if (!needed)
+                    continue;
+
+                keep[pass_idx] = true;
+                for (const auto& res_ref : pass.read)
+                    live[res_ref.handle.id] = true;
+                for (const auto& res_ref : pass.write)
+                    live[res_ref.handle.id] = true;
+            }
+
+            u32 kept = 0;
+            for (u32 pass_idx = 0; pass_idx < passes.size(); pass_idx++)
+            {
+                if (!keep[pass_idx])
+                {
+                    stats.culled_pass_ids.push_back(passes[pass_idx].idx);
+                    stats.culled_pass_names.push_back(passes[pass_idx].name);
+                    continue;
+                }
+                if (kept != pass_idx)
+                    passes[kept] = std::move(passes[pass_idx]);
+                kept++;
+            }
+            passes.erase(passes.begin() + kept, passes.end());
+
+            for (u32 res_id = 0; res_id < resources.size(); res_id++)
+            {
+                if (!live[res_id])
+                    stats.culled_resources++;
+            }
+            stats.culled_passes = static_cast<u32>(stats.culled_pass_ids.size());
+            return stats;
+        }
+
         auto RenderGraph::compile(rhi::PipelineCache& pipeline_cache) -> void
         {
+            cull_stats = cull_passes();
             auto resource_info = calculate_resource_info();
-            
-            std::vector<rhi::ComputePipelineHandle>  compute_pipeline_handles;
-            std::vector<rhi::RasterPipelineHandle>  raster_pipeline_handles;
-            std::vector<rhi::RtPipelineHandle>  rt_pipeline_handles;
+
+            // culled passes never bind their pipelines, their slots keep a null handle so ids stay stable
+            auto is_culled = [&](uint32 pass_idx) {
+                const auto& culled = cull_stats.culled_pass_ids;
+                return std::find(culled.begin(), culled.end(), pass_idx) != culled.end();
+            };
             for (auto& pipeline : compute_pipelines)
             {
-                pipelines.compute.emplace_back(pipeline_cache.register_compute(pipeline.desc));
+                pipelines.compute.emplace_back(is_culled(pipeline.pass_idx) ? rhi::ComputePipelineHandle{} : pipeline_cache.register_compute(pipeline.desc));
             }
 
             for (auto& pipeline : raster_pipelines)
             {
-                pipelines.raster.emplace_back(pipeline_cache.register_raster(pipeline.shaders, pipeline.desc));
+                pipelines.raster.emplace_back(is_culled(pipeline.pass_idx) ? rhi::RasterPipelineHandle{} : pipeline_cache.register_raster(pipeline.shaders, pipeline.desc));
             }
 
             for (auto& pipeline : rt_pipelines)
             {
-                pipelines.rt.emplace_back(pipeline_cache.register_ray_tracing(pipeline.shaders,pipeline.desc));
+                pipelines.rt.emplace_back(is_culled(pipeline.pass_idx) ? rhi::RtPipelineHandle{} : pipeline_cache.register_ray_tracing(pipeline.shaders,pipeline.desc));
             }
 
             this->resource_info = std::move(resource_info);
@@ -295,6 +360,9 @@ namespace diverse
         {
             for (auto& resouce : resource_registry.resources)
             {
+                // placed resources stay with the aliasing allocator, their memory is only theirs for this frame
+                if (resouce.aliased)
+                    continue;
                 switch (resouce.resource.ty)
                 {
                 case AnyRenderResource::Type::OwnedImage:
@@ -316,6 +384,8 @@ namespace diverse
                     break;
                 }
             }
+            transient_resource_cache.aliasing.end_frame();
+            transient_resource_cache.end_frame();
         }
 
         auto RenderGraph::register_execution_params(RenderGraphExecutionParams&& params, TransientResourceCache* transient_resource_cache, rhi::DynamicConstants* dynamic_constants) -> void
@@ -325,15 +395,134 @@ namespace diverse
             this->transient_resource_cache = transient_resource_cache;
         }
         
+        auto RenderGraph::alias_transient_resources(rhi::GpuDevice* device) -> std::vector<std::optional<RegistryResource>>
+        {
+            std::vector<std::optional<RegistryResource>> placed(resources.size());
+            auto& allocator = transient_resource_cache->aliasing;
+            allocator.begin_frame();
+            if (!allocator.enabled())
+                return placed;
+
+            std::vector<bool> exported(resources.size(), false);
+            for (auto& [res, access_type] : exported_resources)
+                exported[res.raw().id] = true;
+
+            // images and buffers never share a heap, nor do resources that need different memory types
+            struct AliasingGroup
+            {
+                u32 memory_type_bits = 0;
+                std::vector<u32> res_ids;
+                std::vector<TransientAliasingRequest> requests;
+            };
+            FlatHashMap<u64, AliasingGroup> groups;
+            for (u32 res_id = 0; res_id < resources.size(); res_id++)
+            {
+                auto& resource = resources[res_id];
+                const auto& lifetime = resource_info.lifetimes[res_id];
+                if (resource.ty != GraphResourceInfo::Type::Created || exported[res_id] || !lifetime.first_access || !lifetime.last_access)
+                    continue;
+
+                const auto& desc = resource.graph_resource_create_info().desc;
+                std::optional<rhi::GpuMemoryRequirements> requirements;
+                u64 kind = 0;
+                if (desc.ty == GraphResourceDesc::Type::Image)
+                {
+                    auto img_desc = desc.image_desc();
+                    img_desc.usage = resource_info.image_usage_flags[res_id];
+                    requirements = allocator.requirements(device, img_desc);
+                }
+                else if (desc.ty == GraphResourceDesc::Type::Buffer)
+                {
+                    auto buf_desc = desc.buffer_desc();
+                    buf_desc.usage = resource_info.buffer_usage_flags[res_id];
+                    requirements = allocator.requirements(device, buf_desc);
+                    kind = 1;
+                }
+                if (!requirements)
+                    continue;
+
+                auto& group = groups[(kind << 32) | requirements->memory_type_bits];
+                group.memory_type_bits = requirements->memory_type_bits;
+                group.res_ids.push_back(res_id);
+                group.requests.push_back({ requirements->size, requirements->alignment, lifetime.first_access.value(), lifetime.last_access.value() });
+            }
+
+            // what the resource was left in by the last pass using it, the state the next one in its memory starts from
+            auto last_access_type = [&](u32 res_id) {
+                auto access_type = rhi::AccessType::Nothing;
+                const auto& pass = passes[resource_info.lifetimes[res_id].last_access.value()];
+                for (const auto& res_ref : pass.read)
+                    if (res_ref.handle.id == res_id) access_type = res_ref.access.access_type;
+                for (const auto& res_ref : pass.write)
+                    if (res_ref.handle.id == res_id) access_type = res_ref.access.access_type;
+                return access_type;
+            };
+
+            for (auto& [group_key, group] : groups)
+            {
+                auto plan = plan_transient_aliasing(group.requests);
+                auto heap = allocator.acquire_heap(device, group_key, group.memory_type_bits, plan.heap_size);
+                if (!heap)
+                    continue;
+
+                u32 placed_count = 0;
+                for (u32 i = 0; i < group.res_ids.size(); i++)
+                {
+                    const auto res_id = group.res_ids[i];
+                    auto& create_info = resources[res_id].graph_resource_create_info();
+                    const char* name = create_info.name.size() > 0 ? create_info.name.data() : nullptr;
+                    std::optional<AnyRenderResource> resource;
+                    if (create_info.desc.ty == GraphResourceDesc::Type::Image)
+                    {
+                        auto img_desc = create_info.desc.image_desc();
+                        img_desc.usage = resource_info.image_usage_flags[res_id];
+                        if (auto image = allocator.place_image(device, img_desc, heap, plan.offsets[i], name))
+                            resource = AnyRenderResource::image(image);
+                    }
+                    else
+                    {
+                        auto buf_desc = create_info.desc.buffer_desc();
+                        buf_desc.usage = resource_info.buffer_usage_flags[res_id];
+                        if (auto buffer = allocator.place_buffer(device, buf_desc, heap, plan.offsets[i], name ? name : "rg buffer"))
+                            resource = AnyRenderResource::buffer(buffer);
+                    }
+                    if (!resource)
+                        continue;
+
+                    auto previous_access = rhi::AccessType::Nothing;
+                    if (!plan.aliased[i].empty())
+                    {
+                        auto predecessor = aliasing_barrier_predecessor(group.requests, plan, i);
+                        previous_access = predecessor ? last_access_type(group.res_ids[predecessor.value()]) : rhi::AccessType::General;
+                    }
+                    placed[res_id] = RegistryResource{ std::move(resource.value()), previous_access, true, true };
+                    placed_count++;
+                }
+                allocator.record_plan(plan, placed_count);
+            }
+            return placed;
+        }
+
         auto RenderGraph::begin_execute() -> void
         {
             auto device = resource_registry.execution_params.device;
+            auto placed = alias_transient_resources(device);
             std::vector<RegistryResource>   ret_resources;
             for (auto res_id = 0; res_id < resources.size(); res_id++)
             {
                 auto& resource = resources[res_id];
                 if (resource.ty == GraphResourceInfo::Type::Created)
                 {
+                    if (placed[res_id])
+                    {
+                        ret_resources.push_back(std::move(placed[res_id].value()));
+                        continue;
+                    }
+                    if (!resource_info.lifetimes[res_id].last_access)
+                    {
+                        ret_resources.push_back({ AnyRenderResource::culled(), rhi::AccessType::Nothing });
+                        continue;
+                    }
                     auto& create_info = resource.graph_resource_create_info();
                     const auto& desc = create_info.desc;
                     switch ( desc.ty )
@@ -411,6 +600,30 @@ namespace diverse
             this->resource_registry = std::move(resource_registry);*/
             resource_registry.resources = std::move(ret_resources);
             resource_registry.pipelines = std::move(pipelines);
+            find_passes_waiting_for_pipelines();
+        }
+
+        // culled passes are gone from passes and their pipelines were never registered, only recorded ones are looked up
+        auto RenderGraph::find_passes_waiting_for_pipelines() -> void
+        {
+            auto& pipeline_cache = *resource_registry.execution_params.pipeline_cache;
+            const auto& handles = resource_registry.pipelines;
+            const size_t pass_count = passes.empty() ? 0 : passes.back().idx + 1;
+            std::vector<bool> recorded(pass_count, false);
+            for (const auto& pass : passes)
+                recorded[pass.idx] = true;
+            pass_waits_for_pipelines.assign(pass_count, false);
+            auto check = [&](uint32 pass_idx, auto&& has_pipeline) {
+                if (pass_idx < pass_count && recorded[pass_idx] && !has_pipeline())
+                    pass_waits_for_pipelines[pass_idx] = true;
+            };
+            for (u32 i = 0; i < compute_pipelines.size(); i++)
+                check(compute_pipelines[i].pass_idx, [&] { return pipeline_cache.get_compute(handles.compute[i]) != nullptr; });
+            for (u32 i = 0; i < raster_pipelines.size(); i++)
+                check(raster_pipelines[i].pass_idx, [&] { return pipeline_cache.get_raster(handles.raster[i]) != nullptr; });
+            for (u32 i = 0; i < rt_pipelines.size(); i++)
+                check(rt_pipelines[i].pass_idx, [&] { return pipeline_cache.get_ray_tracing(handles.rt[i]) != nullptr; });
+            passes_waiting_for_pipelines = static_cast<u32>(std::count(pass_waits_for_pipelines.begin(), pass_waits_for_pipelines.end(), true));
         }
 
         auto RenderGraph::execute()->void
@@ -418,7 +631,7 @@ namespace diverse
             auto device = resource_registry.execution_params.device;
             auto& pipeline_cache = *resource_registry.execution_params.pipeline_cache;
             compile(pipeline_cache);
-            pipeline_cache.prepare_frame(device);
+            pipeline_cache.prepare_frame(device, true);
     
             auto cb = device->get_graphics_cmd_buffer();
             assert(cb);
@@ -432,8 +645,33 @@ namespace diverse
             release_resources(*transient_resource_cache);
         }
         
-        auto RenderGraph::record_main_cb(rhi::CommandBuffer* cb)->void
+        static auto add_resolved_barrier(BarrierAccumulator& accumulator, const ResolvedBarrier& barrier) -> void
+        {
+            if (barrier.image)
+                accumulator.add(barrier.image.value());
+            if (barrier.buffer)
+                accumulator.add(barrier.buffer.value());
+        }
+
+        static auto record_resolved_barrier(rhi::GpuDevice* device, rhi::CommandBuffer* cb, const ResolvedBarrier& barrier) -> void
+        {
+            if (barrier.image)
+                device->record_image_barrier(cb, barrier.image.value());
+            if (barrier.buffer)
+                device->record_buffer_barrier(cb, barrier.buffer.value());
+        }
+
+        auto RenderGraph::record_main_cb(rhi::CommandBuffer* cb, std::vector<std::shared_ptr<rhi::CommandBuffer>>* worker_cbs)->u32
         {
+            profiled_frame = 0;
+            profiled_pass_base = 0;
+            if (profiler && profiler->enabled)
+            {
+                auto device = resource_registry.execution_params.device;
+                profiled_frame = profiler->begin_frame(static_cast<u32>(passes.size()));
+                // two queries per pass, indexed by the pass's position; the presentation cb is submitted after this one
+                device->reset_timestamp_queries(cb, static_cast<u32>(passes.size()) * 2);
+            }
             auto first_presentation_pass = passes.size();
 
             for (auto pass_idx = 0; pass_idx < passes.size(); pass_idx++)
@@ -471,21 +709,97 @@ namespace diverse
                 }
             }
             auto param = resource_registry.execution_params;
+            barrier_stats = {};
+            BarrierAccumulator first_access_barriers;
             for (auto& [res_idx, access] : resource_first_access_states)
             {
                 auto& resource = resource_registry.resources[res_idx];
-                transition_resource(param.device, cb, resource, PassResourceAccessType{ access->access_type , PassResourceAccessSyncType::SkipSyncIfSameAccessType }, false, "");
+                // memory shared with resources used earlier in the frame, it may only transition once they are done
+                if (resource.aliased)
+                    continue;
+                if (auto barrier = resolve_transition(resource, PassResourceAccessType{ access->access_type , PassResourceAccessSyncType::SkipSyncIfSameAccessType }))
+                    add_resolved_barrier(first_access_barriers, barrier.value());
 
                 access->sync_type = PassResourceAccessSyncType::SkipSyncIfSameAccessType;
             }
-
-            for (auto pass_idx = 0; pass_idx < first_presentation_pass; pass_idx++)
+            first_access_barriers.flush(param.device, cb);
+            barrier_stats += first_access_barriers.stats;
+
+            u32 worker_cb_count = 0;
+            record_groups = 1;
+            if (worker_cbs)
+                worker_cb_count = record_passes_parallel(static_cast<u32>(first_presentation_pass), cb, *worker_cbs);
+            if (record_groups == 1)
             {
-                auto& pass = passes[pass_idx];
-                record_pass_cb(pass, resource_registry, cb);
+                for (auto pass_idx = 0; pass_idx < first_presentation_pass; pass_idx++)
+                {
+                    auto& pass = passes[pass_idx];
+                    record_pass_cb(pass, resource_registry, cb);
+                }
             }
 
             passes.erase(passes.begin(), passes.begin() + first_presentation_pass);
+            profiled_pass_base = static_cast<u32>(first_presentation_pass);
+            return worker_cb_count;
+        }
+
+        // Minimum number of passes per recording group, DS_RG_RECORD_MIN_PASSES=0 records everything on one thread
+        static auto min_passes_per_record_group() -> u32
+        {
+            static const u32 min_passes = [] {
+                const char* env = getenv("DS_RG_RECORD_MIN_PASSES");
+                return env ? static_cast<u32>(atoi(env)) : 8u;
+            }();
+            return min_passes;
+        }
+
+        // Barriers are resolved for every pass up front on this thread, the access state they track is sequential.
+        // The passes are then split into contiguous groups: the first is recorded into cb here, the others into
+        // worker command buffers on the job system. Returns how many worker command buffers the caller has to
+        // submit, in order, right after cb.
+        auto RenderGraph::record_passes_parallel(u32 pass_count, rhi::CommandBuffer* cb, std::vector<std::shared_ptr<rhi::CommandBuffer>>& worker_cbs) -> u32
+        {
+            const u32 min_passes = min_passes_per_record_group();
+            if (min_passes == 0 || pass_count < 2 * min_passes)
+                return 0;
+            const u32 group_count = std::min(pass_count / min_passes, System::JobSystem::get_thread_count() + 1);
+            if (group_count < 2)
+                return 0;
+
+            DS_PROFILE_FUNCTION();
+            auto device = resource_registry.execution_params.device;
+            std::vector<std::vector<ResolvedBarrier>> pass_barriers(pass_count);
+            for (u32 pass_idx = 0; pass_idx < pass_count; pass_idx++)
+                pass_barriers[pass_idx] = resolve_pass_barriers(passes[pass_idx], resource_registry);
+
+            while (worker_cbs.size() < group_count - 1)
+                worker_cbs.push_back(device->create_render_command_buffer("rg worker"));
+
+            std::vector<RenderGraphBarrierStats> group_barrier_stats(group_count);
+            auto record_group = [this, &pass_barriers, &group_barrier_stats, pass_count, group_count](u32 group, rhi::CommandBuffer* group_cb) {
+                const u32 begin = pass_count * group / group_count;
+                const u32 end = pass_count * (group + 1) / group_count;
+                for (u32 pass_idx = begin; pass_idx < end; pass_idx++)
+                    group_barrier_stats[group] += record_resolved_pass(passes[pass_idx], pass_barriers[pass_idx], resource_registry, group_cb);
+            };
+
+            System::JobSystem::Context ctx;
+            for (u32 group = 1; group < group_count; group++)
+            {
+                auto group_cb = worker_cbs[group - 1].get();
+                System::JobSystem::execute(ctx, [&record_group, device, group, group_cb](JobDispatchArgs) {
+                    device->begin_cmd(group_cb);
+                    record_group(group, group_cb);
+                    device->end_cmd(group_cb);
+                });
+            }
+            record_group(0, cb);
+            System::JobSystem::wait(ctx);
+            for (const auto& stats : group_barrier_stats)
+                barrier_stats += stats;
+
+            record_groups = group_count;
+            return group_count - 1;
         }
 
         auto RenderGraph::record_presentation_cb(
@@ -494,15 +808,19 @@ namespace diverse
                             -> void
         {
             auto& params = resource_registry.execution_params;
+            BarrierAccumulator export_barriers;
             for (auto& [res_idx, access_type] : exported_resources)
             {
                 if (access_type != rhi::AccessType::Nothing)
                 {
                     auto& resource = resource_registry.resources[res_idx.raw().id];
 
-                    transition_resource(params.device, cb, resource, PassResourceAccessType{ access_type, PassResourceAccessSyncType ::AlwaysSync}, false, "");
+                    if (auto barrier = resolve_transition(resource, PassResourceAccessType{ access_type, PassResourceAccessSyncType ::AlwaysSync}))
+                        add_resolved_barrier(export_barriers, barrier.value());
                 }
             }
+            export_barriers.flush(params.device, cb);
+            barrier_stats += export_barriers.stats;
 
             for (auto& res : resource_registry.resources)
             {
@@ -539,57 +857,78 @@ namespace diverse
                             ResourceRegistry& resource_registry, 
                             rhi::CommandBuffer* cb)->void
         {
-            auto& params = resource_registry.execution_params;
+            barrier_stats += record_resolved_pass(pass, resolve_pass_barriers(pass, resource_registry), resource_registry, cb);
+        }
 
-            std::vector<std::pair<u32, PassResourceAccessType>> transitions;
+        auto RenderGraph::resolve_pass_barriers(RecordedPass& pass, ResourceRegistry& resource_registry) -> std::vector<ResolvedBarrier>
+        {
+            std::vector<ResolvedBarrier> barriers;
             for (auto& resource_ref : pass.read)
-                transitions.push_back({ resource_ref.handle.id, resource_ref.access });
-
+            {
+                if (auto barrier = resolve_transition(resource_registry.resources[resource_ref.handle.id], resource_ref.access))
+                    barriers.push_back(barrier.value());
+            }
             for (auto& resource_ref : pass.write)
-                transitions.push_back({ resource_ref.handle.id, resource_ref.access });
+            {
+                if (auto barrier = resolve_transition(resource_registry.resources[resource_ref.handle.id], resource_ref.access))
+                    barriers.push_back(barrier.value());
+            }
+            return barriers;
+        }
 
-            for (auto& [res_idx, access] : transitions)
+        auto RenderGraph::record_resolved_pass(
+                            RecordedPass& pass,
+                            const std::vector<ResolvedBarrier>& barriers,
+                            ResourceRegistry& resource_registry,
+                            rhi::CommandBuffer* cb)->RenderGraphBarrierStats
+        {
+            auto& params = resource_registry.execution_params;
+            const bool profiling = profiled_frame != 0;
+            const u32 slot = profiled_pass_base + static_cast<u32>(&pass - passes.data());
+            std::chrono::steady_clock::time_point cpu_begin;
+            if (profiling)
             {
-                auto& resource = resource_registry.resources[res_idx];
+                cpu_begin = std::chrono::steady_clock::now();
+                params.device->write_timestamp(cb, slot * 2);
+            }
+
+            BarrierAccumulator accumulator;
+            for (const auto& barrier : barriers)
+                add_resolved_barrier(accumulator, barrier);
+            accumulator.flush(params.device, cb);
 
-                transition_resource(
-                    params.device,
+            // the barriers still go out so resource states stay what later passes expect
+            const bool skipped = pass.idx < pass_waits_for_pipelines.size() && pass_waits_for_pipelines[pass.idx];
+            if (!skipped)
+            {
+                auto api = RenderPassApi{
                     cb,
-                    resource,
-                    access,
-                    false,
-                    ""
-                );
-            }
-            auto api = RenderPassApi{
-                cb,
-                resource_registry
-            };
+                    resource_registry
+                };
 #ifndef DS_PRODUCTION
-            api.device()->event_begin(pass.name.c_str(), cb);
-            if (auto& render_fn = pass.render_fn)
-                render_fn(api);
-            api.device()->event_end(cb);
+                api.device()->event_begin(pass.name.c_str(), cb);
+                if (auto& render_fn = pass.render_fn)
+                    render_fn(api);
+                api.device()->event_end(cb);
 #else
-            if (auto& render_fn = pass.render_fn)
-                render_fn(api);
+                if (auto& render_fn = pass.render_fn)
+                    render_fn(api);
 #endif
-        }
+            }
 
-        auto RenderGraph::transition_resource(
-                            rhi::GpuDevice* device, 
-                            rhi::CommandBuffer* cb,
-                            RegistryResource& resource,
-                            const PassResourceAccessType& access_type,
-                            bool debug,
-                            const std::string& dbg_str)->void
-        {
-            if (resource.access_type == access_type.access_type && access_type.sync_type == PassResourceAccessSyncType::SkipSyncIfSameAccessType)
-                  return;
-            if (debug)
+            if (profiling)
             {
-                DS_LOG_INFO("{}, {}", (int)resource.access_type, (int)access_type.access_type);
+                params.device->write_timestamp(cb, slot * 2 + 1);
+                profiler->set_pass_cpu(slot, pass.name, std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - cpu_begin).count());
             }
+            return accumulator.stats;
+        }
+
+        auto RenderGraph::resolve_transition(RegistryResource& resource, const PassResourceAccessType& access_type) -> std::optional<ResolvedBarrier>
+        {
+            if (resource.access_type == access_type.access_type && access_type.sync_type == PassResourceAccessSyncType::SkipSyncIfSameAccessType && !resource.discard_on_first_use)
+                  return {};
+            std::optional<ResolvedBarrier> barrier;
             switch (resource.resource.ty)
             {
             case AnyRenderResource::Type::OwnedImage:
@@ -600,38 +939,55 @@ namespace diverse
                 if (!aspect)
                 {
                     DS_LOG_ERROR("Invalid image access, {}, {}", (int)access_type.access_type, (int)access_type.sync_type);
-                    return;
+                    return {};
                 }
-                device->record_image_barrier(cb, rhi::ImageBarrier{
+                barrier = ResolvedBarrier{ rhi::ImageBarrier{
                         image,
                         resource.access_type,
                         access_type.access_type,
                         aspect.value()
-                    });
+                    }.with_discard(resource.discard_on_first_use), {} };
                 resource.access_type = access_type.access_type;
+                resource.discard_on_first_use = false;
             }break;
             case AnyRenderResource::Type::OwnedBuffer:
             case AnyRenderResource::Type::ImportedBuffer:
             {
                 auto buffer = resource.resource.buffer().get();
-                device->record_buffer_barrier(cb, rhi::BufferBarrier{
+                barrier = ResolvedBarrier{ {}, rhi::BufferBarrier{
                         buffer,
                         resource.access_type,
                         access_type.access_type,
                         0,
                         (u32)buffer->desc.size
-                    });
+                    } };
                 resource.access_type = access_type.access_type;
+                resource.discard_on_first_use = false;
             }break;
             case AnyRenderResource::Type::ImportedRayTracingAcceleration:
             {
-                if(debug)
-                    DS_LOG_INFO("\t(bvh)");
                 resource.access_type = access_type.access_type;
             }break;
             default:
                 break;
             }
+            return barrier;
+        }
+
+        auto RenderGraph::transition_resource(
+                            rhi::GpuDevice* device, 
+                            rhi::CommandBuffer* cb,
+                            RegistryResource& resource,
+                            const PassResourceAccessType& access_type,
+                            bool debug,
+                            const std::string& dbg_str)->void
+        {
+            if (debug)
+            {
+                DS_LOG_INFO("{}, {}", (int)resource.access_type, (int)access_type.access_type);
+            }
+            if (auto barrier = resolve_transition(resource, access_type))
+                record_resolved_barrier(device, cb, barrier.value());
         }
 
         auto global_barrier(
@@ -3,7 +3,9 @@
 #include "pass.h"
 #include "resource_registry.h"
 #include "transient_resource_cache.h"
-#include "core/frame_alloctor.h"
+#include "barrier_batch.h"
+#include "pass_profiler.h"
+#include "core/frame_arena.h"
 #include <deque>
 
 namespace diverse
@@ -22,7 +24,6 @@ namespace diverse
              static auto export_res(const Handle<Res>& resource, struct RenderGraph& rg, rhi::AccessType access_type)->ExportedHandle<Res>;
         };
 
-        auto frame_alloctor() -> FrameAllocator&;
 
         struct RenderGraphParams
         {
@@ -34,6 +35,22 @@ namespace diverse
             FrameConstantsLayout frame_constants_layout;
 
         };
+        struct RenderGraphCullStats
+        {
+            u32 total_passes = 0;
+            u32 culled_passes = 0;
+            u32 culled_resources = 0;
+            std::vector<u32> culled_pass_ids;
+            std::vector<std::string> culled_pass_names;
+        };
+
+        // A transition resolved against the resource's tracked access, ready to be recorded on any command buffer
+        struct ResolvedBarrier
+        {
+            std::optional<rhi::ImageBarrier> image;
+            std::optional<rhi::BufferBarrier> buffer;
+        };
+
         struct RenderGraph
         {
           
@@ -47,6 +64,17 @@ namespace diverse
             std::unordered_map<uint32, PredefinedDescriptorSet> predefined_descriptor_set_layouts;
 
             ResourceInfo resource_info;
+            RenderGraphCullStats cull_stats;
+            u32 record_groups = 1;  // command buffers the last record_main_cb spread the passes over
+            RenderGraphBarrierStats barrier_stats;  // of the last record_main_cb and record_presentation_cb
+            // by pass idx, passes whose pipelines are still compiling for the first time or never compiled;
+            // they are skipped when recording, see rhi::PipelineCache
+            std::vector<bool> pass_waits_for_pipelines;
+            u32 passes_waiting_for_pipelines = 0;
+            // set by the frame loop, one-shot graphs run through execute() are never profiled
+            RenderGraphProfiler* profiler = nullptr;
+            u64 profiled_frame = 0;     // profiler frame of the last record_main_cb, 0 when it was not profiled
+            u32 profiled_pass_base = 0; // record_main_cb drops the passes it recorded, the rest keep their profiler slots
             RenderGraphPipelines pipelines;
             ResourceRegistry    resource_registry;
             TransientResourceCache* transient_resource_cache;
@@ -69,6 +97,9 @@ namespace diverse
 
             auto create_raw_resource(GraphResourceCreateInfo&& info) -> GraphRawResourceHandle;
             auto calculate_resource_info() -> ResourceInfo;
+            // Walks the passes back from imported, exported and swapchain resources and removes the ones whose
+            // writes nothing reaches. Passes declaring no writes are kept, their effect is invisible to the graph.
+            auto cull_passes() -> RenderGraphCullStats;
 
             template<typename Res>
                 requires std::derived_from<Res, rhi::GpuResource>
@@ -91,12 +122,22 @@ namespace diverse
 
             auto record_pass(RecordedPass&& pass)->void;
 
+            // places transients with known, non-exported lifetimes into shared heaps, by resource index
+            auto alias_transient_resources(rhi::GpuDevice* device) -> std::vector<std::optional<RegistryResource>>;
             auto begin_execute() -> void;
+            auto find_passes_waiting_for_pipelines() -> void;
        
-            auto record_main_cb(rhi::CommandBuffer* CommandBuffer) -> void;
+            // With worker_cbs, large frames are recorded on the job system as well, see record_passes_parallel.
+            // Returns how many of worker_cbs were recorded, they have to be submitted in order right after CommandBuffer.
+            auto record_main_cb(rhi::CommandBuffer* CommandBuffer, std::vector<std::shared_ptr<rhi::CommandBuffer>>* worker_cbs = nullptr) -> u32;
             auto record_presentation_cb(rhi::CommandBuffer* cb, const std::shared_ptr<rhi::GpuTexture>& swapchain) -> void;
             auto record_pass_cb(RecordedPass& pass, ResourceRegistry& resource_registry, rhi::CommandBuffer* cb) -> void;
             auto transition_resource(rhi::GpuDevice* device, rhi::CommandBuffer* cb, RegistryResource& resouce, const PassResourceAccessType& access_type, bool debug, const std::string& dbg_str) -> void;
+            auto resolve_transition(RegistryResource& resource, const PassResourceAccessType& access_type) -> std::optional<ResolvedBarrier>;
+            auto resolve_pass_barriers(RecordedPass& pass, ResourceRegistry& resource_registry) -> std::vector<ResolvedBarrier>;
+            // flushes the pass's barriers as one batch and runs it, returns the batch's barrier stats
+            auto record_resolved_pass(RecordedPass& pass, const std::vector<ResolvedBarrier>& barriers, ResourceRegistry& resource_registry, rhi::CommandBuffer* cb) -> RenderGraphBarrierStats;
+            auto record_passes_parallel(u32 pass_count, rhi::CommandBuffer* cb, std::vector<std::shared_ptr<rhi::CommandBuffer>>& worker_cbs) -> u32;
 
             //immediate mode
             auto execute()->void;
@@ -112,7 +112,7 @@ namespace diverse
                     {
                         auto& offset = binding.DynamicConstants();
                         set_bindings.emplace_back(rhi::DescriptorSetBinding::DynamicBuffer(
-                                {resources.dynamic_constants->buffer.get(), offset}
+                                resources.dynamic_constants->resolve(offset)
                         ));
                     }
                     break;
@@ -120,7 +120,7 @@ namespace diverse
                     {
                         auto& offset = binding.DynamicConstantsStorageBuffer();
                         set_bindings.emplace_back(rhi::DescriptorSetBinding::DynamicStorageBuffer(
-                            { resources.dynamic_constants->buffer.get(), offset }
+                            resources.dynamic_constants->resolve(offset)
                         ));
                     }
                     break;
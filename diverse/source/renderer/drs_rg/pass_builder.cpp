@@ -33,7 +33,7 @@ namespace diverse
 				desc.descriptor_set_opts[set_idx] = std::pair{ set_idx, rhi::DescriptorSetLayoutOpts{rhi::DescriptorSetLayoutCreateFlags::UPDATE_AFTER_BIND_POOL, layout.bindings} };
 			}
 
-			rg->compute_pipelines.push_back(std::move(RgComputePipeline{desc}));
+			rg->compute_pipelines.push_back(std::move(RgComputePipeline{desc, pass_idx}));
 			return RgComputePipelineHandle{id};
 		}
 
@@ -45,7 +45,7 @@ namespace diverse
 				desc.descriptor_set_opts[set_idx] = std::pair{set_idx, rhi::DescriptorSetLayoutOpts{rhi::DescriptorSetLayoutCreateFlags::UPDATE_AFTER_BIND_POOL, layout.bindings}};
 			}
 
-			rg->raster_pipelines.push_back(std::move(RgRasterPipeline{ desc, shaders }));
+			rg->raster_pipelines.push_back(std::move(RgRasterPipeline{ desc, shaders, pass_idx }));
 			return RgRasterPipelineHandle{ id };
 		}
 		auto PassBuilder::register_ray_tracing_pipeline(const std::vector<rhi::PipelineShaderDesc>& shaders, rhi::RayTracingPipelineDesc&& desc) -> RgRtPipelineHandle
@@ -58,7 +58,7 @@ namespace diverse
 
 			}
 
-			rg->rt_pipelines.push_back(std::move(RgRtPipeline{ desc, shaders }));
+			rg->rt_pipelines.push_back(std::move(RgRtPipeline{ desc, shaders, pass_idx }));
 			return RgRtPipelineHandle{ id };
 		}
 		auto PassBuilder::render(std::function<void(RenderPassApi&)>&& fn)->void
@@ -0,0 +1,229 @@
+#include "pass_profiler.h"
+#include "core/ds_log.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace diverse
+{
+    namespace rg
+    {
+        RenderGraphProfiler::RenderGraphProfiler()
+        {
+            if (const char* env = getenv("DS_RG_PROFILE"); env && strcmp(env, "0") != 0)
+                enabled = true;
+            if (const char* env = getenv("DS_RG_PROFILE_FRAMES"))
+                max_frames = std::max(1, atoi(env));
+            if (const char* env = getenv("DS_RG_PROFILE_EXPORT"))
+            {
+                export_path = env;
+                enabled = true;
+            }
+        }
+
+        RenderGraphProfiler::~RenderGraphProfiler()
+        {
+            if (!export_path.empty() && !records.empty())
+                export_file(export_path);
+        }
+
+        auto RenderGraphProfiler::begin_frame(u32 pass_count) -> u64
+        {
+            while (records.size() >= max_frames)
+                records.pop_front();
+            auto& record = records.emplace_back();
+            record.frame = ++frame_index;
+            record.passes.resize(pass_count);
+            return record.frame;
+        }
+
+        auto RenderGraphProfiler::set_pass_cpu(u32 pass, const std::string& name, f64 cpu_ms) -> void
+        {
+            auto& record = records.back();
+            if (pass >= record.passes.size())
+                return;
+            record.passes[pass].name = name;
+            record.passes[pass].cpu_ms = cpu_ms;
+        }
+
+        auto RenderGraphProfiler::resolve_gpu(u64 frame, const std::vector<u64>& timestamps) -> void
+        {
+            if (timestamps.empty() || records.empty() || frame < records.front().frame || frame > records.back().frame)
+                return;
+            auto& record = records[frame - records.front().frame];
+            for (size_t pass = 0; pass < record.passes.size() && pass * 2 + 1 < timestamps.size(); pass++)
+            {
+                const auto begin = timestamps[pass * 2];
+                const auto end = timestamps[pass * 2 + 1];
+                // 0 marks a query that was never written
+                if (begin != 0 && end >= begin)
+                    record.passes[pass].gpu_ms = (end - begin) * 1e-6;
+            }
+        }
+
+        auto RenderGraphProfiler::clear() -> void
+        {
+            records.clear();
+        }
+
+        // nearest rank on sorted samples
+        static auto percentile(const std::vector<f64>& sorted, f64 p) -> f64
+        {
+            if (sorted.empty())
+                return 0.0;
+            const auto rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+            return sorted[std::min(rank, sorted.size() - 1)];
+        }
+
+        auto RenderGraphProfiler::stats() const -> std::vector<PassTimingStats>
+        {
+            struct Samples
+            {
+                std::vector<f64> cpu;
+                std::vector<f64> gpu;
+            };
+            // first appearance order, the order passes run in
+            std::vector<std::string> names;
+            std::unordered_map<std::string, Samples> samples;
+            for (const auto& record : records)
+            {
+                for (const auto& pass : record.passes)
+                {
+                    if (pass.name.empty())
+                        continue;
+                    auto [it, inserted] = samples.try_emplace(pass.name);
+                    if (inserted)
+                        names.push_back(pass.name);
+                    it->second.cpu.push_back(pass.cpu_ms);
+                    if (pass.gpu_ms >= 0.0)
+                        it->second.gpu.push_back(pass.gpu_ms);
+                }
+            }
+
+            std::vector<PassTimingStats> result;
+            result.reserve(names.size());
+            for (const auto& name : names)
+            {
+                auto& pass = samples[name];
+                std::sort(pass.cpu.begin(), pass.cpu.end());
+                std::sort(pass.gpu.begin(), pass.gpu.end());
+                auto& stats = result.emplace_back();
+                stats.name = name;
+                stats.cpu_samples = static_cast<u32>(pass.cpu.size());
+                stats.cpu_p50_ms = percentile(pass.cpu, 0.5);
+                stats.cpu_p95_ms = percentile(pass.cpu, 0.95);
+                stats.cpu_max_ms = pass.cpu.empty() ? 0.0 : pass.cpu.back();
+                stats.gpu_samples = static_cast<u32>(pass.gpu.size());
+                stats.gpu_p50_ms = percentile(pass.gpu, 0.5);
+                stats.gpu_p95_ms = percentile(pass.gpu, 0.95);
+                stats.gpu_max_ms = pass.gpu.empty() ? 0.0 : pass.gpu.back();
+            }
+            return result;
+        }
+
+        static auto escape_json(const std::string& text) -> std::string
+        {
+            std::string escaped;
+            escaped.reserve(text.size());
+            for (char c : text)
+            {
+                switch (c)
+                {
+                case '"': escaped += "\\\""; break;
+                case '\\': escaped += "\\\\"; break;
+                case '\n': escaped += "\\n"; break;
+                case '\t': escaped += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                        escaped += fmt::format("\\u{:04x}", static_cast<int>(c));
+                    else
+                        escaped += c;
+                }
+            }
+            return escaped;
+        }
+
+        static auto escape_csv(const std::string& text) -> std::string
+        {
+            if (text.find_first_of(",\"\n") == std::string::npos)
+                return text;
+            std::string escaped = "\"";
+            for (char c : text)
+            {
+                if (c == '"')
+                    escaped += '"';
+                escaped += c;
+            }
+            return escaped + "\"";
+        }
+
+        auto RenderGraphProfiler::export_json(const std::string& path) const -> bool
+        {
+            std::ofstream file(path);
+            if (!file)
+            {
+                DS_LOG_ERROR("render graph profiler: can not write {}", path);
+                return false;
+            }
+            file << "{\n  \"stats\": [";
+            const auto pass_stats = stats();
+            for (size_t i = 0; i < pass_stats.size(); i++)
+            {
+                const auto& s = pass_stats[i];
+                file << (i ? ",\n    " : "\n    ") << fmt::format(
+                    "{{\"name\": \"{}\", \"cpu_samples\": {}, \"cpu_p50_ms\": {:.4f}, \"cpu_p95_ms\": {:.4f}, \"cpu_max_ms\": {:.4f}, "
+                    "\"gpu_samples\": {}, \"gpu_p50_ms\": {:.4f}, \"gpu_p95_ms\": {:.4f}, \"gpu_max_ms\": {:.4f}}}",
+                    escape_json(s.name), s.cpu_samples, s.cpu_p50_ms, s.cpu_p95_ms, s.cpu_max_ms,
+                    s.gpu_samples, s.gpu_p50_ms, s.gpu_p95_ms, s.gpu_max_ms);
+            }
+            file << "\n  ],\n  \"frames\": [";
+            for (size_t i = 0; i < records.size(); i++)
+            {
+                const auto& record = records[i];
+                file << (i ? ",\n    " : "\n    ") << "{\"frame\": " << record.frame << ", \"passes\": [";
+                bool first = true;
+                for (const auto& pass : record.passes)
+                {
+                    if (pass.name.empty())
+                        continue;
+                    file << (first ? "" : ", ") << fmt::format("{{\"name\": \"{}\", \"cpu_ms\": {:.4f}", escape_json(pass.name), pass.cpu_ms);
+                    if (pass.gpu_ms >= 0.0)
+                        file << fmt::format(", \"gpu_ms\": {:.4f}", pass.gpu_ms);
+                    file << "}";
+                    first = false;
+                }
+                file << "]}";
+            }
+            file << "\n  ]\n}\n";
+            DS_LOG_INFO("render graph profiler: wrote {} frames to {}", records.size(), path);
+            return true;
+        }
+
+        auto RenderGraphProfiler::export_csv(const std::string& path) const -> bool
+        {
+            std::ofstream file(path);
+            if (!file)
+            {
+                DS_LOG_ERROR("render graph profiler: can not write {}", path);
+                return false;
+            }
+            file << "pass,cpu_samples,cpu_p50_ms,cpu_p95_ms,cpu_max_ms,gpu_samples,gpu_p50_ms,gpu_p95_ms,gpu_max_ms\n";
+            for (const auto& s : stats())
+            {
+                file << fmt::format("{},{},{:.4f},{:.4f},{:.4f},{},{:.4f},{:.4f},{:.4f}\n",
+                    escape_csv(s.name), s.cpu_samples, s.cpu_p50_ms, s.cpu_p95_ms, s.cpu_max_ms,
+                    s.gpu_samples, s.gpu_p50_ms, s.gpu_p95_ms, s.gpu_max_ms);
+            }
+            DS_LOG_INFO("render graph profiler: wrote stats of {} frames to {}", records.size(), path);
+            return true;
+        }
+
+        auto RenderGraphProfiler::export_file(const std::string& path) const -> bool
+        {
+            const bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+            return json ? export_json(path) : export_csv(path);
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "core/base_type.h"
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace diverse
+{
+    namespace rg
+    {
+        struct PassTiming
+        {
+            std::string name;
+            f64 cpu_ms = 0.0;      // recording the pass: its barriers and render_fn
+            f64 gpu_ms = -1.0;     // between the pass's timestamps, negative until resolved or when unsupported
+        };
+
+        struct FrameTimingRecord
+        {
+            u64 frame = 0;
+            std::vector<PassTiming> passes;
+        };
+
+        struct PassTimingStats
+        {
+            std::string name;
+            u32 cpu_samples = 0;
+            f64 cpu_p50_ms = 0.0;
+            f64 cpu_p95_ms = 0.0;
+            f64 cpu_max_ms = 0.0;
+            u32 gpu_samples = 0;
+            f64 gpu_p50_ms = 0.0;
+            f64 gpu_p95_ms = 0.0;
+            f64 gpu_max_ms = 0.0;
+        };
+
+        // Per pass CPU record time and GPU time of the last max_frames frames. The render graph fills the CPU
+        // side while recording, the GPU side arrives once the device reads the frame's timestamps back, a couple
+        // of frames later. Stats group the samples by pass name.
+        // DS_RG_PROFILE=1 enables it at startup, DS_RG_PROFILE_FRAMES sets the ring size and
+        // DS_RG_PROFILE_EXPORT names a .json or .csv file written when the profiler is destroyed.
+        struct RenderGraphProfiler
+        {
+            RenderGraphProfiler();
+            ~RenderGraphProfiler();
+
+            bool enabled = false;
+
+            // starts the record of a frame with pass_count passes, returns its frame number
+            auto begin_frame(u32 pass_count) -> u64;
+            // called by the thread recording the pass, passes are recorded by exactly one thread each
+            auto set_pass_cpu(u32 pass, const std::string& name, f64 cpu_ms) -> void;
+            // timestamps in ns, two per pass, as written by the frame tagged with frame
+            auto resolve_gpu(u64 frame, const std::vector<u64>& timestamps) -> void;
+
+            auto frames() const -> const std::deque<FrameTimingRecord>& { return records; }
+            auto stats() const -> std::vector<PassTimingStats>;
+            auto clear() -> void;
+
+            auto export_json(const std::string& path) const -> bool;
+            // one row per pass with the aggregate stats
+            auto export_csv(const std::string& path) const -> bool;
+            // picks the format from the extension, csv for anything but .json
+            auto export_file(const std::string& path) const -> bool;
+
+        private:
+            u32 max_frames = 600;
+            u64 frame_index = 0;
+            std::deque<FrameTimingRecord> records;
+            std::string export_path;
+        };
+    }
+}
@@ -1,4 +1,6 @@
 #include "renderer.h"
+#include "core/memory_manager.h"
+#include "core/ds_log.h"
 namespace diverse
 {
     namespace rg
@@ -21,13 +23,7 @@ namespace diverse
                 buffer_flag |=  rhi::BufferUsageFlags::SHADER_DEVICE_ADDRESS |
                 rhi::BufferUsageFlags::ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY;
             }
-            auto desc = rhi::GpuBufferDesc::new_cpu_to_gpu(DYNAMIC_CONSTANTS_SIZE_BYTES * DYNAMIC_CONSTANTS_BUFFER_COUNT,
-                                                           buffer_flag);
-            dynamic_constants.buffer = device->create_buffer(desc,
-                            "dynamic constants buffer",
-                             nullptr);
-            dynamic_constants.device = device;
-
+            dynamic_constants.init(device, buffer_flag);
 
             frame_descriptor_set = device->create_descriptor_set(dynamic_constants.buffer.get(), FRAME_CONSTANTS_LAYOUT,"frame_render_set");
         }
@@ -39,7 +35,11 @@ namespace diverse
         auto Renderer::draw_frame(TemporalGraph& rg,
                         rhi::Swapchain* swapchain) -> void
         {
+            DS_MEMORY_TAG(RenderGraph);
             auto current_frame = device->begin_frame();
+            // timestamps of the frame that last used this slot, its fences just signalled
+            pass_profiler.resolve_gpu(current_frame->timestamps_tag, current_frame->timestamps);
+            rg.profiler = &pass_profiler;
             for (auto cb : {current_frame->main_cmd_buf, current_frame->presentation_cmd_buf }) {
                 cb->begin();
             }
@@ -49,10 +49,13 @@ namespace diverse
             rg.begin_execute();
 
             // Record and submit the main command buffer
-            rg.record_main_cb(main_cb.get());
+            auto worker_cb_count = rg.record_main_cb(main_cb.get(), &current_frame->worker_cmd_bufs);
+            current_frame->timestamps_tag = rg.profiled_frame;
 
             main_cb->end();
             device->submit_cmd(main_cb.get());
+            for (u32 i = 0; i < worker_cb_count; i++)
+                device->submit_cmd(current_frame->worker_cmd_bufs[i].get());
     
             // Now that we've done the main submission and the GPU is busy, acquire the presentation image.
            auto swapchain_image = swapchain->acquire_next_image();
@@ -83,12 +86,18 @@ namespace diverse
 
            dynamic_constants.advance_frame();
            device->end_frame(current_frame);
-           frame_alloctor().free();
         }
 
         auto Renderer::prepare_frame_constants(TemporalGraph& rg,std::function<FrameConstantsLayout(rhi::DynamicConstants&)> prepare_frame_constants) -> void
         {
             frame_constants_layout = prepare_frame_constants(dynamic_constants);
+            // frame_descriptor_set is bound to the main buffer, its offsets cannot live in an overflow page
+            for (auto offset : { frame_constants_layout.globals_offset, frame_constants_layout.instance_dynamic_parameters_offset,
+                                 frame_constants_layout.triangle_lights_offset, frame_constants_layout.scene_lights_offset })
+            {
+                if (!rhi::DynamicConstants::is_main_page(offset))
+                    DS_LOG_ERROR("Frame constants were pushed past the main dynamic constants buffer");
+            }
             register_render_graph(rg);
         }
 
@@ -108,6 +117,7 @@ namespace diverse
 
 		auto Renderer::prepare_frame(TemporalGraph& rg, std::function<void(TemporalGraph&)> prepare_render_graph) -> void
         {
+            DS_MEMORY_TAG(RenderGraph);
             prepare_render_graph(rg);
 
             auto temp_rg_state = rg.export_temporal();
@@ -32,6 +32,7 @@ namespace diverse
 			rhi::Swapchain* swap_chain;
 			rhi::PipelineCache	pipeline_cache;
 			TransientResourceCache transient_resource_cache;
+			RenderGraphProfiler	pass_profiler;
 			rhi::DynamicConstants dynamic_constants;
 			std::shared_ptr<rhi::DescriptorSet>	frame_descriptor_set;
 			FrameConstantsLayout	frame_constants_layout;
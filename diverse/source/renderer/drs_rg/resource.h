@@ -9,12 +9,13 @@ namespace diverse
 	{
 		struct ResourceLifeTime
         {
+            std::optional<uint32> first_access;
             std::optional<uint32> last_access;
         };
 
         struct ResourceInfo
         {
-            std::vector<ResourceLifeTime>   _lifetimes;
+            std::vector<ResourceLifeTime>   lifetimes;
             std::vector<rhi::TextureUsageFlags> image_usage_flags;
             std::vector<rhi::BufferUsageFlags> buffer_usage_flags;
         };
@@ -173,21 +174,25 @@ namespace diverse
 
 		struct RgRtPipelineHandle { uint32 id; };
 
+		// pass_idx is the pass that registered the pipeline, compile skips pipelines of culled passes
 		struct RgComputePipeline
 		{
 			rhi::ComputePipelineDesc desc;
+			uint32 pass_idx = ~0u;
 		};
 
 		struct RgRasterPipeline
 		{
 			rhi::RasterPipelineDesc desc;
 			std::vector<rhi::PipelineShaderDesc> shaders;
+			uint32 pass_idx = ~0u;
 		};
 
 		struct RgRtPipeline
 		{
 			rhi::RayTracingPipelineDesc desc;
 			std::vector<rhi::PipelineShaderDesc> shaders;
+			uint32 pass_idx = ~0u;
 		};
 		template<typename ResType>
 		requires std::derived_from<ResType,diverse::rhi::GpuResource>
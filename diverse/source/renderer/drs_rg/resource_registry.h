@@ -16,7 +16,8 @@ namespace diverse
 				OwnedBuffer,
 				ImportedBuffer,
 				ImportedRayTracingAcceleration,
-				Pending
+				Pending,
+				Culled
 			}ty;
 
 			std::any value;
@@ -69,12 +70,21 @@ namespace diverse
 			{
 				return { AnyRenderResource::Type::Pending, v };
 			}
+
+			// a created resource no remaining pass touches, it never gets memory
+			static auto culled() -> AnyRenderResource
+			{
+				return { AnyRenderResource::Type::Culled, {} };
+			}
 		};
 
 		struct RegistryResource
 		{
 			AnyRenderResource resource;
 			rhi::AccessType	access_type;
+			// placed in a transient heap, the first barrier discards whatever the aliased resources left there
+			bool aliased = false;
+			bool discard_on_first_use = false;
 		};
 
 		struct ResourceRegistry
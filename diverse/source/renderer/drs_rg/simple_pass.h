@@ -26,9 +26,8 @@ namespace diverse
 
             static auto from(T const& t) -> ConstantData<T>*
             {
-                //TODO: vec switch case
-                ConstantData<T> data(t);
-                return frame_alloctor().allocate(data);
+                //lives until the graph has been executed, frame arena memory is recycled two frames later
+                return FrameArenaNew<ConstantData<T>>(t);
             }
         };
 
@@ -47,9 +46,7 @@ namespace diverse
 
             static auto from(T const& t) -> ConstantVecData<T>*
             {
-                //TODO: vec switch case
-                ConstantVecData<T> data(t);
-                return frame_alloctor().allocate(data);
+                return FrameArenaNew<ConstantVecData<T>>(t);
             }
         };
 
@@ -0,0 +1,248 @@
+#include "transient_aliasing.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+
+namespace diverse
+{
+    namespace rg
+    {
+        // placed resources and heaps nothing asked for in this many frames are released
+        static constexpr u64 MAX_UNUSED_FRAMES = 8;
+        static constexpr u64 HEAP_GRANULARITY = 1 << 20;
+
+        static auto align_up(u64 value, u64 alignment) -> u64
+        {
+            alignment = std::max<u64>(alignment, 1);
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        static auto lifetimes_overlap(const TransientAliasingRequest& a, const TransientAliasingRequest& b) -> bool
+        {
+            return a.first_pass <= b.last_pass && b.first_pass <= a.last_pass;
+        }
+
+        static auto memory_overlaps(const TransientAliasingRequest& a, u64 a_offset, const TransientAliasingRequest& b, u64 b_offset) -> bool
+        {
+            return a_offset < b_offset + b.size && b_offset < a_offset + a.size;
+        }
+
+        auto plan_transient_aliasing(const std::vector<TransientAliasingRequest>& requests) -> TransientAliasingPlan
+        {
+            TransientAliasingPlan plan;
+            plan.offsets.resize(requests.size(), 0);
+            plan.aliased.resize(requests.size());
+
+            std::vector<u32> order(requests.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+                if (requests[a].size != requests[b].size)
+                    return requests[a].size > requests[b].size;
+                return requests[a].first_pass < requests[b].first_pass;
+            });
+
+            std::vector<u32> placed;
+            std::vector<std::pair<u64, u64>> busy;
+            placed.reserve(requests.size());
+            for (auto idx : order)
+            {
+                const auto& request = requests[idx];
+                busy.clear();
+                for (auto other : placed)
+                {
+                    if (lifetimes_overlap(request, requests[other]))
+                        busy.push_back({ plan.offsets[other], plan.offsets[other] + requests[other].size });
+                }
+                std::sort(busy.begin(), busy.end());
+
+                u64 offset = 0;
+                for (const auto& [begin, end] : busy)
+                {
+                    if (offset + request.size <= begin)
+                        break;
+                    offset = std::max(offset, align_up(end, request.alignment));
+                }
+                plan.offsets[idx] = offset;
+                plan.heap_size = std::max(plan.heap_size, offset + request.size);
+                plan.requested_bytes += request.size;
+                placed.push_back(idx);
+            }
+
+            for (u32 idx = 0; idx < requests.size(); idx++)
+            {
+                for (u32 other = 0; other < requests.size(); other++)
+                {
+                    if (requests[other].last_pass < requests[idx].first_pass && memory_overlaps(requests[idx], plan.offsets[idx], requests[other], plan.offsets[other]))
+                        plan.aliased[idx].push_back(other);
+                }
+            }
+            return plan;
+        }
+
+        // The latest ending predecessor L is the one to wait on if every other predecessor also aliases L:
+        // L's own first-use barrier already waited on those, so ordering after L orders after them too.
+        auto aliasing_barrier_predecessor(const std::vector<TransientAliasingRequest>& requests, const TransientAliasingPlan& plan, u32 request) -> std::optional<u32>
+        {
+            const auto& aliased = plan.aliased[request];
+            if (aliased.empty())
+                return {};
+
+            u32 latest = aliased[0];
+            for (auto other : aliased)
+            {
+                if (requests[other].last_pass > requests[latest].last_pass)
+                    latest = other;
+            }
+            const auto& latest_aliased = plan.aliased[latest];
+            for (auto other : aliased)
+            {
+                if (other != latest && std::find(latest_aliased.begin(), latest_aliased.end(), other) == latest_aliased.end())
+                    return {};
+            }
+            return latest;
+        }
+
+        TransientAliasingAllocator::TransientAliasingAllocator()
+        {
+            if (const char* env = getenv("DS_RG_ALIASING"); env && strcmp(env, "0") == 0)
+                is_enabled = false;
+        }
+
+        auto TransientAliasingAllocator::requirements(rhi::GpuDevice* device, const rhi::GpuTextureDesc& desc) -> std::optional<rhi::GpuMemoryRequirements>
+        {
+            auto it = image_requirements.find(desc);
+            if (it != image_requirements.end())
+                return it->second;
+            auto requirements = device->get_memory_requirements(desc);
+            image_requirements.insert({ desc, requirements });
+            return requirements;
+        }
+
+        auto TransientAliasingAllocator::requirements(rhi::GpuDevice* device, const rhi::GpuBufferDesc& desc) -> std::optional<rhi::GpuMemoryRequirements>
+        {
+            auto it = buffer_requirements.find(desc);
+            if (it != buffer_requirements.end())
+                return it->second;
+            auto requirements = device->get_memory_requirements(desc);
+            buffer_requirements.insert({ desc, requirements });
+            return requirements;
+        }
+
+        auto TransientAliasingAllocator::begin_frame() -> void
+        {
+            frame_stats = {};
+        }
+
+        auto TransientAliasingAllocator::acquire_heap(rhi::GpuDevice* device, u64 group, u32 memory_type_bits, u64 size) -> std::shared_ptr<rhi::GpuMemoryHeap>
+        {
+            auto& entry = heaps[group];
+            if (!entry.heap || entry.heap->size < size)
+            {
+                // Resources placed in the old heap go with it, the device defers the actual free past in-flight frames
+                if (entry.heap)
+                    drop_placed(entry.heap.get());
+                entry.heap = device->create_memory_heap(align_up(size + size / 8, HEAP_GRANULARITY), memory_type_bits, "rg transient heap");
+                if (!entry.heap)
+                {
+                    heaps.erase(group);
+                    return nullptr;
+                }
+            }
+            entry.last_used_frame = frame_index;
+            return entry.heap;
+        }
+
+        auto TransientAliasingAllocator::place_image(rhi::GpuDevice* device, const rhi::GpuTextureDesc& desc, const std::shared_ptr<rhi::GpuMemoryHeap>& heap, u64 offset, const char* name) -> std::shared_ptr<rhi::GpuTexture>
+        {
+            auto& entries = images[PlacedKey<rhi::GpuTextureDesc>{ heap.get(), offset, desc }];
+            for (auto& placed : entries)
+            {
+                if (placed.last_used_frame != frame_index)
+                {
+                    placed.last_used_frame = frame_index;
+                    return placed.resource;
+                }
+            }
+            auto image = device->create_placed_texture(desc, heap, offset, name);
+            if (image)
+                entries.push_back({ image, frame_index });
+            return image;
+        }
+
+        auto TransientAliasingAllocator::place_buffer(rhi::GpuDevice* device, const rhi::GpuBufferDesc& desc, const std::shared_ptr<rhi::GpuMemoryHeap>& heap, u64 offset, const char* name) -> std::shared_ptr<rhi::GpuBuffer>
+        {
+            auto& entries = buffers[PlacedKey<rhi::GpuBufferDesc>{ heap.get(), offset, desc }];
+            for (auto& placed : entries)
+            {
+                if (placed.last_used_frame != frame_index)
+                {
+                    placed.last_used_frame = frame_index;
+                    return placed.resource;
+                }
+            }
+            auto buffer = device->create_placed_buffer(desc, heap, offset, name);
+            if (buffer)
+                entries.push_back({ buffer, frame_index });
+            return buffer;
+        }
+
+        auto TransientAliasingAllocator::record_plan(const TransientAliasingPlan& plan, u32 placed) -> void
+        {
+            frame_stats.placed_resources += placed;
+            frame_stats.requested_bytes += plan.requested_bytes;
+            frame_stats.planned_bytes += plan.heap_size;
+        }
+
+        auto TransientAliasingAllocator::end_frame() -> void
+        {
+            auto evict = [&](auto& map) {
+                for (auto it = map.begin(); it != map.end();)
+                {
+                    auto& entries = it->second;
+                    entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const auto& placed) {
+                        return frame_index - placed.last_used_frame > MAX_UNUSED_FRAMES;
+                    }), entries.end());
+                    it = entries.empty() ? map.erase(it) : ++it;
+                }
+            };
+            evict(images);
+            evict(buffers);
+
+            frame_stats.heap_bytes = 0;
+            for (auto it = heaps.begin(); it != heaps.end();)
+            {
+                if (frame_index - it->second.last_used_frame > MAX_UNUSED_FRAMES)
+                {
+                    drop_placed(it->second.heap.get());
+                    it = heaps.erase(it);
+                    continue;
+                }
+                frame_stats.heap_bytes += it->second.heap->size;
+                ++it;
+            }
+            last_stats = frame_stats;
+            frame_index++;
+        }
+
+        auto TransientAliasingAllocator::drop_placed(const rhi::GpuMemoryHeap* heap) -> void
+        {
+            auto drop = [&](auto& map) {
+                for (auto it = map.begin(); it != map.end();)
+                    it = it->first.heap == heap ? map.erase(it) : ++it;
+            };
+            drop(images);
+            drop(buffers);
+        }
+
+        auto TransientAliasingAllocator::clear() -> void
+        {
+            images.clear();
+            buffers.clear();
+            heaps.clear();
+            image_requirements.clear();
+            buffer_requirements.clear();
+            last_stats = {};
+        }
+    }
+}
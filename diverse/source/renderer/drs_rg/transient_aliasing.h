@@ -0,0 +1,118 @@
+#pragma once
+#include "backend/drs_rhi/gpu_device.h"
+#include "core/flat_hash_map.h"
+#include <optional>
+#include <vector>
+
+namespace diverse
+{
+    namespace rg
+    {
+        // One transient resource as the planner sees it: its memory requirements and the inclusive range
+        // of pass indices it is live for.
+        struct TransientAliasingRequest
+        {
+            u64 size = 0;
+            u64 alignment = 1;
+            u32 first_pass = 0;
+            u32 last_pass = 0;
+        };
+
+        struct TransientAliasingPlan
+        {
+            std::vector<u64> offsets;
+            // per request, the earlier requests whose memory it reuses; their lifetimes ended before it starts
+            std::vector<std::vector<u32>> aliased;
+            u64 heap_size = 0;
+            u64 requested_bytes = 0;
+        };
+
+        // Places every request into one heap so that requests live at the same time never share bytes.
+        // Largest first, each at the lowest aligned offset that fits between the already placed requests it
+        // overlaps in time. Pure cpu, no device involved.
+        auto plan_transient_aliasing(const std::vector<TransientAliasingRequest>& requests) -> TransientAliasingPlan;
+
+        // Of a request's aliased predecessors, the one a first-use barrier has to wait on. Returns nothing when
+        // the predecessors are not ordered behind a single one, the barrier then has to be a full one.
+        auto aliasing_barrier_predecessor(const std::vector<TransientAliasingRequest>& requests, const TransientAliasingPlan& plan, u32 request) -> std::optional<u32>;
+
+        struct TransientAliasingStats
+        {
+            u32 placed_resources = 0;
+            u64 requested_bytes = 0;   // sum of the placed resources' sizes, what separate allocations would take
+            u64 planned_bytes = 0;     // sum of the heaps the frame's plans needed
+            u64 heap_bytes = 0;        // heap memory currently allocated
+        };
+
+        // Owns the heaps transient render graph resources are placed into and the placed resources themselves,
+        // which are reused across frames as long as the plan keeps them at the same desc and offset.
+        // Heaps are keyed by a group so images and buffers never share a heap, which sidesteps
+        // bufferImageGranularity. Resources are handed out between begin_frame and end_frame only.
+        struct TransientAliasingAllocator
+        {
+            TransientAliasingAllocator();
+
+            auto enabled() const -> bool { return is_enabled; }
+            auto requirements(rhi::GpuDevice* device, const rhi::GpuTextureDesc& desc) -> std::optional<rhi::GpuMemoryRequirements>;
+            auto requirements(rhi::GpuDevice* device, const rhi::GpuBufferDesc& desc) -> std::optional<rhi::GpuMemoryRequirements>;
+
+            auto begin_frame() -> void;
+            // a heap of at least size bytes for the group, nullptr when the device cannot allocate it
+            auto acquire_heap(rhi::GpuDevice* device, u64 group, u32 memory_type_bits, u64 size) -> std::shared_ptr<rhi::GpuMemoryHeap>;
+            auto place_image(rhi::GpuDevice* device, const rhi::GpuTextureDesc& desc, const std::shared_ptr<rhi::GpuMemoryHeap>& heap, u64 offset, const char* name) -> std::shared_ptr<rhi::GpuTexture>;
+            auto place_buffer(rhi::GpuDevice* device, const rhi::GpuBufferDesc& desc, const std::shared_ptr<rhi::GpuMemoryHeap>& heap, u64 offset, const char* name) -> std::shared_ptr<rhi::GpuBuffer>;
+            auto record_plan(const TransientAliasingPlan& plan, u32 placed) -> void;
+            auto end_frame() -> void;
+
+            auto stats() const -> const TransientAliasingStats& { return last_stats; }
+            auto clear() -> void;
+
+        private:
+            template<typename Desc>
+            struct PlacedKey
+            {
+                const rhi::GpuMemoryHeap* heap;
+                u64 offset;
+                Desc desc;
+                auto operator==(const PlacedKey& other) const -> bool
+                {
+                    return heap == other.heap && offset == other.offset && desc == other.desc;
+                }
+            };
+            template<typename Desc>
+            struct PlacedKeyHash
+            {
+                auto operator()(const PlacedKey<Desc>& key) const -> size_t
+                {
+                    u64 hash_code = std::hash<Desc>()(key.desc);
+                    diverse::hash_combine(hash_code, u64(key.heap));
+                    diverse::hash_combine(hash_code, key.offset);
+                    return hash_code;
+                }
+            };
+            template<typename Res>
+            struct Placed
+            {
+                std::shared_ptr<Res> resource;
+                u64 last_used_frame = 0;
+            };
+            struct Heap
+            {
+                std::shared_ptr<rhi::GpuMemoryHeap> heap;
+                u64 last_used_frame = 0;
+            };
+
+            auto drop_placed(const rhi::GpuMemoryHeap* heap) -> void;
+
+            bool is_enabled = true;
+            u64 frame_index = 1;
+            FlatHashMap<rhi::GpuTextureDesc, std::optional<rhi::GpuMemoryRequirements>> image_requirements;
+            FlatHashMap<rhi::GpuBufferDesc, std::optional<rhi::GpuMemoryRequirements>> buffer_requirements;
+            FlatHashMap<u64, Heap> heaps;
+            FlatHashMap<PlacedKey<rhi::GpuTextureDesc>, std::vector<Placed<rhi::GpuTexture>>, PlacedKeyHash<rhi::GpuTextureDesc>> images;
+            FlatHashMap<PlacedKey<rhi::GpuBufferDesc>, std::vector<Placed<rhi::GpuBuffer>>, PlacedKeyHash<rhi::GpuBufferDesc>> buffers;
+            TransientAliasingStats frame_stats;
+            TransientAliasingStats last_stats;
+        };
+    }
+}
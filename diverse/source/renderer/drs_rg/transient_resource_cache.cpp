@@ -0,0 +1,93 @@
+#include "transient_resource_cache.h"
+#include <cstdlib>
+
+namespace diverse
+{
+    namespace rg
+    {
+        TransientResourceCache::TransientResourceCache()
+        {
+            if (const char* env = getenv("DS_RG_TRANSIENT_BUDGET_MB"))
+                budget_bytes = u64(strtoull(env, nullptr, 10)) << 20;
+            if (const char* env = getenv("DS_RG_TRANSIENT_MAX_UNUSED_FRAMES"))
+                max_unused_frames = static_cast<u32>(atoi(env));
+        }
+
+        auto TransientResourceCache::end_frame() -> void
+        {
+            evict_unused();
+            if (cached_bytes > budget_bytes)
+                evict_over_budget();
+            frame_index++;
+        }
+
+        auto TransientResourceCache::evict_unused() -> void
+        {
+            auto evict = [&](auto& map) {
+                for (auto it = map.begin(); it != map.end();)
+                {
+                    auto& entries = it->second;
+                    while (!entries.empty() && frame_index - entries.front().last_used_frame > max_unused_frames)
+                    {
+                        counters.evicted_resources++;
+                        counters.evicted_bytes += entries.front().size;
+                        cached_bytes -= entries.front().size;
+                        cached_resources--;
+                        entries.pop_front();
+                    }
+                    it = entries.empty() ? map.erase(it) : ++it;
+                }
+            };
+            evict(images);
+            evict(buffers);
+        }
+
+        // Every desc's deque is already ordered by release frame, so the globally least recently used entry
+        // is the oldest of the deque fronts.
+        auto TransientResourceCache::evict_over_budget() -> void
+        {
+            while (cached_bytes > budget_bytes)
+            {
+                auto oldest_image = images.end();
+                for (auto it = images.begin(); it != images.end(); ++it)
+                {
+                    if (!it->second.empty() && (oldest_image == images.end() || it->second.front().last_used_frame < oldest_image->second.front().last_used_frame))
+                        oldest_image = it;
+                }
+                auto oldest_buffer = buffers.end();
+                for (auto it = buffers.begin(); it != buffers.end(); ++it)
+                {
+                    if (!it->second.empty() && (oldest_buffer == buffers.end() || it->second.front().last_used_frame < oldest_buffer->second.front().last_used_frame))
+                        oldest_buffer = it;
+                }
+
+                auto pop_oldest = [&](auto& map, auto it) {
+                    auto& entries = it->second;
+                    counters.evicted_resources++;
+                    counters.evicted_bytes += entries.front().size;
+                    cached_bytes -= entries.front().size;
+                    cached_resources--;
+                    entries.pop_front();
+                    if (entries.empty())
+                        map.erase(it);
+                };
+                const bool has_image = oldest_image != images.end();
+                const bool has_buffer = oldest_buffer != buffers.end();
+                if (!has_image && !has_buffer)
+                    break;
+                if (has_image && (!has_buffer || oldest_image->second.front().last_used_frame <= oldest_buffer->second.front().last_used_frame))
+                    pop_oldest(images, oldest_image);
+                else
+                    pop_oldest(buffers, oldest_buffer);
+            }
+        }
+
+        auto TransientResourceCache::stats() const -> TransientResourceCacheStats
+        {
+            auto stats = counters;
+            stats.cached_resources = cached_resources;
+            stats.cached_bytes = cached_bytes;
+            return stats;
+        }
+    }
+}
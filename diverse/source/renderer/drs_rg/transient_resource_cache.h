@@ -1,101 +1,134 @@
 #pragma once
 #include "backend/drs_rhi/gpu_buffer.h"
 #include "backend/drs_rhi/gpu_texture.h"
+#include "core/flat_hash_map.h"
+#include "transient_aliasing.h"
+#include <deque>
 #include <optional>
 namespace diverse
 {
     namespace rg
     {
+        struct TransientResourceCacheStats
+        {
+            u64 hits = 0;
+            u64 misses = 0;
+            u64 evicted_resources = 0;
+            u64 evicted_bytes = 0;
+            u32 cached_resources = 0;  // released resources waiting for reuse
+            u64 cached_bytes = 0;
+        };
+
+        // Released render graph images and buffers, keyed by desc, handed out again to later graphs.
+        // Entries are stamped with the frame they were released in. end_frame drops the ones unused for
+        // max_unused_frames and then the least recently used ones until the cache fits budget_bytes, so
+        // targets of an old resolution do not stay resident after a resize.
+        // DS_RG_TRANSIENT_BUDGET_MB and DS_RG_TRANSIENT_MAX_UNUSED_FRAMES override the defaults.
         struct TransientResourceCache
         {
-            std::unordered_map<rhi::GpuTextureDesc,std::deque<std::shared_ptr<rhi::GpuTexture>>> images;
-            std::unordered_map<rhi::GpuBufferDesc,std::deque<std::shared_ptr<rhi::GpuBuffer>>>   buffers;
-        
+            template<typename Res>
+            struct Cached
+            {
+                std::shared_ptr<Res> resource;
+                u64 last_used_frame = 0;
+                u64 size = 0;
+            };
+            // per desc oldest first, reuse takes the most recently released one so the rest can age out
+            FlatHashMap<rhi::GpuTextureDesc,std::deque<Cached<rhi::GpuTexture>>> images;
+            FlatHashMap<rhi::GpuBufferDesc,std::deque<Cached<rhi::GpuBuffer>>>   buffers;
+            TransientAliasingAllocator aliasing;
+
+            TransientResourceCache();
+
             auto get_image(const rhi::GpuTextureDesc& desc)->std::optional<std::shared_ptr<rhi::GpuTexture>>
             {
-                auto it = images.find(desc);
-                if( it != images.end())
-                {
-                    if(!it->second.empty())
-                    {
-                        auto back =  it->second.front();
-                        it->second.pop_front();
-                        return back;
-                    }
-                }   
-                return {};
+                return take(images, desc);
             }
 
             auto get_or_insert_image(const rhi::GpuTextureDesc& desc,const std::shared_ptr<rhi::GpuTexture>& texture)->std::optional<std::shared_ptr<rhi::GpuTexture>>
             {
-                auto it = images.find(desc);
-                if( it != images.end())
-                {
-                    auto back =  it->second.front();
-                    it->second.pop_front();
-                    return back;
-                }
-                images[desc].push_back(texture);
+                if (auto image = take(images, desc))
+                    return image;
+                insert_image(texture);
                 return texture;
             }
 
-            auto insert_image(const std::shared_ptr<rhi::GpuTexture>& image)
+            auto insert_image(const std::shared_ptr<rhi::GpuTexture>& image)->void
             {
-                auto it = images.find(image->desc);
-                if( it != images.end())
-                {
-                    it->second.push_back(image);
-                }else
-                {
-                    images.insert({image->desc, {image}});
-                }
+                put(images, image->desc, image, rhi::texture_size_bytes(image->desc));
             }
 
             auto get_buffer(const rhi::GpuBufferDesc& desc)->std::optional<std::shared_ptr<rhi::GpuBuffer>>
             {
-               auto it = buffers.find(desc);
-                if( it != buffers.end())
-                {
-                    if(!it->second.empty())
-                    { 
-                        auto back =  it->second.front();
-                        it->second.pop_front();
-                        return back;
-                    }
-                }   
-                return {};
+                return take(buffers, desc);
             }
 
             auto insert_buffer(const std::shared_ptr<rhi::GpuBuffer>& buffer)->void
             {
-                auto it = buffers.find(buffer->desc);
-                if( it != buffers.end())
-                {
-                    it->second.push_back(buffer);
-                }else
-                {
-                    buffers.insert({buffer->desc, {buffer}});
-                }
+                put(buffers, buffer->desc, buffer, buffer->desc.size);
             }
 
             auto get_or_insert_buffer(const rhi::GpuBufferDesc& desc,const std::shared_ptr<rhi::GpuBuffer>& buffer)->std::optional<std::shared_ptr<rhi::GpuBuffer>>
             {
-                auto it = buffers.find(desc);
-                if( it != buffers.end())
-                {
-                    auto back =  it->second.front();
-                    it->second.pop_front();
-                    return back;
-                }
-                buffers[desc].push_back(buffer);
+                if (auto cached = take(buffers, desc))
+                    return cached;
+                insert_buffer(buffer);
                 return buffer;
             }
 
+            auto set_budget(u64 bytes, u32 unused_frames) -> void
+            {
+                budget_bytes = bytes;
+                max_unused_frames = unused_frames;
+            }
+            // called once per executed graph after its resources were released, evicts and advances the frame
+            auto end_frame() -> void;
+            auto stats() const -> TransientResourceCacheStats;
+
             auto clear_resource()
             {
                 images.clear();
 				buffers.clear();
+                aliasing.clear();
+                cached_bytes = 0;
+                cached_resources = 0;
             }
+
+        private:
+            template<typename Map, typename Desc>
+            auto take(Map& map, const Desc& desc) -> std::optional<decltype(map.begin()->second.back().resource)>
+            {
+                auto it = map.find(desc);
+                if( it != map.end() && !it->second.empty())
+                {
+                    auto back = std::move(it->second.back());
+                    it->second.pop_back();
+                    cached_bytes -= back.size;
+                    cached_resources--;
+                    counters.hits++;
+                    return back.resource;
+                }
+                counters.misses++;
+                return {};
+            }
+
+            template<typename Map, typename Desc, typename Res>
+            auto put(Map& map, const Desc& desc, const std::shared_ptr<Res>& resource, u64 size) -> void
+            {
+                map[desc].push_back({ resource, frame_index, size });
+                cached_bytes += size;
+                cached_resources++;
+            }
+
+            auto evict_unused() -> void;
+            auto evict_over_budget() -> void;
+
+            u64 budget_bytes = 1024ull << 20;
+            u32 max_unused_frames = 120;
+            u64 frame_index = 0;
+            u64 cached_bytes = 0;
+            u32 cached_resources = 0;
+            TransientResourceCacheStats counters;
         };
     }
-}
\ No newline at end of file
+}
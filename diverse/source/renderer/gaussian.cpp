@@ -381,6 +381,7 @@ namespace diverse
 					.constants(crop_constants)
 					.raw_descriptor_set(1, renderer->binldess_descriptorset())
 					.dispatch({ (u32)gs_constants.num_gaussians,1,1 });
+				cmd.model->invalidate_state_delta();
 			}
 			//reset gaussian state
 			{
@@ -392,6 +393,7 @@ namespace diverse
 						.constants(glm::uvec4(gs_constants.num_gaussians, max_gaussians, gs_buf_id,0))
 						.raw_descriptor_set(1, renderer->binldess_descriptorset())
 						.dispatch({ (u32)gs_constants.num_gaussians,1,1 });
+					cmd.model->invalidate_state_delta();
 				}
 				preHasCrop = hasCrop;
 			}
@@ -19,34 +19,33 @@ namespace diverse
         ModelRef = createSharedPtr<GaussianModel>(max_splats);
     }
 
-    void GaussianComponent::apply_color_adjustment()
+    void GaussianComponent::bake_color_adjustment(bool upload)
     {
-        if(albedo_color != glm::vec3(0)  || black_point != 0 || white_point != 1 || brightness != 1)
-        {
-            const float SH0 = 0.282094791773878f;
-            const auto to = [=](f32 value) {return value * SH0 + 0.5f;};
-            const auto from = [=](f32 value) {return (value - 0.5f) / SH0;};
-            const auto offset = -black_point + brightness;
-            const auto scale = 1.0f / (white_point - black_point);;
-            
-            parallel_for<size_t>(0, ModelRef->sh0().size(),[&](size_t i){
-                auto& f_dc_0 = ModelRef->sh0()[i][0];
-                auto& f_dc_1 = ModelRef->sh0()[i][1];
-                auto& f_dc_2 = ModelRef->sh0()[i][2];
-                f_dc_0 = from(offset + to(f_dc_0) * albedo_color.x * scale);
-                f_dc_1 = from(offset + to(f_dc_1) * albedo_color.y * scale);
-                f_dc_2 = from(offset + to(f_dc_2) * albedo_color.z * scale);
-            });
-        }
-        if( transparency != 1.0f )
-        {
-            const auto invSig = [](f32 value) {return (value <= 0) ? -400 : ((value >= 1) ? 400 : -std::log(1/value - 1)); };
-            const auto sig = [](f32 value) {return 1.0f / (1.0f + std::exp(-value));};
-            parallel_for<size_t>(0, ModelRef->opacity().size(),[&](size_t i){
-                auto& opacity = ModelRef->opacity()[i];
-                opacity = invSig(sig(opacity) * transparency);
-            });
-        }
+        if (!ModelRef || color_adjustment.is_identity()) return;
+        const float SH0 = 0.282094791773878f;
+        const auto to = [=](f32 value) {return value * SH0 + 0.5f;};
+        const auto from = [=](f32 value) {return (value - 0.5f) / SH0;};
+        const auto invSig = [](f32 value) {return (value <= 0) ? -400 : ((value >= 1) ? 400 : -std::log(1/value - 1)); };
+        const auto sig = [](f32 value) {return 1.0f / (1.0f + std::exp(-value));};
+        const auto tint = color_adjustment.tint_color();
+        const auto offset = color_adjustment.color_offset();
+        const bool adjust_opacity = tint.w != 1.0f;
+
+        auto lock = ModelRef->lock_data();
+        auto& sh0 = ModelRef->sh0();
+        auto& opacities = ModelRef->opacity();
+        parallel_for<size_t>(0, sh0.size(),[&](size_t i){
+            auto& f_dc = sh0[i];
+            f_dc[0] = from(offset.x + to(f_dc[0]) * tint.x);
+            f_dc[1] = from(offset.y + to(f_dc[1]) * tint.y);
+            f_dc[2] = from(offset.z + to(f_dc[2]) * tint.z);
+            if (adjust_opacity)
+                opacities[i] = invSig(sig(opacities[i]) * tint.w);
+        });
+        lock.unlock();
+        color_adjustment = SplatColorAdjustment{};
+        if (upload)
+            ModelRef->update_color_data();
     }
     // void GaussianComponent::load_from_library(const std::string& path)
     // {
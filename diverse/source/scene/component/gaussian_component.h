@@ -16,6 +16,32 @@ namespace diverse
 	};
 	void set_gaussian_render_type(GaussianRenderType ty);
 
+	// color grading applied by the splat shaders on the fly, only baked into sh0/opacity on export or commit
+	struct SplatColorAdjustment
+	{
+		glm::vec3 albedo_color = glm::vec3(1.0f);
+		f32       brightness = 0.0f;
+		f32       transparency = 1.0f;
+		f32       white_point = 1.0f;
+		f32       black_point = 0.0f;
+
+		bool is_identity() const
+		{
+			return albedo_color == glm::vec3(1.0f) && brightness == 0.0f && transparency == 1.0f && white_point == 1.0f && black_point == 0.0f;
+		}
+		//xyz: color scale, w: transparency
+		glm::vec4 tint_color() const
+		{
+			const auto scale = 1.0f / (white_point - black_point);
+			return glm::vec4(albedo_color * scale, transparency);
+		}
+		glm::vec3 color_offset() const
+		{
+			const auto offset = -black_point + brightness;
+			return glm::vec3(offset, offset, offset);
+		}
+	};
+
 	struct GaussianComponent
 	{
 		
@@ -36,13 +62,10 @@ namespace diverse
 		bool 			   participate_render = true;
 		bool 			   skip_render = false;
 		i32 			   sh_degree = 3;
-		f32 			   transparency = 1.0f;
-		f32 			   brightness = 0.0f;
-		f32				   white_point = 1.0f;
-		f32				   black_point = 0.0f;
-		glm::vec3		   albedo_color = glm::vec3(1.0f);
+		SplatColorAdjustment color_adjustment;
 		u32 			   max_splats = 2000000;
-		void 			  apply_color_adjustment();
+		//writes color_adjustment into sh0/opacity in one pass and resets it to identity
+		void 			  bake_color_adjustment(bool upload = true);
 		template <typename Archive>
 		void save(Archive& archive) const
 		{
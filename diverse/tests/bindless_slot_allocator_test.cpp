@@ -0,0 +1,116 @@
+#include "backend/drs_rhi/bindless_slot_allocator.h"
+#include "core/ds_log.h"
+#include "test_common.h"
+
+#include <vector>
+
+using namespace diverse;
+using namespace diverse::rhi;
+
+namespace
+{
+    void test_allocate_release()
+    {
+        BindlessSlotAllocator slots(0, 2);
+        auto a = slots.allocate();
+        auto b = slots.allocate();
+        DS_CHECK(a.valid() && b.valid());
+        DS_CHECK(a.index == 0 && b.index == 1);
+        DS_CHECK(slots.is_live(a) && slots.is_live(b));
+
+        DS_CHECK(slots.release(a));
+        DS_CHECK(!slots.is_live(a) && slots.is_live(b));
+        // a second release of the same slot is refused
+        DS_CHECK(!slots.release(a));
+        DS_CHECK(!slots.release(BindlessSlot {}));
+
+        auto stats = slots.stats();
+        DS_CHECK(stats.live == 1 && stats.retiring == 1 && stats.free == 0 && stats.high_water_mark == 2);
+    }
+
+    // a released index is held back for retire_frames frames, the frames in flight may still read it
+    void test_retire_window()
+    {
+        BindlessSlotAllocator slots(0, 2);
+        auto a = slots.allocate();
+        slots.release(a);
+
+        slots.end_frame();
+        DS_CHECK(slots.allocate().index == 1);
+        slots.end_frame();
+        DS_CHECK(slots.allocate().index == 2);
+        slots.end_frame();
+        DS_CHECK(slots.stats().free == 1 && slots.stats().retiring == 0);
+
+        auto reused = slots.allocate();
+        DS_CHECK(reused.index == a.index);
+        DS_CHECK(slots.high_water_mark() == 3);
+    }
+
+    // the generation tells a reused index apart from the slot that held it before
+    void test_generation_reuse()
+    {
+        BindlessSlotAllocator slots(0, 0);
+        auto old_slot = slots.allocate();
+        slots.release(old_slot);
+        slots.end_frame();
+
+        auto new_slot = slots.allocate();
+        DS_CHECK(new_slot.index == old_slot.index);
+        DS_CHECK(new_slot.generation != old_slot.generation);
+        DS_CHECK(slots.is_live(new_slot) && !slots.is_live(old_slot));
+
+        // releasing through the stale handle must not free the new owner's slot
+        DS_CHECK(!slots.release(old_slot));
+        DS_CHECK(slots.is_live(new_slot));
+        DS_CHECK(slots.release(new_slot));
+    }
+
+    void test_capacity()
+    {
+        BindlessSlotAllocator slots(4, 1);
+        std::vector<BindlessSlot> held;
+        for(int i = 0; i < 4; i++)
+            held.push_back(slots.allocate());
+        DS_CHECK(!slots.allocate().valid());
+
+        // still full while the released slot is retiring
+        slots.release(held[2]);
+        DS_CHECK(!slots.allocate().valid());
+        slots.end_frame();
+        slots.end_frame();
+        auto slot = slots.allocate();
+        DS_CHECK(slot.valid() && slot.index == 2);
+        DS_CHECK(slots.high_water_mark() == 4);
+    }
+
+    // steady churn keeps the array at the peak of live plus retiring slots, it does not keep growing
+    void test_high_water_mark()
+    {
+        BindlessSlotAllocator slots(0, 2);
+        std::vector<BindlessSlot> live;
+        for(int frame = 0; frame < 100; frame++)
+        {
+            for(auto& slot : live)
+                DS_CHECK(slots.release(slot));
+            live.clear();
+            for(int i = 0; i < 8; i++)
+                live.push_back(slots.allocate());
+            slots.end_frame();
+        }
+        // released in frame F, free again once frame F + 3 starts: at the peak three frames' slots are retiring
+        DS_CHECK(slots.stats().live == 8 && slots.stats().retiring == 8 * 2);
+        DS_CHECK(slots.high_water_mark() == 8 + 8 * 3);
+    }
+}
+
+int main()
+{
+    debug::Log::init();
+    test_allocate_release();
+    test_retire_window();
+    test_generation_reuse();
+    test_capacity();
+    test_high_water_mark();
+    return DS_TEST_RESULT();
+}
@@ -0,0 +1,189 @@
+#include "core/flat_hash_map.h"
+#include "test_common.h"
+
+#include <random>
+#include <string>
+#include <unordered_map>
+
+using namespace diverse;
+
+namespace
+{
+    // few distinct hashes, so probing crosses groups and erase has to leave tombstones
+    struct CollidingHash
+    {
+        size_t operator()(uint64_t key) const { return key & 0x1F; }
+    };
+
+    template <typename Map>
+    bool same_contents(const Map& map, const std::unordered_map<uint64_t, uint64_t>& reference)
+    {
+        if(map.size() != reference.size())
+            return false;
+        size_t visited = 0;
+        for(auto& [key, value] : map)
+        {
+            auto it = reference.find(key);
+            if(it == reference.end() || it->second != value)
+                return false;
+            visited++;
+        }
+        return visited == reference.size();
+    }
+
+    // random insert / find / erase against std::unordered_map
+    template <typename Map>
+    void random_ops(Map& map, uint32_t seed, uint64_t key_range, int ops)
+    {
+        std::unordered_map<uint64_t, uint64_t> reference;
+        std::mt19937_64 rng(seed);
+        for(int i = 0; i < ops; i++)
+        {
+            const uint64_t key = rng() % key_range;
+            switch(rng() % 6)
+            {
+            case 0:
+            case 1:
+            {
+                const uint64_t value = rng();
+                auto [it, inserted]  = map.try_emplace(key, value);
+                auto ref             = reference.try_emplace(key, value);
+                DS_CHECK(inserted == ref.second);
+                DS_CHECK(it->first == key && it->second == ref.first->second);
+                break;
+            }
+            case 2:
+            {
+                const uint64_t value = rng();
+                map.insert_or_assign(key, value);
+                reference.insert_or_assign(key, value);
+                break;
+            }
+            case 3:
+                DS_CHECK(map.erase(key) == reference.erase(key));
+                break;
+            case 4:
+            {
+                auto it  = map.find(key);
+                auto ref = reference.find(key);
+                DS_CHECK((it == map.end()) == (ref == reference.end()));
+                if(it != map.end() && ref != reference.end())
+                    DS_CHECK(it->second == ref->second);
+                break;
+            }
+            default:
+                map[key] += 1;
+                reference[key] += 1;
+                break;
+            }
+            DS_CHECK(map.size() == reference.size());
+        }
+        DS_CHECK(same_contents(map, reference));
+
+        // erase through iterators, every other element
+        bool drop = false;
+        for(auto it = map.begin(); it != map.end();)
+        {
+            if(drop)
+            {
+                reference.erase(it->first);
+                it = map.erase(it);
+            }
+            else
+                ++it;
+            drop = !drop;
+        }
+        DS_CHECK(same_contents(map, reference));
+    }
+
+    void test_random_ops()
+    {
+        FlatHashMap<uint64_t, uint64_t> map;
+        random_ops(map, 1, 4096, 200000);
+
+        FlatHashMap<uint64_t, uint64_t> small;
+        random_ops(small, 2, 24, 50000);
+
+        FlatHashMap<uint64_t, uint64_t, CollidingHash> colliding;
+        random_ops(colliding, 3, 1024, 100000);
+    }
+
+    // inserting and erasing distinct keys forever must reuse tombstones instead of growing
+    void test_tombstone_churn()
+    {
+        FlatHashMap<uint64_t, uint64_t> map;
+        map.reserve(64);
+        const size_t capacity = map.capacity();
+        for(uint64_t i = 0; i < 100000; i++)
+        {
+            map.insert({ i, i });
+            if(i >= 32)
+                DS_CHECK(map.erase(i - 32) == 1);
+        }
+        DS_CHECK(map.size() == 32);
+        DS_CHECK(map.capacity() == capacity);
+        for(uint64_t i = 100000 - 32; i < 100000; i++)
+            DS_CHECK(map.contains(i));
+    }
+
+    void test_string_keys()
+    {
+        FlatHashMap<std::string, std::string, StringHash> map;
+        std::unordered_map<std::string, std::string> reference;
+        for(int i = 0; i < 2000; i++)
+        {
+            std::string key = "shader_" + std::to_string(i * 7);
+            map.emplace(key, key + "_value");
+            reference.emplace(key, key + "_value");
+        }
+        for(int i = 0; i < 2000; i += 3)
+        {
+            std::string key = "shader_" + std::to_string(i * 7);
+            DS_CHECK(map.erase(std::string_view(key)) == reference.erase(key));
+        }
+        DS_CHECK(map.size() == reference.size());
+        for(auto& [key, value] : reference)
+        {
+            // heterogeneous lookups, no std::string temporary
+            auto it = map.find(std::string_view(key));
+            DS_CHECK(it != map.end() && it->second == value);
+            DS_CHECK(map.contains(key.c_str()));
+        }
+        DS_CHECK(!map.contains("shader_1"));
+
+        auto copy = map;
+        DS_CHECK(copy.size() == map.size());
+        auto moved = std::move(copy);
+        DS_CHECK(moved.size() == map.size() && moved.at(std::string_view("shader_7")) == "shader_7_value");
+
+        map.clear();
+        DS_CHECK(map.empty() && map.begin() == map.end());
+        DS_CHECK(!map.contains("shader_7"));
+    }
+
+    void test_arena_storage()
+    {
+        Arena* arena = ArenaAlloc(64 * 1024);
+        {
+            // grows past the arena, the later tables fall back to the heap
+            FlatHashMap<uint64_t, uint64_t> map(arena);
+            std::unordered_map<uint64_t, uint64_t> reference;
+            for(uint64_t i = 0; i < 20000; i++)
+            {
+                map[i * 31] = i;
+                reference[i * 31] = i;
+            }
+            DS_CHECK(same_contents(map, reference));
+        }
+        ArenaRelease(arena);
+    }
+}
+
+int main()
+{
+    test_random_ops();
+    test_tombstone_churn();
+    test_string_keys();
+    test_arena_storage();
+    return DS_TEST_RESULT();
+}
@@ -0,0 +1,157 @@
+#include "core/reference.h"
+#include "test_common.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace diverse;
+
+namespace
+{
+    struct Tracked
+    {
+        static inline std::atomic<int> alive { 0 };
+        int value;
+
+        explicit Tracked(int v = 0) : value(v) { alive++; }
+        virtual ~Tracked() { alive--; }
+    };
+
+    struct Derived : Tracked
+    {
+        static inline int destroyed = 0;
+        using Tracked::Tracked;
+        ~Derived() override { destroyed++; }
+    };
+
+    void test_strong_lifetime()
+    {
+        {
+            auto a = createSharedPtr<Tracked>(7);
+            DS_CHECK(Tracked::alive == 1 && a.use_count() == 1);
+            auto b = a;
+            DS_CHECK(a.use_count() == 2 && b->value == 7);
+            auto c = std::move(b);
+            DS_CHECK(!b && a.use_count() == 2);
+            a = a; // self assignment keeps the count
+            DS_CHECK(a.use_count() == 2);
+            a.reset();
+            DS_CHECK(Tracked::alive == 1 && c.use_count() == 1);
+        }
+        DS_CHECK(Tracked::alive == 0);
+
+        // adopting a raw pointer allocates the count separately
+        {
+            Reference<Tracked> adopted(new Tracked(3));
+            Reference<Tracked> copy = adopted;
+            DS_CHECK(copy.use_count() == 2);
+        }
+        DS_CHECK(Tracked::alive == 0);
+
+        // a base reference destroys the derived object through the inline block
+        {
+            Reference<Tracked> base = createSharedPtr<Derived>(1);
+            DS_CHECK(base.use_count() == 1);
+            Reference<Derived> down;
+            down = base;
+            DS_CHECK(down && base.use_count() == 2);
+        }
+        DS_CHECK(Tracked::alive == 0 && Derived::destroyed == 1);
+    }
+
+    void test_weak_lifetime()
+    {
+        WeakReference<Tracked> weak;
+        DS_CHECK(weak.expired() && !weak.Lock());
+        {
+            auto strong = createSharedPtr<Tracked>(5);
+            weak        = strong;
+            DS_CHECK(!weak.expired() && strong.getCounter()->getWeakReferenceCount() == 1);
+
+            auto locked = weak.Lock();
+            DS_CHECK(locked && locked->value == 5 && strong.use_count() == 2);
+
+            WeakReference<Tracked> other = weak;
+            DS_CHECK(strong.getCounter()->getWeakReferenceCount() == 2);
+        }
+        // the object is gone, the control block is kept alive by the weak reference
+        DS_CHECK(Tracked::alive == 0);
+        DS_CHECK(weak.expired() && !weak.Lock());
+
+        WeakReference<Tracked> copy = weak;
+        DS_CHECK(copy.expired());
+        weak = nullptr;
+        DS_CHECK(copy.expired() && !copy.Lock());
+    }
+
+    void test_borrowed_lifetime()
+    {
+        auto owner                        = createSharedPtr<Tracked>(9);
+        WeakReference<Tracked> keep_block = owner;
+        Borrowed<Tracked> borrowed        = owner.borrow();
+        DS_CHECK(borrowed && borrowed->value == 9);
+        DS_CHECK(owner.use_count() == 1); // borrowing does not touch the count
+
+        // lock() promotes the borrow into a real reference that outlives the owner
+        auto promoted = borrowed.lock();
+        DS_CHECK(promoted && owner.use_count() == 2);
+        owner.reset();
+        DS_CHECK(Tracked::alive == 1 && promoted->value == 9);
+        promoted.reset();
+        DS_CHECK(Tracked::alive == 0);
+
+        // once the object is gone lock() fails instead of resurrecting it
+        DS_CHECK(!borrowed.lock());
+        DS_CHECK(!Borrowed<Tracked>(nullptr).lock());
+    }
+
+    // strong copies and weak locks race with the owner dropping the last reference
+    void test_concurrent_release()
+    {
+        for(int round = 0; round < 200; round++)
+        {
+            auto owner                  = createSharedPtr<Tracked>(round);
+            WeakReference<Tracked> weak = owner;
+            std::atomic<bool> go { false };
+            std::atomic<int> bad_values { 0 };
+
+            std::vector<std::thread> threads;
+            for(int t = 0; t < 4; t++)
+            {
+                threads.emplace_back([&, copy = owner]() mutable {
+                    while(!go.load(std::memory_order_acquire))
+                        ;
+                    for(int i = 0; i < 100; i++)
+                    {
+                        if(auto locked = weak.Lock())
+                        {
+                            if(locked->value != round)
+                                bad_values++;
+                        }
+                        auto again = copy;
+                        again.reset();
+                    }
+                    copy.reset();
+                });
+            }
+            owner.reset();
+            go.store(true, std::memory_order_release);
+            for(auto& thread : threads)
+                thread.join();
+
+            DS_CHECK(bad_values == 0);
+            DS_CHECK(weak.expired() && !weak.Lock());
+            DS_CHECK(Tracked::alive == 0);
+        }
+    }
+}
+
+int main()
+{
+    test_strong_lifetime();
+    test_weak_lifetime();
+    test_borrowed_lifetime();
+    test_concurrent_release();
+    return DS_TEST_RESULT();
+}
@@ -0,0 +1,149 @@
+#include "renderer/drs_rg/graph.h"
+#include "renderer/drs_rg/pass_builder.h"
+#include "backend/drs_null_rhi/gpu_device_null.h"
+#include "core/ds_log.h"
+#include "test_common.h"
+
+#include <algorithm>
+
+using namespace diverse;
+using namespace diverse::rg;
+
+namespace
+{
+    constexpr auto WRITE = rhi::AccessType::ComputeShaderWrite;
+    constexpr auto READ  = rhi::AccessType::ComputeShaderReadSampledImageOrUniformTexelBuffer;
+
+    struct TestGraph
+    {
+        RenderGraph rg;
+        rhi::GpuTextureDesc desc = rhi::GpuTextureDesc::new_2d(PixelFormat::R16G16B16A16_Float, { 64, 64 });
+
+        explicit TestGraph(rhi::GpuDevice* device)
+            : rg(RenderGraphParams { nullptr, nullptr, device, nullptr, nullptr, {} })
+        {
+        }
+
+        auto texture() -> Handle<rhi::GpuTexture> { return rg.create<rhi::GpuTexture>(desc, "t"); }
+
+        template <typename Reads, typename Writes>
+        void pass(const std::string& name, Reads reads, Writes writes)
+        {
+            auto builder = rg.add_pass(name);
+            for(auto& handle : reads)
+                builder.read(handle, READ);
+            for(auto& handle : writes)
+                builder.write(handle, WRITE);
+            rg.record_pass(std::move(builder.pass));
+        }
+
+        auto kept(const std::string& name) const -> bool
+        {
+            return std::any_of(rg.passes.begin(), rg.passes.end(), [&](const RecordedPass& pass) { return pass.name == name; });
+        }
+    };
+
+    using Textures = std::vector<Handle<rhi::GpuTexture>>;
+
+    void test_dead_pass(rhi::GpuDevice* device)
+    {
+        TestGraph graph(device);
+        auto unused    = graph.texture();
+        auto color     = graph.texture();
+        auto swapchain = graph.rg.get_swap_chain();
+        graph.pass("dead", Textures {}, Textures { unused });
+        graph.pass("shade", Textures {}, Textures { color });
+        graph.pass("present", Textures { color }, Textures { swapchain });
+
+        auto stats = graph.rg.cull_passes();
+        DS_CHECK(stats.total_passes == 3 && stats.culled_passes == 1);
+        DS_CHECK(stats.culled_pass_names == std::vector<std::string> { "dead" });
+        DS_CHECK(stats.culled_pass_ids == std::vector<u32> { 0 });
+        DS_CHECK(stats.culled_resources == 1);
+        DS_CHECK(graph.rg.passes.size() == 2 && graph.kept("shade") && graph.kept("present"));
+        // survivors keep their recorded ids
+        DS_CHECK(graph.rg.passes[0].idx == 1 && graph.rg.passes[1].idx == 2);
+    }
+
+    void test_transitive_chain(rhi::GpuDevice* device)
+    {
+        TestGraph graph(device);
+        auto a         = graph.texture();
+        auto b         = graph.texture();
+        auto c         = graph.texture();
+        auto color     = graph.texture();
+        auto swapchain = graph.rg.get_swap_chain();
+        graph.pass("chain_0", Textures {}, Textures { a });
+        graph.pass("shade", Textures {}, Textures { color });
+        graph.pass("chain_1", Textures { a }, Textures { b });
+        graph.pass("chain_2", Textures { b, color }, Textures { c });
+        graph.pass("present", Textures { color }, Textures { swapchain });
+
+        // nothing reads c, so the whole chain feeding it goes, even though chain_2 reads a live resource
+        auto stats = graph.rg.cull_passes();
+        DS_CHECK(stats.culled_passes == 3);
+        DS_CHECK(stats.culled_pass_names == (std::vector<std::string> { "chain_0", "chain_1", "chain_2" }));
+        DS_CHECK(stats.culled_resources == 3);
+        DS_CHECK(graph.rg.passes.size() == 2 && graph.kept("shade") && graph.kept("present"));
+    }
+
+    void test_imported_and_exported(rhi::GpuDevice* device)
+    {
+        TestGraph graph(device);
+        auto history  = device->create_texture(graph.desc, {}, "history");
+        auto imported = graph.rg.import_res(history, rhi::AccessType::Nothing);
+        auto feedback = graph.texture();
+        auto temp     = graph.texture();
+        auto exported = graph.texture();
+
+        graph.pass("feedback", Textures {}, Textures { feedback });
+        graph.pass("write_import", Textures { feedback }, Textures { imported });
+        graph.pass("produce", Textures {}, Textures { temp });
+        graph.pass("write_export", Textures { temp }, Textures { exported });
+        graph.pass("overwrite_dead", Textures {}, Textures { graph.texture() });
+        graph.rg.export_res(exported, READ);
+
+        {
+            // declares no writes, its effect is invisible to the graph so it stays
+            auto builder = graph.rg.add_pass("side_effect");
+            graph.rg.record_pass(std::move(builder.pass));
+        }
+
+        auto stats = graph.rg.cull_passes();
+        DS_CHECK(stats.culled_pass_names == std::vector<std::string> { "overwrite_dead" });
+        DS_CHECK(graph.kept("write_import") && graph.kept("feedback"));
+        DS_CHECK(graph.kept("produce") && graph.kept("write_export"));
+        DS_CHECK(graph.kept("side_effect"));
+    }
+
+    void test_live_graph_untouched(rhi::GpuDevice* device)
+    {
+        TestGraph graph(device);
+        auto swapchain = graph.rg.get_swap_chain();
+        Textures chain;
+        for(int i = 0; i < 8; i++)
+        {
+            chain.push_back(graph.texture());
+            graph.pass("p" + std::to_string(i), i ? Textures { chain[i - 1] } : Textures {}, Textures { chain[i] });
+        }
+        graph.pass("present", Textures { chain.back() }, Textures { swapchain });
+
+        auto stats = graph.rg.cull_passes();
+        DS_CHECK(stats.culled_passes == 0 && stats.culled_resources == 0);
+        DS_CHECK(graph.rg.passes.size() == 9);
+        for(u32 i = 0; i < graph.rg.passes.size(); i++)
+            DS_CHECK(graph.rg.passes[i].idx == i);
+    }
+}
+
+int main()
+{
+    debug::Log::init();
+    rhi::GpuDeviceNull device(0);
+
+    test_dead_pass(&device);
+    test_transitive_chain(&device);
+    test_imported_and_exported(&device);
+    test_live_graph_untouched(&device);
+    return DS_TEST_RESULT();
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+
+// Minimal checks for the engine unit tests: a failed check is reported and main returns DS_TEST_RESULT()
+namespace diverse::test
+{
+    inline int failures = 0;
+}
+
+#define DS_CHECK(condition)                                                                   \
+    do {                                                                                      \
+        if(!(condition))                                                                      \
+        {                                                                                     \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++::diverse::test::failures;                                                      \
+        }                                                                                     \
+    } while(0)
+
+#define DS_TEST_RESULT() \
+    (::diverse::test::failures ? (std::fprintf(stderr, "%d checks failed\n", ::diverse::test::failures), EXIT_FAILURE) : EXIT_SUCCESS)
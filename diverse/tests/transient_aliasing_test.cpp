@@ -0,0 +1,143 @@
+#include "renderer/drs_rg/transient_aliasing.h"
+#include "test_common.h"
+
+#include <random>
+
+using namespace diverse;
+using namespace diverse::rg;
+
+namespace
+{
+    auto request(u64 size, u32 first_pass, u32 last_pass, u64 alignment = 1) -> TransientAliasingRequest
+    {
+        TransientAliasingRequest r;
+        r.size       = size;
+        r.alignment  = alignment;
+        r.first_pass = first_pass;
+        r.last_pass  = last_pass;
+        return r;
+    }
+
+    auto contains(const std::vector<u32>& list, u32 value) -> bool
+    {
+        return std::find(list.begin(), list.end(), value) != list.end();
+    }
+
+    // invariants every plan has to satisfy, whatever the placement heuristic
+    void check_plan(const std::vector<TransientAliasingRequest>& requests, const TransientAliasingPlan& plan)
+    {
+        DS_CHECK(plan.offsets.size() == requests.size() && plan.aliased.size() == requests.size());
+        u64 requested = 0;
+        for(u32 i = 0; i < requests.size(); i++)
+        {
+            const auto& a = requests[i];
+            requested += a.size;
+            DS_CHECK(plan.offsets[i] % std::max<u64>(a.alignment, 1) == 0);
+            DS_CHECK(plan.offsets[i] + a.size <= plan.heap_size);
+            for(u32 j = 0; j < requests.size(); j++)
+            {
+                if(i == j)
+                    continue;
+                const auto& b     = requests[j];
+                const bool live   = a.first_pass <= b.last_pass && b.first_pass <= a.last_pass;
+                const bool shares = plan.offsets[i] < plan.offsets[j] + b.size && plan.offsets[j] < plan.offsets[i] + a.size;
+                DS_CHECK(!(live && shares));
+                // aliased lists exactly the earlier-ending requests sharing bytes
+                DS_CHECK(contains(plan.aliased[i], j) == (shares && b.last_pass < a.first_pass));
+            }
+        }
+        DS_CHECK(plan.requested_bytes == requested);
+    }
+
+    void test_overlapping_lifetimes()
+    {
+        std::vector<TransientAliasingRequest> requests = { request(100, 0, 2), request(100, 1, 3), request(100, 3, 4) };
+        auto plan = plan_transient_aliasing(requests);
+        check_plan(requests, plan);
+        DS_CHECK(plan.offsets[0] != plan.offsets[1]);
+        // the third only overlaps the second, so it reuses the first one's bytes
+        DS_CHECK(plan.offsets[2] == plan.offsets[0]);
+        DS_CHECK(plan.heap_size == 200);
+        DS_CHECK(plan.aliased[2] == std::vector<u32> { 0 });
+    }
+
+    void test_disjoint_lifetimes()
+    {
+        std::vector<TransientAliasingRequest> requests = { request(256, 0, 1), request(256, 2, 3), request(128, 4, 4) };
+        auto plan = plan_transient_aliasing(requests);
+        check_plan(requests, plan);
+        DS_CHECK(plan.offsets[0] == 0 && plan.offsets[1] == 0 && plan.offsets[2] == 0);
+        DS_CHECK(plan.heap_size == 256 && plan.requested_bytes == 640);
+        DS_CHECK(plan.aliased[0].empty());
+        DS_CHECK(plan.aliased[1] == std::vector<u32> { 0 });
+        DS_CHECK(plan.aliased[2].size() == 2);
+    }
+
+    void test_alignment()
+    {
+        // the large unaligned request goes first, the aligned ones have to skip to the next boundary
+        std::vector<TransientAliasingRequest> requests = { request(100, 0, 3), request(50, 0, 3, 64), request(10, 1, 2, 256) };
+        auto plan = plan_transient_aliasing(requests);
+        check_plan(requests, plan);
+        DS_CHECK(plan.offsets[0] == 0);
+        DS_CHECK(plan.offsets[1] == 128);
+        DS_CHECK(plan.offsets[2] == 256);
+        DS_CHECK(plan.heap_size == 266);
+
+        // a gap too small once aligned is skipped
+        requests = { request(64, 0, 1), request(64, 0, 1), request(32, 0, 1, 128), request(64, 2, 2) };
+        plan     = plan_transient_aliasing(requests);
+        check_plan(requests, plan);
+        DS_CHECK(plan.offsets[2] == 128);
+    }
+
+    void test_random_plans()
+    {
+        std::mt19937 rng(7);
+        for(int round = 0; round < 500; round++)
+        {
+            std::vector<TransientAliasingRequest> requests(1 + rng() % 24);
+            for(auto& r : requests)
+            {
+                const u32 first = rng() % 16;
+                r = request(1 + rng() % 4096, first, first + rng() % 6, u64(1) << (rng() % 9));
+            }
+            check_plan(requests, plan_transient_aliasing(requests));
+        }
+    }
+
+    void test_barrier_predecessor()
+    {
+        // a chain through the same bytes: the last user waits on the one right before it
+        std::vector<TransientAliasingRequest> chain = { request(64, 0, 0), request(64, 1, 1), request(64, 2, 2) };
+        auto plan = plan_transient_aliasing(chain);
+        check_plan(chain, plan);
+        DS_CHECK(!aliasing_barrier_predecessor(chain, plan, 0));
+        DS_CHECK(aliasing_barrier_predecessor(chain, plan, 1) == std::optional<u32>(0));
+        DS_CHECK(aliasing_barrier_predecessor(chain, plan, 2) == std::optional<u32>(1));
+
+        // two predecessors live side by side never alias each other, no single one to wait on
+        std::vector<TransientAliasingRequest> split = { request(100, 0, 0), request(100, 0, 0), request(200, 1, 1) };
+        plan = plan_transient_aliasing(split);
+        check_plan(split, plan);
+        DS_CHECK(plan.aliased[2].size() == 2);
+        DS_CHECK(!aliasing_barrier_predecessor(split, plan, 2));
+
+        // the latest predecessor already aliased the other one
+        std::vector<TransientAliasingRequest> ordered = { request(64, 0, 0), request(128, 1, 2), request(128, 3, 3) };
+        plan = plan_transient_aliasing(ordered);
+        check_plan(ordered, plan);
+        DS_CHECK(plan.aliased[2].size() == 2);
+        DS_CHECK(aliasing_barrier_predecessor(ordered, plan, 2) == std::optional<u32>(1));
+    }
+}
+
+int main()
+{
+    test_overlapping_lifetimes();
+    test_disjoint_lifetimes();
+    test_alignment();
+    test_random_plans();
+    test_barrier_predecessor();
+    return DS_TEST_RESULT();
+}